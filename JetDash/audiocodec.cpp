@@ -0,0 +1,348 @@
+#include "audiocodec.h"
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+const double PI = 3.14159265358979323846;
+const double KAISER_BETA = 8.0;     // 저지대역 약 -80dB
+// 차단(-6dB)은 낮은 쪽 나이퀴스트. 전이 대역이 그 양쪽으로 걸쳐서 8k 출력이면 약 3.4k까지 평탄하고,
+// 4.6k 위는 -80dB라 접혀 들어와도 3.4k 위로만 떨어집니다
+const double CUTOFF = 1.0;
+
+// 0차 변형 베셀 함수 (Kaiser 창)
+double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+const int IMA_INDEX[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+const int IMA_STEP[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+// 코드 하나로 상태를 갱신합니다 (인코더/디코더가 같은 식을 써야 어긋나지 않음)
+inline void imaStep(ImaAdpcmState &s, int code)
+{
+    int step = IMA_STEP[s.index];
+    int diff = step >> 3;
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+    int pred = s.predictor + ((code & 8) ? -diff : diff);
+    s.predictor = qint16(qBound(-32768, pred, 32767));
+    s.index = quint8(qBound(0, s.index + IMA_INDEX[code], 88));
+}
+
+inline int imaCode(const ImaAdpcmState &s, int sample)
+{
+    int step = IMA_STEP[s.index];
+    int diff = sample - s.predictor;
+    int code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    if (diff >= step >> 1) { code |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) code |= 1;
+    return code;
+}
+
+inline void put16(char *p, int v)
+{
+    p[0] = char(v & 0xff);
+    p[1] = char((v >> 8) & 0xff);
+}
+
+// 컴포트 노이즈: RMS가 level(-dBFS)인 균일 분포 백색 잡음. 같은 timestamp면 같은 잡음 (로봇 쪽과 같은 식)
+void comfortNoise(int level, quint32 timestamp, qint16 *pcm, int n)
+{
+    double a = 32768.0 * 1.7320508;     // [-a, a] 균일 분포의 RMS = a / sqrt(3)
+    for (int i = 0; i < level; ++i) a *= 0.89125094;   // -1dB
+    qint32 amp = a > 32767.0 ? 32767 : qint32(a + 0.5);
+    quint32 x = timestamp * 2654435761u + 1;
+    for (int i = 0; i < n; ++i) {
+        x = x * 1664525u + 1013904223u;
+        pcm[i] = qint16(qint32((x >> 8) % quint32(2 * amp + 1)) - amp);
+    }
+}
+}
+
+const char *AudioPacket::codecName(int codec)
+{
+    switch (codec) {
+    case Pcm16: return "PCM";
+    case ImaAdpcm: return "ADPCM";
+    default: return "RAW";
+    }
+}
+
+// ------------------ 리샘플러 ------------------ //
+void PolyphaseResampler::configure(int inRate, int outRate, int zeroCrossings)
+{
+    inHz = inRate;
+    outHz = outRate;
+    int g = std::gcd(inRate, outRate);
+    L = outRate / g;
+    M = inRate / g;
+
+    if (L == 1 && M == 1) {
+        taps = 1;
+        coeffs = QVector<float>(1, 1.0f);
+        reset();
+        return;
+    }
+
+    // L배 올린 신호(L * inRate)에서 본 차단 주파수
+    double wc = CUTOFF * 0.5 * qMin(inRate, outRate) / (double(L) * inRate);
+    taps = int(std::ceil(zeroCrossings / wc / L));
+    int n = taps * L;
+    double center = (n - 1) / 2.0;
+    double i0Beta = besselI0(KAISER_BETA);
+
+    QVector<double> h(n);
+    for (int k = 0; k < n; ++k) {
+        double t = k - center;
+        double x = 2 * wc * t;
+        double sinc = (t == 0) ? 1.0 : std::sin(PI * x) / (PI * x);
+        double r = t / (center + 0.5);
+        double win = besselI0(KAISER_BETA * std::sqrt(qMax(0.0, 1 - r * r))) / i0Beta;
+        h[k] = 2 * wc * sinc * win;
+    }
+
+    // phase p의 j번째 탭 = h[p + j*L] (j = 0이 가장 최근 입력). phase마다 합을 1로 맞춰 DC 이득 오차를 없앱니다
+    coeffs.resize(n);
+    for (int p = 0; p < L; ++p) {
+        double sum = 0;
+        for (int j = 0; j < taps; ++j) sum += h[p + j * L];
+        for (int j = 0; j < taps; ++j) coeffs[p * taps + j] = float(h[p + j * L] / sum);
+    }
+    reset();
+}
+
+void PolyphaseResampler::reset()
+{
+    work = QVector<float>(taps - 1, 0.0f);
+    phase = 0;
+    pos = taps - 1;
+}
+
+double PolyphaseResampler::delayMs() const
+{
+    if (inHz == 0 || taps == 1) return 0.0;
+    return (double(taps) * L - 1) / 2.0 / (double(L) * inHz) * 1000.0;
+}
+
+int PolyphaseResampler::process(const qint16 *in, int n, qint16 *out)
+{
+    int keep = taps - 1;
+    work.resize(keep + n);
+    float *w = work.data();
+    for (int i = 0; i < n; ++i) w[keep + i] = in[i];
+
+    int produced = 0;
+    int end = keep + n;
+    while (pos < end) {
+        const float *c = coeffs.constData() + phase * taps;
+        const float *x = w + pos;
+        float acc = 0.0f;
+        for (int j = 0; j < taps; ++j) acc += c[j] * x[-j];
+        out[produced++] = qint16(qBound(-32768L, std::lrint(acc), 32767L));
+
+        phase += M;
+        pos += phase / L;
+        phase %= L;
+    }
+
+    // 다음 블록을 위해 마지막 taps-1개를 앞으로
+    std::copy(w + n, w + end, w);
+    pos -= n;
+    return produced;
+}
+
+// ------------------ IMA ADPCM ------------------ //
+void ImaAdpcm::encode(ImaAdpcmState &state, const qint16 *pcm, int n, quint8 *out)
+{
+    for (int i = 0; i < n; i += 2) {
+        int lo = imaCode(state, pcm[i]);
+        imaStep(state, lo);
+        int hi = 0;
+        if (i + 1 < n) {
+            hi = imaCode(state, pcm[i + 1]);
+            imaStep(state, hi);
+        }
+        *out++ = quint8(lo | (hi << 4));
+    }
+}
+
+void ImaAdpcm::decode(ImaAdpcmState &state, const quint8 *in, int n, qint16 *pcm)
+{
+    for (int i = 0; i < n; ++i) {
+        int code = (i & 1) ? (in[i >> 1] >> 4) : (in[i >> 1] & 0x0f);
+        imaStep(state, code);
+        pcm[i] = state.predictor;
+    }
+}
+
+// ------------------ 패킷 ------------------ //
+void AudioEncoder::configure(int inRate, int outRate, int codec, int frameMs)
+{
+    resampler.configure(inRate, outRate);
+    mode = codec;
+    frameMillis = frameMs;
+    frame.resize(qBound(1, outRate * frameMs / 1000, AudioPacket::MAX_SAMPLES));
+    int bytes = AudioPacket::HEADER_SIZE + AudioPacket::ADPCM_HEADER_SIZE + frame.size() * 2;
+    packet.reserve(bytes);
+    cnFrames = qBound(1, AudioPacket::CN_SPAN_MS / qMax(1, frameMs), AudioPacket::MAX_SAMPLES / int(frame.size()));
+    detector.configure(outRate);
+    reset();
+}
+
+void AudioEncoder::reset()
+{
+    resampler.reset();
+    filled = 0;
+    adpcm = ImaAdpcmState();
+    detector.reset();
+    cnLeft = 0;
+}
+
+void AudioEncoder::setSilenceSuppression(bool on)
+{
+    suppress = on;
+    cnLeft = 0;
+}
+
+// 음성 프레임 하나의 패킷 크기 (UDP/IP 헤더 제외)
+int AudioEncoder::packetBytes() const
+{
+    int n = frame.size();
+    return mode == AudioPacket::ImaAdpcm ? AudioPacket::HEADER_SIZE + AudioPacket::ADPCM_HEADER_SIZE + (n + 1) / 2
+         : mode == AudioPacket::Pcm16 ? AudioPacket::HEADER_SIZE + n * 2
+         : n * 2;
+}
+
+int AudioEncoder::bitrate() const
+{
+    return packetBytes() * 8 * 1000 / frameMillis;
+}
+
+void AudioEncoder::writeHeader(char *p, quint8 flags, int n)
+{
+    p[0] = char(AudioPacket::MAGIC | mode);
+    p[1] = char(flags);
+    put16(p + 2, n);
+    put16(p + 4, seq);
+    put16(p + 6, 0);                // delay: 마이크 쪽은 재지 않음
+    put16(p + 8, int(timestamp & 0xffff));
+    put16(p + 10, int(timestamp >> 16));
+    seq++;
+}
+
+// 보낼 패킷이 있으면 packet에 쓰고 true
+bool AudioEncoder::encodeFrame()
+{
+    int n = frame.size();
+    sent.frames++;
+    sent.fullBytes += quint64(packetBytes() + AudioPacket::UDP_IP_OVERHEAD);
+    if (mode == AudioPacket::Raw) {
+        packet.resize(n * 2);
+        std::memcpy(packet.data(), frame.constData(), size_t(n) * 2);   // little-endian 호스트
+        sent.packets++;
+        sent.bytes += quint64(packet.size() + AudioPacket::UDP_IP_OVERHEAD);
+        return true;
+    }
+
+    if (suppress && !detector.update(frame.constData(), n)) {
+        // 조용한 프레임: 지난 CN 패킷이 덮고 있으면 아무것도 안 보내고, 아니면 새 CN 패킷 (지금 잡음 바닥 크기)
+        sent.suppressed++;
+        bool send = cnLeft == 0;
+        if (send) {
+            packet.resize(AudioPacket::HEADER_SIZE + 1);
+            char *p = packet.data();
+            writeHeader(p, AudioPacket::FLAG_CN, n * cnFrames);
+            p[AudioPacket::HEADER_SIZE] = char(qBound(0, int(std::lround(-detector.noiseDb())), AudioPacket::CN_MAX_LEVEL));
+            cnLeft = cnFrames;
+            sent.packets++;
+            sent.comfortPackets++;
+            sent.bytes += quint64(packet.size() + AudioPacket::UDP_IP_OVERHEAD);
+        }
+        cnLeft--;
+        timestamp += quint32(n);
+        return send;
+    }
+    cnLeft = 0;
+
+    char *p;
+    if (mode == AudioPacket::ImaAdpcm) {
+        packet.resize(AudioPacket::HEADER_SIZE + AudioPacket::ADPCM_HEADER_SIZE + (n + 1) / 2);
+        p = packet.data();
+        char *body = p + AudioPacket::HEADER_SIZE;
+        put16(body, adpcm.predictor);
+        body[2] = char(adpcm.index);
+        body[3] = 0;
+        ImaAdpcm::encode(adpcm, frame.constData(), n,
+                         reinterpret_cast<quint8 *>(body + AudioPacket::ADPCM_HEADER_SIZE));
+    } else {
+        packet.resize(AudioPacket::HEADER_SIZE + n * 2);
+        p = packet.data();
+        for (int i = 0; i < n; ++i) put16(p + AudioPacket::HEADER_SIZE + 2 * i, frame[i]);
+    }
+    writeHeader(p, 0, n);
+    timestamp += quint32(n);
+    sent.packets++;
+    sent.bytes += quint64(packet.size() + AudioPacket::UDP_IP_OVERHEAD);
+    return true;
+}
+
+int decodeAudioPacket(const quint8 *data, int len, qint16 *pcm, int capacity, AudioPacket::Header *header)
+{
+    if (len < AudioPacket::HEADER_SIZE || (data[0] & AudioPacket::MAGIC_MASK) != AudioPacket::MAGIC) return -1;
+    int codec = data[0] & 0x0f;
+    int n = data[2] | (data[3] << 8);
+    if (n > capacity || n > AudioPacket::MAX_SAMPLES) return -1;
+    const quint8 *body = data + AudioPacket::HEADER_SIZE;
+    len -= AudioPacket::HEADER_SIZE;
+    quint32 timestamp = quint32(data[8]) | (quint32(data[9]) << 8) | (quint32(data[10]) << 16)
+                      | (quint32(data[11]) << 24);
+    if (header) {
+        header->codec = codec;
+        header->flags = data[1];
+        header->seq = quint16(data[4] | (data[5] << 8));
+        header->delay = quint16(data[6] | (data[7] << 8));
+        header->timestamp = timestamp;
+    }
+
+    if (data[1] & AudioPacket::FLAG_CN) {
+        if ((codec != AudioPacket::ImaAdpcm && codec != AudioPacket::Pcm16) || len < 1
+            || body[0] > AudioPacket::CN_MAX_LEVEL) return -1;
+        comfortNoise(body[0], timestamp, pcm, n);
+        return n;
+    }
+    if (codec == AudioPacket::ImaAdpcm) {
+        if (len < AudioPacket::ADPCM_HEADER_SIZE + (n + 1) / 2 || body[2] > 88) return -1;
+        ImaAdpcmState s;
+        s.predictor = qint16(body[0] | (body[1] << 8));
+        s.index = body[2];
+        ImaAdpcm::decode(s, body + AudioPacket::ADPCM_HEADER_SIZE, n, pcm);
+        return n;
+    }
+    if (codec == AudioPacket::Pcm16) {
+        if (len < n * 2) return -1;
+        for (int i = 0; i < n; ++i) pcm[i] = qint16(body[2 * i] | (body[2 * i + 1] << 8));
+        return n;
+    }
+    return -1;
+}
@@ -0,0 +1,168 @@
+#ifndef AUDIOCODEC_H
+#define AUDIOCODEC_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+#include <algorithm>
+
+#include "audiolevel.h"
+
+// 음성 UDP 패킷 (docs/Protocol.md 4장, 로봇 쪽 audio_codec.h와 맞춰야 함, 전부 little-endian)
+//   [0] 0xA0 | codec  [1] flags  [2..3] 샘플 수  [4..5] seq  [6..7] delay  [8..11] timestamp  [12..] codec별 데이터
+//   seq는 패킷마다 1씩, timestamp는 첫 샘플 번호(재생 주파수 기준). 받는 쪽 지터 버퍼가 순서/손실/재생 위치를 봅니다
+//   delay는 보낸 쪽에서 잰 첫 샘플 캡처 -> 전송 (0.1ms 단위, 0 = 모름). 로봇 마이크 패킷만 채웁니다
+//   IMA ADPCM: [12..13] 블록 시작 predictor (int16)  [14] step index  [15] 0  [16..] 샘플당 4bit (아래 nibble 먼저)
+//   flags FLAG_CN: 말이 없는 구간. 데이터 대신 [12] 잡음 크기 (-dBFS, RFC 3389처럼 0~127)이고
+//   받는 쪽이 샘플 수만큼 그 크기의 백색 잡음(컴포트 노이즈)을 만듭니다
+// 블록마다 디코더 상태가 들어 있어서 패킷이 빠져도 다음 패킷부터 바로 복원됩니다.
+namespace AudioPacket {
+const quint8 MAGIC = 0xA0;
+const quint8 MAGIC_MASK = 0xF0;
+const int HEADER_SIZE = 12;
+const int ADPCM_HEADER_SIZE = 4;
+const int MAX_SAMPLES = 2048;           // 로봇이 파이프에 한 번에(PIPE_BUF 이하) 쓸 수 있도록
+const quint8 FLAG_CN = 0x01;            // 컴포트 노이즈 패킷
+const int CN_MAX_LEVEL = 127;
+const int CN_SPAN_MS = 100;             // CN 패킷 하나가 덮는 길이 (조용한 동안 이 간격으로 보냄)
+const int UDP_IP_OVERHEAD = 28;         // 패킷마다 붙는 IPv4 + UDP 헤더 (대역폭 계산용)
+
+enum Codec {
+    Pcm16 = 0,
+    ImaAdpcm = 1,
+    Raw = -1,           // 헤더 없는 PCM16 (HELLO에 응답하지 않는 예전 서버)
+};
+
+const char *codecName(int codec);
+
+struct Header {
+    int codec = Raw;
+    quint8 flags = 0;
+    quint16 seq = 0;
+    quint32 timestamp = 0;
+    quint16 delay = 0;          // 0.1ms 단위
+};
+}
+
+// 정수비 L/M 폴리페이스 리샘플러 (Kaiser 창 sinc 저역 통과)
+// 출력 샘플마다 필터 한 phase(taps개)만 곱합니다. 48k -> 8k면 L=1, M=6, 44.1k -> 8k면 L=80, M=441
+// 블록 경계와 상관없이 이어지도록 직전 입력 taps-1개를 들고 있습니다.
+class PolyphaseResampler
+{
+public:
+    // zeroCrossings: 필터 한쪽 날개의 영점 수 (클수록 급한 차단, 지연/연산 증가)
+    void configure(int inRate, int outRate, int zeroCrossings = 16);
+    void reset();
+
+    int inRate() const { return inHz; }
+    int outRate() const { return outHz; }
+    // n개를 넣었을 때 나올 수 있는 최대 출력 수
+    int maxOutput(int n) const { return int((qint64(n) * L + phase) / M) + 1; }
+    // 필터 군지연 (ms)
+    double delayMs() const;
+
+    // 출력 샘플 수를 돌려줍니다. out은 maxOutput(n)개 이상
+    int process(const qint16 *in, int n, qint16 *out);
+
+private:
+    int inHz = 0, outHz = 0;
+    int L = 1, M = 1;
+    int taps = 1;               // phase당 탭 수
+    QVector<float> coeffs;      // [phase][tap], tap 순서는 최근 입력부터
+    QVector<float> work;        // 이전 taps-1개 + 이번 입력
+    int phase = 0;              // 다음 출력의 phase (0..L-1)
+    int pos = 0;                // 다음 출력이 쓰는 가장 최근 입력의 work 위치
+};
+
+// IMA ADPCM (샘플당 4bit, 16bit PCM의 1/4)
+struct ImaAdpcmState {
+    qint16 predictor = 0;
+    quint8 index = 0;
+};
+
+namespace ImaAdpcm {
+// n개를 (n+1)/2바이트로. state는 다음 블록으로 이어집니다
+void encode(ImaAdpcmState &state, const qint16 *pcm, int n, quint8 *out);
+void decode(ImaAdpcmState &state, const quint8 *in, int n, qint16 *pcm);
+}
+
+// 마이크 -> 리샘플 -> 고정 길이(10/20ms) 프레임 -> 인코딩 -> 패킷
+// 무음 억제를 켜면 프레임마다 VAD를 보고, 조용한 프레임은 보내지 않고 CN_SPAN_MS마다 CN 패킷 하나만 보냅니다.
+// CN 패킷은 그 뒤 CN_SPAN_MS를 미리 덮고 (말이 다시 시작되면 받는 쪽에서 말소리가 덮어씀), seq는 보낸 패킷끼리 이어집니다
+class AudioEncoder
+{
+public:
+    // 보낸 양 (UDP/IP 헤더 포함). fullBytes는 억제하지 않았으면 보냈을 양
+    struct Traffic {
+        quint64 frames = 0;
+        quint64 suppressed = 0;     // 말소리가 아니라서 음성 패킷 대신 CN으로 넘긴 프레임
+        quint64 packets = 0;
+        quint64 comfortPackets = 0;
+        quint64 bytes = 0;
+        quint64 fullBytes = 0;
+    };
+
+    void configure(int inRate, int outRate, int codec, int frameMs);
+    void reset();
+    // 받는 쪽이 CN 패킷을 알아들을 때만 켭니다 (HELLO의 audio_cn). 헤더 없는 PCM16에서는 항상 꺼짐
+    void setSilenceSuppression(bool on);
+    bool silenceSuppression() const { return suppress && mode != AudioPacket::Raw; }
+    const VoiceActivityDetector &vad() const { return detector; }
+    const Traffic &traffic() const { return sent; }
+    void resetTraffic() { sent = Traffic(); }
+
+    int codec() const { return mode; }
+    int outRate() const { return resampler.outRate(); }
+    int frameMs() const { return frameMillis; }
+    int frameSamples() const { return int(frame.size()); }
+    // 이 경로가 더하는 지연: 리샘플러 군지연 + 프레임을 다 모을 때까지 (마지막 샘플 기준 0, 첫 샘플 기준 frameMs)
+    double addedLatencyMs() const { return resampler.delayMs() + frameMillis; }
+    // 초당 음성 데이터 (UDP/IP 헤더 제외)
+    int bitrate() const;
+
+    // 입력을 넣고 보낼 패킷이 생길 때마다 onPacket(const QByteArray &)을 부릅니다 (패킷 버퍼는 재사용)
+    template <typename F>
+    void push(const qint16 *in, int n, F onPacket)
+    {
+        if (resampled.size() < resampler.maxOutput(n)) resampled.resize(resampler.maxOutput(n));
+        int produced = resampler.process(in, n, resampled.data());
+        const qint16 *p = resampled.constData();
+        while (produced > 0) {
+            int take = qMin(produced, int(frame.size()) - filled);
+            std::copy(p, p + take, frame.data() + filled);
+            filled += take;
+            p += take;
+            produced -= take;
+            if (filled == frame.size()) {
+                filled = 0;
+                if (encodeFrame()) onPacket(packet);
+            }
+        }
+    }
+
+private:
+    int packetBytes() const;
+    bool encodeFrame();
+    void writeHeader(char *p, quint8 flags, int n);
+
+    PolyphaseResampler resampler;
+    int mode = AudioPacket::ImaAdpcm;
+    int frameMillis = 20;
+    QVector<qint16> resampled;
+    QVector<qint16> frame;
+    int filled = 0;
+    ImaAdpcmState adpcm;
+    bool suppress = false;
+    VoiceActivityDetector detector;
+    int cnFrames = 1;           // CN 패킷 하나가 덮는 프레임 수
+    int cnLeft = 0;             // 지난 CN 패킷이 아직 덮고 있는 프레임
+    Traffic sent;
+    quint16 seq = 0;            // configure()/reset()에도 이어집니다 (로봇이 새 스트림으로 착각하지 않도록)
+    quint32 timestamp = 0;
+    QByteArray packet;
+};
+
+// 패킷 -> PCM (로봇 쪽 audio_packet_decode()와 같은 동작, CN 패킷이면 같은 컴포트 노이즈). 샘플 수, 깨진 패킷이면 -1
+int decodeAudioPacket(const quint8 *data, int len, qint16 *pcm, int capacity, AudioPacket::Header *header = nullptr);
+
+#endif // AUDIOCODEC_H
@@ -0,0 +1,282 @@
+#include "audiojitter.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "audiocodec.h"
+
+namespace {
+const quint32 RING_MASK = AudioJitterBuffer::RING - 1;
+const quint32 HISTORY_MASK = AudioJitterBuffer::HISTORY - 1;
+}
+
+void AudioJitterBuffer::configure(int rate)
+{
+    sampleRate = rate > 0 ? rate : 8000;
+    reset();
+}
+
+void AudioJitterBuffer::reset()
+{
+    started = false;
+    startNs = lastArrivalNs = 0;
+    emitted = 0;
+    playTs = endTs = 0;
+    adjust = 0;
+    std::memset(valid, 0, sizeof(valid));
+    std::memset(history, 0, sizeof(history));
+    historyPos = 0;
+    pitch = 1;
+    plcRun = fade = skip = skipPos = 0;
+    prevArrivalNs = 0;
+    prevTs = 0;
+    jitter = 0;
+    windowMin = INT_MAX;
+    windowStartNs = 0;
+    maxSeq = 0;
+    seqCycles = baseSeq = 0;
+    seen = 0;
+    expectedBefore = 0;
+    st = Stats();
+}
+
+// 재생 시계로 now까지 내보냈어야 하는데 아직 안 내보낸 샘플 (재생 시작 전이면 음수)
+qint64 AudioJitterBuffer::due(qint64 nowNs) const
+{
+    return (nowNs - startNs) * sampleRate / 1000000000LL - qint64(emitted);
+}
+
+// 첫 패킷 (또는 timestamp가 크게 튀었을 때): 이 패킷을 START_MS 뒤에 재생
+void AudioJitterBuffer::start(quint16 seq, quint32 timestamp, qint64 nowNs)
+{
+    if (st.packets) expectedBefore += seqCycles + maxSeq - baseSeq + 1;
+    std::memset(valid, 0, sizeof(valid));
+    started = true;
+    startNs = nowNs + qint64(START_MS) * 1000000;
+    emitted = 0;
+    playTs = endTs = timestamp;
+    adjust = 0;
+    plcRun = fade = skip = skipPos = 0;
+    prevArrivalNs = 0;
+    windowMin = INT_MAX;
+    windowStartNs = nowNs;
+    maxSeq = seq;
+    baseSeq = seq;
+    seqCycles = 0;
+    seen = 0;
+}
+
+// 64개 창 안에서 이미 받은 seq면 true
+bool AudioJitterBuffer::seqSeen(quint16 seq)
+{
+    qint16 d = qint16(quint16(seq - maxSeq));
+    if (d > 0) {
+        if (seq < maxSeq) seqCycles += 65536;
+        seen = d >= 64 ? 1 : (seen << d) | 1;
+        maxSeq = seq;
+        return false;
+    }
+    if (-d >= 64) return false;         // 너무 오래된 것 (어차피 늦음)
+    if (seen & (1ULL << -d)) return true;
+    seen |= 1ULL << -d;
+    return false;
+}
+
+// 늦은 패킷에 맞춰 지연을 늘리고, 1초 동안 남았으면 줄입니다
+void AudioJitterBuffer::adapt(int wait, qint64 nowNs)
+{
+    int m = margin();
+    if (wait < m) {
+        // 지금 버퍼 깊이 + 예약된 조정이 최대 지연을 넘지 않게
+        int depth = int(qint32(endTs - playTs)) - int(due(nowNs)) + adjust;
+        int need = qMin(m - wait, msToSamples(MAX_DELAY_MS) - depth);
+        if (need > 0) adjust += need;
+    }
+
+    windowMin = qMin(windowMin, wait);
+    if (nowNs - windowStartNs >= qint64(WINDOW_MS) * 1000000) {
+        int excess = windowMin - m;
+        if (adjust == 0 && excess > m) adjust = -excess / 2;
+        windowMin = INT_MAX;
+        windowStartNs = nowNs;
+    }
+}
+
+AudioJitterBuffer::PutResult AudioJitterBuffer::put(const quint8 *data, int len, qint64 nowNs)
+{
+    qint16 pcm[AudioPacket::MAX_SAMPLES];
+    AudioPacket::Header h;
+    int n = decodeAudioPacket(data, len, pcm, AudioPacket::MAX_SAMPLES, &h);
+    if (n < 0) return Bad;
+
+    if (!started) start(h.seq, h.timestamp, nowNs);
+    int off = int(qint32(h.timestamp - playTs));
+    if (off > RING - n || off < -RING) {
+        // 보내는 쪽이 다시 시작했거나 오래 끊겼다 -> 새로 맞춥니다
+        st.restarts++;
+        start(h.seq, h.timestamp, nowNs);
+        off = 0;
+    }
+    if (seqSeen(h.seq)) {
+        st.duplicates++;
+        return Dropped;
+    }
+    st.packets++;
+    lastArrivalNs = nowNs;
+    if (h.delay) st.senderDelay.add(qint64(h.delay) * 100000);
+
+    // RFC 3550 도착 지터: 두 패킷의 도착 간격과 timestamp 간격의 차이를 1/16씩 평균
+    if (prevArrivalNs) {
+        double d = double(nowNs - prevArrivalNs) * sampleRate / 1e9 - double(qint32(h.timestamp - prevTs));
+        jitter += (std::fabs(d) - jitter) / 16.0;
+    }
+    prevArrivalNs = nowNs;
+    prevTs = h.timestamp;
+
+    // 이 패킷의 첫 샘플이 재생될 때까지 남은 시간 (예약된 조정 포함)
+    int wait = off - int(due(nowNs)) + adjust;
+    adapt(wait, nowNs);
+    if (off + n <= 0) {
+        st.late++;
+        return Dropped;
+    }
+    st.wait.add(wait > 0 ? qint64(wait) * 1000000000LL / sampleRate : 0);
+
+    bool cn = h.flags & AudioPacket::FLAG_CN;
+    if (cn) st.comfort += quint64(n);
+    for (int i = off < 0 ? -off : 0; i < n; ++i) {
+        quint32 idx = (h.timestamp + quint32(i)) & RING_MASK;
+        if (cn && valid[idx]) continue;     // CN은 앞 구간까지 덮으므로 먼저 와 있던 말소리는 두고
+        ring[idx] = pcm[i];
+        valid[idx] = true;
+    }
+    if (qint32(h.timestamp + quint32(n) - endTs) > 0) endTs = h.timestamp + quint32(n);
+    return Queued;
+}
+
+// 최근 출력에서 정규화 자기상관이 가장 큰 주기 (2.5 ~ 15ms)를 찾아 한 주기를 복사해 둡니다
+void AudioJitterBuffer::startPlc()
+{
+    int minLag = sampleRate / 400;
+    int maxLag = qMin(sampleRate / 66, HISTORY / 2);
+    quint32 end = historyPos;
+    double best = -1.0;
+
+    pitch = maxLag;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        double num = 0.0, energy = 1.0;
+        for (int i = 1; i <= maxLag; ++i) {
+            double x = history[(end - quint32(i)) & HISTORY_MASK];
+            double y = history[(end - quint32(i + lag)) & HISTORY_MASK];
+            num += x * y;
+            energy += y * y;
+        }
+        double score = num / std::sqrt(energy);
+        if (score > best) {
+            best = score;
+            pitch = lag;
+        }
+    }
+    for (int i = 0; i < pitch; ++i) period[i] = history[(end - quint32(pitch) + quint32(i)) & HISTORY_MASK];
+}
+
+// 보정 샘플 하나: 주기를 반복하고 PLC_HOLD_MS 뒤부터 PLC_FADE_MS까지 줄여서 무음
+int AudioJitterBuffer::plcSample()
+{
+    int hold = msToSamples(PLC_HOLD_MS);
+    int end = msToSamples(PLC_FADE_MS);
+    if (plcRun == 0) startPlc();
+    int k = plcRun++;
+    if (k >= end) return 0;
+    if (k < hold) return period[k % pitch];
+    return period[k % pitch] * (end - k) / (end - hold);
+}
+
+// 건너뛸 구간 [playTs, playTs + skip + xfade)가 다 있어야 cross-fade로 건너뜁니다
+bool AudioJitterBuffer::canSkip(int n) const
+{
+    for (int i = 0; i < n + xfade(); ++i) {
+        if (!valid[(playTs + quint32(i)) & RING_MASK]) return false;
+    }
+    return true;
+}
+
+qint16 AudioJitterBuffer::nextSample()
+{
+    const int xf = xfade();
+    quint32 idx = playTs & RING_MASK;
+    int s;
+
+    // 지연 줄이기: skip만큼 뒤의 샘플로 xfade 동안 넘어갑니다
+    if (skip == 0 && adjust < 0 && plcRun == 0) {
+        int n = qMin(-adjust, msToSamples(TICK_MS));
+        if (canSkip(n)) {
+            skip = n;
+            skipPos = 0;
+        }
+    }
+    if (skip) {
+        quint32 far = (playTs + quint32(skip)) & RING_MASK;
+        s = (ring[idx] * (xf - skipPos) + ring[far] * skipPos) / xf;
+        valid[idx] = false;
+        playTs++;
+        if (++skipPos == xf) {
+            for (int i = 0; i < skip; ++i) valid[(playTs + quint32(i)) & RING_MASK] = false;
+            playTs += quint32(skip);
+            adjust += skip;
+            st.skipped += quint64(skip);
+            skip = 0;
+        }
+    } else if (adjust > 0) {
+        // 지연 늘리기: 재생 위치는 그대로 두고 보정 샘플을 끼워 넣습니다 (늦은 패킷이 올 시간을 법니다)
+        s = plcSample();
+        fade = xf;
+        adjust--;
+        st.inserted++;
+    } else if (!valid[idx]) {
+        s = plcSample();
+        fade = xf;
+        playTs++;
+        st.concealed++;
+    } else {
+        s = ring[idx];
+        valid[idx] = false;
+        playTs++;
+        if (plcRun) {
+            // 보정 샘플에서 실제 샘플로 xfade 동안 넘어갑니다
+            int c = plcSample();
+            s = (c * fade + s * (xf - fade)) / xf;
+            if (--fade == 0) plcRun = 0;
+        }
+    }
+
+    history[historyPos++ & HISTORY_MASK] = qint16(s);
+    return qint16(s);
+}
+
+int AudioJitterBuffer::get(qint64 nowNs, qint16 *pcm, int capacity)
+{
+    if (!started) return 0;
+    if (nowNs - lastArrivalNs > qint64(IDLE_MS) * 1000000) {
+        started = false;
+        return 0;
+    }
+    qint64 n = due(nowNs);
+    if (n <= 0) return 0;
+    n = qMin(n, qint64(capacity));
+    for (qint64 i = 0; i < n; ++i) pcm[i] = nextSample();
+    emitted += quint64(n);
+    st.played += quint64(n);
+    return int(n);
+}
+
+const AudioJitterBuffer::Stats &AudioJitterBuffer::stats()
+{
+    quint64 expected = expectedBefore;
+    if (st.packets) expected += seqCycles + maxSeq - baseSeq + 1;
+    st.lost = expected > st.packets ? expected - st.packets : 0;
+    st.jitterMs = jitter * 1000.0 / sampleRate;
+    st.marginMs = margin() * 1000.0 / sampleRate;
+    return st;
+}
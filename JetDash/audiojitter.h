@@ -0,0 +1,116 @@
+#ifndef AUDIOJITTER_H
+#define AUDIOJITTER_H
+
+#include <QtGlobal>
+
+#include "latencystats.h"
+
+// 음성 지터 버퍼 (로봇 마이크 -> 운영자 스피커, docs/Protocol.md 4.4, 4.5)
+// 로봇 쪽 jitter_buffer.c와 같은 동작입니다 (한쪽을 고치면 다른 쪽도).
+//   - 패킷(audiocodec.h 형식)을 디코드해서 timestamp 자리에 넣고, get()이 재생 시계(ns)만큼 꺼냅니다
+//   - 재생 시점이 지나서 온 패킷은 버리고, 빈 자리는 직전 출력의 피치 주기를 반복해서 채웁니다 (10ms 뒤부터 줄여서 60ms면 무음)
+//   - 목표 지연: 1초 동안 가장 적게 기다린 패킷의 대기 시간 = 여유분(5ms + 도착 지터).
+//     늦은 패킷이 오면 바로 늘리고(보정 샘플 끼워 넣기), 남으면 절반씩 줄입니다(짧게 cross-fade하며 건너뜀)
+//   - CN 패킷(말 없는 구간)의 컴포트 노이즈는 빈 자리에만 넣고, 손실/보정으로 세지 않습니다
+// put()과 get()은 같은 스레드에서 부릅니다.
+class AudioJitterBuffer
+{
+public:
+    static const int RING = 8192;           // 재생 대기 샘플 (2의 거듭제곱, 8kHz면 1초)
+    static const int HISTORY = 2048;        // 손실 보정 피치 탐색용 최근 출력
+    static const int TICK_MS = 10;          // get() 주기 (한 번에 건너뛰는 최대 길이)
+    static const int START_MS = 40;         // 첫 패킷 -> 재생 시작
+    static const int MARGIN_MS = 5;
+    static const int MAX_DELAY_MS = 300;
+    static const int WINDOW_MS = 1000;
+    static const int PLC_HOLD_MS = 10;
+    static const int PLC_FADE_MS = 60;
+    static const int IDLE_MS = 500;         // 패킷이 이만큼 안 오면 스트림 끝
+
+    enum PutResult {
+        Bad = -1,       // 헤더가 맞지 않는 패킷
+        Queued = 0,
+        Dropped = 1,    // 늦었거나 중복
+    };
+
+    struct Stats {
+        quint64 packets = 0;        // 받은 패킷 (중복 제외, late 포함)
+        quint64 late = 0;
+        quint64 duplicates = 0;
+        quint64 lost = 0;           // seq 기준 (stats() 부를 때 갱신)
+        quint64 concealed = 0;      // 샘플
+        quint64 inserted = 0;
+        quint64 skipped = 0;
+        quint64 comfort = 0;        // CN 패킷으로 받은 샘플
+        quint64 played = 0;
+        quint64 restarts = 0;
+        double jitterMs = 0;        // 도착 지터 (RFC 3550)
+        double marginMs = 0;        // 목표 최소 대기
+        LatencyHistogram wait;      // 패킷 도착 -> 첫 샘플 재생
+        LatencyHistogram senderDelay;   // 패킷 헤더의 delay (보낸 쪽 첫 샘플 캡처 -> 전송)
+    };
+
+    void configure(int rate);
+    // 재생 상태와 통계를 비웁니다 (다음 패킷부터 새 스트림)
+    void reset();
+
+    int rate() const { return sampleRate; }
+    bool active() const { return started; }
+
+    PutResult put(const quint8 *data, int len, qint64 nowNs);
+    // nowNs까지 재생할 샘플을 pcm에 (최대 capacity개, 남으면 다음 호출에서). 샘플 수
+    int get(qint64 nowNs, qint16 *pcm, int capacity);
+
+    // lost / jitterMs / marginMs를 지금 값으로 채웁니다
+    const Stats &stats();
+
+private:
+    int msToSamples(int ms) const { return int(qint64(sampleRate) * ms / 1000); }
+    int xfade() const { return sampleRate / 200; }
+    qint64 due(qint64 nowNs) const;
+    int margin() const { return msToSamples(MARGIN_MS) + int(jitter); }
+    void start(quint16 seq, quint32 timestamp, qint64 nowNs);
+    bool seqSeen(quint16 seq);
+    void adapt(int wait, qint64 nowNs);
+    void startPlc();
+    int plcSample();
+    bool canSkip(int skip) const;
+    qint16 nextSample();
+
+    int sampleRate = 8000;
+    bool started = false;
+    qint64 startNs = 0;             // 재생 시계 0
+    quint64 emitted = 0;            // startNs 이후 내보낸 샘플
+    quint32 playTs = 0;             // 다음에 재생할 샘플의 timestamp
+    quint32 endTs = 0;              // 받은 샘플 중 가장 뒤 + 1
+    int adjust = 0;                 // 앞으로 끼워 넣을(+) / 건너뛸(-) 샘플
+    qint64 lastArrivalNs = 0;
+
+    qint16 ring[RING];
+    bool valid[RING];
+
+    qint16 history[HISTORY];
+    quint32 historyPos = 0;
+    qint16 period[HISTORY / 2];
+    int pitch = 1;
+    int plcRun = 0;
+    int fade = 0;
+    int skip = 0;
+    int skipPos = 0;
+
+    qint64 prevArrivalNs = 0;
+    quint32 prevTs = 0;
+    double jitter = 0;              // 샘플 단위
+    int windowMin = 0;
+    qint64 windowStartNs = 0;
+
+    quint16 maxSeq = 0;
+    quint32 seqCycles = 0;
+    quint32 baseSeq = 0;
+    quint64 seen = 0;
+    quint64 expectedBefore = 0;
+
+    Stats st;
+};
+
+#endif // AUDIOJITTER_H
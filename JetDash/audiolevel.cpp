@@ -0,0 +1,234 @@
+#include "audiolevel.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AUDIO_GAIN_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_GAIN_NEON 1
+#endif
+
+namespace {
+const int GAIN_ROUND = 1 << (AudioGain::GAIN_BITS - 1);
+
+// 스칼라 꼬리 처리용. peak/sumSquares에 이어서 더합니다
+void applyTail(qint16 *s, int n, int gain, int &peak, quint64 &sumSquares)
+{
+    for (int i = 0; i < n; ++i) {
+        int v = qBound(-32768, (s[i] * gain + GAIN_ROUND) >> AudioGain::GAIN_BITS, 32767);
+        s[i] = qint16(v);
+        peak = qMax(peak, qAbs(v));
+        sumSquares += quint64(v * v);
+    }
+}
+
+#if defined(AUDIO_GAIN_SSE2)
+AudioGain::Block applySimd(qint16 *s, int n, int gain)
+{
+    const __m128i g = _mm_set1_epi16(qint16(gain));
+    const __m128i round = _mm_set1_epi32(GAIN_ROUND);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmax = _mm_set1_epi16(0), vmin = _mm_set1_epi16(0);
+    __m128i acc = zero;                 // 제곱합 64bit 2개
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        // 16x16 -> 32bit 곱 (아래/위 16bit를 따로 구해서 합침)
+        __m128i lo = _mm_mullo_epi16(v, g);
+        __m128i hi = _mm_mulhi_epi16(v, g);
+        __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), AudioGain::GAIN_BITS);
+        __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), AudioGain::GAIN_BITS);
+        v = _mm_packs_epi32(p0, p1);    // 포화
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(s + i), v);
+
+        vmax = _mm_max_epi16(vmax, v);
+        vmin = _mm_min_epi16(vmin, v);
+        // 두 샘플 제곱합은 최대 2^31 (-32768 두 개)이라 부호 없는 32bit로 보고 64bit에 더합니다
+        __m128i sq = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+    }
+
+    alignas(16) qint16 mx[8], mn[8];
+    alignas(16) quint64 sums[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(mx), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i *>(mn), vmin);
+    _mm_store_si128(reinterpret_cast<__m128i *>(sums), acc);
+
+    AudioGain::Block b;
+    for (int k = 0; k < 8; ++k) b.peak = qMax(b.peak, qMax(int(mx[k]), -int(mn[k])));
+    b.sumSquares = sums[0] + sums[1];
+    applyTail(s + i, n - i, gain, b.peak, b.sumSquares);
+    return b;
+}
+#elif defined(AUDIO_GAIN_NEON)
+AudioGain::Block applySimd(qint16 *s, int n, int gain)
+{
+    const int16_t g = int16_t(gain);
+    int16x8_t vmax = vdupq_n_s16(0), vmin = vdupq_n_s16(0);
+    int64x2_t acc = vdupq_n_s64(0);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vld1q_s16(s + i);
+        int32x4_t lo = vmull_n_s16(vget_low_s16(v), g);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(v), g);
+        // 반올림 + 포화 narrow (스칼라와 같은 (x + 2048) >> 12)
+        v = vcombine_s16(vqrshrn_n_s32(lo, AudioGain::GAIN_BITS), vqrshrn_n_s32(hi, AudioGain::GAIN_BITS));
+        vst1q_s16(s + i, v);
+
+        vmax = vmaxq_s16(vmax, v);
+        vmin = vminq_s16(vmin, v);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(v), vget_low_s16(v)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(v), vget_high_s16(v)));
+    }
+
+    // vmaxvq 같은 가로 축소는 AArch64에만 있어서 꺼내서 합칩니다 (32bit ARM도 같은 코드)
+    int16_t mx[8], mn[8];
+    vst1q_s16(mx, vmax);
+    vst1q_s16(mn, vmin);
+
+    AudioGain::Block b;
+    for (int k = 0; k < 8; ++k) b.peak = qMax(b.peak, qMax(int(mx[k]), -int(mn[k])));
+    b.sumSquares = quint64(vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1));
+    applyTail(s + i, n - i, gain, b.peak, b.sumSquares);
+    return b;
+}
+#endif
+}
+
+namespace AudioGain {
+int gainQ12(float gain)
+{
+    return qBound(0, int(std::lround(gain * GAIN_ONE)), GAIN_MAX);
+}
+
+bool simdAvailable()
+{
+#if defined(AUDIO_GAIN_SSE2) || defined(AUDIO_GAIN_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Block applyScalar(qint16 *samples, int n, int gain)
+{
+    Block b;
+    applyTail(samples, n, gain, b.peak, b.sumSquares);
+    return b;
+}
+
+Block apply(qint16 *samples, int n, int gain)
+{
+#if defined(AUDIO_GAIN_SSE2) || defined(AUDIO_GAIN_NEON)
+    return applySimd(samples, n, gain);
+#else
+    return applyScalar(samples, n, gain);
+#endif
+}
+}
+
+void AudioLevelMeter::configure(int rate)
+{
+    sampleRate = qMax(1, rate);
+    reset();
+}
+
+void AudioLevelMeter::reset()
+{
+    meanSquare = 0;
+    peakLevelDb = FLOOR_DB;
+    holdSamples = 0;
+}
+
+void AudioLevelMeter::update(const AudioGain::Block &block, int n)
+{
+    if (n <= 0) return;
+    const double fullScale = 32768.0 * 32768.0;
+
+    // RMS: 블록 평균 제곱을 블록 길이만큼의 지수 평균으로 (블록이 길든 짧든 같은 시정수)
+    double blockMs = double(block.sumSquares) / n / fullScale;
+    double a = 1.0 - std::exp(-n / (sampleRate * RMS_TIME_MS / 1000.0));
+    meanSquare += (blockMs - meanSquare) * a;
+
+    // 피크: 블록 안 최대가 지금 표시보다 크면 바로, 아니면 hold가 끝난 뒤 일정 속도로 내림
+    double blockPeakDb = block.peak > 0 ? 20 * std::log10(block.peak / 32768.0) : FLOOR_DB;
+    if (blockPeakDb >= peakLevelDb) {
+        peakLevelDb = blockPeakDb;
+        holdSamples = qint64(sampleRate * PEAK_HOLD_MS / 1000.0);
+    } else if (holdSamples >= n) {
+        holdSamples -= n;
+    } else {
+        double falling = double(n - holdSamples) / sampleRate;
+        holdSamples = 0;
+        peakLevelDb = qMax(blockPeakDb, peakLevelDb - PEAK_RELEASE_DB_PER_S * falling);
+    }
+    peakLevelDb = qMax(peakLevelDb, FLOOR_DB);
+}
+
+double AudioLevelMeter::rmsDb() const
+{
+    if (meanSquare <= 0) return FLOOR_DB;
+    return qMax(FLOOR_DB, 10 * std::log10(meanSquare));
+}
+
+int AudioLevelMeter::percent(double db)
+{
+    return qBound(0, int(std::lround((db - FLOOR_DB) * 100 / -FLOOR_DB)), 100);
+}
+
+void VoiceActivityDetector::configure(int rate)
+{
+    sampleRate = qMax(1, rate);
+    reset();
+}
+
+void VoiceActivityDetector::reset()
+{
+    primed = voiced = false;
+    hangover = 0;
+    floorDb = frameDb = SILENCE_DB;
+    floorZcr = 0.5;
+    frameZcr = 0;
+}
+
+bool VoiceActivityDetector::update(const qint16 *frame, int n)
+{
+    if (n <= 0) return active();
+
+    quint64 sumSquares = 0;
+    int crossings = 0;
+    for (int i = 0; i < n; ++i) {
+        sumSquares += quint64(frame[i] * frame[i]);
+        if (i > 0 && (frame[i] < 0) != (frame[i - 1] < 0)) crossings++;
+    }
+    double meanSquare = double(sumSquares) / n / (32768.0 * 32768.0);
+    frameDb = meanSquare > 0 ? qMax(SILENCE_DB, 10 * std::log10(meanSquare)) : SILENCE_DB;
+    frameZcr = n > 1 ? double(crossings) / (n - 1) : 0.0;
+
+    if (!primed) {
+        primed = true;
+        floorDb = frameDb;
+        floorZcr = frameZcr;
+    }
+
+    double above = frameDb - floorDb;
+    voiced = frameDb > SILENCE_DB
+          && (above > ON_DB || (above > WEAK_DB && std::fabs(frameZcr - floorZcr) > ZCR_DELTA));
+
+    double seconds = double(n) / sampleRate;
+    if (voiced) {
+        floorDb += NOISE_RISE_DB * seconds;
+        hangover = int(qint64(sampleRate) * HANGOVER_MS / 1000);
+    } else {
+        double a = 1.0 - std::exp(-seconds * 1000.0 / NOISE_TIME_MS);
+        floorDb = frameDb < floorDb ? frameDb : floorDb + (frameDb - floorDb) * a;
+        floorZcr += (frameZcr - floorZcr) * a;
+        hangover = qMax(0, hangover - n);
+    }
+    return active();
+}
@@ -0,0 +1,96 @@
+#ifndef AUDIOLEVEL_H
+#define AUDIOLEVEL_H
+
+#include <QtGlobal>
+
+// 마이크 블록 처리: 게인 + 포화(클리핑) + 피크/제곱합을 한 번 훑을 때 같이 (SSE2 / NEON, 없으면 스칼라)
+// 게인은 Q12 고정소수점 (1.0 = 4096)이라 SIMD와 스칼라 결과가 비트 단위로 같습니다.
+namespace AudioGain {
+const int GAIN_BITS = 12;
+const int GAIN_ONE = 1 << GAIN_BITS;
+const int GAIN_MAX = 32767;             // 8배 미만 (슬라이더는 0~2배)
+
+struct Block {
+    int peak = 0;                       // 처리한 샘플 절댓값 최대 (0~32768)
+    quint64 sumSquares = 0;
+};
+
+int gainQ12(float gain);
+bool simdAvailable();
+
+// samples를 제자리에서 (s * gain + 반올림) >> 12, int16 범위로 포화
+Block apply(qint16 *samples, int n, int gain);
+Block applyScalar(qint16 *samples, int n, int gain);      // 벤치마크 비교용
+}
+
+// 마이크 게이지 (블록 길이와 상관없이 시간 기준)
+//   RMS: 300ms 지수 평균 (VU처럼 말소리 크기)
+//   피크: 바로 올라가고 0.5초 머문 뒤 초당 20dB씩 내려감 (PPM처럼 짧은 클리핑도 보이게)
+class AudioLevelMeter
+{
+public:
+    static constexpr double FLOOR_DB = -60.0;   // 게이지 0%
+    static constexpr double RMS_TIME_MS = 300.0;
+    static constexpr double PEAK_HOLD_MS = 500.0;
+    static constexpr double PEAK_RELEASE_DB_PER_S = 20.0;
+    static constexpr double CLIP_DB = -1.0;
+
+    void configure(int rate);
+    void reset();
+    void update(const AudioGain::Block &block, int n);
+
+    double rmsDb() const;
+    double peakDb() const { return peakLevelDb; }
+    bool clipping() const { return peakLevelDb >= CLIP_DB; }
+    // FLOOR_DB ~ 0dBFS -> 0 ~ 100
+    static int percent(double db);
+
+private:
+    int sampleRate = 48000;
+    double meanSquare = 0;              // full scale 기준 (1.0 = 0dBFS 사각파)
+    double peakLevelDb = FLOOR_DB;
+    qint64 holdSamples = 0;             // 피크가 머물 남은 샘플
+};
+
+// 말소리 구간 검출 (VAD). 고정 길이 프레임(인코더의 10/20ms)마다 update()
+//   - 프레임 에너지(dBFS)와 zero-crossing 비율을 잡음 바닥(말이 없을 때의 평균)과 비교합니다.
+//     바닥 + ON_DB를 넘으면 말소리. 바닥 + WEAK_DB만 넘어도 zero-crossing이 잡음과 ZCR_DELTA 넘게 다르면
+//     말소리 (ㅅ/ㅊ 같은 무성 마찰음은 높고, 작은 유성음은 낮음)
+//   - 잡음 바닥은 말이 아닌 프레임에서 NOISE_TIME_MS로 따라가고, 더 조용해지면 바로 내려갑니다.
+//     말소리로 보는 동안에도 초당 NOISE_RISE_DB씩 올려서 주변 소음이 커지면 결국 따라갑니다
+//   - 말이 끝나도 HANGOVER_MS 동안은 말소리로 (어미와 숨소리가 잘리지 않게), 시작은 바로
+//   - SILENCE_DB 밑은 항상 조용함 (디지털 무음에서 바닥이 끝없이 내려가지 않도록 바닥도 여기서 멈춤)
+class VoiceActivityDetector
+{
+public:
+    static constexpr double ON_DB = 9.0;
+    static constexpr double WEAK_DB = 4.0;
+    static constexpr double ZCR_DELTA = 0.15;
+    static constexpr double SILENCE_DB = -70.0;
+    static constexpr double NOISE_TIME_MS = 1000.0;
+    static constexpr double NOISE_RISE_DB = 2.0;
+    static const int HANGOVER_MS = 200;
+
+    void configure(int rate);
+    void reset();
+    // 프레임 하나를 보고 보낼지 (말소리이거나 hangover 중)
+    bool update(const qint16 *frame, int n);
+
+    bool active() const { return hangover > 0 || voiced; }
+    bool speech() const { return voiced; }         // hangover 빼고 마지막 프레임만의 판정
+    double energyDb() const { return frameDb; }
+    double zeroCrossingRate() const { return frameZcr; }
+    double noiseDb() const { return floorDb; }
+
+private:
+    int sampleRate = 8000;
+    bool primed = false;                // 첫 프레임으로 바닥을 잡았는지
+    bool voiced = false;
+    int hangover = 0;                   // 남은 샘플
+    double floorDb = SILENCE_DB;
+    double floorZcr = 0.5;
+    double frameDb = SILENCE_DB;
+    double frameZcr = 0;
+};
+
+#endif // AUDIOLEVEL_H
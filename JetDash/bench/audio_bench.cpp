@@ -0,0 +1,396 @@
+/*
+ * 마이크 송신 경로(AudioEncoder: 폴리페이스 리샘플 -> 10/20ms 프레임 -> IMA ADPCM) 벤치마크
+ *
+ * 마이크 기본 주파수(48k / 44.1k / 16k)에서 로봇 재생 주파수(8k / 16k)로
+ *   - 리샘플 품질: 통과 대역 다중 톤의 SNR (이상적인 신호를 같은 지연으로 직접 만든 것과 비교),
+ *     나이퀴스트 위 톤(앨리어싱) 감쇠
+ *   - ADPCM 품질: 리샘플 결과 대비 디코드 결과 SNR
+ *   - 대역폭: 예전 방식(입력 주파수 그대로 Int16) 대비 kbit/s (UDP/IP 헤더 28바이트 포함)
+ *   - 지연: 펄스를 넣어 디코드 결과에서 찾은 필터 지연, 펄스 -> 그 샘플이 든 패킷이 나갈 때까지 (평균/최대)
+ *   - CPU: 프레임당 리샘플+인코드, 디코드 시간
+ * 을 재고, 패킷 하나를 빼도 다음 패킷이 손실 없이 복원되는지 확인합니다.
+ * 무음 억제(VAD + CN 패킷)는 말/쉼이 번갈아 나오는 신호에 배경 잡음 크기를 바꿔 가며
+ *   - 말 구간 프레임을 보낸 비율, 쉼 구간(hangover 뒤)에 잘못 보낸 비율, 아낀 대역폭
+ *   - CN 패킷의 잡음 크기가 실제 배경 잡음(출력 주파수 기준)과 맞는지, VAD 프레임당 시간
+ * 을 봅니다.
+ *
+ * Build: cmake -DJETDASH_BUILD_BENCH=ON 후 audio_bench 타깃
+ * Usage: ./audio_bench
+ */
+
+#include <QByteArray>
+#include <QVector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "../audiocodec.h"
+
+namespace {
+const double PI = 3.14159265358979323846;
+const int SECONDS = 4;
+const int UDP_IP_HEADER = 28;
+const int MIC_CHUNK_MS = 10;        // QAudioSource readyRead 한 번에 오는 양 정도
+
+// 통과 대역 톤 (가장 낮은 출력 8k에서 평탄한 3.4k 안, 전화 음성 대역)
+const double TONES[] = { 310.0, 1020.0, 2470.0, 3100.0 };
+
+double toneSample(double t)
+{
+    double v = 0;
+    for (double f : TONES) v += std::sin(2 * PI * f * t);
+    return 6000.0 * v;
+}
+
+QVector<qint16> makeInput(int rate, double (*fn)(double))
+{
+    QVector<qint16> x(rate * SECONDS);
+    for (int i = 0; i < x.size(); ++i) x[i] = qint16(std::lrint(fn(double(i) / rate)));
+    return x;
+}
+
+double snrDb(const double *ref, const qint16 *got, int n)
+{
+    double s = 0, e = 0;
+    for (int i = 0; i < n; ++i) {
+        s += ref[i] * ref[i];
+        e += (ref[i] - got[i]) * (ref[i] - got[i]);
+    }
+    return 10 * std::log10(s / qMax(e, 1e-9));
+}
+
+double rms(const qint16 *x, int n)
+{
+    double s = 0;
+    for (int i = 0; i < n; ++i) s += double(x[i]) * x[i];
+    return std::sqrt(s / qMax(n, 1));
+}
+
+// 입력을 마이크처럼 10ms씩 넣고 나온 패킷을 전부 디코드
+struct Run {
+    QVector<qint16> decoded;
+    QVector<qint64> emittedAt;      // 출력 샘플마다 그 패킷이 나간 시점의 입력 샘플 수
+    long packets = 0;
+    long bytes = 0;
+    double encodeNs = 0;
+    double decodeNs = 0;
+};
+
+void runPipeline(const QVector<qint16> &in, int inRate, int outRate, int codec, int frameMs, Run &r)
+{
+    AudioEncoder enc;
+    enc.configure(inRate, outRate, codec, frameMs);
+    QVector<QByteArray> packets;
+    QVector<qint64> packetAt;
+    int chunk = inRate * MIC_CHUNK_MS / 1000;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < in.size(); i += chunk) {
+        int n = qMin(chunk, int(in.size()) - i);
+        enc.push(in.constData() + i, n, [&](const QByteArray &p) {
+            packets.append(p);
+            packetAt.append(i + n);
+        });
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    qint16 pcm[AudioPacket::MAX_SAMPLES];
+    r.decoded.clear();
+    r.emittedAt.clear();
+    auto t2 = std::chrono::steady_clock::now();
+    for (int k = 0; k < packets.size(); ++k) {
+        const QByteArray &p = packets[k];
+        int n = decodeAudioPacket(reinterpret_cast<const quint8 *>(p.constData()), int(p.size()), pcm,
+                                  AudioPacket::MAX_SAMPLES);
+        for (int i = 0; i < n; ++i) {
+            r.decoded.append(pcm[i]);
+            r.emittedAt.append(packetAt[k]);
+        }
+        r.bytes += p.size();
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    r.packets = packets.size();
+    r.encodeNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / qMax(r.packets, 1L);
+    r.decodeNs = std::chrono::duration<double, std::nano>(t3 - t2).count() / qMax(r.packets, 1L);
+}
+
+// 펄스 여러 개를 넣고: 디코드 결과의 봉우리 위치 -> 필터 지연, 그 샘플이 든 패킷이 나간 시점 -> 전체 추가 지연
+void measureLatency(int inRate, int outRate, int frameMs, double &filterMs, double &meanMs, double &maxMs)
+{
+    const int PULSES = 40;
+    QVector<qint16> in(inRate * SECONDS, 0);
+    QVector<int> at;
+    quint32 seed = 7;
+    for (int k = 0; k < PULSES; ++k) {
+        seed = seed * 1103515245u + 12345u;
+        int pos = inRate / 10 + k * (in.size() - inRate / 5) / PULSES + int((seed >> 16) % 97);
+        at.append(pos);
+        for (int j = -2; j <= 2; ++j) in[pos + j] = qint16(20000 - 4000 * j * j);    // 짧은 클릭
+    }
+
+    Run r;
+    runPipeline(in, inRate, outRate, AudioPacket::Pcm16, frameMs, r);
+    double filterSum = 0, sum = 0;
+    maxMs = 0;
+    for (int pos : at) {
+        int from = int(qint64(pos) * outRate / inRate);
+        int peak = from;
+        for (int i = from; i < qMin(from + outRate / 20, int(r.decoded.size())); ++i) {
+            if (r.decoded[i] > r.decoded[peak]) peak = i;
+        }
+        filterSum += (double(peak) / outRate - double(pos) / inRate) * 1000;
+        double ms = double(r.emittedAt[peak] - pos) * 1000 / inRate;
+        sum += ms;
+        maxMs = qMax(maxMs, ms);
+    }
+    filterMs = filterSum / PULSES;
+    meanMs = sum / PULSES;
+}
+
+// 말/쉼 (0.4~2초씩) 번갈아. 말은 피치가 움직이는 배음 + 음절 envelope, 음절 끝 30%는 무성 마찰음(고역 잡음)
+// talking: 입력 샘플마다 말 구간인지
+QVector<qint16> makeTalkSpurts(int rate, double noiseDb, QVector<bool> &talking)
+{
+    QVector<qint16> x(rate * SECONDS * 5);
+    talking.resize(x.size());
+    quint32 seed = 12345;
+    auto uniform = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return double((seed >> 8) & 0xffff) / 65536.0;
+    };
+    double noiseAmp = 32768.0 * std::pow(10.0, noiseDb / 20) * std::sqrt(3.0);
+    double phase = 0, prevNoise = 0;
+    int i = 0;
+    bool talk = false;
+    while (i < x.size()) {
+        int len = qMin(int(rate * (0.4 + 1.6 * uniform())), int(x.size()) - i);
+        for (int k = 0; k < len; ++k, ++i) {
+            double t = double(k) / rate;
+            double v = 0;
+            if (talk) {
+                double syllable = std::fmod(t * 4.0, 1.0);
+                double env = 0.3 + 0.7 * std::sin(PI * syllable);
+                if (syllable < 0.7) {
+                    double f0 = 170.0 + 50.0 * std::sin(2 * PI * 0.7 * t);
+                    phase += 2 * PI * f0 / rate;
+                    for (int h = 1; h <= 10; ++h) v += std::sin(h * phase) / h;
+                    v *= 4000.0 * env;
+                } else {
+                    double w = (2 * uniform() - 1) * 3000.0;
+                    v = w - prevNoise;      // 1차 차분 = 고역 강조
+                    prevNoise = w;
+                }
+            }
+            v += (2 * uniform() - 1) * noiseAmp;
+            x[i] = qint16(qBound(-32768L, std::lrint(v), 32767L));
+            talking[i] = talk;
+        }
+        talk = !talk;
+    }
+    return x;
+}
+
+bool checkSilenceSuppression()
+{
+    const int inRate = 48000, outRate = 8000, frameMs = 20;
+    const double noiseLevels[] = { -70.0, -55.0, -45.0, -38.0 };
+    bool ok = true;
+
+    std::printf("%-12s %8s %8s %9s %9s %7s %8s %8s %8s\n", "noise", "speech", "false", "full kbps", "sent kbps",
+                "saved", "CN dB", "noise dB", "vad ns");
+    for (double noiseDb : noiseLevels) {
+        QVector<bool> talking;
+        QVector<qint16> in = makeTalkSpurts(inRate, noiseDb, talking);
+
+        AudioEncoder enc;
+        enc.configure(inRate, outRate, AudioPacket::ImaAdpcm, frameMs);
+        enc.setSilenceSuppression(true);
+        int frame = enc.frameSamples();
+        int frames = int(in.size()) / (inRate * frameMs / 1000);
+        QVector<bool> sent(frames + 1, false);
+        QVector<qint16> comfort;
+        qint16 pcm[AudioPacket::MAX_SAMPLES];
+        int chunk = inRate * MIC_CHUNK_MS / 1000;
+        for (int i = 0; i < in.size(); i += chunk) {
+            enc.push(in.constData() + i, qMin(chunk, int(in.size()) - i), [&](const QByteArray &p) {
+                AudioPacket::Header h;
+                int n = decodeAudioPacket(reinterpret_cast<const quint8 *>(p.constData()), int(p.size()), pcm,
+                                          AudioPacket::MAX_SAMPLES, &h);
+                if (n <= 0) return;
+                if (h.flags & AudioPacket::FLAG_CN) {
+                    for (int k = 0; k < n; ++k) comfort.append(pcm[k]);
+                } else if (int(h.timestamp) / frame <= frames) {
+                    sent[int(h.timestamp) / frame] = true;
+                }
+            });
+        }
+
+        // 프레임별 정답: 그 20ms가 (리샘플러 지연은 무시) 절반 넘게 말 구간인지.
+        // 쉼 구간은 말이 끝나고 hangover + 한 프레임 지난 뒤부터만 셉니다
+        const int inFrame = inRate * frameMs / 1000;
+        const int hangFrames = VoiceActivityDetector::HANGOVER_MS / frameMs + 1;
+        int speechFrames = 0, speechSent = 0, gapFrames = 0, gapSent = 0, sinceTalk = hangFrames;
+        for (int f = 0; f < frames; ++f) {
+            int count = 0;
+            for (int k = 0; k < inFrame; ++k) count += talking[f * inFrame + k];
+            if (count * 2 > inFrame) {
+                speechFrames++;
+                speechSent += sent[f];
+                sinceTalk = 0;
+            } else if (++sinceTalk > hangFrames) {
+                gapFrames++;
+                gapSent += sent[f];
+            }
+        }
+
+        // 실제 배경 잡음 크기 (출력 주파수로 리샘플한 뒤) vs CN 패킷이 만든 잡음
+        QVector<bool> none;
+        QVector<qint16> noiseOnly(inRate * SECONDS);
+        {
+            QVector<qint16> spurts = makeTalkSpurts(inRate, noiseDb, none);
+            int n = 0;
+            for (int i = 0; i < spurts.size() && n < noiseOnly.size(); ++i) {
+                if (!none[i]) noiseOnly[n++] = spurts[i];
+            }
+            noiseOnly.resize(n);
+        }
+        Run bg;
+        runPipeline(noiseOnly, inRate, outRate, AudioPacket::Pcm16, frameMs, bg);
+        double bgDb = 20 * std::log10(qMax(rms(bg.decoded.constData(), int(bg.decoded.size())), 1e-3) / 32768.0);
+        double cnDb = 20 * std::log10(qMax(rms(comfort.constData(), int(comfort.size())), 1e-3) / 32768.0);
+
+        // VAD 자체 비용 (출력 프레임 하나)
+        VoiceActivityDetector vad;
+        vad.configure(outRate);
+        const int iterations = 20000;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < iterations; ++k) vad.update(bg.decoded.constData() + (k * frame) % (bg.decoded.size() - frame), frame);
+        auto t1 = std::chrono::steady_clock::now();
+        double vadNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+
+        const AudioEncoder::Traffic &t = enc.traffic();
+        double seconds = double(in.size()) / inRate;
+        double fullKbps = t.fullBytes * 8 / 1000.0 / seconds;
+        double sentKbps = t.bytes * 8 / 1000.0 / seconds;
+        double speechPct = 100.0 * speechSent / qMax(speechFrames, 1);
+        double falsePct = 100.0 * gapSent / qMax(gapFrames, 1);
+        double saved = 100.0 - 100.0 * t.bytes / qMax<quint64>(t.fullBytes, 1);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%.0fdBFS", noiseDb);
+        std::printf("%-12s %7.1f%% %7.1f%% %9.1f %9.1f %6.1f%% %8.1f %8.1f %8.0f\n", name, speechPct, falsePct,
+                    fullKbps, sentKbps, saved, cnDb, bgDb, vadNs);
+        ok &= speechPct >= 97.0 && falsePct <= 5.0 && saved >= 30.0;
+        if (noiseDb > VoiceActivityDetector::SILENCE_DB + 10) ok &= std::fabs(cnDb - bgDb) < 3.0;
+    }
+    std::printf("speech: 말 구간 프레임 중 보낸 비율, false: 쉼 구간(hangover 뒤) 중 보낸 비율, "
+                "kbps는 UDP/IP 헤더 포함\n");
+    return ok;
+}
+
+bool checkLossRecovery()
+{
+    QVector<qint16> in = makeInput(48000, toneSample);
+    AudioEncoder enc;
+    enc.configure(48000, 8000, AudioPacket::ImaAdpcm, 20);
+    QVector<QByteArray> packets;
+    enc.push(in.constData(), int(in.size()), [&](const QByteArray &p) { packets.append(p); });
+
+    // 패킷 하나씩 따로 디코드해도 (앞 패킷이 없어도) 이어서 디코드한 것과 같아야 합니다
+    qint16 alone[AudioPacket::MAX_SAMPLES];
+    ImaAdpcmState s;
+    QVector<qint16> chained(enc.frameSamples());
+    for (int k = 0; k < packets.size(); ++k) {
+        const quint8 *p = reinterpret_cast<const quint8 *>(packets[k].constData());
+        const quint8 *body = p + AudioPacket::HEADER_SIZE;
+        AudioPacket::Header h;
+        int n = decodeAudioPacket(p, int(packets[k].size()), alone, AudioPacket::MAX_SAMPLES, &h);
+        if (k == 0) {
+            s.predictor = qint16(body[0] | (body[1] << 8));
+            s.index = body[2];
+        }
+        ImaAdpcm::decode(s, body + AudioPacket::ADPCM_HEADER_SIZE, n, chained.data());
+        if (n != enc.frameSamples() || std::memcmp(alone, chained.constData(), size_t(n) * 2) != 0) return false;
+        // 지터 버퍼용: seq는 1씩, timestamp는 프레임 샘플 수씩
+        if (h.seq != quint16(k) || h.timestamp != quint32(k * n)) return false;
+    }
+    // 깨진 패킷은 거부
+    qint16 pcm[AudioPacket::MAX_SAMPLES];
+    const quint8 junk[] = { 0x12, 0x34, 0x56, 0x78, 0x9a };
+    const quint8 *first = reinterpret_cast<const quint8 *>(packets[0].constData());
+    return decodeAudioPacket(junk, sizeof(junk), pcm, AudioPacket::MAX_SAMPLES) < 0
+           && decodeAudioPacket(first, int(packets[0].size()) - 1, pcm, AudioPacket::MAX_SAMPLES) < 0;
+}
+}
+
+int main()
+{
+    struct Case {
+        int inRate, outRate, frameMs;
+    } cases[] = {
+        { 48000, 8000, 20 }, { 48000, 8000, 10 }, { 44100, 8000, 20 }, { 16000, 8000, 20 },
+        { 48000, 16000, 20 }, { 44100, 16000, 10 },
+    };
+    bool ok = checkLossRecovery();
+    std::printf("packet loss recovery / bad packet reject: %s\n\n", ok ? "ok" : "FAIL");
+
+    std::printf("silence suppression (48000->8000 ADPCM 20ms, 말/쉼 %d초):\n", SECONDS * 5);
+    ok &= checkSilenceSuppression();
+    std::printf("\n");
+
+    std::printf("%-16s %5s %7s %7s %8s %9s %9s %7s %8s %8s %8s %7s %7s\n", "rate", "frame", "SNR(rs)", "alias",
+                "SNR(adp)", "old kbps", "new kbps", "ratio", "filt ms", "mean ms", "max ms", "enc us", "dec us");
+    for (const Case &c : cases) {
+        QVector<qint16> in = makeInput(c.inRate, toneSample);
+
+        Run pcm, adpcm;
+        runPipeline(in, c.inRate, c.outRate, AudioPacket::Pcm16, c.frameMs, pcm);
+        runPipeline(in, c.inRate, c.outRate, AudioPacket::ImaAdpcm, c.frameMs, adpcm);
+
+        // 리샘플러 SNR: 앞뒤 0.1초는 빼고, 필터 지연만큼 늦춘 이상적인 신호와 비교
+        PolyphaseResampler rs;
+        rs.configure(c.inRate, c.outRate);
+        double delay = rs.delayMs() / 1000;
+        int skip = c.outRate / 10;
+        int n = int(pcm.decoded.size()) - 2 * skip;
+        QVector<double> ideal(n);
+        for (int i = 0; i < n; ++i) ideal[i] = toneSample(double(i + skip) / c.outRate - delay);
+        double snrRs = snrDb(ideal.constData(), pcm.decoded.constData() + skip, n);
+
+        QVector<double> ref(n);
+        for (int i = 0; i < n; ++i) ref[i] = pcm.decoded[i + skip];
+        double snrAdpcm = snrDb(ref.constData(), adpcm.decoded.constData() + skip, n);
+
+        // 출력 나이퀴스트 위 톤 (입력에는 있지만 출력에는 없어야 함)
+        double aliasDb = 0;
+        if (c.inRate > c.outRate) {
+            static int aliasRate;
+            aliasRate = c.outRate;
+            QVector<qint16> high = makeInput(c.inRate, [](double t) {
+                return 16000.0 * std::sin(2 * PI * (0.62 * aliasRate) * t);
+            });
+            Run h;
+            runPipeline(high, c.inRate, c.outRate, AudioPacket::Pcm16, c.frameMs, h);
+            aliasDb = 20 * std::log10(qMax(rms(h.decoded.constData() + skip, n), 1e-3) / rms(high.constData(), int(high.size())));
+        }
+
+        double oldKbps = (c.inRate * 2.0 + UDP_IP_HEADER * (1000.0 / MIC_CHUNK_MS)) * 8 / 1000;
+        double newKbps = (adpcm.bytes + adpcm.packets * double(UDP_IP_HEADER)) * 8 / 1000 / SECONDS;
+
+        double filterMs, meanMs, maxMs;
+        measureLatency(c.inRate, c.outRate, c.frameMs, filterMs, meanMs, maxMs);
+
+        char rate[32];
+        std::snprintf(rate, sizeof(rate), "%d->%d", c.inRate, c.outRate);
+        std::printf("%-16s %3dms %6.1fdB %6.1fdB %7.1fdB %9.1f %9.1f %6.1fx %8.2f %8.2f %8.2f %7.1f %7.1f\n", rate,
+                    c.frameMs, snrRs, aliasDb, snrAdpcm, oldKbps, newKbps, oldKbps / newKbps, filterMs, meanMs,
+                    maxMs, adpcm.encodeNs / 1000, adpcm.decodeNs / 1000);
+        if (c.inRate >= 44100 && c.outRate == 8000) ok &= oldKbps / newKbps > 10;     // 기본 경로
+        ok &= snrRs > 40 && snrAdpcm > 15;
+    }
+    std::printf("\nmean/max ms: 펄스가 마이크에 들어온 뒤 그 샘플이 든 패킷이 나갈 때까지 (마이크 %dms 블록 단위)\n",
+                MIC_CHUNK_MS);
+    std::printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*
+ * 마이크 게인/클리핑/게이지 커널(AudioGain, AudioLevelMeter) 벤치마크
+ *
+ * QAudioSource 블록 크기(10ms @ 44.1k/48k, 20ms, 큰 블록)마다
+ *   - 예전 루프 (샘플마다 float 곱, 비교 두 번으로 클리핑, std::abs 피크)
+ *   - Q12 스칼라 / SIMD (게인 + 포화 + 피크 + 제곱합 한 번에)
+ * 의 samples/ns와 블록당 ns를 재고,
+ *   - SIMD 결과(샘플, 피크, 제곱합)가 스칼라와 비트 단위로 같은지 (블록 끝 자투리, 포화, -32768 포함)
+ *   - 게인 1.0은 원본 그대로인지
+ *   - 게이지: 사인파 RMS/피크 값, 피크 hold/release, 블록 길이와 상관없이 같은 RMS가 나오는지
+ * 를 확인합니다.
+ *
+ * Build: cmake -DJETDASH_BUILD_BENCH=ON 후 audiolevel_bench 타깃
+ * Usage: ./audiolevel_bench
+ */
+
+#include <QVector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../audiolevel.h"
+
+namespace {
+const double PI = 3.14159265358979323846;
+const float GAINS[] = { 0.0f, 0.5f, 1.0f, 1.37f, 2.0f, 7.99f };
+
+QVector<qint16> makeNoise(int n, int amplitude, quint32 seed)
+{
+    QVector<qint16> x(n);
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        x[i] = qint16(int((seed >> 8) % quint32(2 * amplitude + 1)) - amplitude);
+    }
+    return x;
+}
+
+// 예전 NetworkWorker::processAudio() 안쪽 루프
+int legacyLoop(qint16 *samples, int n, float gain)
+{
+    int maxAmplitude = 0;
+    for (int i = 0; i < n; ++i) {
+        int amplifiedSample = static_cast<int>(samples[i] * gain);
+        if (amplifiedSample > 32767) amplifiedSample = 32767;
+        if (amplifiedSample < -32768) amplifiedSample = -32768;
+        samples[i] = static_cast<qint16>(amplifiedSample);
+        int absValue = std::abs(amplifiedSample);
+        if (absValue > maxAmplitude) maxAmplitude = absValue;
+    }
+    return maxAmplitude;
+}
+
+template <typename F>
+double timeNs(int iterations, F fn)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+bool checkExact()
+{
+    bool ok = true;
+    const int sizes[] = { 0, 1, 7, 8, 9, 441, 480, 1023 };
+    for (int n : sizes) {
+        for (float g : GAINS) {
+            // 큰 잡음(자주 포화) + 맨 앞에 -32768 두 개 (제곱합 2^31)
+            QVector<qint16> a = makeNoise(n, 32767, quint32(n * 31 + 7));
+            if (n >= 2) a[0] = a[1] = -32768;
+            QVector<qint16> b = a;
+            int gain = AudioGain::gainQ12(g);
+            AudioGain::Block ba = AudioGain::applyScalar(a.data(), n, gain);
+            AudioGain::Block bb = AudioGain::apply(b.data(), n, gain);
+            if (a != b || ba.peak != bb.peak || ba.sumSquares != bb.sumSquares) {
+                std::printf("FAIL: SIMD != scalar (n=%d gain=%.2f)\n", n, g);
+                ok = false;
+            }
+        }
+    }
+
+    QVector<qint16> x = makeNoise(4099, 32767, 99);
+    x[5] = -32768;
+    QVector<qint16> y = x;
+    AudioGain::Block b = AudioGain::apply(y.data(), y.size(), AudioGain::gainQ12(1.0f));
+    if (x != y || b.peak != 32768) {
+        std::printf("FAIL: gain 1.0 changes samples\n");
+        ok = false;
+    }
+
+    // 예전 루프와는 게인 양자화(Q12, 1/8192 이내 -> 32767에서 4 LSB)와 반올림(float 버림)만 다름
+    QVector<qint16> l = makeNoise(4096, 20000, 3), q = l;
+    legacyLoop(l.data(), l.size(), 1.37f);
+    AudioGain::apply(q.data(), q.size(), AudioGain::gainQ12(1.37f));
+    int worst = 0;
+    for (int i = 0; i < l.size(); ++i) worst = qMax(worst, std::abs(l[i] - q[i]));
+    if (worst > 5) {
+        std::printf("FAIL: differs from legacy loop by %d LSB\n", worst);
+        ok = false;
+    }
+    return ok;
+}
+
+// 사인파를 block 샘플씩 넣고 seconds초 뒤의 게이지
+void feedSine(AudioLevelMeter &m, int rate, int block, double seconds, double amplitude)
+{
+    int total = int(rate * seconds);
+    QVector<qint16> buf(block);
+    static qint64 phase = 0;
+    for (int done = 0; done < total; done += block) {
+        int n = qMin(block, total - done);
+        for (int i = 0; i < n; ++i, ++phase)
+            buf[i] = qint16(std::lrint(amplitude * 32767 * std::sin(2 * PI * 1000.0 * phase / rate)));
+        m.update(AudioGain::applyScalar(buf.data(), n, AudioGain::GAIN_ONE), n);
+    }
+}
+
+bool near(double got, double want, double tol, const char *what)
+{
+    bool ok = std::fabs(got - want) <= tol;
+    std::printf("%s  %-44s %7.2f dB (expect %.2f)\n", ok ? "ok:  " : "FAIL:", what, got, want);
+    return ok;
+}
+
+bool checkMeter()
+{
+    const int rate = 48000;
+    bool ok = true;
+    AudioLevelMeter m;
+    m.configure(rate);
+
+    feedSine(m, rate, 480, 1.5, 0.5);           // -6dBFS 사인 -> RMS -9dBFS
+    ok &= near(m.rmsDb(), -9.03, 0.1, "sine -6dBFS: RMS");
+    ok &= near(m.peakDb(), -6.02, 0.05, "sine -6dBFS: peak");
+
+    feedSine(m, rate, 480, 0.4, 0.0);           // 무음 0.4초: 피크는 아직 hold
+    ok &= near(m.peakDb(), -6.02, 0.05, "silence 0.4s: peak held");
+    feedSine(m, rate, 480, 0.6, 0.0);           // 1초: 0.5초 동안 20dB/s로 내려감
+    ok &= near(m.peakDb(), -16.02, 0.25, "silence 1.0s: peak released");
+    // RMS는 300ms 시정수: 1초 뒤 평균 제곱은 e^(-1000/300)배
+    ok &= near(m.rmsDb(), -9.03 - 10 * (1000.0 / 300) * std::log10(std::exp(1.0)), 0.1, "silence 1.0s: RMS decay");
+
+    // 블록 길이(콜백 주기)가 달라도 같은 값
+    AudioLevelMeter a, b;
+    a.configure(rate);
+    b.configure(rate);
+    feedSine(a, rate, 240, 0.25, 0.3);
+    feedSine(b, rate, 1920, 0.25, 0.3);
+    ok &= near(a.rmsDb() - b.rmsDb(), 0.0, 0.05, "5ms vs 40ms blocks: RMS difference");
+
+    AudioLevelMeter c;
+    c.configure(rate);
+    feedSine(c, rate, 480, 0.1, 1.0);
+    std::printf("%s  full scale sine -> clipping\n", c.clipping() ? "ok:  " : "FAIL:");
+    ok &= c.clipping();
+    return ok;
+}
+
+void bench()
+{
+    struct Case { const char *name; int n; };
+    const Case cases[] = {
+        { "10ms @ 44.1k", 441 },
+        { "10ms @ 48k", 480 },
+        { "20ms @ 48k", 960 },
+        { "85ms @ 48k", 4096 },
+    };
+    const float gain = 1.37f;
+    const int q = AudioGain::gainQ12(gain);
+
+    std::printf("\nSIMD: %s\n", AudioGain::simdAvailable() ? "yes" : "no (scalar only)");
+    std::printf("%-14s %6s  %10s %10s %10s  %9s %9s %9s  %7s\n", "block", "n",
+                "legacy ns", "scalar ns", "simd ns", "legacy/ns", "scalar/ns", "simd/ns", "speedup");
+    for (const Case &c : cases) {
+        QVector<qint16> src = makeNoise(c.n, 12000, 42), buf = src;
+        int iterations = qMax(2000, 4000000 / c.n);
+        volatile quint64 sink = 0;
+
+        // 매번 원본을 복사하지 않고 제자리에서 계속 (게인 1.37을 곱해도 포화 뒤에 값이 유지됨)
+        double legacy = timeNs(iterations, [&]() { sink = sink + legacyLoop(buf.data(), c.n, gain); });
+        buf = src;
+        double scalar = timeNs(iterations, [&]() { sink = sink + AudioGain::applyScalar(buf.data(), c.n, q).sumSquares; });
+        buf = src;
+        double simd = timeNs(iterations, [&]() { sink = sink + AudioGain::apply(buf.data(), c.n, q).sumSquares; });
+
+        std::printf("%-14s %6d  %10.0f %10.0f %10.0f  %9.2f %9.2f %9.2f  %6.1fx\n", c.name, c.n,
+                    legacy, scalar, simd, c.n / legacy, c.n / scalar, c.n / simd, legacy / simd);
+    }
+    std::printf("\nlegacy는 피크만, scalar/simd는 피크 + 제곱합(RMS)까지 계산합니다\n");
+}
+}
+
+int main()
+{
+    bool ok = checkExact();
+    std::printf("SIMD == scalar (bit exact), gain 1.0 identity, legacy within 5 LSB: %s\n\n", ok ? "ok" : "FAIL");
+    ok &= checkMeter();
+    bench();
+    std::printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+/*
+ * 센서값(TELEMETRY) 파싱 벤치마크: QJsonDocument 경로 vs TelemetryParser (JSON / TLV)
+ *
+ * server.py가 보내는 것과 같은 모양의 줄/레코드를 많이 만들어 QBuffer(소켓과 같은 QIODevice 경로)로
+ *   - 기존: readLine() -> QJsonDocument::fromJson -> QJsonObject 조회
+ *   - 새것: read(고정 버퍼) -> TelemetryParser::next (그 자리에서 파싱)
+ *   - 바이너리: HELLO 협상 후의 TLV 레코드 (docs/Protocol.md 2.4)를 같은 파서로
+ * 의 ns/message, 메시지당 메모리 할당 횟수를 재고, 세 경로 결과가 같은지 확인합니다.
+ * 송신 쪽(server.py)까지 포함한 loopback 측정은 robot/jetsonnano/test/telemetry_bench.py
+ * 키 순서가 다르거나 모르는 키/중첩 값/escape가 섞인 줄, 깨진 줄도 QJsonDocument와 비교합니다.
+ *
+ * Build: cmake -DJETDASH_BUILD_BENCH=ON 후 telemetry_bench 타깃
+ * Usage: ./telemetry_bench
+ */
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "../telemetryparser.h"
+
+// 할당 횟수 세기 (이 프로그램 안에서만)
+static std::atomic<long> allocations{0};
+
+void *operator new(std::size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+const int LINES = 20000;
+const int REPEAT = 5;
+
+QByteArray makeStream(QVector<TelemetrySnapshot> &expected)
+{
+    QByteArray stream;
+    quint32 seed = 1;
+    for (int i = 0; i < LINES; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        TelemetrySnapshot t;
+        t.coPpm = int((seed >> 8) % 51);
+        t.obstacleCm = 10 + int((seed >> 16) % 191);
+        t.rollover = (seed >> 28) == 0;
+        expected.append(t);
+        // json.dumps 기본 모양 (": ", ", " 공백 포함)
+        stream += QByteArray("{\"type\": \"TELEMETRY\", \"payload\": {\"co_ppm\": ") + QByteArray::number(t.coPpm)
+                  + ", \"obstacle_cm\": " + QByteArray::number(t.obstacleCm)
+                  + ", \"rollover\": " + (t.rollover ? "true" : "false") + "}}\n";
+    }
+    return stream;
+}
+
+// encode_telemetry_tlv()와 같은 13바이트 레코드
+QByteArray makeTlvStream(const QVector<TelemetrySnapshot> &values)
+{
+    QByteArray stream;
+    for (const TelemetrySnapshot &t : values) {
+        const char rec[13] = {
+            char(TelemetryTlv::SYNC), 11,
+            char(TelemetryTlv::CO_PPM), 2, char(t.coPpm & 0xff), char((t.coPpm >> 8) & 0xff),
+            char(TelemetryTlv::OBSTACLE_CM), 2, char(t.obstacleCm & 0xff), char((t.obstacleCm >> 8) & 0xff),
+            char(TelemetryTlv::ROLLOVER), 1, char(t.rollover ? 1 : 0),
+        };
+        stream.append(rec, sizeof(rec));
+    }
+    return stream;
+}
+
+// 기존 MainWindow::readSensorData()와 같은 방식
+TelemetrySnapshot parseQJson(const QByteArray &line, bool &isTelemetry)
+{
+    TelemetrySnapshot t;
+    isTelemetry = false;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(line);
+    if (jsonDoc.isNull()) return t;
+    QJsonObject jsonObj = jsonDoc.object();
+    if (jsonObj["type"].toString() == "TELEMETRY") {
+        QJsonObject payload = jsonObj["payload"].toObject();
+        t.coPpm = payload["co_ppm"].toInt();
+        t.obstacleCm = payload["obstacle_cm"].toInt();
+        t.rollover = payload["rollover"].toBool();
+        isTelemetry = true;
+    }
+    return t;
+}
+
+int runQJson(const QByteArray &stream, QVector<TelemetrySnapshot> *out)
+{
+    QBuffer dev;
+    dev.setData(stream);
+    dev.open(QIODevice::ReadOnly);
+    int count = 0;
+    while (dev.canReadLine()) {
+        QByteArray line = dev.readLine();
+        bool ok;
+        TelemetrySnapshot t = parseQJson(line, ok);
+        if (!ok) continue;
+        if (out) out->append(t);
+        count++;
+    }
+    return count;
+}
+
+int runParser(const QByteArray &stream, TelemetryParser &parser, QVector<TelemetrySnapshot> *out)
+{
+    QBuffer dev;
+    dev.setData(stream);
+    dev.open(QIODevice::ReadOnly);
+    parser.reset();
+    int count = 0;
+    qint64 n;
+    TelemetrySnapshot t;
+    // 소켓처럼 1400바이트씩 들어온다고 보고 읽습니다
+    while ((n = dev.read(parser.writeBuffer(), qMin(parser.writeSpace(), 1400))) > 0) {
+        parser.commit(int(n));
+        while (parser.next(t) == TelemetryParser::Telemetry) {
+            if (out) out->append(t);
+            count++;
+        }
+    }
+    return count;
+}
+
+template <typename F>
+void measure(const char *name, F fn)
+{
+    long a0 = allocations.load();
+    auto t0 = std::chrono::steady_clock::now();
+    int lines = 0;
+    for (int r = 0; r < REPEAT; ++r) lines += fn();
+    auto t1 = std::chrono::steady_clock::now();
+    long a1 = allocations.load();
+    std::printf("%-20s %8.0f ns/msg  %6.2f alloc/msg\n", name,
+                std::chrono::duration<double, std::nano>(t1 - t0).count() / lines, double(a1 - a0) / lines);
+}
+
+bool checkEdgeCases()
+{
+    const char *lines[] = {
+        "{\"type\":\"TELEMETRY\",\"payload\":{\"co_ppm\":12,\"obstacle_cm\":150,\"rollover\":false}}",
+        "{\"payload\": {\"rollover\": true, \"obstacle_cm\": 7, \"co_ppm\": 3}, \"type\": \"TELEMETRY\"}",
+        "  {\"type\": \"TELEMETRY\", \"seq\": 5, \"payload\": {\"co_ppm\": -4, \"extra\": [1, {\"a\": \"x\\\"}\"}, null], "
+        "\"obstacle_cm\": 12.0, \"rollover\": \"yes\"}}\r",
+        "{\"type\": \"TELEMETRY\", \"payload\": {\"co_ppm\": 1.5, \"obstacle_cm\": 99999999999, \"rollover\": 1}}",
+        "{\"type\": \"TELEMETRY\"}",
+        "{\"type\": \"COMMAND\", \"payload\": {\"target\": \"DRIVE\", \"value\": \"F\"}}",
+        "{\"type\": \"TELEMETRY\", \"payload\": {\"co_ppm\": 12,}}",
+        "{\"type\": \"TELEMETRY\", \"payload\": {\"co_ppm\": 12}} trailing",
+        "{\"type\": \"TELEMETRY\", \"payload\": {\"co_ppm\": 12",
+        "not json",
+    };
+    bool ok = true;
+    for (const char *line : lines) {
+        bool qIs;
+        TelemetrySnapshot q = parseQJson(QByteArray(line), qIs);
+        TelemetrySnapshot p;
+        TelemetryParser::Result r = TelemetryParser::parseLine(line, line + std::strlen(line), p);
+        bool same = (r == TelemetryParser::Telemetry) == qIs && (!qIs || p == q);
+        if (!same) {
+            std::printf("mismatch: %s\n  qjson %d %d/%d/%d  parser %d %d/%d/%d\n", line,
+                        qIs, q.coPpm, q.obstacleCm, q.rollover, r, p.coPpm, p.obstacleCm, p.rollover);
+            ok = false;
+        }
+    }
+    return ok;
+}
+}
+
+int main()
+{
+    QVector<TelemetrySnapshot> expected;
+    expected.reserve(LINES);
+    QByteArray stream = makeStream(expected);
+    QByteArray tlvStream = makeTlvStream(expected);
+
+    QVector<TelemetrySnapshot> a, b, c;
+    TelemetryParser *parser = new TelemetryParser;     // 4KB 버퍼라 힙에 한 번만
+    runQJson(stream, &a);
+    runParser(stream, *parser, &b);
+    runParser(tlvStream, *parser, &c);
+    bool ok = a == expected && b == expected && c == expected && checkEdgeCases();
+    std::printf("%d messages, JSON %lld bytes, TLV %lld bytes, results %s\n", LINES, (long long)stream.size(),
+                (long long)tlvStream.size(), ok ? "ok" : "MISMATCH");
+
+    measure("QJsonDocument", [&] { return runQJson(stream, nullptr); });
+    measure("TelemetryParser", [&] { return runParser(stream, *parser, nullptr); });
+    measure("TelemetryParser TLV", [&] { return runParser(tlvStream, *parser, nullptr); });
+    delete parser;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/*
+ * 열화상 컬러 렌더링(ThermalRenderer) 벤치마크
+ *
+ * 합성 장면(배경 gradient + 따뜻한 영역 두 개 + 센서 노이즈 + 뜨거운 점 몇 개)으로
+ *   - Lepton 2.x(80x60) / 3.x(160x120), 배율 1/4/8, 팔레트별 ns/frame
+ *   - 27Hz 한 프레임(37ms) 중 몇 %를 쓰는지
+ * 를 재고, 자동 게인이 뜨거운 점에 끌려가지 않는지도 확인합니다.
+ *
+ * Build: cmake -DJETDASH_BUILD_BENCH=ON 후 thermalrender_bench 타깃
+ * Usage: ./thermalrender_bench
+ */
+
+#include <QImage>
+#include <QVector>
+#include <chrono>
+#include <cstdio>
+
+#include "../thermalrenderer.h"
+
+namespace {
+const int FRAMES = 64;              // 장면 몇 장을 돌려가며 씁니다
+const double FRAME_BUDGET_NS = 1e9 / 27;
+
+QVector<quint16> synthFrames(int width, int height)
+{
+    QVector<quint16> frames(FRAMES * width * height);
+    quint32 seed = 12345;
+
+    for (int f = 0; f < FRAMES; ++f) {
+        int bx[2] = { width / 8 + f * width / 2 / FRAMES, width - width / 4 - f * width / 4 / FRAMES };
+        int by[2] = { height / 3, height / 2 };
+        quint16 *p = frames.data() + f * width * height;
+
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int v = 7900 + x * 2 + y;
+                for (int b = 0; b < 2; ++b) {
+                    int dx = x - bx[b], dy = y - by[b];
+                    int d2 = dx * dx + dy * dy * 4 / 9;
+                    int r = height / 6;
+                    if (d2 < r * r) v += 350 - d2 * 350 / (r * r) / 2;
+                }
+                seed = seed * 1103515245u + 12345u;
+                v += int((seed >> 16) & 15) - 8;
+                p[y * width + x] = quint16(v);
+            }
+        }
+        // 죽은 픽셀 / 뜨거운 점 (전체의 0.1% 미만)
+        p[0] = 16383;
+        p[width * height / 2] = 16383;
+        p[width * height - 1] = 0;
+    }
+    return frames;
+}
+
+bool checkGain(int width, int height)
+{
+    QVector<quint16> frames = synthFrames(width, height);
+    ThermalRenderer r;
+    const QImage &img = r.render(frames.constData(), width, height, 1);
+
+    // 1~99% 범위는 배경~체온 영역 안이어야 하고, 0이나 16383까지 늘어나면 안 됩니다
+    bool ok = r.gainLow() > 7800 && r.gainHigh() < 8600 && r.gainLow() < r.gainHigh();
+    // 뜨거운 점은 팔레트 마지막 색(ironbow 흰색), 죽은 픽셀은 첫 색(검정)
+    const QRgb *row0 = reinterpret_cast<const QRgb *>(img.constScanLine(0));
+    const QRgb *last = reinterpret_cast<const QRgb *>(img.constScanLine(height - 1));
+    ok = ok && (row0[0] & 0xffffff) == 0xffffff && (last[width - 1] & 0xffffff) == 0;
+    std::printf("%dx%d gain %u..%u %s\n", width, height, r.gainLow(), r.gainHigh(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+void bench(int width, int height, int scale, ThermalRenderer::Palette palette)
+{
+    QVector<quint16> frames = synthFrames(width, height);
+    ThermalRenderer r;
+    r.setPalette(palette);
+    r.render(frames.constData(), width, height, scale);     // 이미지 할당은 여기서 한 번
+
+    const int iterations = scale >= 8 ? 500 : 2000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        r.render(frames.constData() + (i % FRAMES) * width * height, width, height, scale);
+    auto t1 = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+    std::printf("%4dx%-4d x%d -> %4dx%-4d %-9s %10.0f ns/frame  %5.2f%% of 27Hz\n",
+                width, height, scale, width * scale, height * scale,
+                ThermalRenderer::paletteName(palette), ns, ns * 100 / FRAME_BUDGET_NS);
+}
+}
+
+int main()
+{
+    bool ok = checkGain(80, 60) & checkGain(160, 120);
+
+    const int sizes[2][2] = { { 80, 60 }, { 160, 120 } };
+    const int scales[] = { 1, 4, 8 };
+    for (const auto &s : sizes)
+        for (int scale : scales)
+            for (int p = 0; p < ThermalRenderer::PaletteCount; ++p)
+                bench(s[0], s[1], scale, ThermalRenderer::Palette(p));
+    return ok ? 0 : 1;
+}
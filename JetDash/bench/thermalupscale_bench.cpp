@@ -0,0 +1,160 @@
+/*
+ * 열화상 업스케일러(ThermalUpscaler) 벤치마크
+ *
+ * 합성 장면을 Lepton 2.x(80x60) / 3.x(160x120) 크기로 만들어
+ *   - 4배, 8배, 위젯 맞춤(열화상 모니터 라벨 크기 정도, 비정수 배율) 출력에 대해
+ *   - Nearest / Bilinear / Bicubic, 스칼라 / SIMD 별 ns/frame
+ *   - 비교용: 원본을 QImage::scaled(Qt::SmoothTransformation)로 키울 때 (매번 할당)
+ * 를 재고, SIMD 결과가 스칼라와 비트 단위로 같은지와 평평한 장면이 그대로 유지되는지 확인합니다.
+ *
+ * Build: cmake -DJETDASH_BUILD_BENCH=ON 후 thermalupscale_bench 타깃
+ * Usage: ./thermalupscale_bench
+ */
+
+#include <QImage>
+#include <QVector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "../thermalupscaler.h"
+#include "../thermalrenderer.h"
+
+namespace {
+const int FIT_WIDTH = 760;          // 1280x800 창에서 열화상 라벨이 대략 이 정도
+const int FIT_HEIGHT = 540;
+const double FRAME_BUDGET_NS = 1e9 / 27;
+
+QVector<quint16> synthFrame(int width, int height)
+{
+    QVector<quint16> frame(width * height);
+    quint32 seed = 12345;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int v = 7900 + x * 2 + y;
+            int dx = x - width / 3, dy = y - height / 2;
+            int r = height / 5;
+            if (dx * dx + dy * dy < r * r) v += 400;     // 경계가 뚜렷한 따뜻한 영역
+            seed = seed * 1103515245u + 12345u;
+            v += int((seed >> 16) & 15) - 8;
+            frame[y * width + x] = quint16(v);
+        }
+    }
+    frame[0] = 0x3fff;                                  // 뜨거운 점 (bicubic 넘침 확인용)
+    return frame;
+}
+
+template <typename F>
+double timeNs(int iterations, F fn)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+// 위젯 안에 비율 유지하면서 가장 크게
+void fitSize(int w, int h, int &ow, int &oh)
+{
+    ow = FIT_WIDTH;
+    oh = FIT_WIDTH * h / w;
+    if (oh > FIT_HEIGHT) {
+        oh = FIT_HEIGHT;
+        ow = FIT_HEIGHT * w / h;
+    }
+}
+
+bool check(int w, int h, int ow, int oh)
+{
+    QVector<quint16> src = synthFrame(w, h);
+    QVector<quint16> flat(w * h, 8000);
+    bool ok = true;
+
+    for (int m = 0; m < ThermalUpscaler::ModeCount; ++m) {
+        ThermalUpscaler a, b;
+        a.setMode(ThermalUpscaler::Mode(m));
+        b.setMode(ThermalUpscaler::Mode(m));
+        a.setSimdEnabled(false);
+        const quint16 *ra = a.process(src.constData(), w, h, ow, oh);
+        const quint16 *rb = b.process(src.constData(), w, h, ow, oh);
+        if (std::memcmp(ra, rb, sizeof(quint16) * ow * oh) != 0) {
+            std::printf("%s %dx%d -> %dx%d: SIMD != scalar\n", ThermalUpscaler::modeName(ThermalUpscaler::Mode(m)), w, h, ow, oh);
+            ok = false;
+        }
+        const quint16 *rf = b.process(flat.constData(), w, h, ow, oh);
+        for (int i = 0; i < ow * oh; ++i) {
+            if (rf[i] != 8000) {
+                std::printf("%s: flat frame changed at %d (%u)\n", ThermalUpscaler::modeName(ThermalUpscaler::Mode(m)), i, rf[i]);
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+void bench(int w, int h, int ow, int oh, const char *label)
+{
+    QVector<quint16> src = synthFrame(w, h);
+    const int iterations = ow * oh > 300000 ? 200 : 1000;
+
+    for (int m = 0; m < ThermalUpscaler::ModeCount; ++m) {
+        double ns[2];
+        for (int s = 0; s < 2; ++s) {
+            ThermalUpscaler up;
+            up.setMode(ThermalUpscaler::Mode(m));
+            up.setSimdEnabled(s == 1);
+            up.process(src.constData(), w, h, ow, oh);      // 가중치 계산, 버퍼 할당은 여기서 한 번
+            ns[s] = timeNs(iterations, [&] { up.process(src.constData(), w, h, ow, oh); });
+        }
+        std::printf("%3dx%-3d %-6s -> %4dx%-4d %-8s scalar %9.0f ns  simd %9.0f ns  (x%.1f)\n",
+                    w, h, label, ow, oh, ThermalUpscaler::modeName(ThermalUpscaler::Mode(m)),
+                    ns[0], ns[1], ns[0] / ns[1]);
+    }
+
+    // 업스케일 + 컬러맵 전체 (대시보드에서 한 프레임에 하는 일)
+    ThermalUpscaler up;
+    ThermalRenderer r;
+    double total = timeNs(iterations, [&] {
+        r.updateGain(src.constData(), w * h);
+        r.colorize(up.process(src.constData(), w, h, ow, oh), ow, oh);
+    });
+
+    // 비교: 원본을 16bit 흑백 QImage로 만들어 Qt 부드러운 확대 (매 프레임 새 이미지)
+    QImage gray(w, h, QImage::Format_Grayscale16);
+    for (int y = 0; y < h; ++y)
+        std::memcpy(gray.scanLine(y), src.constData() + y * w, sizeof(quint16) * w);
+    double qt = timeNs(iterations / 4 + 1, [&] {
+        QImage scaled = gray.scaled(ow, oh, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        (void)scaled;
+    });
+
+    std::printf("%3dx%-3d %-6s -> %4dx%-4d bicubic+colormap %9.0f ns (%5.2f%% of 27Hz)  QImage::scaled smooth %9.0f ns\n",
+                w, h, label, ow, oh, total, total * 100 / FRAME_BUDGET_NS, qt);
+}
+}
+
+int main()
+{
+    const int sizes[2][2] = { { 80, 60 }, { 160, 120 } };
+    bool ok = true;
+
+    for (const auto &s : sizes) {
+        int w = s[0], h = s[1], fw, fh;
+        fitSize(w, h, fw, fh);
+        ok &= check(w, h, w * 4, h * 4);
+        ok &= check(w, h, w * 8, h * 8);
+        ok &= check(w, h, fw, fh);
+        ok &= check(w, h, fw - 3, fh - 1);          // SIMD 꼬리 처리 (8의 배수가 아닌 폭)
+    }
+    std::printf("check %s\n", ok ? "ok" : "FAIL");
+
+    for (const auto &s : sizes) {
+        int w = s[0], h = s[1], fw, fh;
+        fitSize(w, h, fw, fh);
+        bench(w, h, w * 4, h * 4, "x4");
+        bench(w, h, w * 8, h * 8, "x8");
+        bench(w, h, fw, fh, "fit");
+    }
+    return ok ? 0 : 1;
+}
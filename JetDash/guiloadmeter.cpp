@@ -0,0 +1,46 @@
+#include "guiloadmeter.h"
+
+#include <QThread>
+
+GuiLoadMeter::Snapshot GuiLoadMeter::take()
+{
+    Snapshot s;
+    qint64 elapsed = window.restart();
+    if (elapsed > 0) {
+        s.busyPercent = busyNs * 100.0 / (elapsed * 1e6);
+        s.seconds = elapsed / 1000.0;
+    }
+    s.maxEventMs = maxNs / 1e6;
+    s.events = events;
+
+    busyNs = 0;
+    maxNs = 0;
+    events = 0;
+    return s;
+}
+
+DashApplication::DashApplication(int &argc, char **argv)
+    : QApplication(argc, argv)
+{
+}
+
+bool DashApplication::notify(QObject *receiver, QEvent *event)
+{
+    // 워커 스레드의 이벤트도 여기를 지나가므로 GUI 스레드 것만 잽니다
+    if (QThread::currentThread() != thread() || depth > 0)
+        return QApplication::notify(receiver, event);
+
+    QElapsedTimer timer;
+    timer.start();
+    depth++;
+    bool handled = QApplication::notify(receiver, event);
+    depth--;
+    meter.add(timer.nsecsElapsed());
+    return handled;
+}
+
+GuiLoadMeter *DashApplication::loadMeter()
+{
+    DashApplication *app = qobject_cast<DashApplication *>(QCoreApplication::instance());
+    return app ? &app->meter : nullptr;
+}
@@ -0,0 +1,57 @@
+#ifndef GUILOADMETER_H
+#define GUILOADMETER_H
+
+#include <QApplication>
+#include <QElapsedTimer>
+
+// GUI 스레드가 이벤트 처리(슬롯, 그리기, 키 입력 ...)에 쓴 시간을 잽니다.
+// 통신/디코드가 GUI 스레드에서 빠졌는지, 주행 키 입력이 밀리지 않는지 확인하는 용도입니다.
+class GuiLoadMeter
+{
+public:
+    struct Snapshot {
+        double busyPercent = 0;     // 측정 구간 중 이벤트 처리에 쓴 비율
+        double maxEventMs = 0;      // 가장 오래 걸린 이벤트 하나
+        int events = 0;
+        double seconds = 0;         // 측정 구간 길이
+    };
+
+    GuiLoadMeter() { window.start(); }
+
+    void add(qint64 ns)
+    {
+        busyNs += ns;
+        maxNs = qMax(maxNs, ns);
+        events++;
+    }
+
+    // 지난 take() 이후 구간의 값을 돌려주고 새로 시작합니다
+    Snapshot take();
+
+private:
+    QElapsedTimer window;
+    qint64 busyNs = 0;
+    qint64 maxNs = 0;
+    int events = 0;
+};
+
+// 모든 GUI 스레드 이벤트를 GuiLoadMeter로 재는 QApplication
+// (다른 스레드 객체로 가는 이벤트와 중첩된 이벤트는 바깥 것 하나로만 셉니다)
+class DashApplication : public QApplication
+{
+    Q_OBJECT
+
+public:
+    DashApplication(int &argc, char **argv);
+
+    bool notify(QObject *receiver, QEvent *event) override;
+
+    // DashApplication으로 실행 중이 아니면 nullptr
+    static GuiLoadMeter *loadMeter();
+
+private:
+    GuiLoadMeter meter;
+    int depth = 0;
+};
+
+#endif // GUILOADMETER_H
@@ -0,0 +1,76 @@
+#include "latencystats.h"
+
+#include <QTextStream>
+#include <QtAlgorithms>
+#include <cstring>
+
+// us 단위 값 -> 구간 번호. [2^k, 2^(k+1)) 구간을 SUB칸으로 나눕니다.
+int LatencyHistogram::bucketOf(quint64 us)
+{
+    if (us < quint64(SUB)) return int(us);
+    int k = 63 - int(qCountLeadingZeroBits(us));
+    int idx = k * SUB + int((us >> (k - 2)) & (SUB - 1));
+    return idx < BUCKETS ? idx : BUCKETS - 1;
+}
+
+// 구간 번호 -> 구간 상한 (us)
+qint64 LatencyHistogram::bucketUpperUs(int idx)
+{
+    if (idx < SUB) return idx + 1;
+    int k = idx / SUB;
+    qint64 sub = idx % SUB;
+    return (qint64(1) << k) + ((sub + 1) << (k - 2));
+}
+
+void LatencyHistogram::add(qint64 ns)
+{
+    if (ns < 0) ns = 0;
+    buckets[bucketOf(quint64(ns) / 1000)]++;
+    n++;
+    sum += quint64(ns);
+    if (ns > max) max = ns;
+}
+
+void LatencyHistogram::reset()
+{
+    std::memset(buckets, 0, sizeof(buckets));
+    n = 0;
+    sum = 0;
+    max = 0;
+}
+
+qint64 LatencyHistogram::percentileNs(double p) const
+{
+    if (n == 0) return 0;
+    quint64 target = quint64(n * p / 100.0);
+    if (target >= n) target = n - 1;
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > target) return qMin(bucketUpperUs(i) * 1000, max);
+    }
+    return max;
+}
+
+void LatencyHistogram::writeCsv(QTextStream &out, const QString &name) const
+{
+    for (int i = 0; i < BUCKETS; ++i) {
+        if (buckets[i]) out << name << ',' << bucketUpperUs(i) << ',' << buckets[i] << '\n';
+    }
+}
+
+void RttEstimator::add(qint64 rttNs)
+{
+    double r = double(rttNs);
+    if (samples == 0) {
+        // 첫 값: RFC 6298 2.2
+        srtt = r;
+        rttvar = r / 2;
+    } else {
+        rttvar += (qAbs(srtt - r) - rttvar) / 4;
+        srtt += (r - srtt) / 8;
+        jitter += (qAbs(double(rttNs - last)) - jitter) / 16;
+    }
+    last = rttNs;
+    samples++;
+}
@@ -0,0 +1,93 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QMetaType>
+#include <QString>
+#include <QtGlobal>
+
+class QTextStream;
+
+// 명령 하나의 지연 (ACK를 받았을 때 NetworkWorker가 만듭니다, docs/Protocol.md 2.5)
+struct CommandLatency {
+    quint32 seq = 0;
+    qint64 rttNs = 0;       // 보냄 -> ACK 받음 (JetDash 시계)
+    qint64 robotNs = -1;    // 로봇이 받음 -> 실행 끝 (로봇 시계, ACK에 없으면 -1)
+};
+Q_DECLARE_METATYPE(CommandLatency)
+
+// 로봇 마이크 -> 운영자 스피커 지연 예산 (NetworkWorker가 1초마다 보냅니다, docs/Protocol.md 4.5)
+// 단계마다 스트림 시작부터의 p50 (ms). 네트워크 편도는 여기서 못 재므로 명령 RTT의 절반을 더합니다
+struct ListenLatency {
+    double captureMs = 0;       // 로봇 마이크 캡처 주기 (HELLO listen_capture_ms)
+    double robotMs = 0;         // 로봇이 첫 샘플을 읽음 -> 전송 (패킷 헤더 delay: 프레임 모으기 + 인코드)
+    double jitterMs = 0;        // 도착 -> 재생 (지터 버퍼 대기)
+    double resamplerMs = 0;     // 로봇 주파수 -> 스피커 주파수 필터 지연
+    double deviceMs = 0;        // QAudioSink에 써 두고 아직 재생 안 된 양
+    quint64 packets = 0;
+    quint64 lost = 0;
+    quint64 late = 0;
+    double concealedMs = 0;     // 손실/늦음을 보정한 길이
+    quint64 underruns = 0;      // 스피커 큐가 비어 있던 tick
+    quint64 dropped = 0;        // 스피커 큐가 꽉 차서 버린 샘플
+
+    double totalMs(double networkMs) const
+    {
+        return captureMs + robotMs + networkMs + jitterMs + resamplerMs + deviceMs;
+    }
+};
+Q_DECLARE_METATYPE(ListenLatency)
+
+// 지연 시간 히스토그램 (로봇 쪽 latency_hist.c와 같은 구간: 1us 단위, 2의 거듭제곱 구간마다 4칸)
+class LatencyHistogram
+{
+public:
+    static const int SUB = 4;
+    static const int BUCKETS = 40 * SUB;
+
+    void add(qint64 ns);
+    void reset();
+
+    quint64 count() const { return n; }
+    qint64 maxNs() const { return max; }
+    double meanNs() const { return n ? double(sum) / n : 0; }
+    // p(0~100) 백분위 값 (ns, 해당 구간의 상한)
+    qint64 percentileNs(double p) const;
+
+    // CSV 행으로 내보내기: name,upper_us,count (빈 구간은 건너뜀)
+    void writeCsv(QTextStream &out, const QString &name) const;
+
+    static qint64 bucketUpperUs(int idx);
+
+private:
+    static int bucketOf(quint64 us);
+
+    quint64 buckets[BUCKETS] = {};
+    quint64 n = 0;
+    quint64 sum = 0;
+    qint64 max = 0;
+};
+
+// 왕복 시간 추정 (계속 갱신)
+//   srtt/rttvar: TCP 재전송 타이머와 같은 방식 (RFC 6298, 1/8, 1/4)
+//   jitter: 연속한 두 RTT 차이의 이동 평균 (RFC 3550 interarrival jitter처럼 1/16)
+class RttEstimator
+{
+public:
+    void add(qint64 rttNs);
+    void reset() { *this = RttEstimator(); }
+
+    bool valid() const { return samples > 0; }
+    double srttMs() const { return srtt / 1e6; }
+    double rttvarMs() const { return rttvar / 1e6; }
+    double jitterMs() const { return jitter / 1e6; }
+    double lastMs() const { return last / 1e6; }
+
+private:
+    double srtt = 0;
+    double rttvar = 0;
+    double jitter = 0;
+    qint64 last = 0;
+    quint64 samples = 0;
+};
+
+#endif // LATENCYSTATS_H
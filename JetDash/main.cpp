@@ -1,9 +1,9 @@
 #include "mainwindow.h"
-#include <QApplication>
+#include "guiloadmeter.h"
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    DashApplication a(argc, argv);   // GUI 스레드 이벤트 처리 시간 측정 (guiloadmeter.h)
 
     // ==========================================
     // 🎨 스타일 시트 적용 (여기서부터 디자인 코드)
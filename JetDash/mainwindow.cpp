@@ -7,11 +7,14 @@
 #include <QStyle>
 #include <QMediaDevices>
 #include <QAudioDevice>
+#include <QImage>
+#include <QPixmap>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
 
-// ★ 설정: 라즈베리 파이 주소 및 포트
-const QString RPI_IP = "100.102.180.32";
-const int PORT_CMD = 12345;  // TCP (명령/센서)
-const int PORT_AUDIO = 5000; // UDP (음성)
+#include "guiloadmeter.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -19,56 +22,98 @@ MainWindow::MainWindow(QWidget *parent)
     setupUi();
     applyStyles();
 
+    qRegisterMetaType<TelemetrySnapshot>();
+    qRegisterMetaType<CommandLatency>();
+    qRegisterMetaType<ListenLatency>();
+
     // ---------------------------------------------------------
-    // 1. TCP 소켓 설정 (명령 및 센서 데이터)
+    // 1. 네트워크 스레드 (명령/센서 TCP, 열화상 TCP, 음성 UDP, 자동 재접속)
     // ---------------------------------------------------------
-    tcpSocket = new QTcpSocket(this);
-
-    // 데이터가 들어오면 읽기 함수 실행
-    connect(tcpSocket, &QTcpSocket::readyRead, this, &MainWindow::readSensorData);
+    network = new NetworkWorker;
+    network->moveToThread(&networkThread);
+    connect(&networkThread, &QThread::started, network, &NetworkWorker::start);
+    connect(&networkThread, &QThread::finished, network, &QObject::deleteLater);
 
     // 연결 상태 모니터링
-    connect(tcpSocket, &QTcpSocket::connected, this, [this](){
-        qDebug() << "Link Status: CONNECTED";
-        lblSystemStatus->setText("System : <font color='#2ecc71'>Connected</font>");
+    connect(network, &NetworkWorker::commandLinkChanged, this, [this](bool connected){
+        telemetryShown = false;     // 새 연결의 첫 센서값은 전부 다시 그림
+        if (connected)
+            lblSystemStatus->setText("System : <font color='#2ecc71'>Connected</font>");
+        else
+            lblSystemStatus->setText("System : <font color='red'>Disconnected</font>");
+        if (!connected) lblListen->setText("Robot Mic : -");
     });
-
-    connect(tcpSocket, &QTcpSocket::disconnected, this, [this](){
-        qDebug() << "Link Status: DISCONNECTED";
-        lblSystemStatus->setText("System : <font color='red'>Disconnected</font>");
+    connect(network, &NetworkWorker::reconnecting, this, [this](){
+        lblSystemStatus->setText("System : <font color='#e67e22'>Reconnecting...</font>");
+    });
+    connect(network, &NetworkWorker::telemetryReceived, this, &MainWindow::showTelemetry);
+    connect(network, &NetworkWorker::commandAcked, this, &MainWindow::recordCommandLatency);
+    connect(network, &NetworkWorker::listenLatency, this, &MainWindow::showListenLatency);
+    connect(network, &NetworkWorker::micLevel, this, [this](int percent, bool clipping){
+        // 마이크를 끈 뒤에 늦게 도착한 값은 무시 (게이지는 0으로 둡니다)
+        if (!btnMicToggle->isChecked()) return;
+        volumeBar->setValue(percent);
+        setMeterClipping(clipping);
+    });
+    connect(network, &NetworkWorker::micTraffic, this, [this](double kbps, int savedPercent, bool suppressing){
+        if (!btnMicToggle->isChecked()) return;
+        if (suppressing)
+            lblMicTraffic->setText(QString("Mic TX : %1 kbps (saved %2%)").arg(kbps, 0, 'f', 1).arg(savedPercent));
+        else
+            lblMicTraffic->setText(QString("Mic TX : %1 kbps").arg(kbps, 0, 'f', 1));
     });
 
     // ---------------------------------------------------------
-    // 2. 자동 재접속 타이머 (3초마다 체크)
+    // 2. 디코드 스레드 (열화상 파싱/복원 -> 보간 -> 컬러맵)
     // ---------------------------------------------------------
-    reconnectTimer = new QTimer(this);
-    connect(reconnectTimer, &QTimer::timeout, this, &MainWindow::attemptConnection);
-    reconnectTimer->start(3000); // 3000ms = 3초
+    thermal = new ThermalWorker;
+    thermal->moveToThread(&decodeThread);
+    connect(&decodeThread, &QThread::finished, thermal, &QObject::deleteLater);
+    connect(network, &NetworkWorker::thermalData, thermal, &ThermalWorker::appendData);
+    connect(network, &NetworkWorker::thermalLinkChanged, thermal, [this](bool connected){
+        if (!connected) thermal->reset();
+    });
+    connect(network, &NetworkWorker::thermalLinkChanged, this, [this](bool connected){
+        if (!connected) thermalCameraLabel->setText("THERMAL\n[NO SIGNAL]");
+    });
+    connect(thermal, &ThermalWorker::frameReady, this, &MainWindow::showThermalImage);
 
-    // 프로그램 시작 시 1회 즉시 시도
-    attemptConnection();
+    decodeThread.start();
+    networkThread.start();
 
     // ---------------------------------------------------------
-    // 3. UDP 소켓 (음성 전송용)
+    // 3. GUI 스레드 부하 표시 (1초마다)
     // ---------------------------------------------------------
-    udpSocket = new QUdpSocket(this);
+    loadTimer = new QTimer(this);
+    connect(loadTimer, &QTimer::timeout, this, &MainWindow::updateLoadStats);
+    loadTimer->start(1000);
 
     // 4. 오디오 설정 (수정됨: Int16 강제 고정)
-    QAudioDevice info = QMediaDevices::defaultAudioInput();
-    QAudioFormat format = info.preferredFormat();
+    micDevice = QMediaDevices::defaultAudioInput();
+    micFormat = micDevice.preferredFormat();
 
     // ★★★ 여기가 핵심입니다! ★★★
     // 마이크가 Float를 좋아하든 말든, 우리는 Int16으로 받아야 계산이 됩니다.
-    format.setSampleFormat(QAudioFormat::Int16);
-    format.setChannelCount(1);
+    micFormat.setSampleFormat(QAudioFormat::Int16);
+    micFormat.setChannelCount(1);
 
     // 샘플 레이트는 마이크가 좋아하는 거 씁니다 (보통 48000Hz)
-    // (만약 8000Hz가 지원되면 8000으로 바꾸셔도 됩니다)
-
-    qDebug() << "🎤 설정된 포맷:" << format.sampleFormat();
-    qDebug() << "🎧 설정된 주파수:" << format.sampleRate();
-
-    audioInput = new QAudioSource(info, format, this);
+    // 로봇 재생 주파수(8000Hz)로는 NetworkWorker가 리샘플해서 보냅니다
+
+    qDebug() << "🎤 설정된 포맷:" << micFormat.sampleFormat();
+    qDebug() << "🎧 설정된 주파수:" << micFormat.sampleRate();
+
+    // 스피커 (로봇 마이크 재생): 마이크와 같은 이유로 mono Int16, 주파수는 장치가 좋아하는 것
+    // 로봇이 HELLO 응답에 listen을 붙였을 때만 실제로 재생합니다
+    QAudioDevice speaker = QMediaDevices::defaultAudioOutput();
+    if (!speaker.isNull()) {
+        QAudioFormat speakerFormat = speaker.preferredFormat();
+        speakerFormat.setSampleFormat(QAudioFormat::Int16);
+        speakerFormat.setChannelCount(1);
+        NetworkWorker *n = network;
+        QMetaObject::invokeMethod(n, [n, speaker, speakerFormat](){ n->startSpeaker(speaker, speakerFormat); },
+                                  Qt::QueuedConnection);
+    }
 
     // ---------------------------------------------------------
     // 5. 버튼 이벤트 연결
@@ -86,21 +131,22 @@ MainWindow::MainWindow(QWidget *parent)
             btnMicToggle->setText("MIC ON (Streaming)");
             sendJsonCommand("MIC", true);
 
-            audioDevice = audioInput->start();
-            connect(audioDevice, &QIODevice::readyRead, this, &MainWindow::processAudio);
-            qDebug() << "Audio Streaming STARTED";
+            // 캡처와 볼륨 처리, UDP 전송은 네트워크 스레드에서
+            NetworkWorker *n = network;
+            QAudioDevice device = micDevice;
+            QAudioFormat format = micFormat;
+            QMetaObject::invokeMethod(n, [n, device, format](){ n->startMic(device, format); }, Qt::QueuedConnection);
         } else {
             // [OFF]
             btnMicToggle->setText("🎤 Mic OFF"); // 텍스트도 원래대로 깔끔하게
             sendJsonCommand("MIC", false);
 
-            audioInput->stop();
-            if(audioDevice) audioDevice->disconnect(this);
+            QMetaObject::invokeMethod(network, &NetworkWorker::stopMic, Qt::QueuedConnection);
 
             // ★ [추가] 껐을 때 게이지 바가 멈춰있으면 보기 싫으니 0으로 초기화
             volumeBar->setValue(0);
-
-            qDebug() << "Audio Streaming STOPPED";
+            setMeterClipping(false);
+            lblMicTraffic->setText("Mic TX : -");
         }
 
         // 스타일 갱신 (빨간색/회색 바뀌게)
@@ -137,6 +183,25 @@ MainWindow::MainWindow(QWidget *parent)
         }
     });
 
+    // 열화상 컬러맵 전환 (화면에만 적용, 로봇에는 보내지 않음)
+    connect(btnThermalPalette, &QPushButton::clicked, this, [this](){
+        thermalPalette = ThermalRenderer::Palette((thermalPalette + 1) % ThermalRenderer::PaletteCount);
+        thermal->setPalette(thermalPalette);
+        btnThermalPalette->setText(ThermalRenderer::paletteName(thermalPalette));
+        QMetaObject::invokeMethod(thermal, &ThermalWorker::redraw, Qt::QueuedConnection);
+    });
+
+    // 열화상 확대 보간 방식 전환 (Bicubic -> Nearest -> Bilinear)
+    connect(btnThermalInterp, &QPushButton::clicked, this, [this](){
+        thermalInterp = ThermalUpscaler::Mode((thermalInterp + 1) % ThermalUpscaler::ModeCount);
+        thermal->setMode(thermalInterp);
+        btnThermalInterp->setText(ThermalUpscaler::modeName(thermalInterp));
+        QMetaObject::invokeMethod(thermal, &ThermalWorker::redraw, Qt::QueuedConnection);
+    });
+
+    // 명령 지연 히스토그램 CSV로 저장
+    connect(btnExportLatency, &QPushButton::clicked, this, &MainWindow::exportLatency);
+
     // (3) 시스템 재부팅
     connect(btnReboot, &QPushButton::clicked, this, [this](){
         sendJsonCommand("SYSTEM", "REBOOT");
@@ -145,104 +210,142 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    if(tcpSocket->isOpen()) tcpSocket->close();
+    // 워커는 각자 스레드가 끝날 때 지워지고(deleteLater) 소켓도 그때 닫힙니다
+    networkThread.quit();
+    decodeThread.quit();
+    networkThread.wait();
+    decodeThread.wait();
 }
 
-// [슬롯] 자동 재접속 시도
-void MainWindow::attemptConnection()
+// 열화상 이미지 표시: 디코드 스레드가 다 그려서 보낸 것을 붙이기만 합니다
+void MainWindow::showThermalImage(const QImage &image, quint32 seq)
 {
-    // 연결이 끊겨 있을 때만 시도
-    if (tcpSocket->state() == QAbstractSocket::UnconnectedState) {
-        qDebug() << "Attempting to connect to" << RPI_IP << "...";
-        lblSystemStatus->setText("System : <font color='#e67e22'>Reconnecting...</font>");
-        tcpSocket->connectToHost(RPI_IP, PORT_CMD);
-    }
+    Q_UNUSED(seq);
+    thermalCameraLabel->setPixmap(QPixmap::fromImage(image));
+
+    // 다음 프레임은 지금 라벨 크기에 맞춰서 그리도록
+    thermal->setTargetSize(thermalCameraLabel->contentsRect().size());
+    thermal->frameConsumed();
+    thermalPainted++;
 }
 
-void MainWindow::processAudio()
+// GUI 스레드가 이벤트 처리에 쓴 시간(1초 구간)과 열화상 표시 상태
+void MainWindow::updateLoadStats()
 {
-    // [1] 안전 장치: 장치가 없거나 데이터가 없으면 종료
-    if (!audioDevice) return;
-
-    // 데이터를 몽땅 읽어옵니다.
-    QByteArray data = audioDevice->readAll();
-
-    // 읽은 데이터가 비어있으면 할 게 없으니 리턴
-    if (data.isEmpty()) return;
-
-    // -----------------------------------------------------------
-    // [2] 데이터 처리 (볼륨 조절 + 시각화)
-    // -----------------------------------------------------------
-
-    // QByteArray(바이트 덩어리)를 16비트 정수 배열(숫자 덩어리)로 변환
-    // Int16: -32768 ~ +32767 사이의 숫자
-    int16_t *samples = (int16_t *)data.data();
-    int sampleCount = data.size() / 2; // 2바이트가 숫자 1개이므로 개수는 절반
-
-    int maxAmplitude = 0; // 이번 턴에서 가장 큰 소리 크기 (게이지바 용)
-
-    for (int i = 0; i < sampleCount; ++i) {
-        int originalSample = samples[i];
-
-        // (A) 볼륨 증폭 (현재 게인값 곱하기)
-        // currentGain이 1.0이면 원본, 2.0이면 2배
-        int amplifiedSample = static_cast<int>(originalSample * currentGain);
-
-        // (B) 클리핑 방지 (소리가 너무 커서 찢어지는 현상 막기)
-        if (amplifiedSample > 32767) amplifiedSample = 32767;
-        if (amplifiedSample < -32768) amplifiedSample = -32768;
-
-        // (C) 변경된 값을 다시 데이터에 덮어쓰기
-        samples[i] = static_cast<int16_t>(amplifiedSample);
-
-        // (D) 가장 큰 소리 찾기 (게이지바 그리기 위해 절댓값 사용)
-        int absValue = std::abs(amplifiedSample);
-        if (absValue > maxAmplitude) {
-            maxAmplitude = absValue;
-        }
+    GuiLoadMeter *meter = DashApplication::loadMeter();
+    if (!meter) return;
+
+    GuiLoadMeter::Snapshot s = meter->take();
+    double fps = s.seconds > 0 ? thermalPainted / s.seconds : 0;
+    thermalPainted = 0;
+
+    lblGuiLoad->setText(QString("GUI : %1% busy, max %2 ms<br>Thermal : %3 fps, render %4 ms, dropped %5")
+                            .arg(s.busyPercent, 0, 'f', 1)
+                            .arg(s.maxEventMs, 0, 'f', 1)
+                            .arg(fps, 0, 'f', 1)
+                            .arg(thermal->lastRenderNs() / 1e6, 0, 'f', 2)
+                            .arg(thermal->framesDropped()));
+
+    // 명령 왕복 시간 (PING이 1초마다 가므로 3초 넘게 ACK가 없으면 경고)
+    secondsSinceAck++;
+    if (!cmdRtt.valid()) {
+        lblLatency->setText("Link RTT : -");
+    } else if (secondsSinceAck > 3) {
+        lblLatency->setText(QString("Link RTT : <font color='red'>no ACK %1 s</font>").arg(secondsSinceAck - 1));
+    } else {
+        double srtt = cmdRtt.srttMs();
+        const char *color = srtt < 50 ? "#2ecc71" : srtt < 150 ? "#e67e22" : "red";
+        lblLatency->setText(QString("Link RTT : <font color='%1'>%2 ms</font> ±%3, jitter %4 ms, p99 %5 ms")
+                                .arg(color)
+                                .arg(srtt, 0, 'f', 1)
+                                .arg(cmdRtt.rttvarMs(), 0, 'f', 1)
+                                .arg(cmdRtt.jitterMs(), 0, 'f', 1)
+                                .arg(histRtt.percentileNs(99) / 1e6, 0, 'f', 1));
     }
+}
 
-    // -----------------------------------------------------------
-    // [3] UI 업데이트 (초록색 바)
-    // -----------------------------------------------------------
-    // 0 ~ 32768 범위를 0 ~ 100 퍼센트로 변환
-    int percentage = (maxAmplitude * 100) / 32768;
-
-    // 너무 작으면 0으로 표시 (노이즈 무시)
-    if (percentage < 2) percentage = 0;
-
-    volumeBar->setValue(percentage);
+// 로봇 마이크 -> 스피커 지연 예산 (1초마다). 네트워크 편도는 명령 왕복 시간의 절반으로 봅니다
+void MainWindow::showListenLatency(const ListenLatency &l)
+{
+    double networkMs = cmdRtt.valid() ? cmdRtt.srttMs() / 2 : 0;
+    double total = l.totalMs(networkMs);
+    const char *color = total < LISTEN_BUDGET_MS ? "#2ecc71" : "red";
+    lblListen->setText(QString("Robot Mic : <font color='%1'>%2 ms</font> = capture %3 + robot %4 + net %5"
+                               " + jitter %6 + resample %7 + device %8<br>"
+                               "lost %9, late %10, concealed %11 ms, underrun %12")
+                           .arg(color)
+                           .arg(total, 0, 'f', 0)
+                           .arg(l.captureMs, 0, 'f', 0)
+                           .arg(l.robotMs, 0, 'f', 1)
+                           .arg(networkMs, 0, 'f', 1)
+                           .arg(l.jitterMs, 0, 'f', 1)
+                           .arg(l.resamplerMs, 0, 'f', 1)
+                           .arg(l.deviceMs, 0, 'f', 1)
+                           .arg(l.lost)
+                           .arg(l.late)
+                           .arg(l.concealedMs, 0, 'f', 0)
+                           .arg(l.underruns));
+}
 
-    // -----------------------------------------------------------
-    // [4] UDP 전송
-    // -----------------------------------------------------------
-    // 볼륨 조절이 완료된 data를 라즈베리 파이로 쏘기
-    udpSocket->writeDatagram(data, QHostAddress(RPI_IP), PORT_AUDIO);
+// 마이크 게이지 색: 스타일시트 다시 적용은 비싸서 상태가 바뀔 때만
+void MainWindow::setMeterClipping(bool clipping)
+{
+    if (volumeBar->property("clip").toBool() == clipping) return;
+    volumeBar->setProperty("clip", clipping);
+    volumeBar->style()->unpolish(volumeBar);
+    volumeBar->style()->polish(volumeBar);
 }
 
-// JSON 명령 전송 도우미
-void MainWindow::sendJsonCommand(QString target, QJsonValue value)
+// 명령 ACK 하나: 추정치와 히스토그램 갱신 (표시는 1초마다 updateLoadStats에서)
+void MainWindow::recordCommandLatency(const CommandLatency &l)
 {
-    if (tcpSocket->state() != QAbstractSocket::ConnectedState) {
-        qDebug() << "Failed to send command: Not Connected.";
-        return;
+    cmdRtt.add(l.rttNs);
+    histRtt.add(l.rttNs);
+    if (l.robotNs >= 0) {
+        // 왕복 시간에서 로봇이 붙잡고 있던 시간을 빼면 네트워크(+ 양쪽 소켓 처리) 시간
+        histRobot.add(l.robotNs);
+        histNetwork.add(l.rttNs - l.robotNs);
     }
+    secondsSinceAck = 0;
+}
 
-    QJsonObject payload;
-    payload["target"] = target;
-    payload["value"] = value;
-
-    QJsonObject json;
-    json["type"] = "COMMAND";
-    json["payload"] = payload;
-
-    QByteArray data = QJsonDocument(json).toJson(QJsonDocument::Compact);
+// 히스토그램 CSV 저장: histogram,upper_us,count 행 + 요약(# 주석)
+void MainWindow::exportLatency()
+{
+    QString defaultName = QString("jetdash_latency_%1.csv").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    QString path = QFileDialog::getSaveFileName(this, "Export Latency Histograms", defaultName, "CSV (*.csv)");
+    if (path.isEmpty()) return;
 
-    tcpSocket->write(data + "\n");
-    tcpSocket->flush(); // 즉시 전송 강제
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "Failed to export latency:" << file.errorString();
+        return;
+    }
+    QTextStream out(&file);
+    const struct { const char *name; const LatencyHistogram *h; } hists[] = {
+        { "rtt", &histRtt }, { "robot", &histRobot }, { "network", &histNetwork },
+    };
+    for (const auto &e : hists) {
+        out << "# " << e.name << ": n=" << e.h->count()
+            << " avg_us=" << qRound64(e.h->meanNs() / 1000)
+            << " p50_us=" << e.h->percentileNs(50) / 1000
+            << " p90_us=" << e.h->percentileNs(90) / 1000
+            << " p99_us=" << e.h->percentileNs(99) / 1000
+            << " max_us=" << e.h->maxNs() / 1000 << '\n';
+    }
+    if (cmdRtt.valid()) {
+        out << "# srtt_ms=" << cmdRtt.srttMs() << " rttvar_ms=" << cmdRtt.rttvarMs()
+            << " jitter_ms=" << cmdRtt.jitterMs() << '\n';
+    }
+    out << "histogram,upper_us,count\n";
+    for (const auto &e : hists) e.h->writeCsv(out, e.name);
+    qDebug() << "Latency histograms exported:" << path;
+}
 
-    // 디버그 출력
-    qDebug().noquote() << "[SENT]" << data;
+// JSON 명령 전송 도우미: 만들고 보내는 것은 네트워크 스레드에서 합니다 (DRIVE는 우선 처리)
+void MainWindow::sendJsonCommand(QString target, QJsonValue value)
+{
+    network->postCommand(target, value);
 }
 
 // 키보드 누름 (주행 시작)
@@ -273,47 +376,44 @@ void MainWindow::keyReleaseEvent(QKeyEvent *event)
     }
 }
 
-// 센서 데이터 수신 및 파싱
-void MainWindow::readSensorData() {
-    while (tcpSocket->canReadLine()) {
-        QByteArray data = tcpSocket->readLine();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
-
-        if (jsonDoc.isNull()) continue;
-
-        QJsonObject jsonObj = jsonDoc.object();
-        if (jsonObj["type"].toString() == "TELEMETRY") {
-            QJsonObject payload = jsonObj["payload"].toObject();
-
-            int co = payload["co_ppm"].toInt();
-            int dist = payload["obstacle_cm"].toInt();
-            bool isRollover = payload["rollover"].toBool();
-
-            // CO 농도 표시
-            lblCO->setText(QString("CO Level : <font color='#ff5252'>%1 ppm</font>").arg(co));
-
-            // 거리 표시 (30cm 미만 경고)
-            if(dist < 30) {
-                lblDistance->setText(QString("Distance : <font color='red'>WARNING %1cm</font>").arg(dist));
-            } else {
-                lblDistance->setText(QString("Distance : <font color='#ffb142'>%1cm</font>").arg(dist));
-            }
-
-            // 전복 여부 표시 (이모티콘 없이 색상으로만 구분)
-            if (isRollover) {
-                if (!lblRollover->text().contains("DANGER")) {
-                    lblRollover->setText("Rollover : <font color='red'>DANGER</font>");
-                    rgbCameraLabel->setStyleSheet("border: 5px solid red; background-color: #300000; color: white;");
-                }
-            } else {
-                if (!lblRollover->text().contains("Safe")) {
-                    lblRollover->setText("Rollover : <font color='#00d2d3'>Safe</font>");
-                    rgbCameraLabel->setStyleSheet("border: 3px solid #ff5252; color: #ff5252; font-weight: bold; background-color: black; border-radius: 8px;");
-                }
-            }
-            lblSystemStatus->setText("System : <font color='#2ecc71'>Connected (Receiving)</font>");
+// 센서값 표시 (JSON 파싱은 네트워크 스레드에서 끝난 상태, 값이 바뀐 때만 옵니다)
+// 바뀐 필드의 라벨만 다시 씁니다 (setText/setStyleSheet는 레이아웃/스타일 재계산이 따라옴)
+void MainWindow::showTelemetry(const TelemetrySnapshot &t)
+{
+    int co = t.coPpm;
+    int dist = t.obstacleCm;
+    bool isRollover = t.rollover;
+
+    // CO 농도 표시
+    if (!telemetryShown || co != shownTelemetry.coPpm)
+        lblCO->setText(QString("CO Level : <font color='#ff5252'>%1 ppm</font>").arg(co));
+
+    // 거리 표시 (30cm 미만 경고)
+    if (!telemetryShown || dist != shownTelemetry.obstacleCm) {
+        if(dist < 30) {
+            lblDistance->setText(QString("Distance : <font color='red'>WARNING %1cm</font>").arg(dist));
+        } else {
+            lblDistance->setText(QString("Distance : <font color='#ffb142'>%1cm</font>").arg(dist));
+        }
+    }
+
+    // 전복 여부 표시 (이모티콘 없이 색상으로만 구분)
+    if (!telemetryShown || isRollover != shownTelemetry.rollover) {
+        if (isRollover) {
+            lblRollover->setText("Rollover : <font color='red'>DANGER</font>");
+            rgbCameraLabel->setStyleSheet("border: 5px solid red; background-color: #300000; color: white;");
+        } else {
+            lblRollover->setText("Rollover : <font color='#00d2d3'>Safe</font>");
+            rgbCameraLabel->setStyleSheet("border: 3px solid #ff5252; color: #ff5252; font-weight: bold; background-color: black; border-radius: 8px;");
         }
     }
+
+    // 연결 후 첫 값에서 한 번만
+    if (!telemetryShown)
+        lblSystemStatus->setText("System : <font color='#2ecc71'>Connected (Receiving)</font>");
+
+    shownTelemetry = t;
+    telemetryShown = true;
 }
 
 void MainWindow::setupUi() {
@@ -392,6 +492,8 @@ void MainWindow::setupUi() {
     thermalCameraLabel = new QLabel("THERMAL\n[NO SIGNAL]", this);
     thermalCameraLabel->setAlignment(Qt::AlignCenter);
     thermalCameraLabel->setStyleSheet("color: #7f8c8d; font-weight: bold;");
+    // 라벨 크기에 맞춰 그린 이미지가 다시 라벨을 키우지 않도록 sizeHint는 무시
+    thermalCameraLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
 
     // ★ [추가] 열화상 탐지 버튼
     btnThermalDetect = new QPushButton("Thermal Detect OFF", this);
@@ -403,8 +505,31 @@ void MainWindow::setupUi() {
         "QPushButton:checked { background-color: #e67e22; border: 1px solid #d35400; }" // 주황색 맛
         );
 
+    // 컬러맵 전환 버튼 (누를 때마다 Ironbow -> Rainbow -> Grayscale)
+    btnThermalPalette = new QPushButton(ThermalRenderer::paletteName(thermalPalette), this);
+    btnThermalPalette->setCursor(Qt::PointingHandCursor);
+    btnThermalPalette->setFixedHeight(30);
+    btnThermalPalette->setFixedWidth(100);
+    btnThermalPalette->setStyleSheet(
+        "QPushButton { background-color: #2c3e50; border: 1px solid #555; font-size: 12px; }"
+        );
+
+    // 확대 보간 방식 전환 버튼
+    btnThermalInterp = new QPushButton(ThermalUpscaler::modeName(thermalInterp), this);
+    btnThermalInterp->setCursor(Qt::PointingHandCursor);
+    btnThermalInterp->setFixedHeight(30);
+    btnThermalInterp->setFixedWidth(100);
+    btnThermalInterp->setStyleSheet(
+        "QPushButton { background-color: #2c3e50; border: 1px solid #555; font-size: 12px; }"
+        );
+
+    QHBoxLayout *thermalButtons = new QHBoxLayout();
+    thermalButtons->addWidget(btnThermalDetect);
+    thermalButtons->addWidget(btnThermalPalette);
+    thermalButtons->addWidget(btnThermalInterp);
+
     thermalLayout->addWidget(thermalCameraLabel);
-    thermalLayout->addWidget(btnThermalDetect); // 라벨 밑에 추가
+    thermalLayout->addLayout(thermalButtons); // 라벨 밑에 추가
 
     // 모니터 배치
     monitorLayout->addWidget(rgbFrame);
@@ -433,11 +558,33 @@ void MainWindow::setupUi() {
 
     lblDistance = new QLabel("Distance : - cm", this);
     lblSystemStatus = new QLabel("System : Ready", this);
+    lblLatency = new QLabel("Link RTT : -", this);
+    lblLatency->setStyleSheet("font-size: 12px;");
+    lblGuiLoad = new QLabel("GUI : -", this);
+    lblGuiLoad->setStyleSheet("font-size: 12px; color: #95a5a6;");
+    lblListen = new QLabel("Robot Mic : -", this);
+    lblListen->setStyleSheet("font-size: 12px;");
+    lblMicTraffic = new QLabel("Mic TX : -", this);
+    lblMicTraffic->setStyleSheet("font-size: 12px; color: #95a5a6;");
+
+    // 명령 지연 히스토그램 내보내기
+    btnExportLatency = new QPushButton("Export Latency", this);
+    btnExportLatency->setCursor(Qt::PointingHandCursor);
+    btnExportLatency->setFixedHeight(26);
+    btnExportLatency->setFixedWidth(120);
+    btnExportLatency->setStyleSheet(
+        "QPushButton { background-color: #2c3e50; border: 1px solid #555; font-size: 12px; }"
+        );
 
     sensorLayout->addWidget(lblCO);
     sensorLayout->addWidget(lblRollover);
     sensorLayout->addWidget(lblDistance);
     sensorLayout->addWidget(lblSystemStatus);
+    sensorLayout->addWidget(lblLatency);
+    sensorLayout->addWidget(lblGuiLoad);
+    sensorLayout->addWidget(lblListen);
+    sensorLayout->addWidget(lblMicTraffic);
+    sensorLayout->addWidget(btnExportLatency);
     sensorLayout->addStretch(); // 위로 밀착
 
     // (B) 오른쪽: 버튼 및 슬라이더 뭉치
@@ -465,7 +612,8 @@ void MainWindow::setupUi() {
     volumeBar = new QProgressBar(this);
     volumeBar->setFixedHeight(6); // 아주 얇게
     volumeBar->setTextVisible(false);
-    volumeBar->setStyleSheet("QProgressBar { background: #222; border-radius: 3px; } QProgressBar::chunk { background: #00e676; border-radius: 3px; }");
+    volumeBar->setStyleSheet("QProgressBar { background: #222; border-radius: 3px; } QProgressBar::chunk { background: #00e676; border-radius: 3px; }"
+                             "QProgressBar[clip=\"true\"]::chunk { background: #ff5252; }");   // 피크가 0dBFS 가까이
 
     volumeSlider = new QSlider(Qt::Horizontal, this);
     volumeSlider->setRange(0, 200);
@@ -508,7 +656,7 @@ void MainWindow::setupUi() {
         "}"
         );
     connect(volumeSlider, &QSlider::valueChanged, this, [this](int value){
-        currentGain = value / 100.0f;
+        if (network) network->setMicGain(value / 100.0f);   // atomic, 네트워크 스레드가 다음 블록부터 사용
     });
 
     volumeSlider->setEnabled(false);
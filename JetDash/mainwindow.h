@@ -4,17 +4,16 @@
 #include <QMainWindow>
 #include <QLabel>
 #include <QPushButton>
-#include <QTcpSocket>
-#include <QUdpSocket>
 #include <QKeyEvent>
 #include <QFrame>
-#include <QTimer> // 자동 재접속용
+#include <QThread>
+#include <QTimer> // GUI 부하 표시용
 #include <QProgressBar> // ★ 추가
 #include <QSlider>      // ★ 추가
+#include <QJsonValue>
 
-// ★ Qt 6 오디오 헤더
-#include <QAudioSource>
-#include <QMediaDevices>
+#include "networkworker.h"
+#include "thermalworker.h"
 
 class MainWindow : public QMainWindow
 {
@@ -30,23 +29,44 @@ protected:
     void keyReleaseEvent(QKeyEvent *event) override;
 
 private slots:
-    void readSensorData();      // TCP 데이터 수신
-    void processAudio();        // 마이크 데이터 처리 (UDP 전송)
-    void attemptConnection();   // 재접속 시도 로직
+    void showTelemetry(const TelemetrySnapshot &t);              // 센서값 표시
+    void showThermalImage(const QImage &image, quint32 seq);    // 열화상 이미지 표시
+    void updateLoadStats();                                      // GUI 부하 / 명령 지연 표시 (1초마다)
+    void recordCommandLatency(const CommandLatency &l);          // 명령 ACK 도착
+    void showListenLatency(const ListenLatency &l);              // 로봇 마이크 지연 예산 (1초마다)
+    void exportLatency();                                        // 지연 히스토그램 CSV 저장
 
 private:
     void setupUi();
     void applyStyles();
-    void sendJsonCommand(QString target, QJsonValue value); // JSON 전송 도우미
+    void sendJsonCommand(QString target, QJsonValue value); // JSON 전송 도우미 (네트워크 스레드로)
+    void setMeterClipping(bool clipping);                    // 게이지 색 (바뀔 때만 스타일 다시 적용)
 
-    // --- 통신 객체 ---
-    QTcpSocket *tcpSocket;      // 명령 및 센서값 (TCP)
-    QUdpSocket *udpSocket;      // 음성 전송 (UDP)
-    QTimer *reconnectTimer;     // 자동 재접속 타이머
+    // --- 작업 스레드 ---
+    // GUI 스레드는 그리기와 입력만 하고, 통신과 열화상 복원/렌더링은 여기서 합니다
+    QThread networkThread;
+    QThread decodeThread;
+    NetworkWorker *network = nullptr;
+    ThermalWorker *thermal = nullptr;
 
-    // --- 오디오 객체 (Qt 6) ---
-    QAudioSource *audioInput;
-    QIODevice *audioDevice;
+    // 마이크 장치/포맷 (GUI 스레드에서 고르고 캡처는 네트워크 스레드에서)
+    QAudioDevice micDevice;
+    QAudioFormat micFormat;
+
+    QTimer *loadTimer;
+    TelemetrySnapshot shownTelemetry;   // 지금 라벨에 보이는 센서값
+    bool telemetryShown = false;        // 이번 연결에서 센서값을 그렸는지
+    int thermalPainted = 0;     // 1초 동안 붙인 열화상 프레임 수
+
+    // 명령 -> ACK 지연 (NetworkWorker가 ACK마다 보내줌)
+    RttEstimator cmdRtt;
+    LatencyHistogram histRtt;       // 왕복 전체
+    LatencyHistogram histRobot;     // 로봇이 받아서 실행 끝낼 때까지
+    LatencyHistogram histNetwork;   // 왕복 - 로봇 처리
+    int secondsSinceAck = 0;
+    static const int LISTEN_BUDGET_MS = 150;    // 로봇 마이크 -> 스피커 목표 (넘으면 빨간색)
+    ThermalRenderer::Palette thermalPalette = ThermalRenderer::Ironbow;
+    ThermalUpscaler::Mode thermalInterp = ThermalUpscaler::Bicubic;
 
     // --- UI 구성요소 ---
     QWidget *centralWidget;
@@ -54,19 +74,25 @@ private:
     QLabel *thermalCameraLabel;
     QPushButton *btnRgbDetect;
     QPushButton *btnThermalDetect;
+    QPushButton *btnThermalPalette; // 열화상 컬러맵 전환
+    QPushButton *btnThermalInterp;  // 열화상 확대 보간 방식 전환
 
     QFrame *sensorBox;
     QLabel *lblCO;
     QLabel *lblRollover;
     QLabel *lblDistance;
     QLabel *lblSystemStatus; // 연결 상태 표시
+    QLabel *lblLatency;      // 명령 왕복 시간 (srtt, rttvar, jitter, p99)
+    QLabel *lblGuiLoad;      // GUI 스레드 부하 / 열화상 fps
+    QLabel *lblListen;       // 로봇 마이크 -> 스피커 지연 예산, 손실
+    QLabel *lblMicTraffic;   // 마이크 전송량, 무음 억제로 아낀 비율
 
     QPushButton *btnReboot;
+    QPushButton *btnExportLatency;
     QPushButton *btnMicToggle;
 
     // ★ 추가된 UI 변수
-    QProgressBar *volumeBar;   // 목소리 크기 보여주는 막대
+    QProgressBar *volumeBar;   // 목소리 크기 보여주는 막대 (RMS, 클리핑이면 빨간색)
     QSlider *volumeSlider;     // 볼륨 조절 슬라이더
-    float currentGain = 1.0f;  // 현재 볼륨 배율 (1.0 = 원본)
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,453 @@
+#include "networkworker.h"
+
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QTimer>
+#include <QAudioSource>
+#include <QAudioSink>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+// ★ 설정: 라즈베리 파이 주소 및 포트
+const QString RPI_IP = "100.102.180.32";
+const int PORT_CMD = 12345;  // TCP (명령/센서)
+const int PORT_AUDIO = 5000; // UDP (음성)
+const int PORT_THERMAL = 5001; // TCP (열화상 프레임, 바이너리)
+const int PORT_LISTEN = 5003; // UDP (로봇 마이크, 이쪽에서 받음. HELLO로 알려줌)
+
+// 음성 (docs/Protocol.md 4장)
+const int LEGACY_AUDIO_RATE = 8000;     // HELLO에 음성 형식을 안 알려주는 서버의 aplay 주파수
+const int AUDIO_FRAME_MS = 20;          // 패킷 하나 = 20ms (8kHz ADPCM이면 96바이트, UDP/IP 헤더까지 124바이트)
+const int SPEAKER_BUFFER_MS = 40;       // QAudioSink 버퍼. 10ms마다 채우므로 이 이상은 지연만 늘어남
+
+namespace {
+// postCommand()가 네트워크 스레드로 보내는 명령
+class CommandEvent : public QEvent
+{
+public:
+    static const QEvent::Type TYPE = QEvent::Type(QEvent::User + 1);
+
+    CommandEvent(const QString &target, const QJsonValue &value)
+        : QEvent(TYPE), target(target), value(value) {}
+
+    QString target;
+    QJsonValue value;
+};
+}
+
+NetworkWorker::NetworkWorker(QObject *parent)
+    : QObject(parent), robotAudioRate(LEGACY_AUDIO_RATE), robotAudioCodec(AudioPacket::Raw)
+{
+}
+
+// 아무 스레드에서나 호출. 게시 이벤트는 우선순위 순으로 처리되므로 DRIVE(주행/정지)는
+// 먼저 들어와 있던 마이크/검출 토글 같은 일반 명령이나 invokeMethod 호출보다 앞서 나갑니다
+void NetworkWorker::postCommand(const QString &target, const QJsonValue &value)
+{
+    bool urgent = target == "DRIVE";
+    QCoreApplication::postEvent(this, new CommandEvent(target, value),
+                                urgent ? Qt::HighEventPriority : Qt::NormalEventPriority);
+}
+
+bool NetworkWorker::event(QEvent *e)
+{
+    if (e->type() == CommandEvent::TYPE) {
+        CommandEvent *c = static_cast<CommandEvent *>(e);
+        sendCommand(c->target, c->value);
+        return true;
+    }
+    return QObject::event(e);
+}
+
+// 네트워크 스레드가 시작되면 호출: 소켓이 이 스레드 소속이 되도록 여기서 만듭니다
+void NetworkWorker::start()
+{
+    ackClock.start();
+
+    tcpSocket = new QTcpSocket(this);
+    connect(tcpSocket, &QTcpSocket::readyRead, this, &NetworkWorker::readSensorData);
+    connect(tcpSocket, &QTcpSocket::connected, this, [this](){
+        qDebug() << "Link Status: CONNECTED";
+        // 명령은 작은 패킷 하나라 Nagle에 걸리면 이전 패킷의 ACK(지연 ACK 최대 40ms)를 기다리게 됩니다
+        tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        // 바이너리 센서값(TLV)과 압축 음성을 쓸 수 있다고 알림 (docs/Protocol.md 2.4, 4.2)
+        // 모르는 서버는 이 줄을 무시하고 JSON을 계속 보내고, 파서는 둘 다 읽으므로 따로 기다리지 않습니다.
+        // 음성은 응답이 올 때까지 예전 형식(8kHz PCM16)으로 보냅니다. 로봇 마이크는 PORT_LISTEN으로 받습니다 (4.5)
+        tcpSocket->write("{\"type\":\"HELLO\",\"payload\":{\"telemetry\":[\"TLV\",\"JSON\"],"
+                         "\"audio\":[\"ADPCM\",\"PCM\"],\"listen\":[\"ADPCM\",\"PCM\"],"
+                         "\"listen_port\":" + QByteArray::number(PORT_LISTEN) + "}}\n");
+        emit commandLinkChanged(true);
+    });
+    connect(tcpSocket, &QTcpSocket::disconnected, this, [this](){
+        qDebug() << "Link Status: DISCONNECTED";
+        // 끊기면서 남은 반쪽 줄은 버리고, 다시 붙으면 첫 값은 무조건 보냅니다
+        telemetryParser.reset();
+        haveTelemetry = false;
+        for (PendingCommand &p : pending) p = PendingCommand();
+        // 다음에 붙는 서버가 HELLO를 모를 수도 있으니 예전 형식으로 돌아갑니다
+        handleHello(ServerHello());
+        emit commandLinkChanged(false);
+    });
+
+    // 열화상 프레임 소켓 (JSON 채널과 별도, 같은 타이머로 재접속)
+    thermalSocket = new QTcpSocket(this);
+    connect(thermalSocket, &QTcpSocket::readyRead, this, &NetworkWorker::readThermal);
+    connect(thermalSocket, &QTcpSocket::connected, this, [this](){ emit thermalLinkChanged(true); });
+    connect(thermalSocket, &QTcpSocket::disconnected, this, [this](){ emit thermalLinkChanged(false); });
+
+    udpSocket = new QUdpSocket(this);
+    robotAddress = QHostAddress(RPI_IP);    // 음성 콜백마다 문자열을 다시 파싱하지 않도록
+
+    // 로봇 마이크: 받은 패킷은 지터 버퍼로, 재생은 10ms 타이머 (짧은 주기라 PreciseTimer)
+    listenSocket = new QUdpSocket(this);
+    if (!listenSocket->bind(QHostAddress::AnyIPv4, PORT_LISTEN))
+        qDebug() << "Robot mic: bind" << PORT_LISTEN << "failed:" << listenSocket->errorString();
+    connect(listenSocket, &QUdpSocket::readyRead, this, &NetworkWorker::readListen);
+    playoutTimer = new QTimer(this);
+    playoutTimer->setTimerType(Qt::PreciseTimer);
+    playoutTimer->setInterval(AudioJitterBuffer::TICK_MS);
+    connect(playoutTimer, &QTimer::timeout, this, &NetworkWorker::playListen);
+
+    // 자동 재접속 타이머 (3초마다 체크)
+    reconnectTimer = new QTimer(this);
+    connect(reconnectTimer, &QTimer::timeout, this, &NetworkWorker::attemptConnection);
+    reconnectTimer->start(3000);
+
+    pingTimer = new QTimer(this);
+    connect(pingTimer, &QTimer::timeout, this, &NetworkWorker::sendPing);
+    pingTimer->start(1000);
+
+    // 시작 시 1회 즉시 시도
+    attemptConnection();
+}
+
+// 자동 재접속 시도 (연결이 끊겨 있을 때만)
+void NetworkWorker::attemptConnection()
+{
+    if (tcpSocket->state() == QAbstractSocket::UnconnectedState) {
+        qDebug() << "Attempting to connect to" << RPI_IP << "...";
+        emit reconnecting();
+        tcpSocket->connectToHost(RPI_IP, PORT_CMD);
+    }
+    if (thermalSocket->state() == QAbstractSocket::UnconnectedState) {
+        thermalSocket->connectToHost(RPI_IP, PORT_THERMAL);
+    }
+}
+
+// 열화상 바이트는 그대로 디코드 스레드로 넘깁니다 (QByteArray는 공유 복사라 복사 비용 없음)
+void NetworkWorker::readThermal()
+{
+    QByteArray data = thermalSocket->readAll();
+    if (!data.isEmpty()) emit thermalData(data);
+}
+
+// JSON 명령 전송
+void NetworkWorker::sendCommand(const QString &target, const QJsonValue &value)
+{
+    if (!tcpSocket || tcpSocket->state() != QAbstractSocket::ConnectedState) {
+        qDebug() << "Failed to send command: Not Connected.";
+        return;
+    }
+
+    QJsonObject payload;
+    payload["target"] = target;
+    payload["value"] = value;
+
+    quint32 seq = trackCommand();
+
+    QJsonObject json;
+    json["type"] = "COMMAND";
+    json["seq"] = qint64(seq);      // 로봇이 ACK에 그대로 돌려줌
+    json["payload"] = payload;
+
+    QByteArray data = QJsonDocument(json).toJson(QJsonDocument::Compact);
+
+    tcpSocket->write(data + "\n");
+    tcpSocket->flush(); // 즉시 전송 강제 (이벤트 루프로 돌아갈 때까지 기다리지 않음)
+
+    // 디버그 출력
+    qDebug().noquote() << "[SENT]" << data;
+}
+
+// 새 seq를 정하고 보낸 시각(ACK 왕복 시간 기준)을 기록
+quint32 NetworkWorker::trackCommand()
+{
+    quint32 seq = nextSeq++;
+    if (nextSeq == 0) nextSeq = 1;
+    PendingCommand &p = pending[seq % MAX_PENDING_ACKS];
+    p.seq = seq;
+    p.sentNs = ackClock.nsecsElapsed();
+    return seq;
+}
+
+// 주행 명령이 없을 때도 왕복 시간을 재기 위한 빈 명령 (로봇은 ACK만 보냄)
+void NetworkWorker::sendPing()
+{
+    if (tcpSocket->state() != QAbstractSocket::ConnectedState) return;
+    QByteArray data = "{\"type\":\"COMMAND\",\"seq\":" + QByteArray::number(trackCommand())
+                      + ",\"payload\":{\"target\":\"PING\"}}\n";
+    tcpSocket->write(data);
+    tcpSocket->flush();
+}
+
+// 센서 데이터 수신 및 파싱 -> 값이 바뀌었을 때만 GUI로
+// 줄마다 QByteArray/QJsonDocument를 만들지 않고 파서 버퍼로 바로 읽어서 그 자리에서 파싱합니다 (할당 없음)
+// HELLO 협상이 되면 JSON 줄 대신 TLV 레코드가 오고, 파서가 둘을 알아서 구분합니다
+void NetworkWorker::readSensorData()
+{
+    qint64 n;
+    TelemetrySnapshot t;
+    CommandAck ack;
+    ServerHello hello;
+    while ((n = tcpSocket->read(telemetryParser.writeBuffer(), telemetryParser.writeSpace())) > 0) {
+        qint64 receivedNs = ackClock.nsecsElapsed();
+        telemetryParser.commit(int(n));
+        TelemetryParser::Result r;
+        while ((r = telemetryParser.next(t, &ack, &hello)) != TelemetryParser::NeedMore) {
+            if (r == TelemetryParser::Ack) {
+                handleAck(ack, receivedNs);
+                continue;
+            }
+            if (r == TelemetryParser::Hello) {
+                handleHello(hello);
+                continue;
+            }
+            // 10~100Hz로 같은 값이 계속 오므로 바뀐 것만 넘깁니다 (GUI 라벨 갱신/시그널 큐잉 절약)
+            if (haveTelemetry && t == lastTelemetry) continue;
+            lastTelemetry = t;
+            haveTelemetry = true;
+            emit telemetryReceived(t);
+        }
+    }
+}
+
+// 명령 ACK: seq로 보낸 시각을 찾아 왕복 시간을 냅니다.
+// 로봇 처리 시간(exec - rx)은 로봇 시계끼리 뺀 값이라 시계가 달라도 됩니다
+void NetworkWorker::handleAck(const CommandAck &ack, qint64 receivedNs)
+{
+    if (ack.seq <= 0 || ack.seq > 0xffffffffLL) return;     // seq 없는 ACK (예전 서버)
+    PendingCommand &p = pending[ack.seq % MAX_PENDING_ACKS];
+    if (p.seq != quint32(ack.seq)) return;                  // 이미 받았거나 덮어쓴 명령
+    p.seq = 0;
+
+    CommandLatency l;
+    l.seq = quint32(ack.seq);
+    l.rttNs = receivedNs - p.sentNs;
+    l.robotNs = (ack.rxNs >= 0 && ack.execNs >= ack.rxNs) ? ack.execNs - ack.rxNs : -1;
+    emit commandAcked(l);
+}
+
+// HELLO 응답: 로봇이 받는 음성 형식과 재생 주파수 (없으면 예전 서버 -> 8kHz PCM16 그대로),
+// 로봇 마이크를 보내는지 (없으면 재생 안 함)
+void NetworkWorker::handleHello(const ServerHello &hello)
+{
+    int codec = hello.audioCodec;
+    int rate = hello.audioRate > 0 ? hello.audioRate : LEGACY_AUDIO_RATE;
+    if (codec != robotAudioCodec || rate != robotAudioRate) {
+        robotAudioCodec = codec;
+        robotAudioRate = rate;
+        configureAudio();
+    }
+    robotAudioCn = hello.audioCn;
+    audioEncoder.setSilenceSuppression(robotAudioCn);
+
+    robotListenRate = hello.listenCodec >= 0 ? hello.listenRate : 0;
+    robotListenCaptureMs = hello.listenCaptureMs;
+    configureListen();
+}
+
+// 마이크 주파수 -> 로봇 재생 주파수 리샘플러와 인코더를 다시 만듭니다.
+// 예전에는 마이크 주파수(보통 48kHz) 그대로 보내서 로봇 aplay(8kHz)에서 6배 느리게 재생됐습니다
+void NetworkWorker::configureAudio()
+{
+    if (micRate <= 0) return;
+    audioEncoder.configure(micRate, robotAudioRate, robotAudioCodec, AUDIO_FRAME_MS);
+    audioEncoder.setSilenceSuppression(robotAudioCn);
+    qDebug() << "Audio:" << micRate << "->" << robotAudioRate << "Hz"
+             << AudioPacket::codecName(robotAudioCodec) << audioEncoder.bitrate() / 1000.0 << "kbps,"
+             << "added latency" << audioEncoder.addedLatencyMs() << "ms";
+}
+
+// 마이크 켜기. 장치/포맷은 GUI 스레드에서 골라서 넘겨줍니다 (QMediaDevices는 GUI 스레드에서)
+// 포맷은 mono Int16이어야 합니다 (MainWindow에서 맞춰서 넘김)
+void NetworkWorker::startMic(const QAudioDevice &device, const QAudioFormat &format)
+{
+    if (!audioInput) audioInput = new QAudioSource(device, format, this);
+    if (micRate != format.sampleRate()) {
+        micRate = format.sampleRate();
+        configureAudio();
+    }
+    audioEncoder.reset();
+    audioEncoder.resetTraffic();
+    micMeter.configure(micRate);
+    meterSamples = 0;
+    trafficSamples = 0;
+    lastMeterPercent = -1;
+
+    audioDevice = audioInput->start();
+    if (audioDevice) connect(audioDevice, &QIODevice::readyRead, this, &NetworkWorker::processAudio);
+    qDebug() << "Audio Streaming STARTED";
+}
+
+void NetworkWorker::stopMic()
+{
+    if (audioInput) audioInput->stop();
+    if (audioDevice) audioDevice->disconnect(this);
+    audioDevice = nullptr;
+    qDebug() << "Audio Streaming STOPPED";
+}
+
+void NetworkWorker::processAudio()
+{
+    // [1] 안전 장치: 장치가 없거나 데이터가 없으면 종료
+    if (!audioDevice) return;
+
+    // 데이터를 몽땅 읽어옵니다.
+    QByteArray data = audioDevice->readAll();
+
+    // 읽은 데이터가 비어있으면 할 게 없으니 리턴
+    if (data.isEmpty()) return;
+
+    // -----------------------------------------------------------
+    // [2] 데이터 처리 (볼륨 조절 + 클리핑 + 게이지 값, SIMD로 한 번에)
+    // -----------------------------------------------------------
+
+    // QByteArray(바이트 덩어리)를 16비트 정수 배열(숫자 덩어리)로 보고 제자리에서 고칩니다
+    // Int16: -32768 ~ +32767 사이의 숫자
+    qint16 *samples = reinterpret_cast<qint16 *>(data.data());
+    int sampleCount = data.size() / 2; // 2바이트가 숫자 1개이므로 개수는 절반
+    int gain = AudioGain::gainQ12(micGain.load(std::memory_order_relaxed));
+
+    AudioGain::Block block = AudioGain::apply(samples, sampleCount, gain);
+    micMeter.update(block, sampleCount);
+
+    // 게이지는 콜백마다가 아니라 METER_INTERVAL_MS마다, 바뀌었을 때만 GUI로 (표시는 30Hz면 충분)
+    meterSamples += sampleCount;
+    if (meterSamples >= micRate * METER_INTERVAL_MS / 1000) {
+        meterSamples = 0;
+        int percent = AudioLevelMeter::percent(micMeter.rmsDb());
+        bool clipping = micMeter.clipping();
+        if (percent != lastMeterPercent || clipping != lastMeterClipping) {
+            lastMeterPercent = percent;
+            lastMeterClipping = clipping;
+            emit micLevel(percent, clipping);
+        }
+    }
+
+    // -----------------------------------------------------------
+    // [3] 로봇 재생 주파수로 리샘플 -> 20ms마다 압축해서 UDP 전송
+    //     (VAD가 조용하다고 본 프레임은 안 보내고 100ms마다 CN 패킷 하나)
+    // -----------------------------------------------------------
+    audioEncoder.push(samples, sampleCount, [&](const QByteArray &packet) {
+        udpSocket->writeDatagram(packet, robotAddress, PORT_AUDIO);
+    });
+
+    // 전송량은 1초마다 한 번만 GUI로 (보낸 양 / 억제 안 했으면 보냈을 양)
+    trafficSamples += sampleCount;
+    if (trafficSamples >= micRate * TRAFFIC_INTERVAL_MS / 1000) {
+        const AudioEncoder::Traffic &t = audioEncoder.traffic();
+        double seconds = double(trafficSamples) / micRate;
+        int saved = t.fullBytes ? int(100 - t.bytes * 100 / t.fullBytes) : 0;
+        emit micTraffic(t.bytes * 8 / 1000.0 / seconds, saved, audioEncoder.silenceSuppression());
+        audioEncoder.resetTraffic();
+        trafficSamples = 0;
+    }
+}
+
+// 스피커 켜기 (로봇 마이크 재생). 장치/포맷은 GUI 스레드에서 골라서 넘겨줍니다 (mono Int16)
+// push 모드로 10ms마다 지터 버퍼에서 꺼낸 만큼만 씁니다. 버퍼가 크면 그만큼 늦게 들리므로 SPEAKER_BUFFER_MS로 제한
+void NetworkWorker::startSpeaker(const QAudioDevice &device, const QAudioFormat &format)
+{
+    if (audioOutput) return;
+    audioOutput = new QAudioSink(device, format, this);
+    audioOutput->setBufferSize(format.bytesForDuration(SPEAKER_BUFFER_MS * 1000));
+    speakerRate = format.sampleRate();
+    speakerDevice = audioOutput->start();
+    configureListen();
+}
+
+// 새 스트림: 지터 버퍼와 통계를 비우고, 로봇 마이크와 스피커가 둘 다 있을 때만 재생 타이머를 돌립니다
+void NetworkWorker::configureListen()
+{
+    listenBuffer.configure(robotListenRate);
+    speakerQueue.reset();
+    speakerPlaying = false;
+    speakerUnderruns = speakerDropped = 0;
+    playoutTicks = 0;
+    if (robotListenRate <= 0 || !speakerDevice) {
+        playoutTimer->stop();
+        return;
+    }
+    listenResampler.configure(robotListenRate, speakerRate);
+    listenPcm.resize(AudioPacket::MAX_SAMPLES);
+    playoutTimer->start();
+    qDebug() << "Robot mic:" << robotListenRate << "->" << speakerRate << "Hz, capture"
+             << robotListenCaptureMs << "ms, resampler" << listenResampler.delayMs() << "ms";
+}
+
+// 로봇 마이크 패킷 -> 지터 버퍼 (도착 시각은 재생 시계와 같은 ackClock)
+void NetworkWorker::readListen()
+{
+    while (listenSocket->hasPendingDatagrams()) {
+        qint64 size = qMax<qint64>(listenSocket->pendingDatagramSize(), 1);
+        if (listenDatagram.size() < size) listenDatagram.resize(size);
+        qint64 n = listenSocket->readDatagram(listenDatagram.data(), listenDatagram.size());
+        if (n <= 0 || !playoutTimer->isActive()) continue;
+        listenBuffer.put(reinterpret_cast<const quint8 *>(listenDatagram.constData()), int(n), ackClock.nsecsElapsed());
+    }
+}
+
+// 10ms마다: 재생 시계만큼 지터 버퍼에서 꺼내 스피커 주파수로 바꿔서 QAudioSink에 씁니다
+// (지터 버퍼 시계와 장치 시계가 조금 달라도 큐가 비면 underrun, 차면 버림으로 끝나고 쌓이지 않습니다)
+void NetworkWorker::playListen()
+{
+    // 쓰기 전에 남은 양 = 이번에 쓰는 첫 샘플이 들릴 때까지 기다리는 시간
+    qint64 queued = audioOutput->bufferSize() - audioOutput->bytesFree();
+    if (speakerPlaying) {
+        speakerQueue.add(queued * 1000000000LL / (qint64(speakerRate) * 2));
+        if (queued == 0) speakerUnderruns++;
+    }
+
+    int n = listenBuffer.get(ackClock.nsecsElapsed(), listenPcm.data(), listenPcm.size());
+    speakerPlaying = n > 0;
+    if (n > 0) {
+        if (listenOut.size() < listenResampler.maxOutput(n)) listenOut.resize(listenResampler.maxOutput(n));
+        qint64 bytes = qint64(listenResampler.process(listenPcm.constData(), n, listenOut.data())) * 2;
+        qint64 room = audioOutput->bytesFree();
+        if (bytes > room) {
+            speakerDropped += quint64(bytes - room) / 2;
+            bytes = room;
+        }
+        speakerDevice->write(reinterpret_cast<const char *>(listenOut.constData()), bytes);
+    }
+
+    if (++playoutTicks >= LISTEN_STATS_TICKS) {
+        playoutTicks = 0;
+        emitListenLatency();
+    }
+}
+
+// 단계별 지연 (스트림 시작부터 p50). 받은 패킷이 없으면 보내지 않습니다
+void NetworkWorker::emitListenLatency()
+{
+    const AudioJitterBuffer::Stats &st = listenBuffer.stats();
+    if (st.packets == 0) return;
+
+    ListenLatency l;
+    l.captureMs = robotListenCaptureMs;
+    l.robotMs = st.senderDelay.percentileNs(50) / 1e6;
+    l.jitterMs = st.wait.percentileNs(50) / 1e6;
+    l.resamplerMs = listenResampler.delayMs();
+    l.deviceMs = speakerQueue.percentileNs(50) / 1e6;
+    l.packets = st.packets;
+    l.lost = st.lost;
+    l.late = st.late;
+    l.concealedMs = st.concealed * 1000.0 / listenBuffer.rate();
+    l.underruns = speakerUnderruns;
+    l.dropped = speakerDropped;
+    emit listenLatency(l);
+}
@@ -0,0 +1,143 @@
+#ifndef NETWORKWORKER_H
+#define NETWORKWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonValue>
+#include <QAudioDevice>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <atomic>
+
+#include "audiocodec.h"
+#include "audiojitter.h"
+#include "audiolevel.h"
+#include "latencystats.h"
+#include "telemetryparser.h"
+
+class QTcpSocket;
+class QUdpSocket;
+class QTimer;
+class QAudioSource;
+class QAudioSink;
+class QIODevice;
+
+// 네트워크 스레드에서 도는 통신 담당
+//   - 명령/센서 TCP (JSON 줄 단위, 센서값은 협상되면 TLV, 바뀐 것만 GUI로), 열화상 TCP (바이너리), 음성 UDP
+//   - 3초마다 끊긴 연결 재접속
+//   - 마이크 캡처 -> 볼륨/클리핑/게이지(SIMD) -> 로봇 재생 주파수로 리샘플 -> 20ms 프레임 압축 -> UDP 전송
+//     (로봇이 CN 패킷을 알면 VAD로 조용한 프레임 대신 100ms마다 CN 패킷 하나, 1초마다 대역폭 보고)
+//   - 로봇 마이크 UDP 수신 -> 지터 버퍼 -> 스피커 주파수로 리샘플 -> QAudioSink (10ms마다), 단계별 지연 예산
+// 소켓과 오디오 객체는 전부 start()에서 이 스레드 안에 만듭니다.
+// 다른 스레드에서는 QMetaObject::invokeMethod(Qt::QueuedConnection)로 슬롯을 부르고,
+// 결과는 signal(queued)로만 받습니다. setMicGain()과 postCommand()는 아무 스레드에서나 바로 불러도 됩니다.
+class NetworkWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkWorker(QObject *parent = nullptr);
+
+    void setMicGain(float gain) { micGain.store(gain, std::memory_order_relaxed); }
+
+    // 명령 전송 예약. DRIVE는 높은 우선순위 이벤트로 넣어서 큐에 밀려 있는 다른 작업보다 먼저 보냅니다
+    void postCommand(const QString &target, const QJsonValue &value);
+
+public slots:
+    void start();
+    void sendCommand(const QString &target, const QJsonValue &value);
+    void startMic(const QAudioDevice &device, const QAudioFormat &format);
+    void stopMic();
+    void startSpeaker(const QAudioDevice &device, const QAudioFormat &format);
+
+signals:
+    void commandLinkChanged(bool connected);
+    void reconnecting();
+    void telemetryReceived(const TelemetrySnapshot &telemetry);
+    void thermalData(const QByteArray &data);   // 열화상 스트림 바이트 (디코드 스레드로)
+    void thermalLinkChanged(bool connected);
+    void micLevel(int percent, bool clipping);  // 마이크 게이지 (RMS, 0~100), 피크가 0dBFS 가까이면 clipping
+    void micTraffic(double kbps, int savedPercent, bool suppressing);  // 마이크 전송량 (1초마다, UDP/IP 헤더 포함)
+    void commandAcked(const CommandLatency &latency);   // 명령 -> ACK 왕복 시간, 로봇 처리 시간
+    void listenLatency(const ListenLatency &latency);   // 로봇 마이크 -> 스피커 지연 예산 (1초마다, 받는 중일 때만)
+
+protected:
+    bool event(QEvent *e) override;
+
+private slots:
+    void attemptConnection();
+    void sendPing();
+    void readSensorData();
+    void readThermal();
+    void processAudio();
+    void readListen();
+    void playListen();
+
+private:
+    QTcpSocket *tcpSocket = nullptr;        // 명령 및 센서값 (TCP)
+    QTcpSocket *thermalSocket = nullptr;    // 열화상 프레임 (TCP, 바이너리)
+    QUdpSocket *udpSocket = nullptr;        // 음성 전송 (UDP)
+    QHostAddress robotAddress;              // 음성 전송 주소 (start()에서 RPI_IP로 한 번 만듦)
+    QUdpSocket *listenSocket = nullptr;     // 로봇 마이크 수신 (UDP)
+    QTimer *reconnectTimer = nullptr;       // 자동 재접속 타이머
+    QTimer *pingTimer = nullptr;            // 1초마다 PING (키를 안 눌러도 RTT가 계속 갱신되도록)
+
+    TelemetryParser telemetryParser;        // 센서 줄 파서 (소켓에서 바로 읽는 고정 버퍼)
+    TelemetrySnapshot lastTelemetry;        // 마지막으로 GUI에 보낸 값
+    bool haveTelemetry = false;             // 이번 연결에서 한 번이라도 보냈는지
+
+    // 명령 -> ACK 왕복 시간. 명령마다 seq를 붙이고 보낸 시각을 seq % MAX_PENDING_ACKS 자리에 둡니다
+    // (ACK가 안 오는 명령은 같은 자리를 쓰는 나중 명령이 덮어씀)
+    struct PendingCommand {
+        quint32 seq = 0;        // 0 = 빈 자리 (seq는 1부터)
+        qint64 sentNs = 0;
+    };
+    static const int MAX_PENDING_ACKS = 64;
+    QElapsedTimer ackClock;
+    PendingCommand pending[MAX_PENDING_ACKS];
+    quint32 nextSeq = 1;
+    quint32 trackCommand();
+    void handleAck(const CommandAck &ack, qint64 receivedNs);
+    void handleHello(const ServerHello &hello);
+
+    QAudioSource *audioInput = nullptr;
+    QIODevice *audioDevice = nullptr;
+    int micRate = 0;                        // 마이크 캡처 주파수 (0 = 꺼짐)
+    int robotAudioRate;                     // 로봇 재생 주파수 (HELLO 응답, 예전 서버는 8000 고정)
+    int robotAudioCodec;                    // 로봇이 받는 패킷 형식 (AudioPacket::Codec)
+    bool robotAudioCn = false;              // 로봇이 CN 패킷을 앎 (HELLO 응답) -> 무음 억제
+    AudioEncoder audioEncoder;
+    void configureAudio();
+    static const int METER_INTERVAL_MS = 33;
+    AudioLevelMeter micMeter;
+    int meterSamples = 0;                   // 마지막 게이지 전송 뒤 처리한 샘플
+    int lastMeterPercent = -1;
+    static const int TRAFFIC_INTERVAL_MS = 1000;
+    int trafficSamples = 0;                 // 마지막 전송량 보고 뒤 처리한 샘플
+    bool lastMeterClipping = false;
+    std::atomic<float> micGain{1.0f};       // 1.0 = 원본
+
+    // 로봇 마이크 -> 스피커 (docs/Protocol.md 4.5)
+    static const int LISTEN_STATS_TICKS = 100;  // 재생 tick 100번(1초)마다 지연 예산
+    QAudioSink *audioOutput = nullptr;
+    QIODevice *speakerDevice = nullptr;
+    QTimer *playoutTimer = nullptr;         // 지터 버퍼 재생 시계 (AudioJitterBuffer::TICK_MS)
+    int speakerRate = 0;                    // 스피커 주파수 (0 = 꺼짐)
+    int robotListenRate = 0;                // 로봇 마이크 주파수 (HELLO 응답, 0 = 안 보냄)
+    int robotListenCaptureMs = 0;
+    AudioJitterBuffer listenBuffer;
+    PolyphaseResampler listenResampler;
+    QByteArray listenDatagram;
+    QVector<qint16> listenPcm;
+    QVector<qint16> listenOut;
+    LatencyHistogram speakerQueue;          // tick마다 QAudioSink에 남은 양
+    bool speakerPlaying = false;            // 지난 tick에 썼는지 (그 뒤 큐가 비면 underrun)
+    quint64 speakerUnderruns = 0;
+    quint64 speakerDropped = 0;
+    int playoutTicks = 0;
+    void configureListen();
+    void emitListenLatency();
+};
+
+#endif // NETWORKWORKER_H
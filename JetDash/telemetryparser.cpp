@@ -0,0 +1,354 @@
+#include "telemetryparser.h"
+
+#include <cstring>
+
+namespace {
+const int MAX_DEPTH = 16;       // 모르는 값 건너뛸 때 중첩 한도
+
+struct Cursor {
+    const char *p;
+    const char *end;
+
+    void skipWs()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    }
+    bool eat(char c)
+    {
+        skipWs();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+    bool peek(char c)
+    {
+        skipWs();
+        return p < end && *p == c;
+    }
+};
+
+// 문자열을 복사하지 않고 따옴표 안쪽 범위만 돌려줍니다 (escape는 풀지 않음)
+bool readString(Cursor &c, const char *&s, int &len)
+{
+    if (!c.eat('"')) return false;
+    s = c.p;
+    while (c.p < c.end && *c.p != '"') {
+        if (*c.p == '\\' && c.p + 1 < c.end) ++c.p;
+        ++c.p;
+    }
+    if (c.p >= c.end) return false;
+    len = int(c.p - s);
+    ++c.p;
+    return true;
+}
+
+inline bool equals(const char *s, int len, const char *lit)
+{
+    return int(std::strlen(lit)) == len && std::memcmp(s, lit, len) == 0;
+}
+
+// JSON 숫자. 정수부만 쓰고 소수부/지수는 문법만 확인합니다.
+// 정수가 아니거나 너무 크면(|v| >= 10^18) integral = false
+bool readNumber(Cursor &c, qint64 &v, bool &integral)
+{
+    c.skipWs();
+    bool neg = c.p < c.end && *c.p == '-';
+    if (neg) ++c.p;
+    if (c.p >= c.end || *c.p < '0' || *c.p > '9') return false;
+
+    const qint64 LIMIT = 1000000000000000000LL;
+    qint64 acc = 0;
+    integral = true;
+    while (c.p < c.end && *c.p >= '0' && *c.p <= '9') {
+        int d = *c.p++ - '0';
+        if (acc < LIMIT) acc = acc * 10 + d;    // 넘치지 않게 여기서 멈춰도 범위 밖 판정은 같음
+    }
+    if (acc >= LIMIT) integral = false;
+    if (c.p < c.end && *c.p == '.') {
+        ++c.p;
+        if (c.p >= c.end || *c.p < '0' || *c.p > '9') return false;
+        while (c.p < c.end && *c.p >= '0' && *c.p <= '9') integral &= *c.p++ == '0';
+    }
+    if (c.p < c.end && (*c.p == 'e' || *c.p == 'E')) {
+        ++c.p;
+        if (c.p < c.end && (*c.p == '+' || *c.p == '-')) ++c.p;
+        if (c.p >= c.end || *c.p < '0' || *c.p > '9') return false;
+        while (c.p < c.end && *c.p >= '0' && *c.p <= '9') ++c.p;
+        integral = false;   // 지수 표기는 정수로 보지 않습니다
+    }
+    v = neg ? -acc : acc;
+    return true;
+}
+
+// QJsonValue::toInt()처럼 int 범위 밖이거나 정수가 아니면 0
+bool readInt(Cursor &c, int &v)
+{
+    qint64 acc;
+    bool integral;
+    if (!readNumber(c, acc, integral)) return false;
+    v = (!integral || acc > 0x7fffffffLL || acc < -0x7fffffffLL - 1) ? 0 : int(acc);
+    return true;
+}
+
+bool readLiteral(Cursor &c, const char *lit)
+{
+    c.skipWs();
+    int n = int(std::strlen(lit));
+    if (c.end - c.p < n || std::memcmp(c.p, lit, n) != 0) return false;
+    c.p += n;
+    return true;
+}
+
+bool skipValue(Cursor &c, int depth);
+
+// { "key": value, ... } 를 돌면서 키마다 onMember(key, len)을 부릅니다.
+// onMember는 값을 읽거나 건너뛰어야 합니다.
+template <typename F>
+bool readObject(Cursor &c, F onMember)
+{
+    if (!c.eat('{')) return false;
+    if (c.eat('}')) return true;
+    for (;;) {
+        const char *key;
+        int len;
+        if (!readString(c, key, len) || !c.eat(':')) return false;
+        if (!onMember(key, len)) return false;
+        if (c.eat(',')) continue;
+        return c.eat('}');
+    }
+}
+
+bool skipValue(Cursor &c, int depth)
+{
+    if (depth > MAX_DEPTH) return false;
+    c.skipWs();
+    if (c.p >= c.end) return false;
+
+    switch (*c.p) {
+    case '"': {
+        const char *s;
+        int len;
+        return readString(c, s, len);
+    }
+    case '{':
+        return readObject(c, [&](const char *, int) { return skipValue(c, depth + 1); });
+    case '[':
+        ++c.p;
+        if (c.eat(']')) return true;
+        for (;;) {
+            if (!skipValue(c, depth + 1)) return false;
+            if (c.eat(',')) continue;
+            return c.eat(']');
+        }
+    case 't': return readLiteral(c, "true");
+    case 'f': return readLiteral(c, "false");
+    case 'n': return readLiteral(c, "null");
+    default: {
+        int v;
+        return readInt(c, v);
+    }
+    }
+}
+
+// 값이 기대한 타입이 아니면 QJsonValue::toInt()/toBool()처럼 기본값으로 두고 건너뜁니다
+bool readIntField(Cursor &c, int &v)
+{
+    v = 0;
+    if (c.peek('-') || (c.p < c.end && *c.p >= '0' && *c.p <= '9')) return readInt(c, v);
+    return skipValue(c, 1);
+}
+
+// ACK의 seq/시각 필드. 정수가 아니면 -1 (없음)
+bool readInt64Field(Cursor &c, qint64 &v)
+{
+    v = -1;
+    if (c.peek('-') || (c.p < c.end && *c.p >= '0' && *c.p <= '9')) {
+        bool integral;
+        if (!readNumber(c, v, integral)) return false;
+        if (!integral) v = -1;
+        return true;
+    }
+    return skipValue(c, 1);
+}
+
+bool readBoolField(Cursor &c, bool &v)
+{
+    v = false;
+    if (c.peek('t')) return (v = readLiteral(c, "true"));
+    return skipValue(c, 1);
+}
+
+// 문자열 필드를 names 중 몇 번째인지로. 없거나 문자열이 아니면 -1
+bool readNameField(Cursor &c, const char *const *names, int count, int &v)
+{
+    v = -1;
+    if (!c.peek('"')) return skipValue(c, 1);
+    const char *s;
+    int len;
+    if (!readString(c, s, len)) return false;
+    for (int i = 0; i < count; ++i) {
+        if (equals(s, len, names[i])) v = i;
+    }
+    return true;
+}
+
+const char *const TELEMETRY_NAMES[] = { "JSON", "TLV" };
+const char *const AUDIO_NAMES[] = { "PCM", "ADPCM" };      // 순서 = AudioPacket::Codec
+}
+
+TelemetryParser::Result TelemetryParser::parseLine(const char *begin, const char *end, TelemetrySnapshot &out,
+                                                   CommandAck *ack, ServerHello *hello)
+{
+    Cursor c = { begin, end };
+    TelemetrySnapshot t;
+    CommandAck a;
+    ServerHello h;
+    int telemetry = -1;
+    Result kind = Other;
+
+    bool ok = readObject(c, [&](const char *key, int len) {
+        if (equals(key, len, "type")) {
+            const char *s;
+            int n;
+            if (!c.peek('"')) return skipValue(c, 1);
+            if (!readString(c, s, n)) return false;
+            kind = equals(s, n, "TELEMETRY") ? Telemetry
+                 : equals(s, n, "ACK")     ? Ack
+                 : equals(s, n, "HELLO")   ? Hello
+                                           : Other;
+            return true;
+        }
+        if (equals(key, len, "payload") && c.peek('{')) {
+            return readObject(c, [&](const char *k, int n) {
+                if (equals(k, n, "co_ppm")) return readIntField(c, t.coPpm);
+                if (equals(k, n, "obstacle_cm")) return readIntField(c, t.obstacleCm);
+                if (equals(k, n, "rollover")) return readBoolField(c, t.rollover);
+                if (equals(k, n, "seq")) return readInt64Field(c, a.seq);
+                if (equals(k, n, "rx_ns")) return readInt64Field(c, a.rxNs);
+                if (equals(k, n, "exec_ns")) return readInt64Field(c, a.execNs);
+                if (equals(k, n, "telemetry")) return readNameField(c, TELEMETRY_NAMES, 2, telemetry);
+                if (equals(k, n, "audio")) return readNameField(c, AUDIO_NAMES, 2, h.audioCodec);
+                if (equals(k, n, "audio_rate")) return readIntField(c, h.audioRate);
+                if (equals(k, n, "audio_cn")) return readBoolField(c, h.audioCn);
+                if (equals(k, n, "listen")) return readNameField(c, AUDIO_NAMES, 2, h.listenCodec);
+                if (equals(k, n, "listen_rate")) return readIntField(c, h.listenRate);
+                if (equals(k, n, "listen_capture_ms")) return readIntField(c, h.listenCaptureMs);
+                return skipValue(c, 2);
+            });
+        }
+        return skipValue(c, 1);
+    });
+
+    c.skipWs();
+    if (!ok || c.p != c.end) return Invalid;
+    if (kind == Ack && ack) *ack = a;
+    if (kind == Hello && hello) {
+        h.tlv = telemetry == 1;
+        if (h.audioRate < 0) h.audioRate = 0;
+        if (h.listenRate <= 0) h.listenCodec = -1;
+        if (h.listenCaptureMs < 0) h.listenCaptureMs = 0;
+        *hello = h;
+    }
+    if (kind != Telemetry) return kind;
+    // payload가 없거나 객체가 아니면 QJsonValue::toObject()처럼 빈 객체 -> 전부 기본값
+    out = t;
+    return Telemetry;
+}
+
+// 필드 하나라도 길이가 안 맞으면 JSON에서 타입이 다를 때처럼 기본값으로 둡니다.
+// TLV가 body 밖으로 넘어가면 깨진 레코드
+TelemetryParser::Result TelemetryParser::parseRecord(const quint8 *body, int len, TelemetrySnapshot &out)
+{
+    TelemetrySnapshot t;
+    const quint8 *p = body;
+    const quint8 *end = body + len;
+
+    while (p < end) {
+        if (end - p < 2 || end - p - 2 < p[1]) return Invalid;
+        quint8 tag = p[0];
+        int n = p[1];
+        const quint8 *v = p + 2;
+        switch (tag) {
+        case TelemetryTlv::CO_PPM:
+            if (n == 2) t.coPpm = qint16(v[0] | (v[1] << 8));
+            break;
+        case TelemetryTlv::OBSTACLE_CM:
+            if (n == 2) t.obstacleCm = qint16(v[0] | (v[1] << 8));
+            break;
+        case TelemetryTlv::ROLLOVER:
+            if (n == 1) t.rollover = v[0] != 0;
+            break;
+        default:
+            break;      // 나중에 붙을 센서 (sensor.c)
+        }
+        p = v + n;
+    }
+    out = t;
+    return Telemetry;
+}
+
+void TelemetryParser::commit(int n)
+{
+    used += qBound(0, n, BUFFER_SIZE - used);
+}
+
+// 남은 반쪽 줄/레코드는 버퍼 앞으로 당겨놓고 다음 read()를 기다립니다
+void TelemetryParser::compact()
+{
+    if (start > 0) {
+        std::memmove(buffer, buffer + start, used - start);
+        used -= start;
+        start = 0;
+    }
+}
+
+TelemetryParser::Result TelemetryParser::next(TelemetrySnapshot &out, CommandAck *ack, ServerHello *hello)
+{
+    for (;;) {
+        const char *line = buffer + start;
+        int avail = used - start;
+
+        // 바이너리 레코드: 길이가 앞에 있으니 줄바꿈을 찾지 않습니다 (값에 0x0A가 있어도 됨)
+        if (!skipping && avail > 0 && quint8(line[0]) == TelemetryTlv::SYNC) {
+            if (avail < 2 || avail < 2 + quint8(line[1])) {
+                compact();      // 레코드는 최대 257바이트라 버퍼가 넘칠 일은 없음
+                return NeedMore;
+            }
+            int len = quint8(line[1]);
+            start += 2 + len;
+            records++;
+            Result r = parseRecord(reinterpret_cast<const quint8 *>(line) + 2, len, out);
+            if (r == Telemetry) return Telemetry;
+            bad++;
+            continue;
+        }
+
+        const char *nl = static_cast<const char *>(std::memchr(line, '\n', avail));
+        if (!nl) {
+            compact();
+            // 버퍼가 꽉 찼는데 줄이 안 끝났으면 그 줄은 포기하고 다음 '\n'부터 다시
+            if (used == BUFFER_SIZE) {
+                overflow++;
+                used = 0;
+                skipping = true;
+            }
+            return NeedMore;
+        }
+
+        start = int(nl - buffer) + 1;
+        if (skipping) {
+            skipping = false;
+            continue;
+        }
+
+        Cursor c = { line, nl };
+        c.skipWs();
+        if (c.p == nl) continue;    // 빈 줄
+
+        Result r = parseLine(line, nl, out, ack, hello);
+        if (r == Telemetry || r == Ack || r == Hello) return r;
+        if (r == Invalid) bad++;
+    }
+}
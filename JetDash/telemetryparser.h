@@ -0,0 +1,101 @@
+#ifndef TELEMETRYPARSER_H
+#define TELEMETRYPARSER_H
+
+#include <QMetaType>
+#include <QtGlobal>
+
+// 로봇이 보내는 센서값 한 묶음 (docs/Protocol.md 2.3, GUI에는 이것만 넘깁니다)
+struct TelemetrySnapshot {
+    int coPpm = 0;
+    int obstacleCm = 0;
+    bool rollover = false;
+
+    bool operator==(const TelemetrySnapshot &o) const
+    {
+        return coPpm == o.coPpm && obstacleCm == o.obstacleCm && rollover == o.rollover;
+    }
+    bool operator!=(const TelemetrySnapshot &o) const { return !(*this == o); }
+};
+Q_DECLARE_METATYPE(TelemetrySnapshot)
+
+// 명령 ACK 내용 (docs/Protocol.md 2.5). 없는 필드는 -1
+struct CommandAck {
+    qint64 seq = -1;
+    qint64 rxNs = -1;       // 로봇이 명령을 받은 시각 (로봇 CLOCK_MONOTONIC)
+    qint64 execNs = -1;     // 로봇이 명령 실행을 끝낸 시각
+};
+
+// 로봇의 HELLO 응답 (docs/Protocol.md 2.4, 4.2, 4.5). 예전 서버는 음성 필드를 안 보냅니다
+struct ServerHello {
+    bool tlv = false;       // 센서값이 TLV로 옴
+    int audioCodec = -1;    // 음성 패킷 형식 (AudioPacket::Codec), -1 = 헤더 없는 PCM16
+    int audioRate = 0;      // 로봇 재생 주파수 (Hz), 0 = 모름
+    bool audioCn = false;   // 로봇이 CN 패킷을 알아들음 (조용한 구간을 안 보내도 됨)
+    int listenCodec = -1;   // 로봇 마이크 패킷 형식, -1 = 안 보냄 (마이크 없음 / 예전 서버)
+    int listenRate = 0;     // 로봇 마이크 주파수 (Hz)
+    int listenCaptureMs = 0;    // 로봇 마이크 캡처 주기 (첫 샘플 -> 읽힐 때까지 최대 지연)
+};
+
+// 바이너리 센서값 레코드 (docs/Protocol.md 2.4, HELLO로 협상했을 때만 옵니다)
+//   [sync 0xA5][body 길이 1B][TLV ...],  TLV = [tag 1B][len 1B][값 len바이트, little-endian]
+// JSON 줄은 '{'로, 레코드는 0xA5(UTF-8 첫 바이트로 못 옴)로 시작하므로 같은 스트림에 섞여도 구분됩니다.
+namespace TelemetryTlv {
+const quint8 SYNC = 0xA5;
+const quint8 CO_PPM = 0x01;         // int16
+const quint8 OBSTACLE_CM = 0x02;    // int16
+const quint8 ROLLOVER = 0x03;       // uint8 (0/1)
+}
+
+// TELEMETRY 파서 (할당 없음)
+// 소켓에서 고정 버퍼로 바로 읽고(writeBuffer/commit), 버퍼 안에서 JSON 줄이나 TLV 레코드를 찾아
+// 그 자리에서 파싱합니다.
+// JSON은 QJsonDocument처럼 트리를 만들지 않고 필요한 키(type, payload.co_ppm/obstacle_cm/rollover)만 뽑고
+// 나머지 값은 건너뜁니다. 키 순서, 공백, 모르는 키는 상관없습니다. TLV도 모르는 tag는 건너뜁니다.
+class TelemetryParser
+{
+public:
+    enum Result {
+        Telemetry,      // 센서값 (out에 채움)
+        Ack,            // 명령 ACK (docs/Protocol.md 2.5, ack에 채움)
+        Hello,          // HELLO 응답 (hello에 채움)
+        Other,          // 그 밖의 JSON 줄
+        Invalid,        // 깨진 줄/레코드
+        NeedMore        // next(): 완성된 메시지가 더 없음
+    };
+
+    static const int BUFFER_SIZE = 4096;    // JSON 한 줄이 이보다 길면 그 줄은 버립니다
+
+    // 소켓 read()가 쓸 자리. 쓴 만큼 commit()
+    char *writeBuffer() { return buffer + used; }
+    int writeSpace() const { return BUFFER_SIZE - used; }
+    void commit(int n);
+
+    // 버퍼에서 다음 TELEMETRY(out에 채움), ACK(ack에 채움), HELLO 응답(hello에 채움)을 꺼냅니다.
+    // 다른 줄은 건너뛰고, 없으면 NeedMore
+    Result next(TelemetrySnapshot &out, CommandAck *ack = nullptr, ServerHello *hello = nullptr);
+
+    void reset() { used = 0; start = 0; skipping = false; }
+
+    quint32 badLines() const { return bad; }
+    quint32 overflowLines() const { return overflow; }
+    quint32 binaryRecords() const { return records; }
+
+    // JSON 한 줄 ([begin, end), 줄바꿈 제외) 파싱
+    static Result parseLine(const char *begin, const char *end, TelemetrySnapshot &out, CommandAck *ack = nullptr,
+                            ServerHello *hello = nullptr);
+    // TLV 레코드 body (sync/길이 바이트 제외) 파싱
+    static Result parseRecord(const quint8 *body, int len, TelemetrySnapshot &out);
+
+private:
+    void compact();
+
+    char buffer[BUFFER_SIZE];
+    int used = 0;           // 버퍼에 들어 있는 바이트
+    int start = 0;          // 아직 처리 안 한 줄의 시작
+    bool skipping = false;  // 너무 긴 줄을 다음 '\n'까지 버리는 중
+    quint32 bad = 0;
+    quint32 overflow = 0;
+    quint32 records = 0;
+};
+
+#endif // TELEMETRYPARSER_H
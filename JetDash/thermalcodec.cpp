@@ -0,0 +1,102 @@
+#include "thermalcodec.h"
+#include "thermalstream.h"      // ThermalProtocol::MAX_WIDTH / MAX_HEIGHT
+
+namespace {
+const int BLOCK = 16;
+const quint8 FLAG_KEYFRAME = 0x01;
+const quint8 BLOCK_TEMPORAL = 0x80;
+const quint8 BLOCK_WIDTH_MASK = 0x1f;
+
+// LOCO-I median edge detector (첫 행은 왼쪽, 첫 열은 위 픽셀)
+inline quint16 med(const quint16 *f, int width, int y, int x)
+{
+    if (y == 0) return x ? f[x - 1] : 0;
+    if (x == 0) return f[(y - 1) * width];
+    quint16 a = f[y * width + x - 1];
+    quint16 b = f[(y - 1) * width + x];
+    quint16 c = f[(y - 1) * width + x - 1];
+    quint16 mx = qMax(a, b), mn = qMin(a, b);
+    if (c >= mx) return mn;
+    if (c <= mn) return mx;
+    return quint16(a + b - c);
+}
+
+inline quint16 unzigzag(quint16 z, quint16 pred)
+{
+    return quint16(pred + ((z >> 1) ^ quint16(-(z & 1))));
+}
+
+// w비트 값 16개 (LSB부터 이어 붙임)
+inline const uchar *unpack(const uchar *in, quint16 *z, int w)
+{
+    quint32 acc = 0;
+    quint32 mask = (1u << w) - 1;
+    int bits = 0;
+    for (int i = 0; i < BLOCK; ++i) {
+        while (bits < w) {
+            acc |= quint32(*in++) << bits;
+            bits += 8;
+        }
+        z[i] = quint16(acc & mask);
+        acc >>= w;
+        bits -= w;
+    }
+    return in;
+}
+}
+
+ThermalDecoder::Result ThermalDecoder::decode(const uchar *data, int size, int width, int height,
+                                              QVector<quint16> &pixels)
+{
+    Result r = decodeFrame(data, size, width, height, pixels);
+    if (r == Corrupt) reset();
+    return r;
+}
+
+ThermalDecoder::Result ThermalDecoder::decodeFrame(const uchar *data, int size, int width, int height,
+                                                   QVector<quint16> &pixels)
+{
+    const uchar *p = data;
+    const uchar *end = data + size;
+
+    if (width <= 0 || height <= 0 || width > ThermalProtocol::MAX_WIDTH || height > ThermalProtocol::MAX_HEIGHT)
+        return Corrupt;
+    // 블록마다 헤더 1바이트는 있어야 하므로 payload가 이보다 작으면 볼 필요도 없습니다
+    qint64 count = qint64(width) * height;
+    if (size < 2 + count / BLOCK || data[1] != BLOCK || width % BLOCK != 0) return Corrupt;
+
+    bool keyframe = data[0] & FLAG_KEYFRAME;
+    // 해상도가 바뀌었으면 이전 프레임은 쓸 수 없습니다
+    if (width != prevWidth || height != prevHeight) havePrev = false;
+    if (!keyframe && !havePrev) return NeedKeyframe;
+    p += 2;
+
+    pixels.resize(count);
+    quint16 *f = pixels.data();
+    quint16 z[BLOCK];
+
+    for (int y = 0; y < height; ++y) {
+        for (int x0 = 0; x0 < width; x0 += BLOCK) {
+            if (p >= end) return Corrupt;
+            int w = *p & BLOCK_WIDTH_MASK;
+            bool temporal = *p & BLOCK_TEMPORAL;
+            ++p;
+            if (w > 16 || p + 2 * w > end || (temporal && !havePrev)) return Corrupt;
+            p = unpack(p, z, w);
+
+            // 공간 예측은 방금 복원한 왼쪽 픽셀을 쓰므로 순서대로 복원합니다
+            for (int i = 0; i < BLOCK; ++i) {
+                int x = x0 + i;
+                quint16 pred = temporal ? prev[y * width + x] : med(f, width, y, x);
+                f[y * width + x] = unzigzag(z[i], pred);
+            }
+        }
+    }
+    if (p != end) return Corrupt;
+
+    prev = pixels;
+    prevWidth = width;
+    prevHeight = height;
+    havePrev = true;
+    return Ok;
+}
@@ -0,0 +1,32 @@
+#ifndef THERMALCODEC_H
+#define THERMALCODEC_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// 열화상 프레임 무손실 압축(DELTA_PACK) 복원기
+// 로봇 쪽 robot/jetsonnano/src/thermal_codec.c 의 thermal_decode()와 같은 형식입니다.
+//   payload: [flags 1B][블록 크기 1B] + 블록마다 [헤더 1B][2w 바이트]
+//   블록 헤더 bit0~4: 비트 폭 w, bit7: 시간 예측(이전 프레임), 아니면 공간 예측(MED)
+class ThermalDecoder
+{
+public:
+    enum Result { Ok, NeedKeyframe, Corrupt };
+
+    // data를 복원해서 pixels(width * height)에 채웁니다. ThermalProtocol::MAX_WIDTH/MAX_HEIGHT보다 크면 Corrupt.
+    // Corrupt면 이전 프레임을 버립니다 (다음 keyframe까지 NeedKeyframe, 보낸 쪽이 모르는 프레임에 예측하지 않도록)
+    Result decode(const uchar *data, int size, int width, int height, QVector<quint16> &pixels);
+
+    // 프레임이 빠졌을 때 호출 -> 다음 keyframe까지 기다립니다
+    void reset() { havePrev = false; }
+
+private:
+    Result decodeFrame(const uchar *data, int size, int width, int height, QVector<quint16> &pixels);
+
+    QVector<quint16> prev;      // 직전에 복원한 프레임
+    int prevWidth = 0;
+    int prevHeight = 0;
+    bool havePrev = false;
+};
+
+#endif // THERMALCODEC_H
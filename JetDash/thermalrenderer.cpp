@@ -0,0 +1,155 @@
+#include "thermalrenderer.h"
+
+#include <cstring>
+
+namespace {
+const quint16 VALUE_MASK = ThermalRenderer::LUT_SIZE - 1;
+
+struct ColorStop {
+    double pos;
+    int r, g, b;
+};
+
+// 색 기준점 사이를 선형 보간해서 256색 팔레트를 만듭니다
+void fillPalette(QRgb *out, const ColorStop *stops, int n)
+{
+    for (int i = 0; i < ThermalRenderer::PALETTE_SIZE; ++i) {
+        double t = i / double(ThermalRenderer::PALETTE_SIZE - 1);
+        int k = 0;
+        while (k < n - 2 && t > stops[k + 1].pos) ++k;
+        const ColorStop &a = stops[k], &b = stops[k + 1];
+        double f = qBound(0.0, (t - a.pos) / (b.pos - a.pos), 1.0);
+        out[i] = qRgb(int(a.r + (b.r - a.r) * f + 0.5),
+                      int(a.g + (b.g - a.g) * f + 0.5),
+                      int(a.b + (b.b - a.b) * f + 0.5));
+    }
+}
+
+struct Palettes {
+    QRgb table[ThermalRenderer::PaletteCount][ThermalRenderer::PALETTE_SIZE];
+
+    Palettes()
+    {
+        // 검정 -> 남색 -> 자홍 -> 주황 -> 노랑 -> 흰색 (FLIR ironbow 비슷하게)
+        static const ColorStop ironbow[] = {
+            { 0.00,   0,   0,   0 },
+            { 0.15,  32,   0, 140 },
+            { 0.40, 204,   0, 119 },
+            { 0.65, 255, 110,   0 },
+            { 0.85, 255, 210,   0 },
+            { 1.00, 255, 255, 255 },
+        };
+        // 파랑 -> 하늘 -> 초록 -> 노랑 -> 빨강
+        static const ColorStop rainbow[] = {
+            { 0.00,   0,   0, 255 },
+            { 0.25,   0, 255, 255 },
+            { 0.50,   0, 255,   0 },
+            { 0.75, 255, 255,   0 },
+            { 1.00, 255,   0,   0 },
+        };
+        static const ColorStop grayscale[] = {
+            { 0.00,   0,   0,   0 },
+            { 1.00, 255, 255, 255 },
+        };
+        fillPalette(table[ThermalRenderer::Ironbow], ironbow, int(sizeof(ironbow) / sizeof(ironbow[0])));
+        fillPalette(table[ThermalRenderer::Rainbow], rainbow, int(sizeof(rainbow) / sizeof(rainbow[0])));
+        fillPalette(table[ThermalRenderer::Grayscale], grayscale, 2);
+    }
+};
+
+// 처음 쓸 때 한 번만 만듭니다
+const QRgb *paletteTable(ThermalRenderer::Palette p)
+{
+    static const Palettes palettes;
+    return palettes.table[p];
+}
+}
+
+const char *ThermalRenderer::paletteName(Palette p)
+{
+    switch (p) {
+    case Ironbow: return "Ironbow";
+    case Rainbow: return "Rainbow";
+    case Grayscale: return "Grayscale";
+    default: return "?";
+    }
+}
+
+void ThermalRenderer::setPercentiles(double lowP, double highP)
+{
+    lowPercent = qBound(0.0, lowP, 100.0);
+    highPercent = qBound(lowPercent, highP, 100.0);
+}
+
+// 히스토그램 누적으로 표시 범위(lo~hi)를 찾고 그 범위만 LUT를 다시 채웁니다
+void ThermalRenderer::updateGain(const quint16 *pixels, int count)
+{
+    int mn = LUT_SIZE, mx = -1;
+    for (int i = 0; i < count; ++i) {
+        int v = pixels[i] & VALUE_MASK;
+        hist[v]++;
+        mn = qMin(mn, v);
+        mx = qMax(mx, v);
+    }
+
+    quint32 lowCount = quint32(count * lowPercent / 100.0);
+    quint32 highCount = qMax<quint32>(1, quint32(count * highPercent / 100.0 + 0.5));
+    int lo = mn, hi = mx;
+    quint32 sum = 0;
+    for (int v = mn; v <= mx; ++v) {
+        sum += hist[v];
+        if (sum <= lowCount) lo = v + 1;
+        if (sum >= highCount) { hi = v; break; }
+    }
+    if (mx >= mn) std::memset(hist + mn, 0, sizeof(hist[0]) * (mx - mn + 1));
+    lo = qMin(lo, hi);
+    low = quint16(lo);
+    high = quint16(hi);
+
+    // 픽셀은 그릴 때 lo~hi로 잘라서 찾으므로 LUT는 그 사이만 채우면 됩니다.
+    // 16.16 고정소수점으로 0~255 팔레트 칸에 나눠 담습니다 (hi가 정확히 255가 되도록 올림)
+    const QRgb *colors = paletteTable(pal);
+    quint32 range = quint32(qMax(1, hi - lo));
+    quint32 step = ((quint32(PALETTE_SIZE - 1) << 16) + range - 1) / range;
+    for (int v = lo; v <= hi; ++v)
+        lut[v] = colors[qMin(PALETTE_SIZE - 1, int((quint32(v - lo) * step) >> 16))];
+}
+
+const QImage &ThermalRenderer::render(const quint16 *pixels, int width, int height, int scale)
+{
+    if (width <= 0 || height <= 0) return image;
+    updateGain(pixels, width * height);
+    return colorize(pixels, width, height, scale);
+}
+
+const QImage &ThermalRenderer::colorize(const quint16 *pixels, int width, int height, int scale)
+{
+    scale = qMax(1, scale);
+    if (width <= 0 || height <= 0) return image;
+
+    if (image.width() != width * scale || image.height() != height * scale)
+        image = QImage(width * scale, height * scale, QImage::Format_RGB32);
+    const int lo = low, hi = high;
+
+    uchar *bits = image.bits();
+    qsizetype stride = image.bytesPerLine();
+    size_t rowBytes = size_t(width) * scale * sizeof(QRgb);
+
+    for (int y = 0; y < height; ++y) {
+        const quint16 *src = pixels + y * width;
+        uchar *first = bits + qsizetype(y) * scale * stride;
+        QRgb *dst = reinterpret_cast<QRgb *>(first);
+
+        if (scale == 1) {
+            for (int x = 0; x < width; ++x) dst[x] = lut[qBound(lo, src[x] & VALUE_MASK, hi)];
+        } else {
+            for (int x = 0; x < width; ++x) {
+                QRgb c = lut[qBound(lo, src[x] & VALUE_MASK, hi)];
+                for (int k = 0; k < scale; ++k) *dst++ = c;
+            }
+        }
+        // 세로 방향은 방금 만든 줄을 그대로 복사
+        for (int k = 1; k < scale; ++k) std::memcpy(first + k * stride, first, rowBytes);
+    }
+    return image;
+}
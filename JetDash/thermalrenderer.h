@@ -0,0 +1,56 @@
+#ifndef THERMALRENDERER_H
+#define THERMALRENDERER_H
+
+#include <QImage>
+#include <QtGlobal>
+
+// 열화상 원시값(14bit) -> 컬러 QImage 변환기
+//   1. 히스토그램으로 하위/상위 percentile을 찾아 표시 범위를 정합니다 (자동 게인)
+//      뜨거운 점 몇 개나 죽은 픽셀 때문에 화면 전체가 한 색으로 뭉개지지 않게 합니다.
+//   2. 표시 범위를 256색 팔레트에 나눠 담은 원시값 -> 색 LUT(16384칸)를 채웁니다.
+//      표시 범위 안의 칸만 채우므로 보통 수백 칸이면 끝납니다.
+//   3. 픽셀마다 표시 범위로 자른 뒤 LUT 한 번 찾아서 정수 배율로 키운 이미지에 씁니다.
+// 출력 QImage는 크기가 바뀔 때만 새로 만들고 나머지는 계속 재사용합니다.
+class ThermalRenderer
+{
+public:
+    enum Palette { Ironbow, Rainbow, Grayscale, PaletteCount };
+
+    static const int VALUE_BITS = 14;                   // Lepton 원시값 비트 수
+    static const int LUT_SIZE = 1 << VALUE_BITS;        // 16384
+    static const int PALETTE_SIZE = 256;
+
+    void setPalette(Palette p) { pal = p; }
+    Palette palette() const { return pal; }
+    static const char *paletteName(Palette p);
+
+    // 자동 게인 범위 (기본 1% ~ 99%)
+    void setPercentiles(double low, double high);
+
+    // pixels(width * height)를 scale배 키운 RGB32 이미지로 그립니다 (updateGain + colorize).
+    // 반환한 이미지는 다음 호출 전까지 유효합니다.
+    const QImage &render(const quint16 *pixels, int width, int height, int scale);
+
+    // 표시 범위만 다시 계산 (원본 프레임 기준)
+    void updateGain(const quint16 *pixels, int count);
+    // 마지막 updateGain() 범위로 색만 입힙니다. 업스케일러 출력처럼 픽셀이 많은 이미지는
+    // 원본으로 게인을 구하고 이것만 부르면 히스토그램 비용을 아낄 수 있습니다.
+    const QImage &colorize(const quint16 *pixels, int width, int height, int scale = 1);
+
+    // 마지막 프레임에서 쓴 표시 범위 (원시값)
+    quint16 gainLow() const { return low; }
+    quint16 gainHigh() const { return high; }
+
+private:
+    Palette pal = Ironbow;
+    double lowPercent = 1.0;
+    double highPercent = 99.0;
+    quint16 low = 0;
+    quint16 high = 0;
+
+    QImage image;
+    quint32 hist[LUT_SIZE] = {};    // 쓴 칸만 다시 0으로 돌려놓습니다
+    QRgb lut[LUT_SIZE];             // gainLow() ~ gainHigh() 칸만 유효
+};
+
+#endif // THERMALRENDERER_H
@@ -0,0 +1,99 @@
+#include "thermalstream.h"
+
+#include <QtEndian>
+#include <cstring>
+
+using namespace ThermalProtocol;
+
+void ThermalStreamParser::append(const QByteArray &data)
+{
+    buffer.append(data);
+}
+
+bool ThermalStreamParser::next(ThermalFrame &frame)
+{
+    while (buffer.size() >= HEADER_SIZE) {
+        const uchar *h = reinterpret_cast<const uchar *>(buffer.constData());
+
+        // 헤더가 깨졌으면 다음 magic 위치까지 버리고 다시 맞춥니다
+        if (qFromLittleEndian<quint32>(h) != MAGIC || h[4] != VERSION) {
+            bad++;
+            const char magic[4] = { 'T', 'H', 'R', 'M' };
+            int pos = buffer.indexOf(QByteArray(magic, 4), 1);
+            buffer.remove(0, pos < 0 ? buffer.size() - 3 : pos);
+            continue;
+        }
+
+        int headerSize = qFromLittleEndian<quint16>(h + 6);
+        quint32 payloadSize = qFromLittleEndian<quint32>(h + 28);
+        if (headerSize < HEADER_SIZE || payloadSize > quint32(MAX_PAYLOAD)) {
+            bad++;
+            buffer.remove(0, 4);
+            continue;
+        }
+
+        // 프레임 전체가 아직 안 들어왔으면 다음 readyRead를 기다립니다
+        qsizetype total = headerSize + qsizetype(payloadSize);
+        if (buffer.size() < total) return false;
+
+        bool ok = decodeFrame(buffer.constData(), frame);
+        buffer.remove(0, total);
+        if (ok) return true;
+    }
+    return false;
+}
+
+bool ThermalStreamParser::decodeFrame(const char *msg, ThermalFrame &frame)
+{
+    const uchar *h = reinterpret_cast<const uchar *>(msg);
+    quint8 format = h[5];
+    int headerSize = qFromLittleEndian<quint16>(h + 6);
+    quint32 payloadSize = qFromLittleEndian<quint32>(h + 28);
+
+    frame.seq = qFromLittleEndian<quint32>(h + 8);
+    frame.timestampNs = qFromLittleEndian<quint64>(h + 12);
+    frame.width = qFromLittleEndian<quint16>(h + 20);
+    frame.height = qFromLittleEndian<quint16>(h + 22);
+    frame.minValue = qFromLittleEndian<quint16>(h + 24);
+    frame.maxValue = qFromLittleEndian<quint16>(h + 26);
+
+    // seq로 빠진 프레임 세기. 빠졌으면 압축 복원은 다음 keyframe부터 다시 합니다
+    if (haveSeq && frame.seq != expectedSeq) {
+        if (frame.seq > expectedSeq) lost += frame.seq - expectedSeq;
+        decoder.reset();
+    }
+    expectedSeq = frame.seq + 1;
+    haveSeq = true;
+    payload += payloadSize;
+
+    // 픽셀 버퍼를 잡기 전에 해상도를 확인합니다 (깨진 헤더로 수십 MB를 잡지 않도록).
+    // 버린 프레임 뒤의 시간 예측 프레임은 쓸 수 없으므로 다음 keyframe을 기다립니다
+    if (frame.width <= 0 || frame.height <= 0 || frame.width > MAX_WIDTH || frame.height > MAX_HEIGHT) {
+        bad++;
+        decoder.reset();
+        return false;
+    }
+    qint64 count = qint64(frame.width) * frame.height;
+
+    const uchar *data = reinterpret_cast<const uchar *>(msg + headerSize);
+    if (format == FORMAT_RAW16) {
+        if (qint64(payloadSize) != count * 2) {
+            bad++;
+            return false;
+        }
+        frame.pixels.resize(count);
+        qFromLittleEndian<quint16>(data, count, frame.pixels.data());
+        return true;
+    }
+    if (format == FORMAT_DELTA_PACK) {
+        ThermalDecoder::Result r = decoder.decode(data, int(payloadSize), frame.width, frame.height, frame.pixels);
+        if (r == ThermalDecoder::Corrupt) {
+            // 깨진 프레임 뒤의 시간 예측 프레임은 다음 keyframe까지 버립니다
+            bad++;
+            decoder.reset();
+        }
+        return r == ThermalDecoder::Ok;
+    }
+    bad++;
+    return false;
+}
@@ -0,0 +1,61 @@
+#ifndef THERMALSTREAM_H
+#define THERMALSTREAM_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+#include "thermalcodec.h"
+
+// 열화상 프레임 바이너리 스트림 (docs/Protocol.md 3장)
+// 로봇 쪽 robot/jetsonnano/include/network.h 와 값이 같아야 합니다.
+namespace ThermalProtocol {
+const quint32 MAGIC = 0x4D524854;   // "THRM"
+const quint8 VERSION = 1;
+const int HEADER_SIZE = 32;
+const quint8 FORMAT_RAW16 = 0;
+const quint8 FORMAT_DELTA_PACK = 1;    // 무손실 압축 (thermalcodec.h)
+const int MAX_PAYLOAD = 1 << 20;    // 이보다 크면 깨진 헤더로 봅니다
+const int MAX_WIDTH = 160;          // Lepton 3.x. 이보다 큰 해상도도 깨진 헤더로 봅니다
+const int MAX_HEIGHT = 120;
+}
+
+// 프레임 하나 (픽셀은 행 순서, 센서 원시값)
+struct ThermalFrame {
+    quint32 seq = 0;
+    quint64 timestampNs = 0;        // 로봇 쪽 캡처 시각 (로봇 시계)
+    int width = 0;
+    int height = 0;
+    quint16 minValue = 0;
+    quint16 maxValue = 0;
+    QVector<quint16> pixels;
+};
+
+// TCP로 들어온 바이트를 모아서 프레임 단위로 잘라주는 파서
+// (datagram 하나가 프레임 하나인 UDP도 같은 함수로 처리할 수 있습니다)
+class ThermalStreamParser
+{
+public:
+    // 받은 바이트 추가
+    void append(const QByteArray &data);
+
+    // 완성된 프레임이 있으면 frame에 채우고 true
+    bool next(ThermalFrame &frame);
+
+    quint32 lostFrames() const { return lost; }
+    quint32 badHeaders() const { return bad; }
+    quint64 payloadBytes() const { return payload; }     // 받은 payload 합계 (압축률 표시용)
+
+private:
+    bool decodeFrame(const char *msg, ThermalFrame &frame);
+
+    QByteArray buffer;
+    ThermalDecoder decoder;
+    quint64 payload = 0;
+    quint32 expectedSeq = 0;
+    bool haveSeq = false;
+    quint32 lost = 0;
+    quint32 bad = 0;
+};
+
+#endif // THERMALSTREAM_H
@@ -0,0 +1,225 @@
+#include "thermalupscaler.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define THERMAL_UPSCALE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define THERMAL_UPSCALE_NEON 1
+#endif
+
+namespace {
+const int WEIGHT_BITS = 14;
+const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+const int WEIGHT_ROUND = 1 << (WEIGHT_BITS - 1);
+const int VALUE_MAX = 0x3fff;               // Lepton 원시값 14bit
+
+// Keys cubic (a = -0.5, Catmull-Rom). 원본 픽셀 위치에서는 그 값을 그대로 지납니다
+double cubic(double t)
+{
+    const double a = -0.5;
+    t = std::fabs(t);
+    if (t <= 1.0) return ((a + 2) * t - (a + 3)) * t * t + 1;
+    if (t < 2.0) return ((a * t - 5 * a) * t + 8 * a) * t - 4 * a;
+    return 0.0;
+}
+
+// 출력 한 줄: out[x] = clamp(sum(w[k] * r[k][x]) >> 14)
+void blendRowScalar(quint16 *dst, const qint16 *const *r, const qint16 *w, int taps, int n)
+{
+    for (int x = 0; x < n; ++x) {
+        int acc = WEIGHT_ROUND;
+        for (int k = 0; k < taps; ++k) acc += w[k] * r[k][x];
+        dst[x] = quint16(qBound(0, acc >> WEIGHT_BITS, VALUE_MAX));
+    }
+}
+
+// 가로 한 줄. 탭 수를 컴파일 시점에 정해야 안쪽 루프가 풀립니다
+template <int TAPS, typename Tap>
+void interpolateRow(qint16 *dst, const quint16 *src, const Tap *taps, int n)
+{
+    for (int x = 0; x < n; ++x) {
+        const Tap &t = taps[x];
+        int acc = WEIGHT_ROUND;
+        for (int k = 0; k < TAPS; ++k) acc += t.weight[k] * (src[t.index[k]] & VALUE_MAX);
+        dst[x] = qint16(acc >> WEIGHT_BITS);
+    }
+}
+
+#if defined(THERMAL_UPSCALE_SSE2)
+// 두 줄을 16bit씩 번갈아 놓고 pmaddwd 한 번에 w0*a + w1*b (32bit 8개)
+inline void madd2(__m128i &lo, __m128i &hi, const qint16 *a, const qint16 *b, __m128i w)
+{
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), w));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(va, vb), w));
+}
+
+inline __m128i weightPair(qint16 w0, qint16 w1)
+{
+    return _mm_set1_epi32(int((quint32(quint16(w1)) << 16) | quint16(w0)));
+}
+
+void blendRowSimd(quint16 *dst, const qint16 *const *r, const qint16 *w, int taps, int n)
+{
+    const __m128i w01 = weightPair(w[0], w[1]);
+    const __m128i w23 = weightPair(w[2], w[3]);
+    const __m128i round = _mm_set1_epi32(WEIGHT_ROUND);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vmax = _mm_set1_epi16(VALUE_MAX);
+    int x = 0;
+
+    for (; x + 8 <= n; x += 8) {
+        __m128i lo = round, hi = round;
+        madd2(lo, hi, r[0] + x, r[1] + x, w01);
+        if (taps == 4) madd2(lo, hi, r[2] + x, r[3] + x, w23);
+        __m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, WEIGHT_BITS), _mm_srai_epi32(hi, WEIGHT_BITS));
+        v = _mm_min_epi16(_mm_max_epi16(v, zero), vmax);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), v);
+    }
+    if (x < n) {
+        const qint16 *tail[4] = { r[0] + x, r[1] + x, r[2] + x, r[3] + x };
+        blendRowScalar(dst + x, tail, w, taps, n - x);
+    }
+}
+#elif defined(THERMAL_UPSCALE_NEON)
+void blendRowSimd(quint16 *dst, const qint16 *const *r, const qint16 *w, int taps, int n)
+{
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t vmax = vdupq_n_s16(VALUE_MAX);
+    int x = 0;
+
+    for (; x + 8 <= n; x += 8) {
+        int16x8_t a = vld1q_s16(r[0] + x);
+        int32x4_t lo = vmull_n_s16(vget_low_s16(a), w[0]);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(a), w[0]);
+        for (int k = 1; k < taps; ++k) {
+            int16x8_t b = vld1q_s16(r[k] + x);
+            lo = vmlal_n_s16(lo, vget_low_s16(b), w[k]);
+            hi = vmlal_n_s16(hi, vget_high_s16(b), w[k]);
+        }
+        int16x8_t v = vcombine_s16(vqrshrn_n_s32(lo, WEIGHT_BITS), vqrshrn_n_s32(hi, WEIGHT_BITS));
+        v = vminq_s16(vmaxq_s16(v, zero), vmax);
+        vst1q_u16(dst + x, vreinterpretq_u16_s16(v));
+    }
+    if (x < n) {
+        const qint16 *tail[4] = { r[0] + x, r[1] + x, r[2] + x, r[3] + x };
+        blendRowScalar(dst + x, tail, w, taps, n - x);
+    }
+}
+#endif
+}
+
+bool ThermalUpscaler::simdAvailable()
+{
+#if defined(THERMAL_UPSCALE_SSE2) || defined(THERMAL_UPSCALE_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *ThermalUpscaler::modeName(Mode m)
+{
+    switch (m) {
+    case Nearest: return "Nearest";
+    case Bilinear: return "Bilinear";
+    case Bicubic: return "Bicubic";
+    default: return "?";
+    }
+}
+
+void ThermalUpscaler::setMode(Mode m)
+{
+    if (m != interp) dirty = true;
+    interp = m;
+}
+
+// 출력 좌표 d의 중심을 원본 좌표로 옮긴 뒤 (픽셀 중심 기준) 주변 원본 픽셀과 가중치를 구합니다
+void ThermalUpscaler::computeTaps(QVector<Tap> &taps, int srcSize, int dstSize) const
+{
+    taps.resize(dstSize);
+    for (int d = 0; d < dstSize; ++d) {
+        Tap &t = taps[d];
+        double s = (d + 0.5) * srcSize / dstSize - 0.5;
+        int i0 = int(std::floor(s));
+        double f = s - i0;
+
+        for (int k = 0; k < 4; ++k) {
+            t.index[k] = 0;
+            t.weight[k] = 0;
+        }
+        if (interp == Nearest) {
+            t.index[0] = t.index[1] = qMin(srcSize - 1, d * srcSize / dstSize);
+            t.weight[0] = WEIGHT_ONE;
+        } else if (interp == Bilinear) {
+            t.index[0] = qBound(0, i0, srcSize - 1);
+            t.index[1] = qBound(0, i0 + 1, srcSize - 1);
+            t.weight[1] = qint16(std::lround(f * WEIGHT_ONE));
+            t.weight[0] = qint16(WEIGHT_ONE - t.weight[1]);
+        } else {
+            int sum = 0;
+            for (int k = 0; k < 4; ++k) {
+                t.index[k] = qBound(0, i0 - 1 + k, srcSize - 1);
+                if (k == 1) continue;
+                t.weight[k] = qint16(std::lround(cubic(f + 1 - k) * WEIGHT_ONE));
+                sum += t.weight[k];
+            }
+            // 반올림 오차는 가장 가까운 픽셀 가중치로 맞춰서 합을 정확히 1로
+            t.weight[1] = qint16(WEIGHT_ONE - sum);
+        }
+    }
+}
+
+void ThermalUpscaler::prepare(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    if (!dirty && srcWidth == sw && srcHeight == sh && dstWidth == dw && dstHeight == dh) return;
+    sw = srcWidth;
+    sh = srcHeight;
+    dw = dstWidth;
+    dh = dstHeight;
+    computeTaps(xTaps, sw, dw);
+    computeTaps(yTaps, sh, dh);
+    rows.resize(sh * dw);
+    out.resize(dw * dh);
+    dirty = false;
+}
+
+const quint16 *ThermalUpscaler::process(const quint16 *src, int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) return nullptr;
+    prepare(srcWidth, srcHeight, dstWidth, dstHeight);
+
+    const int taps = tapCount();
+    const Tap *xt = xTaps.constData();
+    const Tap *yt = yTaps.constData();
+
+    // 1. 가로: 원본 행마다 (bicubic은 살짝 넘칠 수 있어서 int16으로 둡니다)
+    for (int y = 0; y < sh; ++y) {
+        const quint16 *s = src + y * sw;
+        qint16 *d = rows.data() + y * dw;
+        if (taps == 4)
+            interpolateRow<4>(d, s, xt, dw);
+        else
+            interpolateRow<2>(d, s, xt, dw);
+    }
+
+    // 2. 세로: 출력 행마다 가로 결과 몇 줄을 섞습니다
+    for (int y = 0; y < dh; ++y) {
+        const Tap &t = yt[y];
+        const qint16 *r[4];
+        for (int k = 0; k < 4; ++k) r[k] = rows.constData() + t.index[k] * dw;
+        quint16 *d = out.data() + y * dw;
+#if defined(THERMAL_UPSCALE_SSE2) || defined(THERMAL_UPSCALE_NEON)
+        if (simd) {
+            blendRowSimd(d, r, t.weight, taps, dw);
+            continue;
+        }
+#endif
+        blendRowScalar(d, r, t.weight, taps, dw);
+    }
+    return out.constData();
+}
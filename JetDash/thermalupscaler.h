@@ -0,0 +1,48 @@
+#ifndef THERMALUPSCALER_H
+#define THERMALUPSCALER_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// 열화상 원시값(14bit)을 컬러맵 전에 키우는 업스케일러
+// 색이 아니라 온도 값 사이를 보간하므로 팔레트 경계에 엉뚱한 중간색이 생기지 않습니다.
+//   1. 가로: 원본 행마다 출력 폭으로 보간해서 임시 버퍼(int16)에 둡니다 (srcH x dstW)
+//   2. 세로: 출력 행마다 임시 버퍼 2줄(bilinear) 또는 4줄(bicubic)을 섞습니다 -> SIMD
+// 가로/세로 좌표와 가중치(Q14)는 크기가 바뀔 때만 다시 계산하고, 출력 버퍼도 계속 재사용합니다.
+class ThermalUpscaler
+{
+public:
+    enum Mode { Nearest, Bilinear, Bicubic, ModeCount };
+
+    void setMode(Mode m);
+    Mode mode() const { return interp; }
+    static const char *modeName(Mode m);
+
+    // SSE2 / NEON 경로가 빌드에 들어 있는지. 끄면 같은 결과를 스칼라로 계산합니다 (벤치마크 비교용)
+    static bool simdAvailable();
+    void setSimdEnabled(bool on) { simd = on && simdAvailable(); }
+
+    // src(srcWidth * srcHeight)를 dstWidth * dstHeight로 키운 결과. 다음 호출 전까지 유효합니다.
+    const quint16 *process(const quint16 *src, int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+
+private:
+    struct Tap {
+        int index[4];       // 원본 좌표 (가장자리는 복제)
+        qint16 weight[4];   // Q14, 합이 16384
+    };
+
+    void prepare(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    void computeTaps(QVector<Tap> &taps, int srcSize, int dstSize) const;
+    int tapCount() const { return interp == Bicubic ? 4 : 2; }
+
+    Mode interp = Bicubic;
+    bool simd = simdAvailable();
+
+    int sw = 0, sh = 0, dw = 0, dh = 0;
+    bool dirty = true;
+    QVector<Tap> xTaps, yTaps;
+    QVector<qint16> rows;       // 가로 보간 결과 (sh x dw)
+    QVector<quint16> out;       // dw x dh
+};
+
+#endif // THERMALUPSCALER_H
@@ -0,0 +1,73 @@
+#include "thermalworker.h"
+
+#include <QElapsedTimer>
+
+ThermalWorker::ThermalWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ThermalWorker::setTargetSize(const QSize &size)
+{
+    targetWidth.store(size.width(), std::memory_order_relaxed);
+    targetHeight.store(size.height(), std::memory_order_relaxed);
+}
+
+// 들어온 만큼 파서에 넣고 완성된 프레임 중 마지막 것만 그립니다
+void ThermalWorker::appendData(const QByteArray &data)
+{
+    parser.append(data);
+
+    bool got = false;
+    while (parser.next(frame)) {
+        decoded.fetch_add(1, std::memory_order_relaxed);
+        got = true;
+    }
+    if (!got) return;
+    haveFrame = true;
+
+    // GUI가 앞 프레임을 아직 안 붙였으면 이번 것은 건너뜁니다
+    if (pending.load(std::memory_order_acquire)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    render();
+}
+
+void ThermalWorker::redraw()
+{
+    if (haveFrame && !pending.load(std::memory_order_acquire)) render();
+}
+
+void ThermalWorker::reset()
+{
+    parser = ThermalStreamParser();
+    haveFrame = false;
+}
+
+// 원시값을 라벨 크기(비율 유지)로 먼저 보간한 뒤 자동 게인 + 컬러맵으로 그립니다.
+// 게인은 원본 프레임으로 구하고, 업스케일러/렌더러 버퍼는 라벨 크기가 바뀔 때만 다시 잡습니다.
+void ThermalWorker::render()
+{
+    if (frame.width <= 0 || frame.height <= 0) return;
+    QElapsedTimer timer;
+    timer.start();
+
+    QSize target(targetWidth.load(std::memory_order_relaxed), targetHeight.load(std::memory_order_relaxed));
+    QSize fit = QSize(frame.width, frame.height).scaled(target, Qt::KeepAspectRatio);
+    if (fit.width() < frame.width || fit.height() < frame.height) fit = QSize(frame.width, frame.height);
+
+    upscaler.setMode(ThermalUpscaler::Mode(mode.load(std::memory_order_relaxed)));
+    renderer.setPalette(ThermalRenderer::Palette(palette.load(std::memory_order_relaxed)));
+
+    const quint16 *pixels = upscaler.process(frame.pixels.constData(), frame.width, frame.height,
+                                             fit.width(), fit.height());
+    renderer.updateGain(frame.pixels.constData(), frame.width * frame.height);
+    const QImage &image = renderer.colorize(pixels, fit.width(), fit.height());
+    renderNs.store(timer.nsecsElapsed(), std::memory_order_relaxed);
+
+    // queued signal이 QImage를 공유 복사로 넘깁니다. GUI가 다 쓰기 전에 다음 프레임을 그리게 되면
+    // Qt가 알아서 새 버퍼로 떼어내므로(detach) 화면이 깨지지는 않습니다.
+    pending.store(true, std::memory_order_release);
+    emit frameReady(image, frame.seq);
+}
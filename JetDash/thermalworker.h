@@ -0,0 +1,65 @@
+#ifndef THERMALWORKER_H
+#define THERMALWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <atomic>
+
+#include "thermalstream.h"
+#include "thermalupscaler.h"
+#include "thermalrenderer.h"
+
+// 디코드 스레드에서 도는 열화상 처리 담당
+//   스트림 바이트 -> 프레임 파싱/복원 -> 라벨 크기로 보간 -> 컬러맵 -> frameReady(QImage)
+// GUI는 받은 이미지를 붙이기만 하고 frameConsumed()를 부릅니다.
+// GUI가 아직 앞 프레임을 못 그렸으면 새 프레임은 그리지 않고 버립니다 (최신 프레임만 표시).
+// 설정값(set*)과 frameConsumed()는 atomic이라 GUI 스레드에서 바로 불러도 됩니다.
+class ThermalWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThermalWorker(QObject *parent = nullptr);
+
+    void setTargetSize(const QSize &size);
+    void setPalette(ThermalRenderer::Palette p) { palette.store(p, std::memory_order_relaxed); }
+    void setMode(ThermalUpscaler::Mode m) { mode.store(m, std::memory_order_relaxed); }
+    void frameConsumed() { pending.store(false, std::memory_order_release); }
+
+    // 통계 (아무 스레드에서나 읽기)
+    quint32 framesDecoded() const { return decoded.load(std::memory_order_relaxed); }
+    quint32 framesDropped() const { return dropped.load(std::memory_order_relaxed); }
+    qint64 lastRenderNs() const { return renderNs.load(std::memory_order_relaxed); }
+
+public slots:
+    void appendData(const QByteArray &data);
+    void redraw();      // 설정을 바꾼 뒤 마지막 프레임을 다시 그리기
+    void reset();       // 연결이 끊겼을 때: 반쯤 받은 프레임과 복원 상태를 버립니다
+
+signals:
+    // image는 다음 frameConsumed() 전까지 다시 쓰지 않습니다
+    void frameReady(const QImage &image, quint32 seq);
+
+private:
+    void render();
+
+    ThermalStreamParser parser;
+    ThermalFrame frame;         // 수신 버퍼 재사용
+    bool haveFrame = false;
+    ThermalUpscaler upscaler;
+    ThermalRenderer renderer;
+
+    std::atomic<int> targetWidth{0};
+    std::atomic<int> targetHeight{0};
+    std::atomic<int> palette{ThermalRenderer::Ironbow};
+    std::atomic<int> mode{ThermalUpscaler::Bicubic};
+    std::atomic<bool> pending{false};
+
+    std::atomic<quint32> decoded{0};
+    std::atomic<quint32> dropped{0};
+    std::atomic<qint64> renderNs{0};
+};
+
+#endif // THERMALWORKER_H
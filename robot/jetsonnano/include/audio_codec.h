@@ -0,0 +1,66 @@
+#ifndef AUDIO_CODEC_H
+#define AUDIO_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 음성 UDP 패킷 (docs/Protocol.md 4장, JetDash audiocodec.h와 맞춰야 함)
+ *
+ * HELLO로 협상한 클라이언트는 로봇 재생 주파수(AUDIO_RATE)로 리샘플해서 10/20ms 프레임마다 패킷 하나를 보낸다.
+ * 반대 방향(로봇 마이크 -> 운영자, "listen")도 같은 형식이다.
+ *   [0] 0xA0 | codec  [1] flags  [2..3] 샘플 수  [4..5] seq  [6..7] delay  [8..11] timestamp  [12..] codec별 데이터
+ *   seq:       패킷마다 1씩 (uint16, 한 바퀴 돌면 0부터)
+ *   delay:     송신 측에서 잰 첫 샘플 캡처 -> 전송 시간 (0.1ms 단위, 0: 재지 않음). 지연 예산 표시용
+ *   timestamp: 첫 샘플의 번호 (uint32, 재생 주파수 기준 샘플 단위). RTP처럼 seq로 순서/손실을, timestamp로 재생 위치를 안다
+ *   PCM16:     샘플 수 * 2바이트
+ *   IMA ADPCM: [12..13] 블록 시작 predictor (int16)  [14] step index  [15] 0  [16..] 샘플당 4bit (아래 nibble 먼저)
+ *   flags 0x01 (CN): 말이 없는 구간. 데이터 대신 [12] 잡음 크기 (-dBFS, RFC 3389처럼 0~127) 1바이트이고,
+ *              받는 쪽은 샘플 수만큼 그 크기의 백색 잡음(컴포트 노이즈)을 만든다. 보내는 쪽은 조용한 프레임을
+ *              보내지 않고 최대 100ms마다 CN 패킷 하나만 보낸다 (HELLO 응답에 "audio_cn": true인 로봇에게만)
+ * 여러 바이트 값은 전부 little-endian.
+ * ADPCM 상태가 패킷마다 들어 있으므로 패킷이 빠져도 다음 패킷은 그대로 복원된다.
+ * 협상하지 않은 예전 클라이언트는 헤더 없는 PCM16을 보낸다.
+ */
+#define AUDIO_RATE 8000                 // aplay 재생 주파수 (HELLO 응답의 audio_rate)
+#define AUDIO_PACKET_MAGIC 0xA0
+#define AUDIO_PACKET_MAGIC_MASK 0xF0
+#define AUDIO_PACKET_HEADER 12
+#define AUDIO_ADPCM_HEADER 4
+#define AUDIO_PACKET_MAX_SAMPLES 2048   // 디코드 결과(4096바이트)를 파이프에 한 번에(PIPE_BUF) 쓸 수 있도록
+#define AUDIO_FLAG_CN 0x01              // 컴포트 노이즈 패킷
+#define AUDIO_CN_MAX_LEVEL 127
+
+#define AUDIO_CODEC_RAW -1              // 헤더 없는 PCM16 (협상 전)
+#define AUDIO_CODEC_PCM16 0
+#define AUDIO_CODEC_IMA_ADPCM 1
+
+typedef struct {
+    int codec;              // AUDIO_CODEC_*
+    uint8_t flags;          // AUDIO_FLAG_*
+    uint16_t seq;
+    uint32_t timestamp;     // 첫 샘플 번호
+    uint16_t delay;         // 첫 샘플 캡처 -> 전송 (0.1ms 단위, 0: 모름)
+} AudioPacketHeader;
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;          // step table 위치 (0~88)
+} ImaAdpcmState;
+
+// n개 샘플 <-> (n+1)/2바이트. state는 다음 블록으로 이어진다.
+void ima_adpcm_encode(ImaAdpcmState *state, const int16_t *pcm, size_t n, uint8_t *out);
+void ima_adpcm_decode(ImaAdpcmState *state, const uint8_t *in, size_t n, int16_t *pcm);
+
+// 패킷 하나를 만든다 (로봇 -> 운영자 방향, 테스트). 쓴 바이트 수, n이 너무 크면 0
+// h->codec이 AUDIO_CODEC_RAW면 헤더 없이 PCM16만 쓴다
+size_t audio_packet_encode(const AudioPacketHeader *h, ImaAdpcmState *state, const int16_t *pcm, size_t n, uint8_t *out);
+// 패킷 -> 헤더(h, NULL 가능)와 PCM. 샘플 수, 헤더가 맞지 않거나 잘린 패킷이면 -1
+int audio_packet_decode(const uint8_t *packet, size_t len, AudioPacketHeader *h, int16_t *pcm, size_t capacity);
+// CN 패킷 (n: 잡음으로 채울 샘플 수, level: -dBFS). h->flags는 무시하고 AUDIO_FLAG_CN을 쓴다. 쓴 바이트 수
+size_t audio_packet_encode_cn(const AudioPacketHeader *h, size_t n, uint8_t level, uint8_t *out);
+
+// AUDIO_CODEC_* -> HELLO에 쓰는 이름 ("ADPCM" / "PCM" / "RAW")
+const char *audio_codec_name(int codec);
+
+#endif
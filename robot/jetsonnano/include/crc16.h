@@ -0,0 +1,32 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-16/CCITT (x^16 + x^12 + x^5 + 1), 초기값 0, 비반사(MSB first). VoSPI 패킷 CRC와 같다.
+
+#define CRC16_IMPL_BITWISE 0    // 비트 단위 (기준 구현)
+#define CRC16_IMPL_TABLE   1    // slice-by-8 룩업 테이블
+#define CRC16_IMPL_CLMUL   2    // carry-less multiply 폴딩 (x86 PCLMUL / ARMv8 PMULL)
+
+// 테이블/상수 초기화 및 사용할 구현 선택. 다른 함수보다 먼저 한 번 호출한다.
+// 가속 경로는 CPU가 지원하고 자체 검증을 통과할 때만 사용한다.
+void crc16_init(void);
+
+// 현재 선택된 구현 (CRC16_IMPL_*)
+int crc16_active_impl(void);
+// impl을 사용할 수 있으면 1
+int crc16_impl_available(int impl);
+
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_ccitt_bitwise(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_ccitt_table(uint16_t crc, const uint8_t *data, size_t len);
+
+// VoSPI 패킷(164바이트)의 CRC 계산: ID의 상위 4bit와 CRC 필드를 0으로 보고 전체 패킷에 대해 계산한다.
+uint16_t crc16_vospi(const uint8_t *packet, int impl);
+
+// 패킷에 실린 CRC와 계산값이 같으면 1, 다르면 0 (선택된 구현 사용)
+int crc16_vospi_check(const uint8_t *packet);
+
+#endif
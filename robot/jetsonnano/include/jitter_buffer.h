@@ -0,0 +1,104 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "audio_codec.h"
+#include "latency_hist.h"
+
+/*
+ * 음성 지터 버퍼 (docs/Protocol.md 4.4)
+ *
+ * 패킷 헤더의 timestamp 자리에 디코드한 샘플을 넣어 두고(순서가 바뀌어 와도 제자리로),
+ * 재생 시계(CLOCK_MONOTONIC)에 맞춰 get()이 부를 때까지 지난 만큼 꺼낸다.
+ *   - 재생 시점이 지나서 온 패킷은 버린다 (late)
+ *   - 빈 자리는 직전 출력의 피치 주기를 반복해서 채우고(PLC), 10ms 뒤부터 줄여서 60ms면 무음
+ *   - 목표 지연: 패킷이 버퍼에서 기다린 시간의 최솟값(1초 창)이 여유분(5ms + 도착 지터)이 되도록
+ *     늦은 패킷이 오면 바로 늘리고(PLC로 샘플을 끼워 넣음), 남으면 절반씩 줄인다(짧게 cross-fade하며 건너뜀).
+ *   - CN 패킷(말 없는 구간)은 디코더가 만든 컴포트 노이즈를 빈 자리에만 넣는다. 손실/보정으로 세지 않는다
+ * 패킷 처리와 get()은 같은 thread (ControlServer epoll loop)에서 부른다.
+ */
+#define JITTER_RING 8192                // 재생 대기 샘플 (2의 거듭제곱, 8kHz면 1초)
+#define JITTER_HISTORY 2048             // PLC 피치 탐색용 최근 출력
+#define JITTER_TICK_MS 10               // get() 주기 (ControlServer playout timer)
+#define JITTER_START_MS 40              // 첫 패킷 -> 재생 시작
+#define JITTER_MARGIN_MS 5              // 가장 늦게 온 패킷도 이만큼은 기다리도록
+#define JITTER_MAX_DELAY_MS 300
+#define JITTER_WINDOW_MS 1000           // 지연을 줄일지 보는 창
+#define JITTER_PLC_HOLD_MS 10           // 손실 보정: 이 동안은 그대로 반복
+#define JITTER_PLC_FADE_MS 60           // 여기까지 줄여서 무음
+#define JITTER_IDLE_MS 500              // 패킷이 이만큼 안 오면 스트림 끝
+
+typedef struct {
+    unsigned long packets;          // 받은 패킷 (중복 제외, late 포함)
+    unsigned long late;             // 재생 시점이 지나서 버린 패킷
+    unsigned long duplicates;
+    unsigned long lost;             // seq 기준 끝내 안 온 패킷 (stats 갱신 시점까지)
+    unsigned long concealed;        // 빈 자리를 PLC로 채운 샘플
+    unsigned long inserted;         // 지연을 늘리려고 끼워 넣은 샘플
+    unsigned long skipped;          // 지연을 줄이려고 건너뛴 샘플
+    unsigned long comfort;          // CN 패킷으로 받은 샘플 (보내는 쪽이 조용해서 안 보낸 구간)
+    unsigned long played;           // 재생한 샘플 (PLC 포함)
+    unsigned long restarts;         // timestamp가 크게 튀어서 다시 시작한 횟수
+    double jitter_ms;               // 도착 지터 (RFC 3550 평균 편차)
+    double margin_ms;               // 목표 최소 대기 시간
+    LatencyHist wait;               // 패킷 도착 -> 첫 샘플 재생 (버퍼에서 기다린 시간)
+} JitterStats;
+
+typedef struct {
+    int rate;
+    int started;
+    uint64_t start_ns;              // 재생 시계 0
+    uint64_t emitted;               // start_ns 이후 내보낸 샘플
+    uint32_t play_ts;               // 다음에 재생할 샘플의 timestamp
+    uint32_t end_ts;                // 받은 샘플 중 가장 뒤 + 1
+    int32_t adjust;                 // 앞으로 끼워 넣을(+) / 건너뛸(-) 샘플
+    uint64_t last_arrival_ns;
+
+    int16_t ring[JITTER_RING];
+    uint8_t valid[JITTER_RING];
+
+    // 손실 보정
+    int16_t history[JITTER_HISTORY];
+    unsigned int history_pos;
+    int16_t period[JITTER_HISTORY / 2];     // 반복할 피치 주기 한 개
+    int pitch;
+    int plc_run;                    // 지금 이어지는 보정 샘플 수 (0: 보정 중 아님)
+    int fade;                       // 보정 -> 실제 샘플 cross-fade 남은 샘플
+    int skip;                       // 건너뛰는 중인 샘플 수 (cross-fade가 끝나면 play_ts를 이만큼 더 민다)
+    int skip_pos;                   // 건너뛰기 cross-fade 진행
+
+    // 지연 추정
+    uint64_t prev_arrival_ns;       // 직전 패킷 도착 시각과 timestamp (RFC 3550 지터)
+    uint32_t prev_ts;
+    double jitter;                  // 샘플 단위
+    int32_t window_min;             // 창 안의 최소 대기 (샘플)
+    uint64_t window_start_ns;
+
+    // seq
+    uint16_t max_seq;
+    uint32_t seq_cycles;            // max_seq가 한 바퀴 돌 때마다 65536
+    uint32_t base_seq;
+    uint64_t seen;                  // max_seq부터 거꾸로 64개 받았는지 (중복 검사)
+    unsigned long expected_before;  // 다시 시작하기 전 구간에서 받았어야 할 패킷 수
+
+    JitterStats stats;
+} JitterBuffer;
+
+void jitter_buffer_init(JitterBuffer *jb, int rate);
+// 재생 상태와 통계를 비운다 (다음 패킷부터 새 스트림)
+void jitter_buffer_reset(JitterBuffer *jb);
+
+// 패킷 하나 (audio_codec.h 형식). 0: 넣음, 1: 늦었거나 중복이라 버림, -1: 깨진 패킷
+int jitter_buffer_put(JitterBuffer *jb, const uint8_t *packet, size_t len, uint64_t now_ns);
+// now_ns까지 재생할 샘플을 pcm에 꺼낸다 (최대 capacity개, 남으면 다음 호출에서). 샘플 수
+size_t jitter_buffer_get(JitterBuffer *jb, uint64_t now_ns, int16_t *pcm, size_t capacity);
+// 재생 중인지. JITTER_IDLE_MS 동안 패킷이 없으면 get()이 재생을 멈춘다 (통계는 reset()까지 남음)
+int jitter_buffer_active(const JitterBuffer *jb);
+
+// stats.lost / jitter_ms / margin_ms를 지금 값으로 채운다
+const JitterStats *jitter_buffer_stats(JitterBuffer *jb);
+void jitter_buffer_print_stats(JitterBuffer *jb, const char *name);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+// 지연 시간 히스토그램 (log-linear: 1us 단위, 2의 거듭제곱 구간마다 4칸)
+#define LATENCY_HIST_SUB 4
+#define LATENCY_HIST_BUCKETS (40 * LATENCY_HIST_SUB)
+
+typedef struct {
+    uint64_t buckets[LATENCY_HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} LatencyHist;
+
+uint64_t latency_now_ns(void);      // CLOCK_MONOTONIC
+
+void latency_hist_reset(LatencyHist *h);
+void latency_hist_add(LatencyHist *h, uint64_t ns);
+// p(0~100) 백분위 값 (ns, 해당 구간의 상한)
+uint64_t latency_hist_percentile(const LatencyHist *h, double p);
+// "name: n=.. avg=.. p50=.. p90=.. p99=.. max=.." 한 줄 출력
+void latency_hist_print(const LatencyHist *h, const char *name);
+
+#endif
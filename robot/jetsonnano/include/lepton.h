@@ -15,25 +15,79 @@
 
 #include <stdint.h>
 
+#include "lepton_transport.h"
+
+// 센서 종류: 기본은 Lepton 2.5 (80x60). Lepton 3.x (160x120)는 -DLEPTON_VERSION=3 으로 빌드한다.
+#ifndef LEPTON_VERSION
+#define LEPTON_VERSION 2
+#endif
+
 #define VOSPI_FRAME_SIZE (164)
-#define MAX_LOOP_COUNT (1000000000)
+#define VOSPI_PACKET_PIXELS (80)            // 패킷 하나에 담기는 픽셀 수
+#define VOSPI_SEGMENT_PACKETS (60)          // 세그먼트 하나의 패킷 수 (패킷 ID 0~59)
+#define VOSPI_SEGMENT_ID_PACKET (20)        // Lepton 3.x: 세그먼트 번호(TTT)가 실리는 패킷
+
+// lepton_capture() 한 번이 돌려받는 최대 시간. 넘기면 resync 후 0을 반환한다.
+#define LEPTON_CAPTURE_TIMEOUT_NS (250000000ULL)
+// 프레임을 완성하지 못한 채 동기가 이만큼 연속으로 깨지면 resync (/CS >185ms deassert) 한다.
+#define LEPTON_MAX_SYNC_ERRORS (8)
+// pacing 중 batch 전체가 discard 패킷이면 이만큼 쉬었다가 다시 읽는다.
+#define LEPTON_DISCARD_BACKOFF_NS (1000000ULL)
+
+// 한 번의 SPI 전송으로 읽는 VoSPI 패킷 수.
+// spidev의 기본 bufsiz(4096)를 넘지 않도록 기본값은 20패킷(3280바이트)으로 둔다.
+// 한 프레임(60패킷)을 한 번에 읽으려면 spidev.bufsiz=16384 이상으로 부팅해야 한다.
+#define LEPTON_DEFAULT_BATCH_PACKETS (20)
+#define LEPTON_MAX_BATCH_PACKETS (60)
+
+// VoSPI 프레임 주기 (27Hz)와 pacing 여유 시간
+#define LEPTON_FRAME_PERIOD_NS (1000000000ULL / 27)
+#define LEPTON_PACING_MARGIN_NS (3000000ULL)
 
+#if LEPTON_VERSION >= 3
+#define LEPTON_WIDTH 160
+#define LEPTON_HEIGHT 120
+#define LEPTON_SEGMENTS 4
+#else
 #define LEPTON_WIDTH 80
 #define LEPTON_HEIGHT 60
-#define DEBUG_ID_CRC 2  // 2: ID 및 CRC 포함, 0: 순수 이미지 데이터만
+#define LEPTON_SEGMENTS 1
+#endif
+
+typedef struct {
+    unsigned long spi_transfers;    // SPI ioctl 호출 횟수
+    unsigned long packets;          // 수신한 VoSPI 패킷 수
+    unsigned long discard_packets;  // discard 패킷 수
+    unsigned long crc_errors;       // CRC 불일치로 버린 패킷 수
+    unsigned long frames;           // 완성된 프레임 수
+    unsigned long sync_errors;      // 패킷 ID/세그먼트 순서가 어긋나 버린 세그먼트 수
+    unsigned long resyncs;          // /CS deassert resync 횟수
+    unsigned long timeouts;         // LEPTON_CAPTURE_TIMEOUT_NS 안에 프레임을 못 받은 횟수
+} LeptonStats;
+
+
+int init_lepton(LeptonTransport *t);
+
+int cleanup_lepton(LeptonTransport *t);
 
-// // 열화상 이미지 버퍼 (외부 접근용)
-// extern uint16_t image[LEPTON_HEIGHT][LEPTON_WIDTH + DEBUG_ID_CRC];
+// VoSPI 패킷을 frame에 바로 디코딩한다 (ring buffer 슬롯을 직접 넘기면 중간 복사가 없다).
+// 1: 프레임 완성, 0: 시간 초과 (resync 후 반환, 다시 호출하면 된다), -1: 전송 오류
+// 실패했을 때 frame 내용은 일부만 채워져 있을 수 있다.
+int lepton_capture(LeptonTransport *t, uint16_t (*frame)[LEPTON_WIDTH]);
 
+int lepton_set_batch_size(int packets);
 
-int init_lepton(void);
+void lepton_get_stats(LeptonStats *stats);
 
-int cleanup_lepton(int fd);
+void lepton_reset_stats(void);
 
-int lepton_capture(int fd);
+// 1초마다 캡처 통계를 출력한다. ring_drops: ring buffer가 가득 차서 버린 프레임 (누적, 초당으로 출력)
+void lepton_report_stats(unsigned long ring_drops);
 
-void get_image(uint16_t (*cpy_image)[LEPTON_WIDTH]);
+// 1: 프레임을 다 읽은 뒤 다음 프레임이 나올 때까지 잠든다 (discard 패킷을 읽느라 CPU를 쓰지 않는다).
+// 녹화 파일을 최대 속도로 재생할 때는 0으로 둔다.
+void lepton_set_pacing(int enable);
 
-void print_image(int fd);
+void print_image(void);
 
 #endif
\ No newline at end of file
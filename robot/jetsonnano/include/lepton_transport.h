@@ -0,0 +1,40 @@
+#ifndef LEPTON_TRANSPORT_H
+#define LEPTON_TRANSPORT_H
+
+#include <stdint.h>
+
+#define LEPTON_SPI_DEVICE "/dev/spidev0.0"
+
+// 재생 속도
+#define LEPTON_REPLAY_UNLIMITED 0   // 파일을 최대한 빠르게 읽는다 (벤치마크용)
+#define LEPTON_REPLAY_REALTIME  1   // SPI 클럭(10MHz) 기준 패킷 전송 시간에 맞춰 읽는다
+
+// VoSPI 패킷을 읽어오는 SPI 계층.
+// lepton.c는 이 인터페이스만 사용하므로 실제 spidev 대신 녹화 파일로도 캡처 경로를 돌릴 수 있다.
+typedef struct LeptonTransport LeptonTransport;
+
+struct LeptonTransport {
+    const char *name;
+
+    // packets개의 VoSPI 패킷(각 164바이트)을 rx에 연속으로 채운다. 성공 1, 실패 -1
+    int (*transfer)(LeptonTransport *t, uint8_t *rx, int packets);
+
+    // VoSPI 재동기화: /CS deassert + SCK idle (>185ms). 성공 1, 실패 -1
+    int (*resync)(LeptonTransport *t);
+
+    void (*close)(LeptonTransport *t);
+};
+
+// /dev/spidevX.Y 백엔드 (SPI_MODE_3, 8bit, 10MHz)
+LeptonTransport *lepton_spidev_open(const char *device);
+
+// 녹화된 VoSPI 패킷 파일(164바이트 패킷을 이어붙인 raw 파일) 재생 백엔드.
+// 파일 끝에 도달하면 처음부터 다시 재생한다. 끝에 잘린 패킷(164바이트 미만)은 버리고,
+// 패킷이 하나도 없는 파일은 열지 않는다 (NULL).
+LeptonTransport *lepton_replay_open(const char *path, int rate);
+
+// inner로 받은 패킷을 그대로 path 파일에 기록하는 백엔드. replay 파일을 만들 때 사용한다.
+// 닫으면 inner도 함께 닫는다. 실패해서 NULL을 돌려줄 때도 inner를 닫는다 (inner가 NULL이면 그대로 NULL).
+LeptonTransport *lepton_record_open(LeptonTransport *inner, const char *path);
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <netinet/in.h>     // struct sockaddr_in
+
+#include "lepton.h"
+#include "thermal_codec.h"
+#include "audio_codec.h"
+#include "jitter_buffer.h"
+
+/*
+ * 열화상 프레임 바이너리 스트림 (docs/Protocol.md 3장)
+ *
+ * JSON 채널(12345)과 별도로 프레임만 보내는 포트를 연다.
+ *   TCP: 접속한 클라이언트에게 [헤더 32바이트][payload]를 이어서 보낸다.
+ *   UDP: 클라이언트가 아무 datagram(구독 요청)이나 보내면 그 주소로 프레임마다 datagram 하나를 보낸다.
+ * 모든 필드는 little-endian이다.
+ */
+#define THERMAL_TCP_PORT 5001
+#define THERMAL_UDP_PORT 5002
+
+#define THERMAL_MAGIC 0x4D524854u           // "THRM"
+#define THERMAL_PROTO_VERSION 1
+#define THERMAL_HEADER_SIZE 32
+
+// payload 형식
+#define THERMAL_FORMAT_RAW16 0              // 16bit 픽셀 width*height개, 행 순서
+#define THERMAL_FORMAT_DELTA_PACK 1         // 무손실 예측 + 가변 비트 폭 (thermal_codec.h)
+
+#define THERMAL_MAX_CLIENTS 4
+#define THERMAL_UDP_MAX_PAYLOAD 65507       // IPv4 UDP datagram 최대 크기 (헤더 포함)
+#define THERMAL_SEND_TIMEOUT_MS 100         // TCP 클라이언트가 이 시간 동안 못 받으면 끊는다
+#define THERMAL_UDP_PEER_TIMEOUT_S 10       // UDP 구독자가 이 시간 동안 구독 요청을 다시 보내지 않으면 끊는다
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t format;
+    uint16_t header_size;       // 이후 버전에서 헤더가 늘어나도 payload 위치를 알 수 있도록
+    uint32_t seq;               // 프레임 일련번호 (빠진 프레임 확인용)
+    uint64_t timestamp_ns;      // 로봇 쪽 capture(commit) 시각, CLOCK_MONOTONIC
+    uint16_t width;
+    uint16_t height;
+    uint16_t min;               // 프레임의 최소/최대 픽셀 값 (표시용 정규화)
+    uint16_t max;
+    uint32_t payload_size;
+} ThermalFrameHeader;
+
+typedef struct {
+    int tcp_fd;                 // listen 소켓
+    int udp_fd;
+    int clients[THERMAL_MAX_CLIENTS];           // 접속한 TCP 클라이언트 (-1: 빈 자리)
+    struct sockaddr_in udp_peers[THERMAL_MAX_CLIENTS];
+    int udp_npeers;
+    // poll()이 받아둔 새 클라이언트. 다른 thread(ControlServer의 epoll loop)가 poll()을 불러도 되도록
+    // clients/udp_peers는 send_frame()만 건드리고, 새 접속은 lock을 잡고 여기에만 넣는다.
+    // (udp_peers를 지우는 것은 poll()이 읽는 중일 수 있으므로 send_frame()도 lock을 잡는다)
+    pthread_mutex_t lock;
+    uint64_t udp_seen_ns[THERMAL_MAX_CLIENTS];  // udp_peers의 마지막 구독 요청 시각 (lock). 0: 포트가 닫혀 지울 구독자
+    int new_clients[THERMAL_MAX_CLIENTS];
+    int n_new_clients;
+    struct sockaddr_in new_peers[THERMAL_MAX_CLIENTS];
+    int n_new_peers;
+    int event_driven;           // 1: poll()은 epoll loop가 부르므로 send_frame()은 부르지 않는다
+    int format;                 // THERMAL_FORMAT_*
+    ThermalEncoder encoder;     // DELTA_PACK: 모든 클라이언트가 같은 압축 결과를 받는다
+    uint8_t encoded[THERMAL_CODEC_MAX_BYTES];
+    unsigned long frames_sent;
+    unsigned long bytes_sent;
+    unsigned long raw_bytes;        // 압축 전 payload 바이트 (압축률 확인용)
+    unsigned long clients_dropped;  // 끊은 TCP 클라이언트 + 만료/거부된 UDP 구독자
+} ThermalServer;
+
+// 헤더 <-> 32바이트 직렬화. decode는 magic/version/header_size가 맞지 않으면 -1
+void thermal_header_encode(const ThermalFrameHeader *h, uint8_t out[THERMAL_HEADER_SIZE]);
+int thermal_header_decode(ThermalFrameHeader *h, const uint8_t in[THERMAL_HEADER_SIZE]);
+
+// tcp_port/udp_port에 소켓을 연다. 0이면 그 전송 방식은 쓰지 않는다. 성공 1, 실패 -1
+int thermal_server_open(ThermalServer *s, uint16_t tcp_port, uint16_t udp_port);
+void thermal_server_close(ThermalServer *s);
+
+// payload 형식 (기본 THERMAL_FORMAT_DELTA_PACK)
+void thermal_server_set_format(ThermalServer *s, int format);
+// "raw" / "delta" -> THERMAL_FORMAT_*, 모르는 이름이면 -1
+int thermal_format_from_name(const char *name);
+
+// 새 TCP 접속과 UDP 구독 요청을 받아들인다 (블로킹하지 않음).
+// event_driven이 아니면 send_frame()이 매번 호출한다. 아무 thread에서나 불러도 된다.
+void thermal_server_poll(ThermalServer *s);
+
+// 모든 클라이언트에게 프레임 하나를 보낸다. 반환값은 프레임을 받은 클라이언트 수.
+// UDP 구독자는 THERMAL_UDP_PEER_TIMEOUT_S 안에 구독 요청을 다시 보내야 하고,
+// 받는 쪽 포트가 닫혀 ICMP port unreachable(ECONNREFUSED)이 오면 바로 끊는다.
+// RAW16이면 픽셀은 ring buffer 슬롯에서 복사 없이 그대로 보낸다.
+// DELTA_PACK은 새 클라이언트가 붙으면 다음 프레임을 keyframe으로 보낸다.
+int thermal_server_send_frame(ThermalServer *s, const uint16_t (*frame)[LEPTON_WIDTH],
+                              uint32_t seq, uint64_t timestamp_ns);
+
+
+
+/*
+ * 제어 채널 서버 (docs/Protocol.md 2장, server.py를 C로 옮긴 것)
+ *
+ * thread 하나가 epoll loop 하나로 다음을 모두 처리한다.
+ *   - TCP 12345: 여러 클라이언트의 COMMAND/HELLO 줄을 받고, ACK와 센서값(JSON 또는 TLV)을 보낸다.
+ *   - UDP 5000: 음성 패킷(audio_codec.h)을 지터 버퍼에 넣고 10ms마다 재생 시계에 맞춰 audio sink(aplay 파이프 등)에 쓴다.
+ *     협상 전(헤더 없는 PCM16)에는 받은 그대로 쓴다.
+ *   - 로봇 마이크(arecord 파이프 또는 파일): 20ms 프레임마다 인코딩해서 HELLO로 "listen"을 요청한
+ *     클라이언트의 UDP listen_port로 같은 소켓(5000)에서 보낸다 (docs/Protocol.md 4.5)
+ *   - 열화상 스트림(5001/5002)의 새 접속/구독 요청 (프레임 전송은 계속 transmit thread가 한다)
+ *   - 센서값 주기 timer (timerfd)
+ * 모든 소켓은 non-blocking이고 loop는 어떤 클라이언트 때문에도 막히지 않는다.
+ * 보낼 데이터가 쌓인 클라이언트만 EPOLLOUT을 켜고, 송신 버퍼가 차면 센서값은 버리고 ACK가 못 들어가면 끊는다.
+ */
+#define CONTROL_TCP_PORT 12345
+#define AUDIO_UDP_PORT 5000
+
+#define CONTROL_MAX_CLIENTS 16
+#define CONTROL_LINE_MAX 1024           // 명령 한 줄 최대 길이 (넘으면 다음 '\n'까지 버림)
+#define CONTROL_OUT_MAX 16384           // 클라이언트별 송신 대기 버퍼
+#define CONTROL_TELEMETRY_HZ 10         // server.py --telemetry-hz
+#define CONTROL_TELEMETRY_BATCH_MS 50   // server.py --telemetry-batch-ms
+#define AUDIO_DATAGRAM_MAX 4096
+#define AUDIO_SOURCE_FRAME_MS 20        // 로봇 마이크 -> 운영자 패킷 하나
+
+// 바이너리 센서값 레코드 (docs/Protocol.md 2.4, JetDash telemetryparser.h와 맞춰야 함)
+#define TELEMETRY_TLV_SYNC 0xA5
+#define TELEMETRY_TLV_CO_PPM 0x01       // int16
+#define TELEMETRY_TLV_OBSTACLE_CM 0x02  // int16
+#define TELEMETRY_TLV_ROLLOVER 0x03     // uint8
+#define TELEMETRY_TLV_RECORD_SIZE 13
+
+typedef struct {
+    int co_ppm;
+    int obstacle_cm;
+    int rollover;
+} ControlTelemetry;
+
+// 받은 COMMAND 하나. 문자열은 JSON 따옴표 안쪽 그대로 (escape는 풀지 않음), 없으면 ""
+typedef struct {
+    int64_t seq;                // 최상위 "seq" (없으면 -1)
+    char target[32];
+    char value[32];             // 문자열이 아니면 값 그대로 ("true", "1" 등)
+    char action[32];
+    uint64_t rx_ns;             // 줄을 받은 시각 (CLOCK_MONOTONIC)
+} ControlCommand;
+
+typedef struct {
+    int fd;                     // -1: 빈 자리
+    char in[CONTROL_LINE_MAX];
+    size_t in_len;
+    int in_skipping;            // 너무 긴 줄을 버리는 중
+    uint8_t out[CONTROL_OUT_MAX];
+    size_t out_len;
+    int want_write;             // EPOLLOUT 등록 여부
+    int tlv;                    // 센서값 형식 (HELLO로 협상)
+    int acks;                   // HELLO를 보낸 클라이언트에게만 ACK를 보냄
+    int audio_codec;            // HELLO로 협상한 음성 패킷 형식 (AUDIO_CODEC_*)
+    int listen_codec;           // 로봇 마이크를 받을 형식 (AUDIO_CODEC_RAW: 안 받음)
+    struct sockaddr_in listen_addr;     // 접속 주소 + HELLO의 listen_port
+    uint64_t batch_start_ns;    // 지금 모으는 센서값 배치의 첫 값 시각 (0: 비어 있음)
+} ControlClient;
+
+// 로봇 마이크 -> 운영자. 읽은 PCM을 프레임으로 모아서 듣는 클라이언트마다 보낸다
+typedef struct {
+    int fd;                     // -1: 없음
+    int paced;                  // 1: 일반 파일 (capture timer가 프레임 주기마다 한 프레임씩, 끝나면 처음부터)
+    int rate;
+    int capture_ms;             // fd 앞단 장치 버퍼 (arecord period 등, 잴 수 없어서 HELLO 응답으로 알려줌)
+    int16_t frame[AUDIO_PACKET_MAX_SAMPLES];
+    size_t frame_bytes;         // 프레임 하나 (바이트)
+    size_t filled;              // 지금 프레임에 찬 바이트 (파이프는 홀수 바이트로도 읽힌다)
+    uint64_t frame_start_ns;    // 지금 프레임의 첫 샘플을 읽은 시각
+    ImaAdpcmState adpcm;
+    uint16_t seq;
+    uint32_t timestamp;
+
+    unsigned long frames;
+    unsigned long packets_sent;
+    unsigned long send_failed;
+    LatencyHist hold;           // 첫 샘플 읽음 -> 인코딩해서 전송 (프레임 모으기 + 인코딩)
+    LatencyHist encode;
+} AudioSource;
+
+typedef struct ControlServer ControlServer;
+
+// 명령 실행 (epoll thread에서 불린다. 오래 걸리면 그동안 다른 클라이언트도 기다린다)
+typedef void (*ControlCommandHandler)(const ControlCommand *cmd, void *arg);
+// 주기마다 센서값 읽기
+typedef void (*ControlTelemetrySource)(ControlTelemetry *out, void *arg);
+
+struct ControlServer {
+    int epoll_fd;
+    int tcp_fd;
+    int audio_fd;
+    int timer_fd;
+    int wake_fd;                // eventfd: control_server_stop()
+    int playout_fd;             // timerfd: 지터 버퍼 재생 (음성 스트림이 있을 때만 돈다)
+    int capture_fd;             // timerfd: 파일 음원을 실시간 속도로 읽기 (AudioSource.paced)
+    ThermalServer *thermal;     // NULL이면 열화상 스트림은 loop에 넣지 않는다
+    ControlClient clients[CONTROL_MAX_CLIENTS];
+    int nclients;
+
+    double telemetry_hz;
+    int batch_ms;
+    ControlCommandHandler on_command;
+    void *command_arg;
+    ControlTelemetrySource read_telemetry;
+    void *telemetry_arg;
+    int audio_sink;             // 음성 PCM을 쓸 fd (-1: 버림). non-blocking으로 바꿔서 쓴다
+    int audio_rate;             // sink 재생 주파수 (HELLO 응답으로 알려서 클라이언트가 리샘플)
+    int audio_codec;            // 지금 받는 음성 형식: 협상한 클라이언트가 없으면 AUDIO_CODEC_RAW
+    JitterBuffer jitter;
+    int playout_on;
+    AudioSource source;
+    int listeners;              // 로봇 마이크를 받는 클라이언트 수
+
+    volatile int running;
+    // 통계 (epoll thread만 쓴다)
+    unsigned long commands;
+    unsigned long bad_lines;
+    unsigned long telemetry_sent;
+    unsigned long telemetry_dropped;    // 송신 버퍼가 차서 버린 센서값
+    unsigned long clients_dropped;
+    unsigned long audio_packets;
+    unsigned long audio_bytes;
+    unsigned long audio_dropped;        // sink가 못 받아서 버린 write
+    unsigned long audio_bad;            // 헤더가 맞지 않는 음성 패킷
+};
+
+// tcp_port/audio_port에 소켓을 연다. 0이면 그 포트는 쓰지 않는다.
+// thermal이 있으면 그 listen/구독 소켓도 loop에 넣는다 (thermal_server_open() 뒤에 부를 것). 성공 1, 실패 -1
+int control_server_open(ControlServer *s, uint16_t tcp_port, uint16_t audio_port, ThermalServer *thermal);
+void control_server_close(ControlServer *s);
+
+// 센서값 주기(Hz)와 배치 시간(ms, 0 = 매번). run() 전에 부를 것
+void control_server_set_telemetry(ControlServer *s, double hz, int batch_ms,
+                                  ControlTelemetrySource source, void *arg);
+// 기본 handler는 server.py의 process_command()처럼 출력만 한다
+void control_server_set_command_handler(ControlServer *s, ControlCommandHandler handler, void *arg);
+// rate: sink 재생 주파수 (기본 AUDIO_RATE)
+void control_server_set_audio_sink(ControlServer *s, int fd, int rate);
+// 로봇 마이크. fd는 arecord 파이프(paced 0, 읽을 수 있을 때마다) 또는 일반 파일(paced 1, 실시간 속도로 반복).
+// rate: PCM16 mono 주파수, capture_ms: fd 앞단 버퍼. run() 전에 부를 것. fd는 호출한 쪽이 닫는다. 성공 1, 실패 -1
+int control_server_set_audio_source(ControlServer *s, int fd, int rate, int paced, int capture_ms);
+// 로봇 마이크 송신 통계 출력
+void control_server_print_source_stats(ControlServer *s);
+
+// stop()이 불릴 때까지 loop를 돈다 (전용 thread에서 호출)
+void control_server_run(ControlServer *s);
+// 다른 thread에서 run()을 끝낸다
+void control_server_stop(ControlServer *s);
+
+// 센서값 인코딩 (테스트/벤치용으로도 쓴다). 쓴 바이트 수
+size_t control_encode_telemetry_json(const ControlTelemetry *t, char *out, size_t cap);
+size_t control_encode_telemetry_tlv(const ControlTelemetry *t, uint8_t out[TELEMETRY_TLV_RECORD_SIZE]);
+
+#endif
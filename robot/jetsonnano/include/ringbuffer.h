@@ -3,21 +3,100 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 
 #include "lepton.h"
 
-#define OFFSET_SIZE 2
-#define BUFFER_SIZE 100
+#define RINGBUFFER_CACHELINE 64
+#define RINGBUFFER_DEFAULT_CAPACITY 8      // 약 300ms (27Hz), 프레임 10개 96KB
 
+// lepton_ringbuffer_init() flags
+#define RINGBUFFER_MLOCK     0x1   // 슬롯 메모리를 mlock()해서 캡처 중 page fault/swap을 막는다
+#define RINGBUFFER_HUGEPAGE  0x2   // 2MB hugepage로 할당 (실패하면 일반 페이지 + MADV_HUGEPAGE)
+
+// 가득 찼을 때의 정책 (lepton_ringbuffer_set_policy)
+#define RINGBUFFER_DROP_NEWEST  0   // 새 프레임을 버린다 (기본값)
+#define RINGBUFFER_DROP_OLDEST  1   // 가장 오래된 프레임을 버리고 새 프레임을 넣는다
+#define RINGBUFFER_LATEST_ONLY  2   // mailbox: 항상 가장 최근 프레임 하나만 남긴다
+
+// 단일 생산자(capture thread) / 단일 소비자(transmit thread) lock-free ring buffer.
+// 프레임 메모리(frames)와 대기열(queue)을 분리해서 queue에는 프레임 번호만 넣는다.
+// 프레임은 capacity + 2개: 대기열 capacity개 + 생산자가 쓰는 중인 것 1개 + 소비자가 읽는 중인 것 1개.
+// 그래서 소비자가 슬롯을 제자리에서 읽는 동안에도 생산자는 가장 오래된 프레임을 버리고 새 프레임을 쓸 수 있다.
+//
+// head는 생산자만 올리고, tail은 소비자가 꺼낼 때와 생산자가 오래된 프레임을 버릴 때 CAS로 올린다.
+// 소비자가 다 읽은 프레임은 free 대기열(free_q)로 생산자에게 돌려준다.
+// 생산자/소비자가 각각 하나일 때만 mutex 없이 안전하다.
+// capacity는 실행 시 정하며 2의 거듭제곱으로 올림해서 인덱스를 mask로 계산한다.
 typedef struct {
-    uint16_t buffer[OFFSET_SIZE * BUFFER_SIZE][LEPTON_HEIGHT][LEPTON_WIDTH];
-    size_t head;
-    size_t tail;
-    size_t count;
+    // --- 생산자 ---
+    _Alignas(RINGBUFFER_CACHELINE) atomic_size_t head;
+    size_t cached_tail;         // 생산자가 마지막으로 본 tail
+    size_t free_tail;           // free_q에서 다음에 꺼낼 위치
+    uint32_t *spare;            // 생산자가 가진 빈 프레임 번호들
+    size_t nspare;
+    int32_t prod_frame;         // reserve()한 프레임 번호 (-1: 없음)
+    int policy;
+    atomic_ulong dropped_newest;
+    atomic_ulong dropped_oldest;
+    // --- 소비자 ---
+    _Alignas(RINGBUFFER_CACHELINE) atomic_size_t tail;
+    size_t cached_head;         // 소비자가 마지막으로 본 head
+    atomic_size_t free_head;    // free_q에 다음에 넣을 위치
+    int32_t cons_frame;         // acquire()한 프레임 번호 (-1: 없음)
+    // 소비자 대기/깨우기 (futex). 생산자는 waiters가 있을 때만 wake_seq를 올리고 깨운다.
+    _Alignas(RINGBUFFER_CACHELINE) atomic_uint wake_seq;
+    atomic_int waiters;
+    // --- 공유 (init 이후 읽기 전용 포인터) ---
+    _Alignas(RINGBUFFER_CACHELINE) uint16_t (*frames)[LEPTON_HEIGHT][LEPTON_WIDTH];
+    _Atomic uint32_t *queue;    // capacity개, 대기 중인 프레임 번호
+    _Atomic uint32_t *free_q;   // free_mask + 1개, 소비자 -> 생산자 반납
+    uint64_t *commit_ns;        // 프레임별 commit 시각 (CLOCK_MONOTONIC, 지연 측정용)
+    size_t capacity;
+    size_t mask;                // capacity - 1
+    size_t nframes;             // capacity + 2
+    size_t free_mask;
+    size_t mapped_size;         // mmap한 바이트 수
+    int flags;                  // 실제로 적용된 RINGBUFFER_* flags
 } LeptonRingBuffer;
 
+typedef struct {
+    unsigned long dropped_newest;   // DROP_NEWEST: 가득 차서 버린 새 프레임 수
+    unsigned long dropped_oldest;   // DROP_OLDEST/LATEST_ONLY: 새 프레임에 밀려 버린 프레임 수
+} LeptonRingBufferDrops;
+
+// capacity개(2의 거듭제곱으로 올림)의 슬롯을 할당한다. 성공 1, 실패 -1
+int lepton_ringbuffer_init(LeptonRingBuffer* rb, size_t capacity, int flags);
+void lepton_ringbuffer_destroy(LeptonRingBuffer* rb);
+// capacity개 슬롯에 필요한 메모리(바이트, 페이지 단위 올림)
+size_t lepton_ringbuffer_memory_budget(size_t capacity, int flags);
+void lepton_ringbuffer_print_budget(const LeptonRingBuffer* rb);
+// RINGBUFFER_DROP_NEWEST / DROP_OLDEST / LATEST_ONLY. 스레드 시작 전에 설정한다.
+int lepton_ringbuffer_set_policy(LeptonRingBuffer* rb, int policy);
+// 이름("drop-newest", "drop-oldest", "latest") -> 정책, 모르는 이름이면 -1
+int lepton_ringbuffer_policy_from_name(const char *name);
+const char *lepton_ringbuffer_policy_name(int policy);
+void lepton_ringbuffer_get_drops(LeptonRingBuffer* rb, LeptonRingBufferDrops *drops);
+// 생산자 쪽에서 호출. DROP_NEWEST가 아니면 항상 1
 int lepton_ringbuffer_is_available(LeptonRingBuffer* rb);
+// 소비자 쪽에서 호출
 int lepton_ringbuffer_is_empty(LeptonRingBuffer* rb);
+size_t lepton_ringbuffer_count(LeptonRingBuffer* rb);
+// --- zero-copy API ---
+// 생산자: reserve()로 받은 슬롯에 직접 프레임을 쓰고 commit()으로 공개한다.
+// DROP_NEWEST에서 가득 차 있으면 NULL (dropped_newest 증가). 다른 정책은 commit() 때 오래된 프레임을 버린다.
+uint16_t (*lepton_ringbuffer_reserve(LeptonRingBuffer* rb))[LEPTON_WIDTH];
+void lepton_ringbuffer_commit(LeptonRingBuffer* rb);
+// 소비자: acquire()로 받은 슬롯을 제자리에서 읽고 release()로 반납한다. 비어 있으면 NULL.
+const uint16_t (*lepton_ringbuffer_acquire(LeptonRingBuffer* rb))[LEPTON_WIDTH];
+// acquire()와 같지만 비어 있으면 프레임이 commit될 때까지 최대 timeout_ms 동안 잠든다.
+// timeout_ms < 0 이면 무한 대기. 시간 초과 시 NULL.
+const uint16_t (*lepton_ringbuffer_acquire_wait(LeptonRingBuffer* rb, int timeout_ms))[LEPTON_WIDTH];
+// acquire한 슬롯이 commit된 시각 (ns, CLOCK_MONOTONIC)
+uint64_t lepton_ringbuffer_commit_time(LeptonRingBuffer* rb);
+void lepton_ringbuffer_release(LeptonRingBuffer* rb);
+
+// --- 복사 API (reserve/commit, acquire/release 위에 구현) ---
 int lepton_ringbuffer_enqueue(LeptonRingBuffer* rb, const uint16_t image[][LEPTON_WIDTH]);
 int lepton_ringbuffer_dequeue(LeptonRingBuffer* rb, uint16_t image[][LEPTON_WIDTH]);
 
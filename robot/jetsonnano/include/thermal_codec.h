@@ -0,0 +1,58 @@
+#ifndef THERMAL_CODEC_H
+#define THERMAL_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "lepton.h"
+
+/*
+ * 열화상 프레임 무손실 압축 (thermal stream format THERMAL_FORMAT_DELTA_PACK)
+ *
+ * 한 행을 16픽셀 블록으로 나누고 블록마다 예측기를 고른다.
+ *   - 공간 예측: LOCO-I MED (왼쪽, 위, 왼쪽 위 픽셀)
+ *   - 시간 예측: 직전 프레임의 같은 위치 (keyframe이 아닐 때만)
+ * 잔차(mod 2^16)를 zigzag로 부호 없는 값으로 바꾸고, 블록 안에서 가장 큰 값의 비트 수 w로
+ * 16개를 이어 붙인다. 16 * w 비트는 항상 2w 바이트이므로 블록은 바이트 경계에서 끝난다.
+ *
+ * payload: [flags 1B][블록 크기 1B] + 블록마다 [헤더 1B][2w 바이트]
+ *   flags  bit0: keyframe (시간 예측 블록 없음, 이전 프레임 없이 복원 가능)
+ *   헤더   bit0~4: w (0~16), bit7: 시간 예측
+ */
+#define THERMAL_CODEC_BLOCK 16
+#define THERMAL_CODEC_KEYFRAME_INTERVAL 27      // 약 1초마다 keyframe
+#define THERMAL_CODEC_FLAG_KEYFRAME 0x01
+#define THERMAL_CODEC_BLOCK_TEMPORAL 0x80
+#define THERMAL_CODEC_BLOCK_WIDTH_MASK 0x1f
+
+#define THERMAL_CODEC_BLOCKS (LEPTON_HEIGHT * LEPTON_WIDTH / THERMAL_CODEC_BLOCK)
+// 최악의 경우 (모든 블록이 16비트): 원본보다 블록당 1바이트 크다.
+#define THERMAL_CODEC_MAX_BYTES (2 + THERMAL_CODEC_BLOCKS * (1 + 2 * THERMAL_CODEC_BLOCK))
+
+#if LEPTON_WIDTH % THERMAL_CODEC_BLOCK != 0
+#error "LEPTON_WIDTH는 THERMAL_CODEC_BLOCK의 배수여야 한다"
+#endif
+
+typedef struct {
+    uint16_t prev[LEPTON_HEIGHT][LEPTON_WIDTH];     // 직전에 보낸 프레임
+    int have_prev;
+    unsigned int since_keyframe;
+} ThermalEncoder;
+
+typedef struct {
+    uint16_t prev[LEPTON_HEIGHT][LEPTON_WIDTH];     // 직전에 복원한 프레임
+    int have_prev;
+} ThermalDecoder;
+
+void thermal_encoder_init(ThermalEncoder *e);
+// 다음 프레임을 keyframe으로 보낸다 (새 클라이언트가 붙었을 때)
+void thermal_encoder_force_keyframe(ThermalEncoder *e);
+// frame을 out(THERMAL_CODEC_MAX_BYTES 이상)에 압축하고 바이트 수를 반환한다.
+size_t thermal_encode(ThermalEncoder *e, const uint16_t (*frame)[LEPTON_WIDTH], uint8_t *out);
+
+void thermal_decoder_init(ThermalDecoder *d);
+// 1: 성공, 0: 이전 프레임이 없어 keyframe을 기다려야 함, -1: 잘못된 데이터
+// 프레임이 빠졌으면(seq가 건너뜀) 호출하는 쪽에서 thermal_decoder_init()으로 상태를 지운다.
+int thermal_decode(ThermalDecoder *d, const uint8_t *in, size_t len, uint16_t (*frame)[LEPTON_WIDTH]);
+
+#endif
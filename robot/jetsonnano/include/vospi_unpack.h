@@ -0,0 +1,32 @@
+#ifndef VOSPI_UNPACK_H
+#define VOSPI_UNPACK_H
+
+#include <stdint.h>
+
+// VoSPI 패킷 payload(big-endian 16bit) -> 프레임 픽셀(호스트 순서) 변환.
+// RAW14 모드에서 상위 2bit는 항상 0이므로 VOSPI_PIXEL_MASK로 지운다.
+
+#define VOSPI_PIXEL_MASK 0x3fff
+
+#define VOSPI_UNPACK_IMPL_SCALAR 0    // 한 픽셀씩 (기준 구현)
+#define VOSPI_UNPACK_IMPL_SSSE3  1    // x86: pshufb로 8픽셀씩
+#define VOSPI_UNPACK_IMPL_AVX2   2    // x86: vpshufb로 16픽셀씩
+#define VOSPI_UNPACK_IMPL_NEON   3    // ARMv8 (Jetson Nano): vrev16q로 8픽셀씩
+#define VOSPI_UNPACK_IMPL_COUNT  4
+
+// 사용할 구현 선택. 다른 함수보다 먼저 한 번 호출한다 (init_lepton()이 호출한다).
+// 가속 경로는 CPU가 지원하고 자체 검증을 통과할 때만 사용한다.
+void vospi_unpack_init(void);
+
+// 현재 선택된 구현 (VOSPI_UNPACK_IMPL_*)
+int vospi_unpack_active_impl(void);
+// impl을 사용할 수 있으면 1
+int vospi_unpack_impl_available(int impl);
+const char *vospi_unpack_impl_name(int impl);
+
+// src의 big-endian 픽셀 n개를 dst에 쓴다.
+void vospi_unpack_line_impl(uint16_t *dst, const uint8_t *src, int n, int impl);
+// 선택된 구현 사용
+void vospi_unpack_line(uint16_t *dst, const uint8_t *src, int n);
+
+#endif
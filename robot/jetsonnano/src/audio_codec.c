@@ -0,0 +1,203 @@
+#include <string.h>
+
+#include "../include/audio_codec.h"
+
+static const int8_t ima_index_table[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+static const int16_t ima_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+// 코드 하나로 상태 갱신 (인코더와 디코더가 같은 식을 써야 어긋나지 않는다)
+static void _ima_step(ImaAdpcmState *s, int code)
+{
+    int step = ima_step_table[s->index];
+    int diff = step >> 3;
+    int pred, index;
+
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+    pred = s->predictor + ((code & 8) ? -diff : diff);
+    s->predictor = (int16_t)(pred > 32767 ? 32767 : pred < -32768 ? -32768 : pred);
+    index = s->index + ima_index_table[code];
+    s->index = (uint8_t)(index < 0 ? 0 : index > 88 ? 88 : index);
+}
+
+static int _ima_code(const ImaAdpcmState *s, int sample)
+{
+    int step = ima_step_table[s->index];
+    int diff = sample - s->predictor;
+    int code = 0;
+
+    if (diff < 0)
+    {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    if (diff >= step >> 1) { code |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) code |= 1;
+    return code;
+}
+
+void ima_adpcm_encode(ImaAdpcmState *state, const int16_t *pcm, size_t n, uint8_t *out)
+{
+    for (size_t i = 0; i < n; i += 2)
+    {
+        int lo = _ima_code(state, pcm[i]);
+        int hi = 0;
+        _ima_step(state, lo);
+        if (i + 1 < n)
+        {
+            hi = _ima_code(state, pcm[i + 1]);
+            _ima_step(state, hi);
+        }
+        *out++ = (uint8_t)(lo | hi << 4);
+    }
+}
+
+void ima_adpcm_decode(ImaAdpcmState *state, const uint8_t *in, size_t n, int16_t *pcm)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        int code = (i & 1) ? in[i >> 1] >> 4 : in[i >> 1] & 0x0f;
+        _ima_step(state, code);
+        pcm[i] = state->predictor;
+    }
+}
+
+static void _put_header(const AudioPacketHeader *h, uint8_t flags, size_t n, uint8_t *out)
+{
+    out[0] = (uint8_t)(AUDIO_PACKET_MAGIC | h->codec);
+    out[1] = flags;
+    out[2] = (uint8_t)n;
+    out[3] = (uint8_t)(n >> 8);
+    out[4] = (uint8_t)h->seq;
+    out[5] = (uint8_t)(h->seq >> 8);
+    out[6] = (uint8_t)h->delay;
+    out[7] = (uint8_t)(h->delay >> 8);
+    for (int i = 0; i < 4; i++)
+        out[8 + i] = (uint8_t)(h->timestamp >> (8 * i));
+}
+
+// 컴포트 노이즈: RMS가 level(-dBFS)인 균일 분포 백색 잡음. 같은 timestamp면 같은 잡음 (JetDash와 같은 식)
+static void _comfort_noise(uint8_t level, uint32_t timestamp, int16_t *pcm, size_t n)
+{
+    double a = 32768.0 * 1.7320508;     // [-a, a] 균일 분포의 RMS = a / sqrt(3)
+    uint32_t x = timestamp * 2654435761u + 1;
+    int32_t amp;
+
+    for (int i = 0; i < level; i++)
+        a *= 0.89125094;                // -1dB
+    amp = a > 32767.0 ? 32767 : (int32_t)(a + 0.5);
+    for (size_t i = 0; i < n; i++)
+    {
+        x = x * 1664525u + 1013904223u;
+        pcm[i] = (int16_t)((int32_t)((x >> 8) % (uint32_t)(2 * amp + 1)) - amp);
+    }
+}
+
+size_t audio_packet_encode(const AudioPacketHeader *h, ImaAdpcmState *state, const int16_t *pcm, size_t n, uint8_t *out)
+{
+    uint8_t *body = out + AUDIO_PACKET_HEADER;
+
+    if (n > AUDIO_PACKET_MAX_SAMPLES)
+        return 0;
+    if (h->codec == AUDIO_CODEC_RAW)
+    {
+        memcpy(out, pcm, n * 2);        // little-endian 호스트
+        return n * 2;
+    }
+
+    _put_header(h, h->flags, n, out);
+    if (h->codec == AUDIO_CODEC_IMA_ADPCM)
+    {
+        body[0] = (uint8_t)state->predictor;
+        body[1] = (uint8_t)((uint16_t)state->predictor >> 8);
+        body[2] = state->index;
+        body[3] = 0;
+        ima_adpcm_encode(state, pcm, n, body + AUDIO_ADPCM_HEADER);
+        return AUDIO_PACKET_HEADER + AUDIO_ADPCM_HEADER + (n + 1) / 2;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        body[2 * i] = (uint8_t)pcm[i];
+        body[2 * i + 1] = (uint8_t)((uint16_t)pcm[i] >> 8);
+    }
+    return AUDIO_PACKET_HEADER + n * 2;
+}
+
+int audio_packet_decode(const uint8_t *packet, size_t len, AudioPacketHeader *h, int16_t *pcm, size_t capacity)
+{
+    const uint8_t *body = packet + AUDIO_PACKET_HEADER;
+    uint32_t timestamp;
+    size_t n;
+    int codec;
+
+    if (len < AUDIO_PACKET_HEADER || (packet[0] & AUDIO_PACKET_MAGIC_MASK) != AUDIO_PACKET_MAGIC)
+        return -1;
+    codec = packet[0] & 0x0f;
+    if (codec != AUDIO_CODEC_IMA_ADPCM && codec != AUDIO_CODEC_PCM16)
+        return -1;
+    n = (size_t)(packet[2] | packet[3] << 8);
+    if (n > capacity || n > AUDIO_PACKET_MAX_SAMPLES)
+        return -1;
+    timestamp = (uint32_t)packet[8] | (uint32_t)packet[9] << 8 | (uint32_t)packet[10] << 16 | (uint32_t)packet[11] << 24;
+    len -= AUDIO_PACKET_HEADER;
+
+    if (packet[1] & AUDIO_FLAG_CN)
+    {
+        if (len < 1 || body[0] > AUDIO_CN_MAX_LEVEL)
+            return -1;
+        _comfort_noise(body[0], timestamp, pcm, n);
+    }
+    else if (codec == AUDIO_CODEC_IMA_ADPCM)
+    {
+        ImaAdpcmState s;
+        if (len < AUDIO_ADPCM_HEADER + (n + 1) / 2 || body[2] > 88)
+            return -1;
+        s.predictor = (int16_t)(body[0] | body[1] << 8);
+        s.index = body[2];
+        ima_adpcm_decode(&s, body + AUDIO_ADPCM_HEADER, n, pcm);
+    }
+    else
+    {
+        if (len < n * 2)
+            return -1;
+        for (size_t i = 0; i < n; i++)
+            pcm[i] = (int16_t)(body[2 * i] | body[2 * i + 1] << 8);
+    }
+
+    if (h)
+    {
+        h->codec = codec;
+        h->flags = packet[1];
+        h->seq = (uint16_t)(packet[4] | packet[5] << 8);
+        h->delay = (uint16_t)(packet[6] | packet[7] << 8);
+        h->timestamp = timestamp;
+    }
+    return (int)n;
+}
+
+size_t audio_packet_encode_cn(const AudioPacketHeader *h, size_t n, uint8_t level, uint8_t *out)
+{
+    if (n > AUDIO_PACKET_MAX_SAMPLES || h->codec == AUDIO_CODEC_RAW)
+        return 0;
+    _put_header(h, AUDIO_FLAG_CN, n, out);
+    out[AUDIO_PACKET_HEADER] = level > AUDIO_CN_MAX_LEVEL ? AUDIO_CN_MAX_LEVEL : level;
+    return AUDIO_PACKET_HEADER + 1;
+}
+
+const char *audio_codec_name(int codec)
+{
+    switch (codec)
+    {
+    case AUDIO_CODEC_PCM16: return "PCM";
+    case AUDIO_CODEC_IMA_ADPCM: return "ADPCM";
+    default: return "RAW";
+    }
+}
@@ -0,0 +1,251 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC16_HAVE_X86_CLMUL 1
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#include <arm_neon.h>
+#include <sys/auxv.h>       // getauxval()
+#include <asm/hwcap.h>      // HWCAP_PMULL
+#define CRC16_HAVE_NEON_PMULL 1
+#endif
+
+#include "../include/crc16.h"
+#include "../include/lepton.h"
+
+#define CRC16_POLY 0x1021
+
+static uint16_t crc_table[8][256];     // slice-by-8 테이블
+static uint64_t fold_k128;             // x^128 mod P
+static uint64_t fold_k192;             // x^192 mod P
+static int active_impl = CRC16_IMPL_BITWISE;
+static int initialized = 0;
+
+
+uint16_t crc16_ccitt_bitwise(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t crc16_ccitt_table(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len >= 8)
+    {
+        crc = crc_table[7][data[0] ^ (crc >> 8)] ^
+              crc_table[6][data[1] ^ (crc & 0xff)] ^
+              crc_table[5][data[2]] ^
+              crc_table[4][data[3]] ^
+              crc_table[3][data[4]] ^
+              crc_table[2][data[5]] ^
+              crc_table[1][data[6]] ^
+              crc_table[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    while (len--)
+    {
+        crc = (uint16_t)(crc << 8) ^ crc_table[0][((crc >> 8) ^ *data++) & 0xff];
+    }
+    return crc;
+}
+
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len)
+{
+    return crc16_ccitt_table(crc, data, len);
+}
+
+// x^n mod P
+static uint64_t _xpow_mod(int n)
+{
+    uint32_t r = 1;
+    while (n--)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+            r ^= 0x10000 | CRC16_POLY;
+    }
+    return r;
+}
+
+
+// ------------------ carry-less multiply 폴딩 ------------------ //
+// 패킷 앞에 0을 12바이트 붙여(초기값 0이므로 CRC는 변하지 않는다) 176바이트 = 16바이트 블록 11개로 맞춘다.
+// 128bit 상태 R = H*x^64 + L 을 다음 블록으로 옮길 때 R*x^128 ≡ H*(x^192 mod P) + L*(x^128 mod P).
+// 마지막 128bit 상태는 원래 메시지와 CRC가 같으므로 테이블로 16바이트만 마무리한다.
+
+#if defined(CRC16_HAVE_X86_CLMUL)
+__attribute__((target("pclmul,ssse3")))
+static uint16_t _crc16_vospi_clmul(const uint8_t *packet)
+{
+    uint8_t head[16] = {0, };
+    uint8_t out[16];
+    const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k = _mm_set_epi64x((long long)fold_k192, (long long)fold_k128);
+    __m128i r;
+
+    head[12] = packet[0] & 0x0f;
+    head[13] = packet[1];
+    r = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)head), rev);
+
+    for (int i = 4; i < VOSPI_FRAME_SIZE; i += 16)
+    {
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(packet + i)), rev);
+        __m128i lo = _mm_clmulepi64_si128(r, k, 0x00);
+        __m128i hi = _mm_clmulepi64_si128(r, k, 0x11);
+        r = _mm_xor_si128(_mm_xor_si128(lo, hi), b);
+    }
+    _mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(r, rev));
+    return crc16_ccitt_table(0, out, 16);
+}
+
+static int _clmul_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+}
+
+#elif defined(CRC16_HAVE_NEON_PMULL)
+static inline uint64x2_t _load_be128(const uint8_t *p)
+{
+    uint8x16_t v = vrev64q_u8(vld1q_u8(p));
+    return vreinterpretq_u64_u8(vextq_u8(v, v, 8));
+}
+
+static uint16_t _crc16_vospi_clmul(const uint8_t *packet)
+{
+    uint8_t head[16] = {0, };
+    uint8_t out[16];
+    uint64x2_t r;
+
+    head[12] = packet[0] & 0x0f;
+    head[13] = packet[1];
+    r = _load_be128(head);
+
+    for (int i = 4; i < VOSPI_FRAME_SIZE; i += 16)
+    {
+        uint64x2_t b = _load_be128(packet + i);
+        uint64x2_t lo = vreinterpretq_u64_p128(vmull_p64((poly64_t)vgetq_lane_u64(r, 0), (poly64_t)fold_k128));
+        uint64x2_t hi = vreinterpretq_u64_p128(vmull_p64((poly64_t)vgetq_lane_u64(r, 1), (poly64_t)fold_k192));
+        r = veorq_u64(veorq_u64(lo, hi), b);
+    }
+    uint8x16_t v = vrev64q_u8(vreinterpretq_u8_u64(r));
+    vst1q_u8(out, vextq_u8(v, v, 8));
+    return crc16_ccitt_table(0, out, 16);
+}
+
+static int _clmul_supported(void)
+{
+    return (getauxval(AT_HWCAP) & HWCAP_PMULL) ? 1 : 0;
+}
+
+#else
+static uint16_t _crc16_vospi_clmul(const uint8_t *packet)
+{
+    return crc16_vospi(packet, CRC16_IMPL_TABLE);
+}
+
+static int _clmul_supported(void)
+{
+    return 0;
+}
+#endif
+
+
+uint16_t crc16_vospi(const uint8_t *packet, int impl)
+{
+    uint8_t head[4];
+    uint16_t crc;
+
+    if (impl == CRC16_IMPL_CLMUL)
+    {
+        return _crc16_vospi_clmul(packet);
+    }
+
+    head[0] = packet[0] & 0x0f;
+    head[1] = packet[1];
+    head[2] = 0;
+    head[3] = 0;
+    if (impl == CRC16_IMPL_BITWISE)
+    {
+        crc = crc16_ccitt_bitwise(0, head, sizeof(head));
+        return crc16_ccitt_bitwise(crc, packet + 4, VOSPI_FRAME_SIZE - 4);
+    }
+    crc = crc16_ccitt_table(0, head, sizeof(head));
+    return crc16_ccitt_table(crc, packet + 4, VOSPI_FRAME_SIZE - 4);
+}
+
+int crc16_vospi_check(const uint8_t *packet)
+{
+    uint16_t expected = (uint16_t)(packet[2] << 8 | packet[3]);
+    return (crc16_vospi(packet, active_impl) == expected) ? 1 : 0;
+}
+
+// 가속 경로 자체 검증: 임의 패킷 몇 개에 대해 비트 단위 구현과 비교한다.
+static int _clmul_self_test(void)
+{
+    uint8_t pkt[VOSPI_FRAME_SIZE];
+    uint32_t seed = 0x12345678;
+
+    for (int n = 0; n < 16; n++)
+    {
+        for (int i = 0; i < VOSPI_FRAME_SIZE; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            pkt[i] = (uint8_t)(seed >> 16);
+        }
+        if (_crc16_vospi_clmul(pkt) != crc16_vospi(pkt, CRC16_IMPL_BITWISE))
+            return 0;
+    }
+    return 1;
+}
+
+void crc16_init(void)
+{
+    if (initialized)
+        return;
+
+    for (int b = 0; b < 256; b++)
+    {
+        uint8_t byte = (uint8_t)b;
+        crc_table[0][b] = crc16_ccitt_bitwise(0, &byte, 1);
+    }
+    for (int k = 1; k < 8; k++)
+    {
+        for (int b = 0; b < 256; b++)
+        {
+            uint16_t prev = crc_table[k - 1][b];
+            crc_table[k][b] = (uint16_t)(prev << 8) ^ crc_table[0][prev >> 8];
+        }
+    }
+    fold_k128 = _xpow_mod(128);
+    fold_k192 = _xpow_mod(192);
+
+    active_impl = CRC16_IMPL_TABLE;
+    if (_clmul_supported() && _clmul_self_test())
+    {
+        active_impl = CRC16_IMPL_CLMUL;
+    }
+    initialized = 1;
+}
+
+int crc16_active_impl(void)
+{
+    return active_impl;
+}
+
+int crc16_impl_available(int impl)
+{
+    if (impl == CRC16_IMPL_CLMUL)
+        return _clmul_supported();
+    return 1;
+}
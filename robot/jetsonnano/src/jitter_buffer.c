@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "../include/jitter_buffer.h"
+
+#define RING_MASK (JITTER_RING - 1)
+#define HISTORY_MASK (JITTER_HISTORY - 1)
+
+static int32_t _ms_to_samples(const JitterBuffer *jb, int ms)
+{
+    return (int32_t)((int64_t)jb->rate * ms / 1000);
+}
+
+// 건너뛰기/보정 끝 cross-fade 길이 (5ms)
+static int _xfade(const JitterBuffer *jb)
+{
+    return jb->rate / 200;
+}
+
+// 재생 시계로 now까지 내보냈어야 하는데 아직 안 내보낸 샘플 (재생 시작 전이면 음수)
+static int64_t _due(const JitterBuffer *jb, uint64_t now_ns)
+{
+    if (now_ns < jb->start_ns)
+        return -(int64_t)((jb->start_ns - now_ns) * (uint64_t)jb->rate / 1000000000ULL);
+    return (int64_t)((now_ns - jb->start_ns) * (uint64_t)jb->rate / 1000000000ULL) - (int64_t)jb->emitted;
+}
+
+// 가장 늦게 온 패킷이 기다려야 할 시간 (샘플)
+static int32_t _margin(const JitterBuffer *jb)
+{
+    return _ms_to_samples(jb, JITTER_MARGIN_MS) + (int32_t)jb->jitter;
+}
+
+void jitter_buffer_init(JitterBuffer *jb, int rate)
+{
+    memset(jb, 0, sizeof(*jb));
+    jb->rate = rate > 0 ? rate : AUDIO_RATE;
+}
+
+void jitter_buffer_reset(JitterBuffer *jb)
+{
+    jitter_buffer_init(jb, jb->rate);
+}
+
+int jitter_buffer_active(const JitterBuffer *jb)
+{
+    return jb->started;
+}
+
+// 첫 패킷 (또는 timestamp가 크게 튀었을 때): 이 패킷을 JITTER_START_MS 뒤에 재생
+static void _start(JitterBuffer *jb, const AudioPacketHeader *h, uint64_t now_ns)
+{
+    if (jb->stats.packets)
+        jb->expected_before += jb->seq_cycles + jb->max_seq - jb->base_seq + 1;
+    memset(jb->valid, 0, sizeof(jb->valid));
+    jb->started = 1;
+    jb->start_ns = now_ns + (uint64_t)JITTER_START_MS * 1000000ULL;
+    jb->emitted = 0;
+    jb->play_ts = jb->end_ts = h->timestamp;
+    jb->adjust = 0;
+    jb->plc_run = jb->fade = jb->skip = jb->skip_pos = 0;
+    jb->prev_arrival_ns = 0;
+    jb->window_min = INT32_MAX;
+    jb->window_start_ns = now_ns;
+    jb->max_seq = h->seq;
+    jb->base_seq = h->seq;
+    jb->seq_cycles = 0;
+    jb->seen = 0;
+}
+
+// 64개 창 안에서 이미 받은 seq면 1
+static int _seq_seen(JitterBuffer *jb, uint16_t seq)
+{
+    int16_t d = (int16_t)(seq - jb->max_seq);
+
+    if (d > 0)
+    {
+        if (seq < jb->max_seq)
+            jb->seq_cycles += 65536;
+        jb->seen = (d >= 64) ? 1 : (jb->seen << d) | 1;
+        jb->max_seq = seq;
+        return 0;
+    }
+    if (-d >= 64)
+        return 0;           // 너무 오래된 것 (어차피 늦음)
+    if (jb->seen & (1ULL << -d))
+        return 1;
+    jb->seen |= 1ULL << -d;
+    return 0;
+}
+
+// 늦은 패킷에 맞춰 지연을 늘리고, 1초 동안 남았으면 줄인다
+static void _adapt(JitterBuffer *jb, int32_t wait, uint64_t now_ns)
+{
+    int32_t margin = _margin(jb);
+
+    if (wait < margin)
+    {
+        // 지금 버퍼 깊이 + 예약된 조정이 최대 지연을 넘지 않게
+        int32_t depth = (int32_t)(jb->end_ts - jb->play_ts) - (int32_t)_due(jb, now_ns) + jb->adjust;
+        int32_t need = margin - wait;
+        int32_t room = _ms_to_samples(jb, JITTER_MAX_DELAY_MS) - depth;
+        if (need > room)
+            need = room;
+        if (need > 0)
+            jb->adjust += need;
+    }
+
+    if (wait < jb->window_min)
+        jb->window_min = wait;
+    if (now_ns - jb->window_start_ns >= (uint64_t)JITTER_WINDOW_MS * 1000000ULL)
+    {
+        int32_t excess = jb->window_min - margin;
+        if (jb->adjust == 0 && excess > margin)
+            jb->adjust = -excess / 2;
+        jb->window_min = INT32_MAX;
+        jb->window_start_ns = now_ns;
+    }
+}
+
+int jitter_buffer_put(JitterBuffer *jb, const uint8_t *packet, size_t len, uint64_t now_ns)
+{
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES];
+    AudioPacketHeader h;
+    int32_t off, wait;
+    int cn;
+    int n = audio_packet_decode(packet, len, &h, pcm, AUDIO_PACKET_MAX_SAMPLES);
+
+    if (n < 0)
+        return -1;
+    if (!jb->started)
+        _start(jb, &h, now_ns);
+    off = (int32_t)(h.timestamp - jb->play_ts);
+    if (off > JITTER_RING - n || off < -JITTER_RING)
+    {
+        // 송신 측이 다시 시작했거나 오래 끊겼다 -> 새로 맞춘다
+        jb->stats.restarts++;
+        _start(jb, &h, now_ns);
+        off = 0;
+    }
+    if (_seq_seen(jb, h.seq))
+    {
+        jb->stats.duplicates++;
+        return 1;
+    }
+    jb->stats.packets++;
+    jb->last_arrival_ns = now_ns;
+
+    // RFC 3550 도착 지터: 두 패킷의 도착 간격과 timestamp 간격의 차이를 1/16씩 평균
+    if (jb->prev_arrival_ns)
+    {
+        double d = (double)(int64_t)(now_ns - jb->prev_arrival_ns) * jb->rate / 1e9 -
+                   (double)(int32_t)(h.timestamp - jb->prev_ts);
+        jb->jitter += (fabs(d) - jb->jitter) / 16.0;
+    }
+    jb->prev_arrival_ns = now_ns;
+    jb->prev_ts = h.timestamp;
+
+    // 이 패킷의 첫 샘플이 재생될 때까지 남은 시간 (예약된 조정 포함)
+    wait = off - (int32_t)_due(jb, now_ns) + jb->adjust;
+    _adapt(jb, wait, now_ns);
+    if (off + n <= 0)
+    {
+        jb->stats.late++;
+        return 1;
+    }
+    latency_hist_add(&jb->stats.wait, wait > 0 ? (uint64_t)wait * 1000000000ULL / (uint64_t)jb->rate : 0);
+
+    cn = h.flags & AUDIO_FLAG_CN;
+    if (cn)
+        jb->stats.comfort += (unsigned long)n;
+    for (int i = off < 0 ? -off : 0; i < n; i++)
+    {
+        uint32_t idx = (h.timestamp + (uint32_t)i) & RING_MASK;
+        // CN은 앞으로 올 구간까지 덮으므로, 순서가 바뀌어 먼저 와 있던 말소리는 지우지 않는다
+        if (cn && jb->valid[idx])
+            continue;
+        jb->ring[idx] = pcm[i];
+        jb->valid[idx] = 1;
+    }
+    if ((int32_t)(h.timestamp + (uint32_t)n - jb->end_ts) > 0)
+        jb->end_ts = h.timestamp + (uint32_t)n;
+    return 0;
+}
+
+// 최근 출력에서 정규화 자기상관이 가장 큰 주기 (2.5 ~ 15ms)를 찾아 한 주기를 복사해 둔다
+static void _start_plc(JitterBuffer *jb)
+{
+    int min_lag = jb->rate / 400;
+    int max_lag = jb->rate / 66;
+    unsigned int end = jb->history_pos;
+    double best = -1.0;
+
+    if (max_lag > JITTER_HISTORY / 2)
+        max_lag = JITTER_HISTORY / 2;
+    jb->pitch = max_lag;
+    for (int lag = min_lag; lag <= max_lag; lag++)
+    {
+        double num = 0.0, energy = 1.0;
+        for (int i = 1; i <= max_lag; i++)
+        {
+            double x = jb->history[(end - (unsigned int)i) & HISTORY_MASK];
+            double y = jb->history[(end - (unsigned int)(i + lag)) & HISTORY_MASK];
+            num += x * y;
+            energy += y * y;
+        }
+        if (num / sqrt(energy) > best)
+        {
+            best = num / sqrt(energy);
+            jb->pitch = lag;
+        }
+    }
+    for (int i = 0; i < jb->pitch; i++)
+        jb->period[i] = jb->history[(end - (unsigned int)jb->pitch + (unsigned int)i) & HISTORY_MASK];
+}
+
+// 보정 샘플 하나: 주기를 반복하고 JITTER_PLC_HOLD_MS 뒤부터 JITTER_PLC_FADE_MS까지 줄여서 무음
+static int _plc_sample(JitterBuffer *jb)
+{
+    int hold = _ms_to_samples(jb, JITTER_PLC_HOLD_MS);
+    int end = _ms_to_samples(jb, JITTER_PLC_FADE_MS);
+    int k;
+
+    if (jb->plc_run == 0)
+        _start_plc(jb);
+    k = jb->plc_run++;
+    if (k >= end)
+        return 0;
+    if (k < hold)
+        return jb->period[k % jb->pitch];
+    return jb->period[k % jb->pitch] * (end - k) / (end - hold);
+}
+
+// 건너뛸 구간 [play_ts, play_ts + skip + xfade)가 다 있어야 cross-fade로 건너뛴다
+static int _can_skip(const JitterBuffer *jb, int skip)
+{
+    for (int i = 0; i < skip + _xfade(jb); i++)
+    {
+        if (!jb->valid[(jb->play_ts + (uint32_t)i) & RING_MASK])
+            return 0;
+    }
+    return 1;
+}
+
+static int16_t _next_sample(JitterBuffer *jb)
+{
+    int xfade = _xfade(jb);
+    uint32_t idx = jb->play_ts & RING_MASK;
+    int s;
+
+    // 지연 줄이기: skip만큼 뒤의 샘플로 xfade 동안 넘어간다
+    if (jb->skip == 0 && jb->adjust < 0 && jb->plc_run == 0)
+    {
+        int skip = -jb->adjust;
+        if (skip > _ms_to_samples(jb, JITTER_TICK_MS))
+            skip = _ms_to_samples(jb, JITTER_TICK_MS);
+        if (_can_skip(jb, skip))
+        {
+            jb->skip = skip;
+            jb->skip_pos = 0;
+        }
+    }
+    if (jb->skip)
+    {
+        uint32_t far = (jb->play_ts + (uint32_t)jb->skip) & RING_MASK;
+        s = (jb->ring[idx] * (xfade - jb->skip_pos) + jb->ring[far] * jb->skip_pos) / xfade;
+        jb->valid[idx] = 0;
+        jb->play_ts++;
+        if (++jb->skip_pos == xfade)
+        {
+            for (int i = 0; i < jb->skip; i++)
+                jb->valid[(jb->play_ts + (uint32_t)i) & RING_MASK] = 0;
+            jb->play_ts += (uint32_t)jb->skip;
+            jb->adjust += jb->skip;
+            jb->stats.skipped += (unsigned long)jb->skip;
+            jb->skip = 0;
+        }
+    }
+    else if (jb->adjust > 0)
+    {
+        // 지연 늘리기: 재생 위치는 그대로 두고 보정 샘플을 끼워 넣는다 (늦은 패킷이 올 시간을 번다)
+        s = _plc_sample(jb);
+        jb->fade = xfade;
+        jb->adjust--;
+        jb->stats.inserted++;
+    }
+    else if (!jb->valid[idx])
+    {
+        s = _plc_sample(jb);
+        jb->fade = xfade;
+        jb->play_ts++;
+        jb->stats.concealed++;
+    }
+    else
+    {
+        s = jb->ring[idx];
+        jb->valid[idx] = 0;
+        jb->play_ts++;
+        if (jb->plc_run)
+        {
+            // 보정 샘플에서 실제 샘플로 xfade 동안 넘어간다
+            int c = _plc_sample(jb);
+            s = (c * jb->fade + s * (xfade - jb->fade)) / xfade;
+            if (--jb->fade == 0)
+                jb->plc_run = 0;
+        }
+    }
+
+    jb->history[jb->history_pos++ & HISTORY_MASK] = (int16_t)s;
+    return (int16_t)s;
+}
+
+size_t jitter_buffer_get(JitterBuffer *jb, uint64_t now_ns, int16_t *pcm, size_t capacity)
+{
+    int64_t due;
+
+    if (!jb->started)
+        return 0;
+    if (now_ns - jb->last_arrival_ns > (uint64_t)JITTER_IDLE_MS * 1000000ULL)
+    {
+        jb->started = 0;
+        return 0;
+    }
+    due = _due(jb, now_ns);
+    if (due <= 0)
+        return 0;
+    if ((uint64_t)due > capacity)
+        due = (int64_t)capacity;
+    for (int64_t i = 0; i < due; i++)
+        pcm[i] = _next_sample(jb);
+    jb->emitted += (uint64_t)due;
+    jb->stats.played += (unsigned long)due;
+    return (size_t)due;
+}
+
+const JitterStats *jitter_buffer_stats(JitterBuffer *jb)
+{
+    JitterStats *st = &jb->stats;
+    unsigned long expected = jb->expected_before;
+
+    if (st->packets)
+        expected += jb->seq_cycles + jb->max_seq - jb->base_seq + 1;
+    st->lost = expected > st->packets ? expected - st->packets : 0;
+    st->jitter_ms = jb->jitter * 1000.0 / jb->rate;
+    st->margin_ms = _margin(jb) * 1000.0 / jb->rate;
+    return st;
+}
+
+void jitter_buffer_print_stats(JitterBuffer *jb, const char *name)
+{
+    const JitterStats *st = jitter_buffer_stats(jb);
+    double ms = 1000.0 / jb->rate;
+
+    printf("%s: packets %lu, lost %lu (%.1f%%), late %lu, dup %lu, jitter %.1fms, margin %.1fms\n", name,
+           st->packets, st->lost, st->packets + st->lost ? 100.0 * st->lost / (st->packets + st->lost) : 0.0,
+           st->late, st->duplicates, st->jitter_ms, st->margin_ms);
+    printf("    played %.0fms: concealed %.0fms, inserted %.0fms, skipped %.0fms, comfort noise %.0fms, restarts %lu\n",
+           st->played * ms, st->concealed * ms, st->inserted * ms, st->skipped * ms, st->comfort * ms, st->restarts);
+    latency_hist_print(&st->wait, "    arrival->playout");
+}
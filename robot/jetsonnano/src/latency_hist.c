@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>           // clock_gettime()
+
+#include "../include/latency_hist.h"
+
+uint64_t latency_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void latency_hist_reset(LatencyHist *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+// us 단위 값 -> 구간 번호. [2^k, 2^(k+1)) 구간을 LATENCY_HIST_SUB칸으로 나눈다.
+static int _bucket_of(uint64_t us)
+{
+    int k, idx;
+    if (us < LATENCY_HIST_SUB)
+        return (int)us;
+    k = 63 - __builtin_clzll(us);
+    idx = k * LATENCY_HIST_SUB + (int)((us >> (k - 2)) & (LATENCY_HIST_SUB - 1));
+    return (idx < LATENCY_HIST_BUCKETS) ? idx : LATENCY_HIST_BUCKETS - 1;
+}
+
+// 구간 번호 -> 구간 상한 (us)
+static uint64_t _bucket_upper(int idx)
+{
+    int k = idx / LATENCY_HIST_SUB;
+    uint64_t sub = (uint64_t)(idx % LATENCY_HIST_SUB);
+    if (idx < LATENCY_HIST_SUB)
+        return (uint64_t)idx + 1;
+    return (1ULL << k) + ((sub + 1) << (k - 2));
+}
+
+void latency_hist_add(LatencyHist *h, uint64_t ns)
+{
+    h->buckets[_bucket_of(ns / 1000)]++;
+    h->count++;
+    h->sum_ns += ns;
+    if (ns > h->max_ns)
+        h->max_ns = ns;
+}
+
+uint64_t latency_hist_percentile(const LatencyHist *h, double p)
+{
+    uint64_t target, seen = 0;
+    if (h->count == 0)
+        return 0;
+    target = (uint64_t)(h->count * p / 100.0);
+    if (target >= h->count)
+        target = h->count - 1;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+        if (seen > target)
+        {
+            uint64_t ns = _bucket_upper(i) * 1000;
+            return (ns < h->max_ns) ? ns : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+void latency_hist_print(const LatencyHist *h, const char *name)
+{
+    if (h->count == 0)
+    {
+        printf("%s: n=0\n", name);
+        return;
+    }
+    printf("%s: n=%llu avg=%.0fus p50=%.0fus p90=%.0fus p99=%.0fus max=%.0fus\n", name,
+           (unsigned long long)h->count,
+           (double)h->sum_ns / h->count / 1000.0,
+           latency_hist_percentile(h, 50) / 1000.0,
+           latency_hist_percentile(h, 90) / 1000.0,
+           latency_hist_percentile(h, 99) / 1000.0,
+           h->max_ns / 1000.0);
+}
@@ -1,156 +1,367 @@
 #include <stdio.h>          // printf(), perror()
 #include <stdint.h>         // uint8_t, uint16_t, uint32_t
-#include <fcntl.h>          // open(), O_RDWR
-#include <unistd.h>         // close(), usleep()z
-#include <sys/ioctl.h>      // ioctl()
-#include <linux/spi/spidev.h>  // SPI_MODE_3, SPI_IOC_*, struct spi_ioc_transfer
 #include <string.h>
+#include <time.h>           // clock_gettime()
 
 #include "../include/lepton.h"
+#include "../include/crc16.h"
+#include "../include/vospi_unpack.h"
+#include "../include/lepton_transport.h"
 
-static const char *device = "/dev/spidev0.0";
-static uint8_t mode = SPI_MODE_3;
-static uint8_t bits = 8;
-static uint32_t speed = 10000000;   // 10MHz
-static uint16_t delay = 0;
-
-
-uint16_t image[LEPTON_HEIGHT][LEPTON_WIDTH + DEBUG_ID_CRC];
-
-int init_lepton(void)
-{
-    int fd;
-    int ret = 0;
-
-    fd = open(device, O_RDWR);
-	if (fd < 0)
-	{
-		perror("open(): device를 열 수 없습니다");
-		return fd;
-	}
-
-	ret = ioctl(fd, SPI_IOC_WR_MODE, &mode);
-	if (ret == -1)
-	{
-		perror("SPI 모드 설정 요류");
-		return -1;
-	}
-
-	ret = ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits);
-	if (ret == -1)
-	{
-		perror("BITS_PER_WORD 설정 오류");
-		return -1;
-	}
-
-	ret = ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed);
-	if (ret == -1)
-	{
-		perror("SPI_IOC_WR_MAX_SPEED_HZ 설정 오류");
-		return -1;
-	}
-
-    // Lepton 2.5 동기화: Deassert /CS and idle SCK for at least 185ms(5 frame periods)
-    usleep(300000);	  // >185ms
-
-    return fd;
-}
-
-int cleanup_lepton(int fd){
-    return (close(fd) == 0) ? 1 : -1;
-}
-static int _get_VoSPI_packet(int fd, uint8_t *rx)
-{
-    int ret;
-    int i;
-    uint8_t dummy_tx[VOSPI_FRAME_SIZE] = {0, };
-    struct spi_ioc_transfer tr = {
-        .tx_buf = (unsigned long)dummy_tx,
-		.rx_buf = (unsigned long)rx,
-		.len = VOSPI_FRAME_SIZE,
-		.delay_usecs = delay,
-		.speed_hz = speed,
-		.bits_per_word = bits,
-	};
-    ret = ioctl(fd, SPI_IOC_MESSAGE(1), &tr);
-    if(ret < 1){
-        perror("Error while ioctl SPI communication");
-		return -1;
-	}
+// batch 수신 버퍼
+static uint8_t batch_rx[VOSPI_FRAME_SIZE * LEPTON_MAX_BATCH_PACKETS];
+static int batch_size = LEPTON_DEFAULT_BATCH_PACKETS;
+static int batch_count = 0;     // batch_rx에 들어있는 패킷 수
+static int batch_pos = 0;       // 다음에 꺼낼 패킷 위치
+
+static LeptonStats lepton_stats;
+
+// VoSPI 타이밍 기반 대기 (lepton_set_pacing)
+static int pacing = 0;
+static uint64_t frame_start_ns = 0;     // 마지막 프레임의 패킷 0 수신 시각
+static uint64_t frame_end_ns = 0;       // 마지막 프레임의 마지막 패킷 수신 시각
+
+// 마지막으로 받은 각 라인의 패킷 ID (print_image() 디버그용)
+static uint16_t line_ids[LEPTON_HEIGHT];
+
+int init_lepton(LeptonTransport *t)
+{
+    if (t == NULL)
+    {
+        return -1;
+    }
+    batch_pos = batch_count = 0;
+    crc16_init();
+    vospi_unpack_init();
+
+    // VoSPI 동기화: Deassert /CS and idle SCK for at least 185ms(5 frame periods)
+    return t->resync(t);
+}
+
+int cleanup_lepton(LeptonTransport *t){
+    if (t == NULL)
+    {
+        return -1;
+    }
+    t->close(t);
     return 1;
 }
 
-static int _packet_crc(uint8_t *rx)
+static int _get_VoSPI_packets(LeptonTransport *t, uint8_t *rx, int packets)
 {
-    // TODO 패킷 CRC 검사 polynomial: x^16 + x^12 + x^5 + x^0
+    lepton_stats.spi_transfers++;
+    return t->transfer(t, rx, packets);
+}
+
+// batch 버퍼에서 다음 패킷을 꺼낸다. 다 쓰면 batch_size 만큼 새로 읽어온다.
+// 프레임 끝(마지막 세그먼트의 패킷 59) 이후에 남은 패킷은 버리지 않고 다음 lepton_capture() 호출에서 이어서 사용한다.
+static uint8_t *_next_VoSPI_packet(LeptonTransport *t)
+{
+    if (batch_pos >= batch_count)
+    {
+        if (_get_VoSPI_packets(t, batch_rx, batch_size) < 0)
+        {
+            batch_pos = batch_count = 0;
+            return NULL;
+        }
+        batch_pos = 0;
+        batch_count = batch_size;
+    }
+    lepton_stats.packets++;
+    return &batch_rx[VOSPI_FRAME_SIZE * batch_pos++];
+}
+
+int lepton_set_batch_size(int packets)
+{
+    if (packets < 1 || packets > LEPTON_MAX_BATCH_PACKETS)
+    {
+        printf("잘못된 batch 크기: %d (1 ~ %d)\n", packets, LEPTON_MAX_BATCH_PACKETS);
+        return -1;
+    }
+    batch_size = packets;
+    batch_pos = batch_count = 0;   // 이전 크기로 읽어둔 패킷은 버린다
     return 1;
 }
 
-//FIXME Thread가 여기서 못 나오고있다.
-int lepton_capture(int fd)
+void lepton_get_stats(LeptonStats *stats)
+{
+    *stats = lepton_stats;
+}
+
+void lepton_reset_stats(void)
+{
+    memset(&lepton_stats, 0, sizeof(lepton_stats));
+}
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double _now_sec(void)
+{
+    return _now_ns() * 1e-9;
+}
+
+void lepton_set_pacing(int enable)
+{
+    pacing = enable;
+    frame_start_ns = frame_end_ns = 0;
+}
+
+// 다음 프레임의 패킷 0이 나올 때쯤(직전 프레임 끝 + 프레임 주기 - 읽기 시간 - 여유)까지 잠든다.
+// 그 사이에는 discard 패킷만 나오므로 SPI를 계속 읽을 필요가 없다.
+static void _pace_next_frame(void)
+{
+    uint64_t readout, wake, now;
+    struct timespec ts;
+
+    if (!pacing || frame_end_ns == 0)
+        return;
+    readout = frame_end_ns - frame_start_ns;
+    if (readout + LEPTON_PACING_MARGIN_NS >= LEPTON_FRAME_PERIOD_NS)
+        return;
+    wake = frame_end_ns + LEPTON_FRAME_PERIOD_NS - readout - LEPTON_PACING_MARGIN_NS;
+    now = _now_ns();
+    if (now >= wake)
+        return;
+
+    ts.tv_sec = (time_t)(wake / 1000000000ULL);
+    ts.tv_nsec = (long)(wake % 1000000000ULL);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    // 잠들기 전에 읽어둔 패킷은 이미 지난 것이므로 버린다.
+    batch_pos = batch_count;
+}
+
+// 마지막 출력 이후 1초 이상 지났으면 초당 통계를 출력한다.
+void lepton_report_stats(unsigned long ring_drops)
+{
+    static LeptonStats prev;
+    static unsigned long prev_drops;
+    static double prev_time = 0;
+    double now = _now_sec();
+    double dt = now - prev_time;
+
+    if (prev_time == 0)
+    {
+        prev = lepton_stats;
+        prev_drops = ring_drops;
+        prev_time = now;
+        return;
+    }
+    if (dt < 1.0)
+    {
+        return;
+    }
+    printf("[lepton] %.1f frames/s, %.1f xfer/s, discard %.1f/s, CRC 오류 %.1f/s, sync 오류 %.1f/s, resync %lu, timeout %lu, "
+           "ring drop %.1f/s\n",
+           (lepton_stats.frames - prev.frames) / dt,
+           (lepton_stats.spi_transfers - prev.spi_transfers) / dt,
+           (lepton_stats.discard_packets - prev.discard_packets) / dt,
+           (lepton_stats.crc_errors - prev.crc_errors) / dt,
+           (lepton_stats.sync_errors - prev.sync_errors) / dt,
+           lepton_stats.resyncs, lepton_stats.timeouts, (ring_drops - prev_drops) / dt);
+    prev = lepton_stats;
+    prev_drops = ring_drops;
+    prev_time = now;
+}
+
+// 패킷 CRC 검사 polynomial: x^16 + x^12 + x^5 + x^0
+static int _packet_crc(uint8_t *rx)
+{
+    if (crc16_vospi_check(rx))
+    {
+        return 1;
+    }
+    lepton_stats.crc_errors++;
+    return 0;
+}
+
+// 동기를 잃었을 때: 읽어둔 패킷을 버리고 /CS를 185ms 이상 deassert 한다.
+static int _resync(LeptonTransport *t)
+{
+    lepton_stats.resyncs++;
+    batch_pos = batch_count = 0;
+    frame_start_ns = frame_end_ns = 0;
+    return t->resync(t);
+}
+
+// 프레임 사이에 discard 패킷만 계속 나올 때 SPI를 쉬지 않고 읽지 않도록 잠깐 쉰다.
+static void _discard_backoff(void)
+{
+    struct timespec ts = { 0, (long)LEPTON_DISCARD_BACKOFF_NS };
+
+    if (!pacing)
+        return;
+    nanosleep(&ts, NULL);
+    batch_pos = batch_count;
+}
+
+// 세그먼트 안의 패킷 위치 -> 프레임 좌표
+// Lepton 2.5: 패킷 하나가 한 줄, Lepton 3.x: 패킷 두 개가 한 줄 (세그먼트 하나가 30줄)
+static void _store_packet(uint16_t (*frame)[LEPTON_WIDTH], int segment, int id, const uint8_t *rx)
+{
+    int pos = (segment - 1) * VOSPI_SEGMENT_PACKETS + id;
+    int row = pos * VOSPI_PACKET_PIXELS / LEPTON_WIDTH;
+    uint16_t *dst = &frame[row][(pos * VOSPI_PACKET_PIXELS) % LEPTON_WIDTH];
+
+    line_ids[row] = (uint16_t)(rx[0] << 8 | rx[1]);
+    vospi_unpack_line(dst, rx + 4, VOSPI_PACKET_PIXELS);
+}
+
+#if LEPTON_SEGMENTS > 1
+// 다른 세그먼트 자리에 받아둔 패킷 0 ~ 19를 세그먼트 1 자리로 옮긴다.
+static void _move_to_first_segment(uint16_t (*frame)[LEPTON_WIDTH], int segment)
+{
+    int rows = VOSPI_SEGMENT_ID_PACKET * VOSPI_PACKET_PIXELS / LEPTON_WIDTH;
+    int from = (segment - 1) * VOSPI_SEGMENT_PACKETS * VOSPI_PACKET_PIXELS / LEPTON_WIDTH;
+
+    memmove(frame[0], frame[from], sizeof(frame[0]) * rows);
+}
+#endif
+
+/*
+ * VoSPI 수신 상태 머신
+ *   WAIT_SEGMENT: 패킷 0을 기다린다. 중간부터 들어온 세그먼트의 나머지 패킷은 조용히 버린다.
+ *   IN_SEGMENT:   패킷 ID가 0, 1, 2, ... 59 순서로 와야 한다. 어긋나면 세그먼트를 버리고
+ *                 (sync 오류) 다시 패킷 0을 기다린다.
+ * Lepton 3.x는 패킷 20의 TTT 비트로 세그먼트 번호(1~4, 0은 무효 프레임)를 확인하고,
+ * 세그먼트 1 ~ 4가 순서대로 모여야 프레임이 완성된다.
+ * discard 패킷은 어느 상태에서든 무시한다.
+ *
+ * resync는 꼭 필요할 때만 한다: 프레임을 완성하지 못한 채 sync 오류가 LEPTON_MAX_SYNC_ERRORS번
+ * 연속으로 나거나, LEPTON_CAPTURE_TIMEOUT_NS 안에 프레임을 못 받았을 때.
+ * 두 경우 모두 resync 후 0을 반환하므로 한 번의 호출은 (timeout + resync 시간) 안에 끝난다.
+ */
+enum {
+    VOSPI_WAIT_SEGMENT,
+    VOSPI_IN_SEGMENT,
+};
+
+int lepton_capture(LeptonTransport *t, uint16_t (*frame)[LEPTON_WIDTH])
 {
-    int ret = 0;
-    uint8_t frame_number = 0;
-    unsigned int loop_count = 0;
-    do {
-        loop_count++;
-        uint8_t rx[VOSPI_FRAME_SIZE] = {0, };
-        ret = _get_VoSPI_packet(fd, rx);
-        if (ret < 0)
+    int state = VOSPI_WAIT_SEGMENT;
+    int expected_packet = 0;
+    int segment = 1;            // 지금 받고 있는 (또는 기다리는) 세그먼트 번호
+    int sync_error_run = 0;
+    int discard_run = 0;
+    uint64_t now, deadline, segment_start_ns = 0;
+
+    _pace_next_frame();
+    deadline = _now_ns() + LEPTON_CAPTURE_TIMEOUT_NS;
+    for (;;)
+    {
+        uint8_t *rx = _next_VoSPI_packet(t);
+        if (rx == NULL)
         {
             printf("Error while ioctl SPI communication\n");
             return -1;
         }
+        now = _now_ns();
+        if (now > deadline)
+        {
+            lepton_stats.timeouts++;
+            printf("이미지 수신 타임아웃\n");
+            return (_resync(t) < 0) ? -1 : 0;
+        }
 
-        if(((rx[0] & 0x0f) != 0x0f) && (_packet_crc(rx) > 0))
+        if ((rx[0] & 0x0f) == 0x0f)
         {
-            frame_number = rx[1];
-            //DEBUG
-            printf("%04x, %04x\n",rx[0], rx[1]);    
-            if(frame_number < LEPTON_HEIGHT)
+            lepton_stats.discard_packets++;
+            if (state == VOSPI_WAIT_SEGMENT && segment == 1 && ++discard_run >= batch_size)
             {
-                for(int i=0;i<LEPTON_WIDTH + DEBUG_ID_CRC;i++)
-                {
-                    if (DEBUG_ID_CRC)
-                    {
-                        image[frame_number][i] = (rx[2*i] << 8 | rx[2*i+1]);
-                    }
-                    else
-                    {
-                        image[frame_number][i] = (rx[2*i+4] << 8 | rx[2*i+5]);
-                    }
-                }
+                _discard_backoff();
+                discard_run = 0;
             }
-            else
+            continue;
+        }
+        discard_run = 0;
+
+        int id = ((rx[0] & 0x0f) << 8) | rx[1];
+        int ok = _packet_crc(rx);
+        if (ok && id == 0)
+        {
+            if (state == VOSPI_IN_SEGMENT)
+                lepton_stats.sync_errors++;     // 이전 세그먼트가 끝나기 전에 새 세그먼트 시작
+            state = VOSPI_IN_SEGMENT;
+            segment_start_ns = now;
+        }
+        else if (state == VOSPI_WAIT_SEGMENT)
+        {
+            continue;
+        }
+        else if (!ok || id != expected_packet)
+        {
+            #ifdef DEBUG_VOSPI
+            printf("sync 오류: 패킷 %d (기대 %d)\n", id, expected_packet);
+            #endif
+            lepton_stats.sync_errors++;
+            state = VOSPI_WAIT_SEGMENT;
+            if (++sync_error_run >= LEPTON_MAX_SYNC_ERRORS)
             {
-                printf("잘못된 프레임 ID: %d\n", frame_number);
+                return (_resync(t) < 0) ? -1 : 0;
             }
+            continue;
         }
-    } while((frame_number != 59) && (loop_count < MAX_LOOP_COUNT));
+        #ifdef DEBUG_VOSPI
+        printf("%04x, %04x\n",rx[0], rx[1]);
+        #endif
 
-    if(loop_count >= MAX_LOOP_COUNT){
-        printf("이미지 수신 타임아웃\n");
-        return -1;
-    }
-    else{
-        return 1;
-    }
-}
+#if LEPTON_SEGMENTS > 1
+        if (id == VOSPI_SEGMENT_ID_PACKET)
+        {
+            int ttt = (rx[0] >> 4) & 0x07;
+            if (ttt != segment)
+            {
+                if (ttt == 1)
+                {
+                    // 앞 세그먼트를 놓쳤다. 지금 세그먼트를 새 프레임의 첫 세그먼트로 삼는다.
+                    lepton_stats.sync_errors++;
+                    _move_to_first_segment(frame, segment);
+                    segment = 1;
+                }
+                else
+                {
+                    // 무효 프레임(0)이거나 프레임 중간부터 들어왔다. 다음 세그먼트 1을 기다린다.
+                    if (ttt != 0 && segment > 1)
+                        lepton_stats.sync_errors++;
+                    segment = 1;
+                    state = VOSPI_WAIT_SEGMENT;
+                    continue;
+                }
+            }
+        }
+#endif
+        _store_packet(frame, segment, id, rx);
+        expected_packet = id + 1;
 
-void get_image(uint16_t (*cpy_image)[LEPTON_WIDTH])
-{
-    for (int r=0; r<LEPTON_HEIGHT; r++){
-        memcpy(cpy_image[r], &image[r][DEBUG_ID_CRC], sizeof(uint16_t)*LEPTON_WIDTH);
+        if (id == VOSPI_SEGMENT_PACKETS - 1)
+        {
+            state = VOSPI_WAIT_SEGMENT;
+            expected_packet = 0;
+            sync_error_run = 0;
+            if (segment == 1)
+                frame_start_ns = segment_start_ns;
+            if (segment == LEPTON_SEGMENTS)
+            {
+                lepton_stats.frames++;
+                frame_end_ns = now;
+                return 1;
+            }
+            segment++;
+        }
     }
 }
 
 
 // ------------------ DEBUG 함수 ------------------ //
-void print_image(int fd)
+void print_image(void)
 {
     printf("-- ID들 잘 들어왔나 확인 -- \n");
-    for (int r=0; r<60; r++){
-        printf("%02X ", image[r][0]);
+    for (int r=0; r<LEPTON_HEIGHT; r++){
+        printf("%02X ", line_ids[r]);
     }
     printf("\n");
 }
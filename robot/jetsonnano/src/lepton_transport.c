@@ -0,0 +1,286 @@
+#include <stdio.h>          // printf(), perror(), FILE
+#include <stdlib.h>         // malloc(), free()
+#include <stdint.h>
+#include <string.h>
+#include <time.h>           // clock_gettime(), nanosleep()
+#include <fcntl.h>          // open(), O_RDWR
+#include <unistd.h>         // close(), usleep()
+#include <sys/ioctl.h>      // ioctl()
+#include <sys/stat.h>       // fstat()
+#include <linux/spi/spidev.h>  // SPI_MODE_3, SPI_IOC_*, struct spi_ioc_transfer
+
+#include "../include/lepton.h"
+#include "../include/lepton_transport.h"
+
+
+// ------------------ spidev 백엔드 ------------------ //
+typedef struct {
+    LeptonTransport base;
+    int fd;
+    uint8_t mode;
+    uint8_t bits;
+    uint32_t speed;
+    uint16_t delay;
+    // tx는 항상 0이므로 매 전송마다 새로 만들 필요가 없다.
+    uint8_t tx[VOSPI_FRAME_SIZE * LEPTON_MAX_BATCH_PACKETS];
+} SpidevTransport;
+
+// 여러 VoSPI 패킷을 한 번의 SPI 전송(= ioctl 1회)으로 읽는다.
+// CS는 전송이 끝날 때까지 assert 상태로 유지되므로 패킷 경계는 164바이트 단위로 그대로 이어진다.
+static int _spidev_transfer(LeptonTransport *t, uint8_t *rx, int packets)
+{
+    SpidevTransport *s = (SpidevTransport *)t;
+    int ret;
+    struct spi_ioc_transfer tr = {
+        .tx_buf = (unsigned long)s->tx,
+        .rx_buf = (unsigned long)rx,
+        .len = (uint32_t)(VOSPI_FRAME_SIZE * packets),
+        .delay_usecs = s->delay,
+        .speed_hz = s->speed,
+        .bits_per_word = s->bits,
+    };
+    ret = ioctl(s->fd, SPI_IOC_MESSAGE(1), &tr);
+    if(ret < 1){
+        perror("Error while ioctl SPI communication");
+        return -1;
+    }
+    return 1;
+}
+
+static int _spidev_resync(LeptonTransport *t)
+{
+    (void)t;
+    // 전송을 하지 않는 동안 /CS는 deassert, SCK는 idle 상태로 유지된다.
+    usleep(300000);	  // >185ms
+    return 1;
+}
+
+static void _spidev_close(LeptonTransport *t)
+{
+    SpidevTransport *s = (SpidevTransport *)t;
+    close(s->fd);
+    free(s);
+}
+
+LeptonTransport *lepton_spidev_open(const char *device)
+{
+    int ret = 0;
+    SpidevTransport *s = calloc(1, sizeof(*s));
+    if (s == NULL)
+    {
+        perror("calloc(): spidev transport");
+        return NULL;
+    }
+    s->base.name = "spidev";
+    s->base.transfer = _spidev_transfer;
+    s->base.resync = _spidev_resync;
+    s->base.close = _spidev_close;
+    s->mode = SPI_MODE_3;
+    s->bits = 8;
+    s->speed = 10000000;   // 10MHz
+    s->delay = 0;
+
+    s->fd = open(device, O_RDWR);
+	if (s->fd < 0)
+	{
+		perror("open(): device를 열 수 없습니다");
+		free(s);
+		return NULL;
+	}
+
+	ret = ioctl(s->fd, SPI_IOC_WR_MODE, &s->mode);
+	if (ret == -1)
+	{
+		perror("SPI 모드 설정 요류");
+		goto fail;
+	}
+
+	ret = ioctl(s->fd, SPI_IOC_WR_BITS_PER_WORD, &s->bits);
+	if (ret == -1)
+	{
+		perror("BITS_PER_WORD 설정 오류");
+		goto fail;
+	}
+
+	ret = ioctl(s->fd, SPI_IOC_WR_MAX_SPEED_HZ, &s->speed);
+	if (ret == -1)
+	{
+		perror("SPI_IOC_WR_MAX_SPEED_HZ 설정 오류");
+		goto fail;
+	}
+    return &s->base;
+
+fail:
+    _spidev_close(&s->base);
+    return NULL;
+}
+
+
+// ------------------ replay 백엔드 ------------------ //
+#define REPLAY_SPI_HZ 10000000  // 실시간 재생 시 기준 SPI 클럭
+
+typedef struct {
+    LeptonTransport base;
+    FILE *fp;
+    int rate;
+    struct timespec next;       // 실시간 재생: 다음 전송이 끝나야 하는 시각
+} ReplayTransport;
+
+static void _timespec_add_ns(struct timespec *ts, long ns)
+{
+    ts->tv_nsec += ns;
+    while (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+static int _replay_transfer(LeptonTransport *t, uint8_t *rx, int packets)
+{
+    ReplayTransport *r = (ReplayTransport *)t;
+    size_t want = (size_t)VOSPI_FRAME_SIZE * packets;
+    size_t got = 0;
+
+    while (got < want)
+    {
+        size_t n = fread(rx + got, 1, want - got, r->fp);
+        got += n;
+        if (got < want)
+        {
+            if (ferror(r->fp) || ftell(r->fp) < VOSPI_FRAME_SIZE)
+            {
+                printf("replay 파일 읽기 오류\n");
+                return -1;
+            }
+            // 파일 끝에 잘린 패킷(녹화 중 종료 등)이 있으면 버린다. 다음 패킷을 처음부터 채워야
+            // 반복 재생 후에도 164바이트 경계가 어긋나지 않는다.
+            got -= got % VOSPI_FRAME_SIZE;
+            rewind(r->fp);
+        }
+    }
+
+    if (r->rate == LEPTON_REPLAY_REALTIME)
+    {
+        // 8bit * 164바이트 / 10MHz = 약 131us/패킷
+        _timespec_add_ns(&r->next, (long)(want * 8 * (1000000000LL / REPLAY_SPI_HZ)));
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &r->next, NULL);
+    }
+    return 1;
+}
+
+static int _replay_resync(LeptonTransport *t)
+{
+    ReplayTransport *r = (ReplayTransport *)t;
+    if (r->rate == LEPTON_REPLAY_REALTIME)
+    {
+        usleep(300000);
+        clock_gettime(CLOCK_MONOTONIC, &r->next);
+    }
+    return 1;
+}
+
+static void _replay_close(LeptonTransport *t)
+{
+    ReplayTransport *r = (ReplayTransport *)t;
+    fclose(r->fp);
+    free(r);
+}
+
+LeptonTransport *lepton_replay_open(const char *path, int rate)
+{
+    struct stat st;
+    ReplayTransport *r = calloc(1, sizeof(*r));
+    if (r == NULL)
+    {
+        perror("calloc(): replay transport");
+        return NULL;
+    }
+    r->base.name = "replay";
+    r->base.transfer = _replay_transfer;
+    r->base.resync = _replay_resync;
+    r->base.close = _replay_close;
+    r->rate = rate;
+    r->fp = fopen(path, "rb");
+    if (r->fp == NULL)
+    {
+        perror("fopen(): replay 파일을 열 수 없습니다");
+        free(r);
+        return NULL;
+    }
+    if (fstat(fileno(r->fp), &st) < 0 || st.st_size < VOSPI_FRAME_SIZE)
+    {
+        printf("replay 파일에 VoSPI 패킷(%d바이트)이 하나도 없습니다: %s\n", VOSPI_FRAME_SIZE, path);
+        _replay_close(&r->base);
+        return NULL;
+    }
+    if (st.st_size % VOSPI_FRAME_SIZE != 0)
+        printf("replay 파일 끝의 잘린 패킷 %ld바이트는 재생하지 않습니다: %s\n",
+               (long)(st.st_size % VOSPI_FRAME_SIZE), path);
+    clock_gettime(CLOCK_MONOTONIC, &r->next);
+    return &r->base;
+}
+
+
+// ------------------ record 백엔드 ------------------ //
+typedef struct {
+    LeptonTransport base;
+    LeptonTransport *inner;
+    FILE *fp;
+} RecordTransport;
+
+static int _record_transfer(LeptonTransport *t, uint8_t *rx, int packets)
+{
+    RecordTransport *r = (RecordTransport *)t;
+    int ret = r->inner->transfer(r->inner, rx, packets);
+    if (ret > 0)
+    {
+        fwrite(rx, VOSPI_FRAME_SIZE, (size_t)packets, r->fp);
+    }
+    return ret;
+}
+
+static int _record_resync(LeptonTransport *t)
+{
+    RecordTransport *r = (RecordTransport *)t;
+    return r->inner->resync(r->inner);
+}
+
+static void _record_close(LeptonTransport *t)
+{
+    RecordTransport *r = (RecordTransport *)t;
+    fclose(r->fp);
+    r->inner->close(r->inner);
+    free(r);
+}
+
+LeptonTransport *lepton_record_open(LeptonTransport *inner, const char *path)
+{
+    RecordTransport *r;
+
+    if (inner == NULL)
+        return NULL;
+    r = calloc(1, sizeof(*r));
+    if (r == NULL)
+    {
+        perror("calloc(): record transport");
+        inner->close(inner);
+        return NULL;
+    }
+    r->base.name = "record";
+    r->base.transfer = _record_transfer;
+    r->base.resync = _record_resync;
+    r->base.close = _record_close;
+    r->inner = inner;
+    r->fp = fopen(path, "wb");
+    if (r->fp == NULL)
+    {
+        perror("fopen(): record 파일을 열 수 없습니다");
+        free(r);
+        inner->close(inner);
+        return NULL;
+    }
+    // 로봇에서는 보통 Ctrl-C로 끝내므로 stdio 버퍼에 남은 패킷을 잃지 않도록 바로 쓴다 (전송 1번 = write 1번)
+    setvbuf(r->fp, NULL, _IONBF, 0);
+    return &r->base;
+}
@@ -1,80 +1,297 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
 #include <pthread.h>
 
 #include "../include/lepton.h"
 #include "../include/ringbuffer.h"
+#include "../include/latency_hist.h"
+#include "../include/network.h"
 
 
-LeptonRingBuffer lepton_ring_buffer = { .head = 0, .tail = 0, .count = 0 };
-pthread_mutex_t buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const char *lepton_replay_path = NULL;   // 지정하면 spidev 대신 녹화 파일을 재생
+static const char *lepton_record_path = NULL;   // 지정하면 받은 VoSPI 패킷을 그대로 녹화 (-r로 재생)
+static int transmit_polling = 0;                 // 1: 예전 방식(비어 있으면 37ms sleep)으로 소비 (지연 비교용)
+static const char *mic_file_path = NULL;         // 지정하면 arecord 대신 PCM 파일을 실시간 속도로 반복 (로봇 마이크)
+
+#define LATENCY_REPORT_FRAMES 270                // 약 10초마다 capture->dequeue 지연 출력
+
+// 생산자(lepton_capture_thread)와 소비자(lepton_transmit_thread)가 하나씩이므로 mutex 없이 사용한다.
+LeptonRingBuffer lepton_ring_buffer;
+// 열화상 프레임 바이너리 스트림 (프레임 전송은 transmit thread, 새 접속은 control thread의 epoll loop)
+ThermalServer thermal_server;
+// 명령/센서값(TCP 12345)과 음성(UDP 5000). server.py를 대신한다.
+ControlServer control_server;
+
+// -r은 AUDIO_RATE (JetDash가 여기에 맞춰 리샘플). 지터 버퍼가 10ms마다 쓰므로 장치 버퍼는 40ms면 충분하다
+// (기본값은 장치에 따라 수백 ms라 양방향 대화 지연이 그만큼 늘어난다, docs/Protocol.md 4.5)
+#define AUDIO_PLAYER_CMD "aplay -q -f S16_LE -r 8000 -c 1 -t raw --period-time=10000 --buffer-time=40000"
+// 로봇 마이크 -> 운영자. period를 짧게 잡아야 arecord가 오래 모아서 내보내지 않는다
+#define AUDIO_CAPTURE_PERIOD_MS 10
+#define AUDIO_RECORDER_CMD "arecord -q -f S16_LE -r 8000 -c 1 -t raw --period-time=10000 --buffer-time=40000"
+
+// ring buffer가 가득 차서 버린 프레임 (정책에 따라 새 프레임 또는 오래된 프레임)
+static unsigned long ring_drops(void)
+{
+    LeptonRingBufferDrops drops;
+    lepton_ringbuffer_get_drops(&lepton_ring_buffer, &drops);
+    return drops.dropped_newest + drops.dropped_oldest;
+}
 
 // 카메라에서 이미지를 캡쳐해서 ring buffer에 이미지를 저장하는 것 까지 수행.
+// VoSPI 패킷은 ring buffer 슬롯에 바로 디코딩된다.
 static void* lepton_capture_thread(void* arg) {
-    int lepton_fd = init_lepton();
+    LeptonTransport *lepton;
     int ret;
-    uint16_t pure_img[LEPTON_HEIGHT][LEPTON_WIDTH];
+    uint16_t (*slot)[LEPTON_WIDTH];
+    // 버퍼가 가득 찼을 때도 VoSPI 동기를 잃지 않도록 프레임은 계속 읽어서 여기에 버린다.
+    static uint16_t overflow_frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+
+    if (lepton_replay_path)
+        lepton = lepton_replay_open(lepton_replay_path, LEPTON_REPLAY_REALTIME);
+    else
+        lepton = lepton_spidev_open(LEPTON_SPI_DEVICE);
+    if (lepton_record_path)
+        lepton = lepton_record_open(lepton, lepton_record_path);
+    if (init_lepton(lepton) < 0)
+    {
+        printf("Lepton 초기화 오류\n");
+        cleanup_lepton(lepton);     // 열린 spidev fd / replay 파일을 닫는다 (NULL이면 아무것도 안 함)
+        return NULL;
+    }
+    // 실제 센서는 27Hz로 프레임을 내보내므로 프레임 사이에는 discard 패킷을 읽지 않고 잠든다.
+    lepton_set_pacing(lepton_replay_path == NULL);
+
     while(1)
     {
-        ret = lepton_capture(lepton_fd);
+        slot = lepton_ringbuffer_reserve(&lepton_ring_buffer);
+        if (slot == NULL)
+        {
+            // 버퍼가 가득 참: 버린 수는 dropped_newest로 세고 lepton_report_stats()가 1초마다 출력
+            lepton_capture(lepton, overflow_frame);
+            lepton_report_stats(ring_drops());
+            continue;
+        }
+
+        // 캡처에 실패하면 commit하지 않으므로 같은 슬롯을 다음 캡처에 다시 쓴다.
+        ret = lepton_capture(lepton, slot);
         if (ret < 0) 
         {
             printf("Lepton 이미지 캡처 오류\n");
             continue;
         }
-        get_image(pure_img);
-        pthread_mutex_lock(&buffer_mutex);
-        ret = lepton_ringbuffer_enqueue(&lepton_ring_buffer, pure_img);
-        pthread_mutex_unlock(&buffer_mutex);
+        if (ret == 0)
+        {
+            lepton_report_stats(ring_drops());
+            continue; // 시간 초과: resync 했으므로 다시 읽는다
+        }
+        lepton_ringbuffer_commit(&lepton_ring_buffer);
+        lepton_report_stats(ring_drops());
 
-        //DEBUG-start
+#ifdef DEBUG
         printf("enqueue 완료 : 이미지 프린트\n");
-        print_image(lepton_fd);
-        //DEBUG-end
+        print_image();
+#endif
+    }
+    cleanup_lepton(lepton);
+}
+
+static void* lepton_transmit_thread(void* arg) {
+    const uint16_t (*transmit_image)[LEPTON_WIDTH];
+    LatencyHist latency;
+    uint32_t seq = 0;
+    uint64_t captured_ns;
 
-        if (!ret)
+    latency_hist_reset(&latency);
+    while(1)
+    {
+        if (transmit_polling)
+        {
+            transmit_image = lepton_ringbuffer_acquire(&lepton_ring_buffer);
+            if (transmit_image == NULL)
+            {
+                usleep(37000);   // 27Hz에 맞춰서 sleep
+                continue;
+            }
+        }
+        else
         {
-            continue; // 버퍼가 가득 참
+            // 프레임이 commit되는 즉시 깨어난다.
+            transmit_image = lepton_ringbuffer_acquire_wait(&lepton_ring_buffer, 1000);
+            if (transmit_image == NULL)
+            {
+                continue;
+            }
+        }
+        captured_ns = lepton_ringbuffer_commit_time(&lepton_ring_buffer);
+        latency_hist_add(&latency, latency_now_ns() - captured_ns);
+        // 슬롯을 그대로 보내고 release
+        thermal_server_send_frame(&thermal_server, transmit_image, seq++, captured_ns);
+
+        lepton_ringbuffer_release(&lepton_ring_buffer);
+
+        if (latency.count >= LATENCY_REPORT_FRAMES)
+        {
+            LeptonRingBufferDrops drops;
+            latency_hist_print(&latency, transmit_polling ? "capture->dequeue (polling)" : "capture->dequeue");
+            latency_hist_reset(&latency);
+            lepton_ringbuffer_get_drops(&lepton_ring_buffer, &drops);
+            printf("RingBuffer drops (%s): newest=%lu oldest=%lu\n",
+                   lepton_ringbuffer_policy_name(lepton_ring_buffer.policy),
+                   drops.dropped_newest, drops.dropped_oldest);
+            if (thermal_server.bytes_sent > 0)
+            {
+                printf("[thermal] %lu frames, 압축률 %.2f\n", thermal_server.frames_sent,
+                       (double)thermal_server.raw_bytes / thermal_server.bytes_sent);
+            }
         }
-        usleep(37000); // 약 27Hz, 꼭 필요한지 검토 필요.
     }
-    cleanup_lepton(lepton_fd);
 }
 
-static void decompress_image(uint16_t flatten_image[], uint16_t original_image[][LEPTON_WIDTH])
+// 가짜 센서값 (나중에 sensor.c로 실제 센서 연결)
+static void read_sensors(ControlTelemetry *t, void *arg)
 {
-    memcpy(flatten_image, &original_image[0][0], (size_t)(sizeof(uint16_t)*LEPTON_HEIGHT*LEPTON_WIDTH));
+    (void)arg;
+    t->co_ppm = rand() % 51;
+    t->obstacle_cm = 10 + rand() % 191;
+    t->rollover = (rand() % 10 == 0) ? rand() % 2 : 0;
 }
 
-static void* lepton_transmit_thread(void* arg) {
-    int ret;
-    uint16_t transmit_image[LEPTON_HEIGHT][LEPTON_WIDTH];
-    uint16_t flatten_image[LEPTON_HEIGHT * LEPTON_WIDTH];
-    while(1)
+// 명령/센서값/음성/열화상 접속을 epoll loop 하나로 처리한다.
+static void* control_thread(void* arg) {
+    control_server_run(&control_server);
+    return NULL;
+}
+
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s [-r replay.vospi] [-R out.vospi] [-A mic.raw] [-d depth] [-o policy] [-c codec] [-t hz] [-b ms] [-m] [-H] [-P]\n", prog);
+    printf("  -r  spidev 대신 녹화된 VoSPI 파일 재생\n");
+    printf("  -R  받은 VoSPI 패킷을 파일로 녹화 (-r로 재생)\n");
+    printf("  -A  arecord 대신 PCM 파일(S16_LE, %dHz, mono)을 로봇 마이크로 반복 재생\n", AUDIO_RATE);
+    printf("  -d  ring buffer 슬롯 수 (2의 거듭제곱으로 올림, 기본 %d)\n", RINGBUFFER_DEFAULT_CAPACITY);
+    printf("  -o  가득 찼을 때 정책: drop-newest(기본), drop-oldest, latest(가장 최근 프레임만, 저지연)\n");
+    printf("  -c  열화상 스트림 payload: delta(무손실 압축, 기본), raw\n");
+    printf("  -t  센서값 전송 주기 (Hz, 기본 %d)\n", CONTROL_TELEMETRY_HZ);
+    printf("  -b  센서값을 모아 보내는 시간 (ms, 0 = 매번, 기본 %d)\n", CONTROL_TELEMETRY_BATCH_MS);
+    printf("  -m  ring buffer 메모리 mlock\n");
+    printf("  -H  ring buffer를 hugepage로 할당\n");
+    printf("  -P  transmit thread를 예전 polling(37ms sleep) 방식으로 실행 (지연 비교용)\n");
+}
+
+int main(int argc, char *argv[]){
+    int opt;
+    size_t depth = RINGBUFFER_DEFAULT_CAPACITY;
+    int rb_flags = 0;
+    int rb_policy = RINGBUFFER_DROP_NEWEST;
+    int thermal_format = THERMAL_FORMAT_DELTA_PACK;
+    double telemetry_hz = CONTROL_TELEMETRY_HZ;
+    int telemetry_batch_ms = CONTROL_TELEMETRY_BATCH_MS;
+    FILE *audio_player;
+    FILE *audio_recorder = NULL;
+    int mic_file = -1;
+
+    while ((opt = getopt(argc, argv, "r:R:A:d:o:c:t:b:mHPh")) != -1)
     {
-        pthread_mutex_lock(&buffer_mutex);
-        ret = lepton_ringbuffer_dequeue(&lepton_ring_buffer, transmit_image);
-        pthread_mutex_unlock(&buffer_mutex);
-        if (ret == 0)
+        switch (opt)
         {
-            usleep(37000);   // 27Hz에 맞춰서 sleep
-            continue;
+        case 'r': lepton_replay_path = optarg; break;
+        case 'R': lepton_record_path = optarg; break;
+        case 'A': mic_file_path = optarg; break;
+        case 'd': depth = (size_t)strtoul(optarg, NULL, 0); break;
+        case 'o':
+            rb_policy = lepton_ringbuffer_policy_from_name(optarg);
+            if (rb_policy < 0)
+            {
+                print_usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'c':
+            thermal_format = thermal_format_from_name(optarg);
+            if (thermal_format < 0)
+            {
+                print_usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 't': telemetry_hz = atof(optarg); break;
+        case 'b': telemetry_batch_ms = atoi(optarg); break;
+        case 'm': rb_flags |= RINGBUFFER_MLOCK; break;
+        case 'H': rb_flags |= RINGBUFFER_HUGEPAGE; break;
+        case 'P': transmit_polling = 1; break;
+        default:
+            print_usage(argv[0]);
+            return 1;
         }
-        //TODO MQTT로 transmit_image 바이트 배열 전송
-        decompress_image(flatten_image, transmit_image);   
     }
-}
 
-int main(void){
-    int ret = 0;
-    
+    if (lepton_ringbuffer_init(&lepton_ring_buffer, depth, rb_flags) < 0)
+    {
+        return 1;
+    }
+    lepton_ringbuffer_set_policy(&lepton_ring_buffer, rb_policy);
+    lepton_ringbuffer_print_budget(&lepton_ring_buffer);
+    if (thermal_server_open(&thermal_server, THERMAL_TCP_PORT, THERMAL_UDP_PORT) < 0)
+    {
+        lepton_ringbuffer_destroy(&lepton_ring_buffer);
+        return 1;
+    }
+    thermal_server_set_format(&thermal_server, thermal_format);
+    if (control_server_open(&control_server, CONTROL_TCP_PORT, AUDIO_UDP_PORT, &thermal_server) < 0)
+    {
+        thermal_server_close(&thermal_server);
+        lepton_ringbuffer_destroy(&lepton_ring_buffer);
+        return 1;
+    }
+    control_server_set_telemetry(&control_server, telemetry_hz, telemetry_batch_ms, read_sensors, NULL);
+
+    // aplay가 죽어도 write()가 EPIPE로 실패할 뿐 프로세스가 끝나지 않도록
+    signal(SIGPIPE, SIG_IGN);
+    audio_player = popen(AUDIO_PLAYER_CMD, "w");
+    if (audio_player)
+        control_server_set_audio_sink(&control_server, fileno(audio_player), AUDIO_RATE);
+    else
+        printf("에러: '%s' 실행 실패, 음성은 버립니다\n", AUDIO_PLAYER_CMD);
+
+    // 로봇 마이크: 파일은 프레임 주기마다 읽으므로 캡처 버퍼 = 프레임 하나
+    if (mic_file_path)
+    {
+        mic_file = open(mic_file_path, O_RDONLY);
+        if (mic_file < 0 || control_server_set_audio_source(&control_server, mic_file, AUDIO_RATE, 1,
+                                                            AUDIO_SOURCE_FRAME_MS) < 0)
+            printf("에러: 마이크 파일 '%s'을 열 수 없습니다\n", mic_file_path);
+    }
+    else if ((audio_recorder = popen(AUDIO_RECORDER_CMD, "r")) == NULL ||
+             control_server_set_audio_source(&control_server, fileno(audio_recorder), AUDIO_RATE, 0,
+                                             AUDIO_CAPTURE_PERIOD_MS) < 0)
+    {
+        printf("에러: '%s' 실행 실패, 로봇 마이크는 보내지 않습니다\n", AUDIO_RECORDER_CMD);
+    }
+
     pthread_t lepton_capture_thread_id;
     pthread_t lepton_transmit_thread_id;
+    pthread_t control_thread_id;
+    pthread_create(&control_thread_id, NULL, control_thread, NULL);
     pthread_create(&lepton_capture_thread_id, NULL, lepton_capture_thread, NULL);
     pthread_create(&lepton_transmit_thread_id, NULL, lepton_transmit_thread, NULL);
 
     pthread_join(lepton_capture_thread_id, NULL);
     pthread_join(lepton_transmit_thread_id, NULL);
+    control_server_stop(&control_server);
+    pthread_join(control_thread_id, NULL);
+    control_server_close(&control_server);
+    if (audio_player)
+        pclose(audio_player);
+    if (audio_recorder)
+        pclose(audio_recorder);
+    if (mic_file >= 0)
+        close(mic_file);
+    thermal_server_close(&thermal_server);
+    lepton_ringbuffer_destroy(&lepton_ring_buffer);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,1691 @@
+#include <stdio.h>          // printf(), perror()
+#include <stdint.h>
+#include <inttypes.h>       // PRId64, PRIu64
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>          // fcntl(), O_NONBLOCK
+#include <unistd.h>         // close()
+#include <arpa/inet.h>      // htons(), inet_ntoa()
+#include <netinet/in.h>
+#include <netinet/tcp.h>    // TCP_NODELAY
+#include <linux/errqueue.h> // struct sock_extended_err
+#include <sys/socket.h>
+#include <sys/uio.h>        // struct iovec
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "../include/network.h"
+#include "../include/latency_hist.h"   // latency_now_ns()
+
+// payload는 메모리의 uint16_t 배열을 그대로 보내므로 little-endian 호스트(Jetson, x86)만 지원한다.
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "thermal stream payload는 little-endian 호스트를 가정한다"
+#endif
+
+#define FRAME_BYTES (sizeof(uint16_t) * LEPTON_HEIGHT * LEPTON_WIDTH)
+
+
+// ------------------ 헤더 직렬화 ------------------ //
+static void _put16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void _put32(uint8_t *p, uint32_t v) { _put16(p, (uint16_t)v); _put16(p + 2, (uint16_t)(v >> 16)); }
+static void _put64(uint8_t *p, uint64_t v) { _put32(p, (uint32_t)v); _put32(p + 4, (uint32_t)(v >> 32)); }
+static uint16_t _get16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t _get32(const uint8_t *p) { return _get16(p) | (uint32_t)_get16(p + 2) << 16; }
+static uint64_t _get64(const uint8_t *p) { return _get32(p) | (uint64_t)_get32(p + 4) << 32; }
+
+void thermal_header_encode(const ThermalFrameHeader *h, uint8_t out[THERMAL_HEADER_SIZE])
+{
+    _put32(out + 0, h->magic);
+    out[4] = h->version;
+    out[5] = h->format;
+    _put16(out + 6, h->header_size);
+    _put32(out + 8, h->seq);
+    _put64(out + 12, h->timestamp_ns);
+    _put16(out + 20, h->width);
+    _put16(out + 22, h->height);
+    _put16(out + 24, h->min);
+    _put16(out + 26, h->max);
+    _put32(out + 28, h->payload_size);
+}
+
+int thermal_header_decode(ThermalFrameHeader *h, const uint8_t in[THERMAL_HEADER_SIZE])
+{
+    h->magic = _get32(in + 0);
+    h->version = in[4];
+    h->format = in[5];
+    h->header_size = _get16(in + 6);
+    h->seq = _get32(in + 8);
+    h->timestamp_ns = _get64(in + 12);
+    h->width = _get16(in + 20);
+    h->height = _get16(in + 22);
+    h->min = _get16(in + 24);
+    h->max = _get16(in + 26);
+    h->payload_size = _get32(in + 28);
+    if (h->magic != THERMAL_MAGIC || h->version != THERMAL_PROTO_VERSION ||
+        h->header_size < THERMAL_HEADER_SIZE)
+    {
+        return -1;
+    }
+    return 1;
+}
+
+
+// ------------------ 서버 ------------------ //
+static int _set_nonblock(int fd)
+{
+    int fl = fcntl(fd, F_GETFL, 0);
+    if (fl < 0 || fcntl(fd, F_SETFL, fl | O_NONBLOCK) < 0)
+        return -1;
+    return 1;
+}
+
+static int _open_socket(int type, uint16_t port, int backlog)
+{
+    int one = 1;
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, type, 0);
+    if (fd < 0)
+    {
+        perror("socket()");
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("bind()");
+        close(fd);
+        return -1;
+    }
+    if (type == SOCK_STREAM && listen(fd, backlog) < 0)
+    {
+        perror("listen()");
+        close(fd);
+        return -1;
+    }
+    if (_set_nonblock(fd) < 0)
+    {
+        perror("fcntl(): O_NONBLOCK");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int thermal_server_open(ThermalServer *s, uint16_t tcp_port, uint16_t udp_port)
+{
+    int one = 1;
+
+    memset(s, 0, sizeof(*s));
+    s->tcp_fd = s->udp_fd = -1;
+    s->format = THERMAL_FORMAT_DELTA_PACK;
+    pthread_mutex_init(&s->lock, NULL);
+    thermal_encoder_init(&s->encoder);
+    for (int i = 0; i < THERMAL_MAX_CLIENTS; i++)
+        s->clients[i] = -1;
+
+    if (tcp_port != 0 && (s->tcp_fd = _open_socket(SOCK_STREAM, tcp_port, THERMAL_MAX_CLIENTS)) < 0)
+        return -1;
+    if (udp_port != 0 && (s->udp_fd = _open_socket(SOCK_DGRAM, udp_port, 0)) < 0)
+    {
+        thermal_server_close(s);
+        return -1;
+    }
+    // connect하지 않은 UDP 소켓은 이 옵션이 있어야 ICMP port unreachable을 알려준다.
+    // 어느 구독자가 거부했는지는 error queue의 주소로 알 수 있다 (_drain_refused_peers()).
+    if (s->udp_fd >= 0)
+        setsockopt(s->udp_fd, IPPROTO_IP, IP_RECVERR, &one, sizeof(one));
+    printf("[thermal] TCP %u, UDP %u 대기중\n", tcp_port, udp_port);
+    return 1;
+}
+
+void thermal_server_close(ThermalServer *s)
+{
+    for (int i = 0; i < THERMAL_MAX_CLIENTS; i++)
+    {
+        if (s->clients[i] >= 0)
+            close(s->clients[i]);
+        s->clients[i] = -1;
+    }
+    for (int i = 0; i < s->n_new_clients; i++)
+        close(s->new_clients[i]);
+    s->n_new_clients = s->n_new_peers = 0;
+    if (s->tcp_fd >= 0)
+        close(s->tcp_fd);
+    if (s->udp_fd >= 0)
+        close(s->udp_fd);
+    s->tcp_fd = s->udp_fd = -1;
+    pthread_mutex_destroy(&s->lock);
+}
+
+void thermal_server_set_format(ThermalServer *s, int format)
+{
+    s->format = format;
+    thermal_encoder_force_keyframe(&s->encoder);
+}
+
+int thermal_format_from_name(const char *name)
+{
+    if (strcmp(name, "raw") == 0)
+        return THERMAL_FORMAT_RAW16;
+    if (strcmp(name, "delta") == 0)
+        return THERMAL_FORMAT_DELTA_PACK;
+    return -1;
+}
+
+static void _accept_clients(ThermalServer *s)
+{
+    struct timeval tv = { 0, THERMAL_SEND_TIMEOUT_MS * 1000 };
+    int one = 1;
+
+    for (;;)
+    {
+        int fd = accept(s->tcp_fd, NULL, NULL);
+        if (fd < 0)
+            return;     // EAGAIN: 대기 중인 접속 없음
+
+        // 느린 클라이언트 때문에 transmit thread가 오래 막히지 않도록 전송 timeout을 둔다.
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        pthread_mutex_lock(&s->lock);
+        if (s->n_new_clients < THERMAL_MAX_CLIENTS)
+        {
+            s->new_clients[s->n_new_clients++] = fd;
+            fd = -1;
+        }
+        pthread_mutex_unlock(&s->lock);
+        if (fd >= 0)
+        {
+            printf("[thermal] 클라이언트가 너무 많아 접속을 거절합니다\n");
+            close(fd);
+        }
+    }
+}
+
+static int _same_peer(const struct sockaddr_in *a, const struct sockaddr_in *b)
+{
+    return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+// error queue에 쌓인 ICMP port unreachable을 읽고 그 주소의 구독자를 지울 것으로 표시한다 (lock을 잡고).
+// 실제로 지우는 것은 send_frame()이다 (udp_peers는 send_frame()이 lock 없이 읽으며 보낸다).
+// 큐가 남아 있으면 epoll이 EPOLLERR를 계속 알려주고, 소켓의 pending error 때문에
+// 다른 구독자에게 보내는 sendmsg()가 엉뚱하게 실패하므로 poll()과 send_frame() 양쪽에서 비운다.
+static void _drain_refused_peers(ThermalServer *s)
+{
+    for (;;)
+    {
+        struct sockaddr_in to;
+        uint8_t control[128];
+        struct msghdr msg;
+        struct cmsghdr *cm;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &to;
+        msg.msg_namelen = sizeof(to);
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(s->udp_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            return;     // EAGAIN: 큐가 비었다
+
+        for (cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            const struct sock_extended_err *ee = (const struct sock_extended_err *)CMSG_DATA(cm);
+            if (cm->cmsg_level != IPPROTO_IP || cm->cmsg_type != IP_RECVERR || ee->ee_errno != ECONNREFUSED)
+                continue;
+            for (int i = 0; i < s->udp_npeers; i++)
+            {
+                if (_same_peer(&s->udp_peers[i], &to))
+                    s->udp_seen_ns[i] = 0;
+            }
+            for (int i = 0; i < s->n_new_peers; i++)
+            {
+                if (_same_peer(&s->new_peers[i], &to))
+                    s->new_peers[i--] = s->new_peers[--s->n_new_peers];
+            }
+        }
+    }
+}
+
+// 이미 구독 중인 주소가 다시 보내면 구독 시각만 갱신한다 (THERMAL_UDP_PEER_TIMEOUT_S)
+static void _accept_udp_peers(ThermalServer *s)
+{
+    uint8_t buf[64];
+    struct sockaddr_in from;
+    socklen_t len = sizeof(from);
+
+    for (;;)
+    {
+        int known = 0;
+        if (recvfrom(s->udp_fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &len) < 0)
+        {
+            // IP_RECVERR: 보낸 프레임의 ICMP 오류가 여기서 먼저 보고될 수 있다.
+            if (errno == ECONNREFUSED)
+                continue;
+            // EAGAIN: 대기 중인 구독 요청 없음. error queue도 비워야 epoll이 다시 깨우지 않는다
+            pthread_mutex_lock(&s->lock);
+            _drain_refused_peers(s);
+            pthread_mutex_unlock(&s->lock);
+            return;
+        }
+        len = sizeof(from);
+        pthread_mutex_lock(&s->lock);
+        for (int i = 0; i < s->udp_npeers; i++)
+        {
+            if (_same_peer(&s->udp_peers[i], &from))
+            {
+                s->udp_seen_ns[i] = latency_now_ns();
+                known = 1;
+            }
+        }
+        for (int i = 0; i < s->n_new_peers; i++)
+            known |= _same_peer(&s->new_peers[i], &from);
+        if (!known && s->udp_npeers + s->n_new_peers < THERMAL_MAX_CLIENTS)
+        {
+            s->new_peers[s->n_new_peers++] = from;
+            printf("[thermal] UDP 구독 %s:%u\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+void thermal_server_poll(ThermalServer *s)
+{
+    if (s->tcp_fd >= 0)
+        _accept_clients(s);
+    if (s->udp_fd >= 0)
+        _accept_udp_peers(s);
+}
+
+// udp_peers[i]를 지운다. lock을 잡고 불러야 한다 (poll()이 udp_peers를 읽는다)
+static void _remove_udp_peer(ThermalServer *s, int i, const char *why)
+{
+    printf("[thermal] UDP 구독 끊김 %s:%u (%s)\n", inet_ntoa(s->udp_peers[i].sin_addr),
+           ntohs(s->udp_peers[i].sin_port), why);
+    s->udp_npeers--;
+    s->udp_peers[i] = s->udp_peers[s->udp_npeers];
+    s->udp_seen_ns[i] = s->udp_seen_ns[s->udp_npeers];
+    s->clients_dropped++;
+}
+
+// 포트가 닫혔거나(_drain_refused_peers()) 구독 요청이 끊긴 UDP 구독자를 지운다 (lock을 잡고, send_frame()에서만)
+static void _expire_udp_peers(ThermalServer *s, uint64_t now)
+{
+    for (int i = s->udp_npeers - 1; i >= 0; i--)
+    {
+        if (s->udp_seen_ns[i] == 0)
+            _remove_udp_peer(s, i, "ECONNREFUSED");
+        else if (now - s->udp_seen_ns[i] > THERMAL_UDP_PEER_TIMEOUT_S * 1000000000ULL)
+            _remove_udp_peer(s, i, "구독 요청 없음");
+    }
+}
+
+// poll()이 받아둔 클라이언트를 전송 목록으로 옮기고, 구독 요청이 끊긴 UDP 구독자를 지운다 (send_frame()에서만)
+static void _adopt_new_clients(ThermalServer *s)
+{
+    int adopted = 0;
+    uint64_t now = latency_now_ns();
+
+    pthread_mutex_lock(&s->lock);
+    if (s->udp_fd >= 0)
+        _drain_refused_peers(s);
+    _expire_udp_peers(s, now);
+    for (int n = 0; n < s->n_new_clients; n++)
+    {
+        int slot = -1;
+        for (int i = 0; i < THERMAL_MAX_CLIENTS; i++)
+        {
+            if (s->clients[i] < 0)
+            {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0)
+        {
+            printf("[thermal] 클라이언트가 너무 많아 접속을 거절합니다\n");
+            close(s->new_clients[n]);
+            continue;
+        }
+        s->clients[slot] = s->new_clients[n];
+        printf("[thermal] TCP 클라이언트 접속 (%d)\n", slot);
+        adopted++;
+    }
+    for (int n = 0; n < s->n_new_peers; n++)
+    {
+        s->udp_seen_ns[s->udp_npeers] = now;
+        s->udp_peers[s->udp_npeers++] = s->new_peers[n];
+        adopted++;
+    }
+    s->n_new_clients = s->n_new_peers = 0;
+    pthread_mutex_unlock(&s->lock);
+
+    if (adopted > 0)
+        thermal_encoder_force_keyframe(&s->encoder);
+}
+
+// iov 전체를 보낸다. 중간에 끊기면 스트림 경계가 깨지므로 실패로 처리한다.
+static int _send_all(int fd, struct iovec *iov, int iovcnt)
+{
+    struct msghdr msg;
+
+    while (iovcnt > 0)
+    {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len)
+        {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 1;
+}
+
+static void _frame_min_max(const uint16_t (*frame)[LEPTON_WIDTH], uint16_t *min, uint16_t *max)
+{
+    const uint16_t *p = frame[0];
+    uint16_t lo = 0xffff, hi = 0;
+
+    for (size_t i = 0; i < LEPTON_HEIGHT * LEPTON_WIDTH; i++)
+    {
+        lo = (p[i] < lo) ? p[i] : lo;
+        hi = (p[i] > hi) ? p[i] : hi;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+int thermal_server_send_frame(ThermalServer *s, const uint16_t (*frame)[LEPTON_WIDTH],
+                              uint32_t seq, uint64_t timestamp_ns)
+{
+    ThermalFrameHeader h;
+    uint8_t hdr[THERMAL_HEADER_SIZE];
+    const void *payload = frame[0];
+    int delivered = 0;
+    int refused = 0;
+
+    if (!s->event_driven)
+        thermal_server_poll(s);
+    _adopt_new_clients(s);
+    if (s->udp_npeers == 0)
+    {
+        int i;
+        for (i = 0; i < THERMAL_MAX_CLIENTS && s->clients[i] < 0; i++)
+            ;
+        if (i == THERMAL_MAX_CLIENTS)
+            return 0;   // 받을 클라이언트가 없으면 압축도 하지 않는다
+    }
+
+    h.magic = THERMAL_MAGIC;
+    h.version = THERMAL_PROTO_VERSION;
+    h.format = (uint8_t)s->format;
+    h.header_size = THERMAL_HEADER_SIZE;
+    h.seq = seq;
+    h.timestamp_ns = timestamp_ns;
+    h.width = LEPTON_WIDTH;
+    h.height = LEPTON_HEIGHT;
+    h.payload_size = (uint32_t)FRAME_BYTES;
+    _frame_min_max(frame, &h.min, &h.max);
+    if (s->format == THERMAL_FORMAT_DELTA_PACK)
+    {
+        h.payload_size = (uint32_t)thermal_encode(&s->encoder, frame, s->encoded);
+        payload = s->encoded;
+    }
+    thermal_header_encode(&h, hdr);
+
+    for (int i = 0; i < THERMAL_MAX_CLIENTS; i++)
+    {
+        struct iovec iov[2] = {
+            { hdr, sizeof(hdr) },
+            { (void *)payload, h.payload_size },
+        };
+        if (s->clients[i] < 0)
+            continue;
+        if (_send_all(s->clients[i], iov, 2) < 0)
+        {
+            printf("[thermal] TCP 클라이언트 끊김 (%d)\n", i);
+            close(s->clients[i]);
+            s->clients[i] = -1;
+            s->clients_dropped++;
+            continue;
+        }
+        s->bytes_sent += sizeof(hdr) + h.payload_size;
+        delivered++;
+    }
+
+    for (int i = 0; i < s->udp_npeers; i++)
+    {
+        struct iovec iov[2] = {
+            { hdr, sizeof(hdr) },
+            { (void *)payload, h.payload_size },
+        };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &s->udp_peers[i];
+        msg.msg_namelen = sizeof(s->udp_peers[i]);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+        // 프레임 하나 = datagram 하나. 소켓 버퍼가 차면 그 프레임은 그냥 버린다.
+        // (DELTA_PACK은 다음 keyframe까지 클라이언트가 복원하지 못한다)
+        if (sendmsg(s->udp_fd, &msg, MSG_DONTWAIT) < 0)
+        {
+            // ECONNREFUSED는 앞서 보낸 datagram에 대한 ICMP 응답이라 이 구독자가 원인이라는 보장이 없다.
+            // 어느 구독자인지는 error queue에 있으므로 루프가 끝난 뒤 그걸 보고 지운다.
+            refused |= (errno == ECONNREFUSED);
+            continue;
+        }
+        s->bytes_sent += sizeof(hdr) + h.payload_size;
+        delivered++;
+    }
+    if (refused)
+    {
+        pthread_mutex_lock(&s->lock);
+        _drain_refused_peers(s);
+        _expire_udp_peers(s, latency_now_ns());
+        pthread_mutex_unlock(&s->lock);
+    }
+
+    if (delivered > 0)
+    {
+        s->frames_sent++;
+        s->raw_bytes += FRAME_BYTES;
+    }
+    return delivered;
+}
+
+
+// ------------------ 제어 채널 (TCP 12345 / UDP 5000) ------------------ //
+
+// epoll_event.data.u32: 0 ~ CONTROL_MAX_CLIENTS-1은 클라이언트 번호, 그 위는 소켓 종류
+enum {
+    EV_CONTROL_LISTEN = CONTROL_MAX_CLIENTS,
+    EV_AUDIO,
+    EV_TIMER,
+    EV_WAKE,
+    EV_THERMAL,
+    EV_PLAYOUT,
+    EV_CAPTURE,         // 로봇 마이크 파이프 또는 파일 읽기 timer
+};
+
+#define EPOLL_BATCH 32
+
+// 명령 줄 JSON 스캐너. 줄을 복사하지 않고 그 자리에서 필요한 키만 읽는다.
+// (JetDash telemetryparser.cpp와 같은 방식, 모르는 값은 문법만 확인하고 건너뜀)
+#define JSON_MAX_DEPTH 16
+
+typedef struct {
+    const char *p;
+    const char *end;
+} JsonCursor;
+
+static void _json_ws(JsonCursor *c)
+{
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\r' || *c->p == '\n'))
+        c->p++;
+}
+
+static int _json_eat(JsonCursor *c, char ch)
+{
+    _json_ws(c);
+    if (c->p < c->end && *c->p == ch)
+    {
+        c->p++;
+        return 1;
+    }
+    return 0;
+}
+
+static int _json_peek(JsonCursor *c, char ch)
+{
+    _json_ws(c);
+    return c->p < c->end && *c->p == ch;
+}
+
+// 따옴표 안쪽 범위 (escape는 풀지 않음)
+static int _json_string(JsonCursor *c, const char **s, size_t *len)
+{
+    if (!_json_eat(c, '"'))
+        return 0;
+    *s = c->p;
+    while (c->p < c->end && *c->p != '"')
+    {
+        if (*c->p == '\\' && c->p + 1 < c->end)
+            c->p++;
+        c->p++;
+    }
+    if (c->p >= c->end)
+        return 0;
+    *len = (size_t)(c->p - *s);
+    c->p++;
+    return 1;
+}
+
+static int _json_equals(const char *s, size_t len, const char *lit)
+{
+    return strlen(lit) == len && memcmp(s, lit, len) == 0;
+}
+
+// 정수부만 쓴다. 소수부/지수가 있거나 |v| >= 10^18이면 *integral = 0
+static int _json_number(JsonCursor *c, int64_t *v, int *integral)
+{
+    const int64_t limit = 1000000000000000000LL;
+    int64_t acc = 0;
+    int neg;
+
+    _json_ws(c);
+    neg = c->p < c->end && *c->p == '-';
+    if (neg)
+        c->p++;
+    if (c->p >= c->end || *c->p < '0' || *c->p > '9')
+        return 0;
+    *integral = 1;
+    while (c->p < c->end && *c->p >= '0' && *c->p <= '9')
+    {
+        int d = *c->p++ - '0';
+        if (acc < limit)
+            acc = acc * 10 + d;
+    }
+    if (acc >= limit)
+        *integral = 0;
+    if (c->p < c->end && *c->p == '.')
+    {
+        c->p++;
+        if (c->p >= c->end || *c->p < '0' || *c->p > '9')
+            return 0;
+        while (c->p < c->end && *c->p >= '0' && *c->p <= '9')
+            *integral &= *c->p++ == '0';
+    }
+    if (c->p < c->end && (*c->p == 'e' || *c->p == 'E'))
+    {
+        c->p++;
+        if (c->p < c->end && (*c->p == '+' || *c->p == '-'))
+            c->p++;
+        if (c->p >= c->end || *c->p < '0' || *c->p > '9')
+            return 0;
+        while (c->p < c->end && *c->p >= '0' && *c->p <= '9')
+            c->p++;
+        *integral = 0;
+    }
+    *v = neg ? -acc : acc;
+    return 1;
+}
+
+static int _json_literal(JsonCursor *c, const char *lit)
+{
+    size_t n = strlen(lit);
+    _json_ws(c);
+    if ((size_t)(c->end - c->p) < n || memcmp(c->p, lit, n) != 0)
+        return 0;
+    c->p += n;
+    return 1;
+}
+
+// 객체 멤버 하나씩: '{'를 먹은 뒤 first = 1로 시작한다.
+// 키를 읽고 ':'까지 먹었으면 1, '}'로 끝났으면 0, 문법 오류 -1. 1이면 호출한 쪽이 값을 읽거나 건너뛰어야 한다.
+static int _json_member(JsonCursor *c, int *first, const char **key, size_t *len)
+{
+    if (_json_eat(c, '}'))
+        return 0;
+    if (!*first && !_json_eat(c, ','))
+        return -1;
+    *first = 0;
+    if (!_json_string(c, key, len) || !_json_eat(c, ':'))
+        return -1;
+    return 1;
+}
+
+static int _json_skip(JsonCursor *c, int depth)
+{
+    const char *s;
+    size_t len;
+    int64_t v;
+    int integral, first = 1, r;
+
+    if (depth > JSON_MAX_DEPTH)
+        return 0;
+    _json_ws(c);
+    if (c->p >= c->end)
+        return 0;
+    switch (*c->p)
+    {
+    case '"':
+        return _json_string(c, &s, &len);
+    case '{':
+        c->p++;
+        while ((r = _json_member(c, &first, &s, &len)) > 0)
+        {
+            if (!_json_skip(c, depth + 1))
+                return 0;
+        }
+        return r == 0;
+    case '[':
+        c->p++;
+        if (_json_eat(c, ']'))
+            return 1;
+        for (;;)
+        {
+            if (!_json_skip(c, depth + 1))
+                return 0;
+            if (_json_eat(c, ','))
+                continue;
+            return _json_eat(c, ']');
+        }
+    case 't': return _json_literal(c, "true");
+    case 'f': return _json_literal(c, "false");
+    case 'n': return _json_literal(c, "null");
+    default:
+        return _json_number(c, &v, &integral);
+    }
+}
+
+// 값을 문자열로: 문자열이면 따옴표 안쪽, 아니면 값 그대로 ("true", "1").
+// out에 안 들어가거나 객체/배열이면 ""
+static int _json_token(JsonCursor *c, char *out, size_t cap, int depth)
+{
+    const char *s;
+    size_t len;
+
+    out[0] = '\0';
+    if (_json_peek(c, '"'))
+    {
+        if (!_json_string(c, &s, &len))
+            return 0;
+    }
+    else
+    {
+        s = c->p;
+        if (!_json_skip(c, depth))
+            return 0;
+        len = (size_t)(c->p - s);
+        if (*s == '{' || *s == '[')
+            return 1;
+    }
+    if (len < cap)
+    {
+        memcpy(out, s, len);
+        out[len] = '\0';
+    }
+    return 1;
+}
+
+// 문자열 하나를 읽고 names[i]와 같으면 *mask의 i번째 비트를 켠다
+static int _json_name(JsonCursor *c, const char *const *names, int count, int *mask)
+{
+    const char *s;
+    size_t len;
+
+    if (!_json_string(c, &s, &len))
+        return 0;
+    for (int i = 0; i < count; i++)
+        *mask |= _json_equals(s, len, names[i]) << i;
+    return 1;
+}
+
+// "telemetry": "TLV" 또는 ["TLV", "JSON"] (문자열 하나나 배열)
+static int _json_names(JsonCursor *c, const char *const *names, int count, int *mask)
+{
+    if (_json_peek(c, '"'))
+        return _json_name(c, names, count, mask);
+    if (!_json_peek(c, '['))
+        return _json_skip(c, 2);
+    c->p++;
+    if (_json_eat(c, ']'))
+        return 1;
+    for (;;)
+    {
+        if (_json_peek(c, '"') ? !_json_name(c, names, count, mask) : !_json_skip(c, 3))
+            return 0;
+        if (_json_eat(c, ','))
+            continue;
+        return _json_eat(c, ']');
+    }
+}
+
+enum {
+    LINE_INVALID = -1,
+    LINE_OTHER = 0,
+    LINE_COMMAND,
+    LINE_HELLO,
+};
+
+// HELLO payload에서 클라이언트가 받을/보낼 수 있다고 알린 형식
+static const char *const telemetry_names[] = { "TLV" };
+static const char *const audio_names[] = { "PCM", "ADPCM" };     // 비트 번호 = AUDIO_CODEC_*
+
+typedef struct {
+    int telemetry;      // telemetry_names 비트
+    int audio;          // audio_names 비트 (운영자 -> 로봇)
+    int listen;         // audio_names 비트 (로봇 마이크 -> 운영자)
+    int64_t listen_port;
+} HelloRequest;
+
+// 키 순서와 상관없이 읽는다 (payload가 type보다 먼저 와도 됨)
+static int _parse_line(const char *line, const char *end, ControlCommand *cmd, HelloRequest *hello)
+{
+    JsonCursor c = { line, end };
+    const char *key, *s;
+    size_t len, n;
+    int first = 1, r, kind = LINE_OTHER;
+
+    cmd->seq = -1;
+    cmd->target[0] = cmd->value[0] = cmd->action[0] = '\0';
+    hello->telemetry = hello->audio = hello->listen = 0;
+    hello->listen_port = 0;
+
+    if (!_json_eat(&c, '{'))
+        return LINE_INVALID;
+    while ((r = _json_member(&c, &first, &key, &len)) > 0)
+    {
+        if (_json_equals(key, len, "type") && _json_peek(&c, '"'))
+        {
+            if (!_json_string(&c, &s, &n))
+                return LINE_INVALID;
+            kind = _json_equals(s, n, "COMMAND") ? LINE_COMMAND :
+                   _json_equals(s, n, "HELLO") ? LINE_HELLO : LINE_OTHER;
+        }
+        else if (_json_equals(key, len, "seq") && (_json_peek(&c, '-') || (c.p < c.end && *c.p >= '0' && *c.p <= '9')))
+        {
+            int64_t v;
+            int integral;
+            if (!_json_number(&c, &v, &integral))
+                return LINE_INVALID;
+            cmd->seq = integral ? v : -1;
+        }
+        else if (_json_equals(key, len, "payload") && _json_peek(&c, '{'))
+        {
+            int pfirst = 1;
+            c.p++;
+            while ((r = _json_member(&c, &pfirst, &key, &len)) > 0)
+            {
+                int ok;
+                if (_json_equals(key, len, "target"))
+                    ok = _json_token(&c, cmd->target, sizeof(cmd->target), 2);
+                else if (_json_equals(key, len, "value"))
+                    ok = _json_token(&c, cmd->value, sizeof(cmd->value), 2);
+                else if (_json_equals(key, len, "action"))
+                    ok = _json_token(&c, cmd->action, sizeof(cmd->action), 2);
+                else if (_json_equals(key, len, "telemetry"))
+                    ok = _json_names(&c, telemetry_names, 1, &hello->telemetry);
+                else if (_json_equals(key, len, "audio"))
+                    ok = _json_names(&c, audio_names, 2, &hello->audio);
+                else if (_json_equals(key, len, "listen"))
+                    ok = _json_names(&c, audio_names, 2, &hello->listen);
+                else if (_json_equals(key, len, "listen_port") && !_json_peek(&c, '"') && !_json_peek(&c, '{') &&
+                         !_json_peek(&c, '['))
+                {
+                    int integral;
+                    ok = _json_number(&c, &hello->listen_port, &integral) && integral;
+                }
+                else
+                    ok = _json_skip(&c, 2);
+                if (!ok)
+                    return LINE_INVALID;
+            }
+            if (r < 0)
+                return LINE_INVALID;
+        }
+        else if (!_json_skip(&c, 1))
+        {
+            return LINE_INVALID;
+        }
+    }
+    _json_ws(&c);
+    if (r < 0 || c.p != c.end)
+        return LINE_INVALID;
+    return kind;
+}
+
+
+// ------------------ 센서값 인코딩 ------------------ //
+static int16_t _clamp16(int v)
+{
+    return (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+}
+
+size_t control_encode_telemetry_json(const ControlTelemetry *t, char *out, size_t cap)
+{
+    // server.py json.dumps()와 같은 모양
+    int n = snprintf(out, cap, "{\"type\": \"TELEMETRY\", \"payload\": {\"co_ppm\": %d, \"obstacle_cm\": %d, "
+                     "\"rollover\": %s}}\n", t->co_ppm, t->obstacle_cm, t->rollover ? "true" : "false");
+    return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+}
+
+size_t control_encode_telemetry_tlv(const ControlTelemetry *t, uint8_t out[TELEMETRY_TLV_RECORD_SIZE])
+{
+    out[0] = TELEMETRY_TLV_SYNC;
+    out[1] = TELEMETRY_TLV_RECORD_SIZE - 2;
+    out[2] = TELEMETRY_TLV_CO_PPM;
+    out[3] = 2;
+    _put16(out + 4, (uint16_t)_clamp16(t->co_ppm));
+    out[6] = TELEMETRY_TLV_OBSTACLE_CM;
+    out[7] = 2;
+    _put16(out + 8, (uint16_t)_clamp16(t->obstacle_cm));
+    out[10] = TELEMETRY_TLV_ROLLOVER;
+    out[11] = 1;
+    out[12] = t->rollover ? 1 : 0;
+    return TELEMETRY_TLV_RECORD_SIZE;
+}
+
+
+// ------------------ 서버 ------------------ //
+
+// server.py process_command()와 같은 동작 (출력만)
+static void _default_command_handler(const ControlCommand *cmd, void *arg)
+{
+    (void)arg;
+    printf("[control] 명령 처리: 타겟=%s, 값=%s\n", cmd->target, cmd->value);
+    if (strcmp(cmd->target, "DRIVE") == 0)
+    {
+        if (strcmp(cmd->value, "F") == 0) printf("    전진 (Forward)\n");
+        else if (strcmp(cmd->value, "B") == 0) printf("    후진 (Backward)\n");
+        else if (strcmp(cmd->value, "L") == 0) printf("    좌회전 (Left)\n");
+        else if (strcmp(cmd->value, "R") == 0) printf("    우회전 (Right)\n");
+        else if (strcmp(cmd->value, "STOP") == 0) printf("    정지 (Stop)\n");
+    }
+    else if (strcmp(cmd->target, "MIC") == 0)
+    {
+        printf(strcmp(cmd->value, "true") == 0 ? "    마이크 ON\n" : "    마이크 OFF\n");
+    }
+    else if (strcmp(cmd->target, "SYSTEM") == 0 && strcmp(cmd->action, "REBOOT") == 0)
+    {
+        printf("    재부팅 시퀀스!\n");
+    }
+}
+
+static int _epoll_add(ControlServer *s, int fd, uint32_t events, uint32_t tag)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u32 = tag;
+    if (epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        perror("epoll_ctl()");
+        return -1;
+    }
+    return 1;
+}
+
+int control_server_open(ControlServer *s, uint16_t tcp_port, uint16_t audio_port, ThermalServer *thermal)
+{
+    memset(s, 0, sizeof(*s));
+    s->tcp_fd = s->audio_fd = s->timer_fd = s->wake_fd = s->playout_fd = s->capture_fd = -1;
+    s->audio_sink = -1;
+    s->source.fd = -1;
+    s->audio_rate = AUDIO_RATE;
+    jitter_buffer_init(&s->jitter, AUDIO_RATE);
+    s->audio_codec = AUDIO_CODEC_RAW;
+    s->telemetry_hz = CONTROL_TELEMETRY_HZ;
+    s->batch_ms = CONTROL_TELEMETRY_BATCH_MS;
+    s->on_command = _default_command_handler;
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+        s->clients[i].fd = -1;
+
+    s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    s->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    s->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    s->playout_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    s->capture_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (s->epoll_fd < 0 || s->timer_fd < 0 || s->wake_fd < 0 || s->playout_fd < 0 || s->capture_fd < 0)
+    {
+        perror("epoll/timerfd/eventfd");
+        control_server_close(s);
+        return -1;
+    }
+    if (_epoll_add(s, s->timer_fd, EPOLLIN, EV_TIMER) < 0 || _epoll_add(s, s->wake_fd, EPOLLIN, EV_WAKE) < 0 ||
+        _epoll_add(s, s->playout_fd, EPOLLIN, EV_PLAYOUT) < 0 || _epoll_add(s, s->capture_fd, EPOLLIN, EV_CAPTURE) < 0)
+    {
+        control_server_close(s);
+        return -1;
+    }
+
+    if (tcp_port != 0 &&
+        ((s->tcp_fd = _open_socket(SOCK_STREAM, tcp_port, CONTROL_MAX_CLIENTS)) < 0 ||
+         _epoll_add(s, s->tcp_fd, EPOLLIN, EV_CONTROL_LISTEN) < 0))
+    {
+        control_server_close(s);
+        return -1;
+    }
+    if (audio_port != 0 &&
+        ((s->audio_fd = _open_socket(SOCK_DGRAM, audio_port, 0)) < 0 ||
+         _epoll_add(s, s->audio_fd, EPOLLIN, EV_AUDIO) < 0))
+    {
+        control_server_close(s);
+        return -1;
+    }
+    if (thermal)
+    {
+        // 새 접속/구독 요청이 오면 바로 받아둔다 (transmit thread는 프레임 보낼 때 옮겨가기만 함)
+        if ((thermal->tcp_fd >= 0 && _epoll_add(s, thermal->tcp_fd, EPOLLIN, EV_THERMAL) < 0) ||
+            (thermal->udp_fd >= 0 && _epoll_add(s, thermal->udp_fd, EPOLLIN, EV_THERMAL) < 0))
+        {
+            control_server_close(s);
+            return -1;
+        }
+        s->thermal = thermal;
+        thermal->event_driven = 1;
+    }
+    printf("[control] TCP %u, 음성 UDP %u 대기중\n", tcp_port, audio_port);
+    return 1;
+}
+
+// 음성 형식을 협상한 클라이언트가 아무도 없으면 예전 형식(헤더 없는 PCM16)으로 받는다
+static void _update_audio_codec(ControlServer *s)
+{
+    int codec = AUDIO_CODEC_RAW;
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+    {
+        if (s->clients[i].fd >= 0 && s->clients[i].audio_codec > codec)
+            codec = s->clients[i].audio_codec;
+    }
+    if (codec != s->audio_codec)
+        printf("[control] 음성 형식: %s\n", audio_codec_name(codec));
+    s->audio_codec = codec;
+}
+
+// 로봇 마이크를 듣는 클라이언트 수. 모두 떠나면 그 동안의 송신 통계를 찍고 비운다
+static void _update_listeners(ControlServer *s)
+{
+    int n = 0;
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+    {
+        if (s->clients[i].fd >= 0 && s->clients[i].listen_codec != AUDIO_CODEC_RAW)
+            n++;
+    }
+    if (n == 0 && s->listeners > 0)
+    {
+        control_server_print_source_stats(s);
+        s->source.frames = s->source.packets_sent = s->source.send_failed = 0;
+        latency_hist_reset(&s->source.hold);
+        latency_hist_reset(&s->source.encode);
+    }
+    s->listeners = n;
+}
+
+static void _client_close(ControlServer *s, ControlClient *c, const char *why)
+{
+    printf("[control] 클라이언트 끊김 (%d): %s\n", (int)(c - s->clients), why);
+    close(c->fd);       // epoll에서도 빠진다
+    c->fd = -1;
+    s->nclients--;
+    _update_audio_codec(s);
+    _update_listeners(s);
+}
+
+void control_server_close(ControlServer *s)
+{
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+    {
+        if (s->clients[i].fd >= 0)
+            close(s->clients[i].fd);
+        s->clients[i].fd = -1;
+    }
+    s->nclients = 0;
+    if (s->thermal)
+        s->thermal->event_driven = 0;
+    s->thermal = NULL;
+    if (s->tcp_fd >= 0)
+        close(s->tcp_fd);
+    if (s->audio_fd >= 0)
+        close(s->audio_fd);
+    if (s->timer_fd >= 0)
+        close(s->timer_fd);
+    if (s->wake_fd >= 0)
+        close(s->wake_fd);
+    if (s->playout_fd >= 0)
+        close(s->playout_fd);
+    if (s->capture_fd >= 0)
+        close(s->capture_fd);
+    if (s->epoll_fd >= 0)
+        close(s->epoll_fd);
+    s->tcp_fd = s->audio_fd = s->timer_fd = s->wake_fd = s->playout_fd = s->capture_fd = s->epoll_fd = -1;
+    s->source.fd = -1;      // fd는 set_audio_source()를 부른 쪽이 닫는다
+}
+
+void control_server_set_telemetry(ControlServer *s, double hz, int batch_ms,
+                                  ControlTelemetrySource source, void *arg)
+{
+    s->telemetry_hz = hz;
+    s->batch_ms = batch_ms < 0 ? 0 : batch_ms;
+    s->read_telemetry = source;
+    s->telemetry_arg = arg;
+}
+
+void control_server_set_command_handler(ControlServer *s, ControlCommandHandler handler, void *arg)
+{
+    s->on_command = handler ? handler : _default_command_handler;
+    s->command_arg = arg;
+}
+
+void control_server_set_audio_sink(ControlServer *s, int fd, int rate)
+{
+    // aplay가 밀려도 loop가 막히지 않도록. 못 쓰는 datagram은 버린다.
+    if (fd >= 0)
+        _set_nonblock(fd);
+    s->audio_sink = fd;
+    s->audio_rate = rate > 0 ? rate : AUDIO_RATE;
+    jitter_buffer_init(&s->jitter, s->audio_rate);
+}
+
+int control_server_set_audio_source(ControlServer *s, int fd, int rate, int paced, int capture_ms)
+{
+    AudioSource *src = &s->source;
+    size_t samples = (size_t)rate * AUDIO_SOURCE_FRAME_MS / 1000;
+
+    if (fd < 0 || samples == 0 || samples > AUDIO_PACKET_MAX_SAMPLES)
+        return -1;
+    memset(src, 0, sizeof(*src));
+    src->fd = fd;
+    src->paced = paced;
+    src->rate = rate;
+    src->capture_ms = capture_ms;
+    src->frame_bytes = samples * sizeof(int16_t);
+    latency_hist_reset(&src->hold);
+    latency_hist_reset(&src->encode);
+
+    if (paced)
+    {
+        // 장치처럼 프레임 주기마다 한 프레임씩 (먼저 읽어 두면 아직 말하지 않은 소리를 보내는 셈)
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        its.it_interval.tv_nsec = AUDIO_SOURCE_FRAME_MS * 1000000L;
+        its.it_value = its.it_interval;
+        if (timerfd_settime(s->capture_fd, 0, &its, NULL) < 0)
+        {
+            perror("timerfd_settime()");
+            src->fd = -1;
+            return -1;
+        }
+    }
+    else if (_set_nonblock(fd) < 0 || _epoll_add(s, fd, EPOLLIN, EV_CAPTURE) < 0)
+    {
+        src->fd = -1;
+        return -1;
+    }
+    printf("[control] 로봇 마이크: %s, %dHz, 프레임 %dms\n", paced ? "파일" : "파이프", rate, AUDIO_SOURCE_FRAME_MS);
+    return 1;
+}
+
+void control_server_print_source_stats(ControlServer *s)
+{
+    const AudioSource *src = &s->source;
+
+    printf("[audio] 로봇 마이크: frames %lu, packets %lu, send 실패 %lu (캡처 버퍼 %dms 별도)\n",
+           src->frames, src->packets_sent, src->send_failed, src->capture_ms);
+    latency_hist_print(&src->hold, "    first sample->sent");
+    latency_hist_print(&src->encode, "    encode");
+}
+
+void control_server_stop(ControlServer *s)
+{
+    uint64_t one = 1;
+    s->running = 0;
+    if (write(s->wake_fd, &one, sizeof(one)) < 0)
+        perror("write(): eventfd");
+}
+
+static void _client_want_write(ControlServer *s, ControlClient *c, int on)
+{
+    struct epoll_event ev;
+
+    if (c->want_write == on)
+        return;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | (on ? EPOLLOUT : 0);
+    ev.data.u32 = (uint32_t)(c - s->clients);
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->want_write = on;
+}
+
+// 모아둔 것을 write 한 번으로 보낸다 (TCP_NODELAY라 보통 패킷 하나). 남으면 EPOLLOUT을 기다린다. 끊겼으면 -1
+static int _client_flush(ControlServer *s, ControlClient *c)
+{
+    size_t off = 0;
+
+    while (off < c->out_len)
+    {
+        ssize_t n = send(c->fd, c->out + off, c->out_len - off, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return -1;
+        }
+        off += (size_t)n;
+    }
+    if (off > 0)
+    {
+        memmove(c->out, c->out + off, c->out_len - off);
+        c->out_len -= off;
+    }
+    c->batch_start_ns = 0;
+    _client_want_write(s, c, c->out_len > 0);
+    return 1;
+}
+
+static int _client_queue(ControlClient *c, const void *data, size_t len)
+{
+    if (len > CONTROL_OUT_MAX - c->out_len)
+        return -1;
+    memcpy(c->out + c->out_len, data, len);
+    c->out_len += len;
+    return 1;
+}
+
+static void _accept_control_clients(ControlServer *s)
+{
+    int one = 1;
+
+    for (;;)
+    {
+        int fd = accept(s->tcp_fd, NULL, NULL);
+        int slot = -1;
+        if (fd < 0)
+            return;
+
+        for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+        {
+            if (s->clients[i].fd < 0)
+            {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0)
+        {
+            printf("[control] 클라이언트가 너무 많아 접속을 거절합니다\n");
+            close(fd);
+            continue;
+        }
+        // 작은 명령/ACK가 Nagle에 걸려 상대의 지연 ACK(최대 40ms)를 기다리지 않도록
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (_set_nonblock(fd) < 0 || _epoll_add(s, fd, EPOLLIN, (uint32_t)slot) < 0)
+        {
+            close(fd);
+            continue;
+        }
+        s->clients[slot].fd = fd;
+        s->clients[slot].in_len = 0;
+        s->clients[slot].in_skipping = 0;
+        s->clients[slot].out_len = 0;
+        s->clients[slot].want_write = 0;
+        s->clients[slot].tlv = 0;
+        s->clients[slot].acks = 0;
+        s->clients[slot].audio_codec = AUDIO_CODEC_RAW;
+        s->clients[slot].listen_codec = AUDIO_CODEC_RAW;
+        s->clients[slot].batch_start_ns = 0;
+        s->nclients++;
+        printf("[control] 클라이언트 접속 (%d)\n", slot);
+    }
+}
+
+static int _send_ack(ControlServer *s, ControlClient *c, const ControlCommand *cmd, uint64_t exec_ns)
+{
+    char line[256];
+    char seq[32] = "";
+    char target[sizeof(cmd->target) + 2] = "null";
+    int n;
+
+    if (cmd->target[0])
+        snprintf(target, sizeof(target), "\"%s\"", cmd->target);
+    if (cmd->seq >= 0)
+        snprintf(seq, sizeof(seq), ", \"seq\": %" PRId64, cmd->seq);
+    n = snprintf(line, sizeof(line), "{\"type\": \"ACK\", \"payload\": {\"target\": %s, \"rx_ns\": %" PRIu64
+                 ", \"exec_ns\": %" PRIu64 "%s}}\n", target, cmd->rx_ns, exec_ns, seq);
+    // ACK는 못 보내면 지연 측정이 틀어지므로 버리지 않고 끊는다
+    if (_client_queue(c, line, (size_t)n) < 0)
+        return -1;
+    // 급한 메시지: 센서값 배치를 기다리지 않고 바로 보냄 (docs/Protocol.md 2.5)
+    return c->want_write ? 1 : _client_flush(s, c);
+}
+
+static int _handle_hello(ControlServer *s, ControlClient *c, const HelloRequest *hello)
+{
+    char line[320];
+    char audio[80] = "";
+    char listen[96] = "";
+    int tlv = hello->telemetry & 1;
+    int n;
+
+    // 음성: 보낼 수 있다고 한 것 중 가장 작은 형식. 재생 주파수를 알려주면 클라이언트가 거기에 맞춰 리샘플한다
+    // audio_cn: CN 패킷을 알아듣는다 (클라이언트가 조용한 구간을 보내지 않아도 됨)
+    if (hello->audio)
+    {
+        c->audio_codec = (hello->audio & (1 << AUDIO_CODEC_IMA_ADPCM)) ? AUDIO_CODEC_IMA_ADPCM : AUDIO_CODEC_PCM16;
+        snprintf(audio, sizeof(audio), ", \"audio\": \"%s\", \"audio_rate\": %d, \"audio_cn\": true",
+                 audio_codec_name(c->audio_codec), s->audio_rate);
+        _update_audio_codec(s);
+    }
+    // 로봇 마이크: 마이크가 있고 받을 UDP 포트를 알려준 경우에만. 보내는 곳은 이 TCP 연결의 상대 주소
+    c->listen_codec = AUDIO_CODEC_RAW;
+    if (hello->listen && hello->listen_port > 0 && hello->listen_port <= 65535 && s->source.fd >= 0)
+    {
+        socklen_t alen = sizeof(c->listen_addr);
+        if (getpeername(c->fd, (struct sockaddr *)&c->listen_addr, &alen) == 0)
+        {
+            c->listen_addr.sin_port = htons((uint16_t)hello->listen_port);
+            c->listen_codec = (hello->listen & (1 << AUDIO_CODEC_IMA_ADPCM)) ? AUDIO_CODEC_IMA_ADPCM : AUDIO_CODEC_PCM16;
+            snprintf(listen, sizeof(listen), ", \"listen\": \"%s\", \"listen_rate\": %d, \"listen_capture_ms\": %d",
+                     audio_codec_name(c->listen_codec), s->source.rate, s->source.capture_ms);
+            printf("[control] 로봇 마이크 (%d): %s -> %s:%u\n", (int)(c - s->clients),
+                   audio_codec_name(c->listen_codec), inet_ntoa(c->listen_addr.sin_addr), (unsigned)hello->listen_port);
+        }
+    }
+    _update_listeners(s);
+    n = snprintf(line, sizeof(line), "{\"type\": \"HELLO\", \"payload\": {\"telemetry\": \"%s\", \"rate_hz\": %d%s%s}}\n",
+                 tlv ? "TLV" : "JSON", (int)(s->telemetry_hz + 0.5), audio, listen);
+
+    // 모아둔 센서값 뒤에 응답을 붙이고, 그 다음 메시지부터 형식을 바꾼다
+    c->acks = 1;
+    if (_client_queue(c, line, (size_t)n) < 0)
+        return -1;
+    if (c->tlv != tlv)
+        printf("[control] 센서값 형식 (%d): %s\n", (int)(c - s->clients), tlv ? "TLV" : "JSON");
+    c->tlv = tlv;
+    return c->want_write ? 1 : _client_flush(s, c);
+}
+
+static int _handle_line(ControlServer *s, ControlClient *c, const char *line, const char *end)
+{
+    ControlCommand cmd;
+    HelloRequest hello;
+    int kind;
+
+    cmd.rx_ns = latency_now_ns();
+    kind = _parse_line(line, end, &cmd, &hello);
+    if (kind == LINE_INVALID)
+    {
+        s->bad_lines++;
+        printf("[control] 깨진 데이터 수신: %.*s\n", (int)(end - line), line);
+        return 1;
+    }
+    if (kind == LINE_HELLO)
+        return _handle_hello(s, c, &hello);
+    if (kind != LINE_COMMAND)
+        return 1;
+
+    s->commands++;
+    if (strcmp(cmd.target, "PING") != 0)     // 왕복 시간 측정용 (ACK만 보냄)
+        s->on_command(&cmd, s->command_arg);
+    if (!c->acks)
+        return 1;
+    return _send_ack(s, c, &cmd, latency_now_ns());
+}
+
+// 들어온 만큼 읽고 끝난 줄을 모두 처리한다. 끊겼으면 -1
+static int _client_read(ControlServer *s, ControlClient *c)
+{
+    for (;;)
+    {
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+        char *line, *nl, *end;
+        if (n == 0)
+            return -1;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : -1;
+        }
+        c->in_len += (size_t)n;
+
+        line = c->in;
+        end = c->in + c->in_len;
+        while ((nl = memchr(line, '\n', (size_t)(end - line))) != NULL)
+        {
+            if (c->in_skipping)
+            {
+                c->in_skipping = 0;     // 너무 긴 줄의 끝
+            }
+            else
+            {
+                JsonCursor blank = { line, nl };
+                _json_ws(&blank);
+                if (blank.p != nl && _handle_line(s, c, line, nl) < 0)
+                    return -1;
+            }
+            line = nl + 1;
+        }
+        c->in_len = (size_t)(end - line);
+        memmove(c->in, line, c->in_len);
+        // 버퍼가 꽉 찼는데 줄이 안 끝났으면 그 줄은 포기하고 다음 '\n'부터 다시
+        if (c->in_len == sizeof(c->in))
+        {
+            if (!c->in_skipping)
+                s->bad_lines++;
+            c->in_skipping = 1;
+            c->in_len = 0;
+        }
+    }
+}
+
+// 음성 스트림이 있는 동안만 JITTER_TICK_MS마다 깨운다
+static void _set_playout_timer(ControlServer *s, int on)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    if (on)
+    {
+        its.it_interval.tv_nsec = JITTER_TICK_MS * 1000000L;
+        its.it_value = its.it_interval;
+    }
+    if (timerfd_settime(s->playout_fd, 0, &its, NULL) < 0)
+        perror("timerfd_settime()");
+    s->playout_on = on;
+}
+
+static void _receive_audio(ControlServer *s)
+{
+    uint8_t buf[AUDIO_DATAGRAM_MAX];
+
+    for (;;)
+    {
+        ssize_t n = recv(s->audio_fd, buf, sizeof(buf), 0);
+        if (n < 0)
+            return;
+        s->audio_packets++;
+        s->audio_bytes += (unsigned long)n;
+        if (s->audio_codec == AUDIO_CODEC_RAW)
+        {
+            // 예전 클라이언트: 받은 그대로 (PIPE_BUF 이하 write는 전부 들어가거나 EAGAIN)
+            if (s->audio_sink >= 0 && n > 0 && write(s->audio_sink, buf, (size_t)n) < 0)
+                s->audio_dropped++;
+            continue;
+        }
+        if (jitter_buffer_put(&s->jitter, buf, (size_t)n, latency_now_ns()) < 0)
+            s->audio_bad++;
+        else if (!s->playout_on && jitter_buffer_active(&s->jitter))
+            _set_playout_timer(s, 1);
+    }
+}
+
+// 재생 시계에 맞춰 지터 버퍼에서 꺼내 sink로. 패킷이 끊기면 통계를 찍고 timer를 멈춘다
+static void _playout_tick(ControlServer *s)
+{
+    uint64_t expirations;
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES];
+    size_t n;
+
+    if (read(s->playout_fd, &expirations, sizeof(expirations)) < 0)
+        return;
+    while ((n = jitter_buffer_get(&s->jitter, latency_now_ns(), pcm, AUDIO_PACKET_MAX_SAMPLES)) > 0)
+    {
+        if (s->audio_sink >= 0 && write(s->audio_sink, pcm, n * sizeof(int16_t)) < 0)
+            s->audio_dropped++;
+    }
+    if (!jitter_buffer_active(&s->jitter))
+    {
+        jitter_buffer_print_stats(&s->jitter, "[audio] 스트림 끝");
+        jitter_buffer_reset(&s->jitter);
+        _set_playout_timer(s, 0);
+    }
+}
+
+// 프레임 하나를 듣는 클라이언트마다 그 형식으로 보낸다 (형식별로 한 번만 인코딩)
+static void _send_source_frame(ControlServer *s)
+{
+    AudioSource *src = &s->source;
+    size_t n = src->frame_bytes / sizeof(int16_t);
+    uint8_t packets[2][AUDIO_PACKET_HEADER + AUDIO_PACKET_MAX_SAMPLES * 2];
+    size_t len[2] = { 0, 0 };
+    uint64_t t0, sent_ns;
+    AudioPacketHeader h;
+
+    memset(&h, 0, sizeof(h));
+
+    src->frames++;
+    if (s->listeners > 0 && s->audio_fd >= 0)
+    {
+        t0 = latency_now_ns();
+        h.seq = src->seq;
+        h.timestamp = src->timestamp;
+        h.delay = (uint16_t)((t0 - src->frame_start_ns) / 100000u);
+        for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+        {
+            ControlClient *c = &s->clients[i];
+            if (c->fd < 0 || c->listen_codec == AUDIO_CODEC_RAW)
+                continue;
+            if (len[c->listen_codec] == 0)
+            {
+                h.codec = c->listen_codec;
+                len[c->listen_codec] = audio_packet_encode(&h, &src->adpcm, src->frame, n, packets[c->listen_codec]);
+            }
+            if (sendto(s->audio_fd, packets[c->listen_codec], len[c->listen_codec], 0,
+                       (const struct sockaddr *)&c->listen_addr, sizeof(c->listen_addr)) < 0)
+                src->send_failed++;
+            else
+                src->packets_sent++;
+        }
+        sent_ns = latency_now_ns();
+        latency_hist_add(&src->encode, sent_ns - t0);
+        latency_hist_add(&src->hold, sent_ns - src->frame_start_ns);
+    }
+    // 듣는 사람이 없어도 번호는 실제 시간대로 (다시 들을 때 받는 쪽이 이어지는 스트림으로 본다)
+    src->seq++;
+    src->timestamp += (uint32_t)n;
+}
+
+// 읽은 바이트를 프레임에 채우고 찰 때마다 보낸다
+static void _source_append(ControlServer *s, const uint8_t *data, size_t len, uint64_t now_ns)
+{
+    AudioSource *src = &s->source;
+
+    while (len > 0)
+    {
+        size_t take = src->frame_bytes - src->filled;
+        if (take > len)
+            take = len;
+        if (src->filled == 0)
+            src->frame_start_ns = now_ns;
+        memcpy((uint8_t *)src->frame + src->filled, data, take);
+        src->filled += take;
+        data += take;
+        len -= take;
+        if (src->filled == src->frame_bytes)
+        {
+            _send_source_frame(s);
+            src->filled = 0;
+        }
+    }
+}
+
+static void _source_stop(ControlServer *s, const char *why)
+{
+    printf("[control] 로봇 마이크 끝: %s\n", why);
+    if (s->source.paced)
+    {
+        struct itimerspec off;
+        memset(&off, 0, sizeof(off));
+        timerfd_settime(s->capture_fd, 0, &off, NULL);
+    }
+    else
+    {
+        epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, s->source.fd, NULL);
+    }
+    s->source.fd = -1;
+}
+
+static void _read_source(ControlServer *s)
+{
+    AudioSource *src = &s->source;
+    uint8_t buf[AUDIO_PACKET_MAX_SAMPLES * 2];
+    uint64_t expirations;
+
+    if (src->fd < 0)
+        return;
+    if (src->paced)
+    {
+        // 파일: 지난 주기만큼 프레임을 읽는다 (끝나면 처음부터 다시)
+        if (read(s->capture_fd, &expirations, sizeof(expirations)) < 0)
+            return;
+        while (expirations-- > 0 && src->fd >= 0)
+        {
+            size_t got = 0;
+            while (got < src->frame_bytes)
+            {
+                ssize_t r = read(src->fd, buf + got, src->frame_bytes - got);
+                if (r == 0 && got == 0 && lseek(src->fd, 0, SEEK_SET) == 0)
+                    r = read(src->fd, buf, src->frame_bytes);
+                if (r <= 0)
+                    break;
+                got += (size_t)r;
+            }
+            if (got == 0)
+            {
+                _source_stop(s, "파일을 읽을 수 없음");
+                return;
+            }
+            _source_append(s, buf, got, latency_now_ns());
+        }
+        return;
+    }
+    for (;;)
+    {
+        ssize_t r = read(src->fd, buf, sizeof(buf));
+        if (r > 0)
+        {
+            _source_append(s, buf, (size_t)r, latency_now_ns());
+            continue;
+        }
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            _source_stop(s, r == 0 ? "EOF (arecord 종료)" : "read()");
+        return;
+    }
+}
+
+static void _telemetry_tick(ControlServer *s)
+{
+    uint64_t expirations;
+    ControlTelemetry t = { 0, 0, 0 };
+    char json[128];
+    uint8_t tlv[TELEMETRY_TLV_RECORD_SIZE];
+    size_t json_len;
+    uint64_t now, period_ns, batch_ns;
+
+    if (read(s->timer_fd, &expirations, sizeof(expirations)) < 0 || s->nclients == 0)
+        return;     // 밀린 주기는 한 번만 보낸다 (오래된 값을 몰아 보내지 않음)
+
+    if (s->read_telemetry)
+        s->read_telemetry(&t, s->telemetry_arg);
+    json_len = control_encode_telemetry_json(&t, json, sizeof(json));
+    control_encode_telemetry_tlv(&t, tlv);
+    now = latency_now_ns();
+    period_ns = (uint64_t)(1e9 / s->telemetry_hz);
+    batch_ns = (uint64_t)s->batch_ms * 1000000u;
+
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++)
+    {
+        ControlClient *c = &s->clients[i];
+        if (c->fd < 0)
+            continue;
+        if (_client_queue(c, c->tlv ? (const void *)tlv : json, c->tlv ? sizeof(tlv) : json_len) < 0)
+        {
+            s->telemetry_dropped++;     // 못 받아가는 클라이언트: 최신 값이 아니면 의미 없음
+            continue;
+        }
+        s->telemetry_sent++;
+        if (c->batch_start_ns == 0)
+            c->batch_start_ns = now;
+        // 다음 값까지 기다리면 배치 시간을 넘는 경우에만 보냄 (10Hz면 매번, 100Hz면 5개씩)
+        if (c->want_write || now - c->batch_start_ns + period_ns < batch_ns)
+            continue;
+        if (_client_flush(s, c) < 0)
+        {
+            s->clients_dropped++;
+            _client_close(s, c, "send()");
+        }
+    }
+}
+
+// hz <= 0이면 timer를 멈춘다
+static void _set_telemetry_timer(ControlServer *s, double hz)
+{
+    struct itimerspec its;
+    uint64_t period_ns = hz > 0 ? (uint64_t)(1e9 / hz) : 0;
+
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_sec = (time_t)(period_ns / 1000000000u);
+    its.it_interval.tv_nsec = (long)(period_ns % 1000000000u);
+    its.it_value = its.it_interval;
+    if (timerfd_settime(s->timer_fd, 0, &its, NULL) < 0)
+        perror("timerfd_settime()");
+}
+
+void control_server_run(ControlServer *s)
+{
+    struct epoll_event events[EPOLL_BATCH];
+
+    _set_telemetry_timer(s, s->telemetry_hz);
+    s->running = 1;
+    while (s->running)
+    {
+        int n = epoll_wait(s->epoll_fd, events, EPOLL_BATCH, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait()");
+            break;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            uint32_t tag = events[i].data.u32;
+            ControlClient *c;
+
+            switch (tag)
+            {
+            case EV_CONTROL_LISTEN: _accept_control_clients(s); continue;
+            case EV_AUDIO: _receive_audio(s); continue;
+            case EV_TIMER: _telemetry_tick(s); continue;
+            case EV_THERMAL: thermal_server_poll(s->thermal); continue;
+            case EV_PLAYOUT: _playout_tick(s); continue;
+            case EV_CAPTURE: _read_source(s); continue;
+            case EV_WAKE: s->running = 0; continue;
+            default: break;
+            }
+
+            // 같은 epoll_wait 결과 안에서 앞의 이벤트 처리 중에 끊긴 클라이언트
+            c = &s->clients[tag];
+            if (c->fd < 0)
+                continue;
+            if ((events[i].events & EPOLLOUT) && _client_flush(s, c) < 0)
+            {
+                s->clients_dropped++;
+                _client_close(s, c, "send()");
+                continue;
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && _client_read(s, c) < 0)
+            {
+                if (c->fd >= 0)
+                    _client_close(s, c, "연결 종료");
+            }
+        }
+    }
+    _set_telemetry_timer(s, 0);
+    _set_playout_timer(s, 0);
+}
@@ -4,54 +4,419 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>     // assert()
+#include <unistd.h>     // sysconf()
+#include <time.h>
+#include <sys/mman.h>   // mmap(), mlock(), madvise()
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
-#define DEBUG
+#include "../include/latency_hist.h"
 
+// #define DEBUG
 
+#define SLOT(cnt) ((cnt) & rb->mask)
+#define FRAME_BYTES (sizeof(uint16_t) * LEPTON_HEIGHT * LEPTON_WIDTH)
+#define HUGEPAGE_SIZE (2UL * 1024 * 1024)
+#define NO_FRAME (-1)
+
+
+static size_t _round_pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+static size_t _round_up(size_t n, size_t align)
+{
+    return (n + align - 1) / align * align;
+}
+
+size_t lepton_ringbuffer_memory_budget(size_t capacity, int flags)
+{
+    // 대기열 capacity개 + 생산자/소비자가 들고 있는 프레임 2개
+    size_t bytes = (_round_pow2(capacity) + 2) * FRAME_BYTES;
+    if (flags & RINGBUFFER_HUGEPAGE)
+        return _round_up(bytes, HUGEPAGE_SIZE);
+    return _round_up(bytes, (size_t)sysconf(_SC_PAGESIZE));
+}
+
+int lepton_ringbuffer_init(LeptonRingBuffer* rb, size_t capacity, int flags)
+{
+    void *mem = MAP_FAILED;
+
+    if (capacity == 0)
+    {
+        printf("RingBuffer capacity는 1 이상이어야 합니다.\n");
+        return -1;
+    }
+    rb->capacity = _round_pow2(capacity);
+    rb->mask = rb->capacity - 1;
+    rb->nframes = rb->capacity + 2;
+    rb->free_mask = _round_pow2(rb->nframes) - 1;
+    rb->flags = 0;
+
+    if (flags & RINGBUFFER_HUGEPAGE)
+    {
+        rb->mapped_size = lepton_ringbuffer_memory_budget(capacity, RINGBUFFER_HUGEPAGE);
+        mem = mmap(NULL, rb->mapped_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (mem != MAP_FAILED)
+            rb->flags |= RINGBUFFER_HUGEPAGE;
+        else
+            perror("mmap(MAP_HUGETLB) 실패, 일반 페이지 사용");
+    }
+    if (mem == MAP_FAILED)
+    {
+        rb->mapped_size = lepton_ringbuffer_memory_budget(capacity, 0);
+        // MAP_POPULATE: 캡처 루프에서 처음 슬롯을 쓸 때 page fault가 나지 않도록 미리 채운다.
+        mem = mmap(NULL, rb->mapped_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (mem == MAP_FAILED)
+        {
+            perror("mmap(): RingBuffer 할당 실패");
+            return -1;
+        }
+        if (flags & RINGBUFFER_HUGEPAGE)
+            madvise(mem, rb->mapped_size, MADV_HUGEPAGE);
+    }
+    if (flags & RINGBUFFER_MLOCK)
+    {
+        if (mlock(mem, rb->mapped_size) == 0)
+            rb->flags |= RINGBUFFER_MLOCK;
+        else
+            perror("mlock() 실패 (RLIMIT_MEMLOCK 확인)");
+    }
+
+    rb->commit_ns = calloc(rb->nframes, sizeof(uint64_t));
+    rb->queue = calloc(rb->capacity, sizeof(*rb->queue));
+    rb->free_q = calloc(rb->free_mask + 1, sizeof(*rb->free_q));
+    rb->spare = calloc(rb->nframes, sizeof(*rb->spare));
+    if (!rb->commit_ns || !rb->queue || !rb->free_q || !rb->spare)
+    {
+        perror("calloc(): RingBuffer 인덱스");
+        rb->frames = mem;
+        lepton_ringbuffer_destroy(rb);
+        return -1;
+    }
+
+    // 처음에는 모든 프레임이 생산자 몫이다.
+    for (size_t i = 0; i < rb->nframes; i++)
+        rb->spare[i] = (uint32_t)(rb->nframes - 1 - i);
+    rb->nspare = rb->nframes;
+    rb->prod_frame = NO_FRAME;
+    rb->cons_frame = NO_FRAME;
+    rb->policy = RINGBUFFER_DROP_NEWEST;
+    rb->free_tail = 0;
+    atomic_init(&rb->free_head, 0);
+    atomic_init(&rb->dropped_newest, 0);
+    atomic_init(&rb->dropped_oldest, 0);
+
+    rb->frames = mem;
+    atomic_init(&rb->wake_seq, 0);
+    atomic_init(&rb->waiters, 0);
+    atomic_init(&rb->head, 0);
+    atomic_init(&rb->tail, 0);
+    rb->cached_tail = 0;
+    rb->cached_head = 0;
+    return 1;
+}
+
+void lepton_ringbuffer_destroy(LeptonRingBuffer* rb)
+{
+    if (rb->frames != NULL)
+    {
+        if (rb->flags & RINGBUFFER_MLOCK)
+            munlock(rb->frames, rb->mapped_size);
+        munmap(rb->frames, rb->mapped_size);
+        rb->frames = NULL;
+    }
+    free(rb->commit_ns);
+    free(rb->queue);
+    free(rb->free_q);
+    free(rb->spare);
+    rb->commit_ns = NULL;
+    rb->queue = NULL;
+    rb->free_q = NULL;
+    rb->spare = NULL;
+}
+
+void lepton_ringbuffer_print_budget(const LeptonRingBuffer* rb)
+{
+    printf("RingBuffer: depth %zu (+2) x %zu B = %zu B, mapped %zu B (hugepage: %s, mlock: %s, policy: %s)\n",
+           rb->capacity, (size_t)FRAME_BYTES, rb->nframes * FRAME_BYTES, rb->mapped_size,
+           (rb->flags & RINGBUFFER_HUGEPAGE) ? "yes" : "no",
+           (rb->flags & RINGBUFFER_MLOCK) ? "yes" : "no",
+           lepton_ringbuffer_policy_name(rb->policy));
+}
+
+static const char *policy_names[] = { "drop-newest", "drop-oldest", "latest" };
+
+int lepton_ringbuffer_set_policy(LeptonRingBuffer* rb, int policy)
+{
+    if (policy < RINGBUFFER_DROP_NEWEST || policy > RINGBUFFER_LATEST_ONLY)
+        return -1;
+    rb->policy = policy;
+    return 1;
+}
+
+int lepton_ringbuffer_policy_from_name(const char *name)
+{
+    for (int i = 0; i < (int)(sizeof(policy_names) / sizeof(policy_names[0])); i++)
+    {
+        if (strcmp(name, policy_names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+const char *lepton_ringbuffer_policy_name(int policy)
+{
+    if (policy < RINGBUFFER_DROP_NEWEST || policy > RINGBUFFER_LATEST_ONLY)
+        return "unknown";
+    return policy_names[policy];
+}
+
+void lepton_ringbuffer_get_drops(LeptonRingBuffer* rb, LeptonRingBufferDrops *drops)
+{
+    drops->dropped_newest = atomic_load_explicit(&rb->dropped_newest, memory_order_relaxed);
+    drops->dropped_oldest = atomic_load_explicit(&rb->dropped_oldest, memory_order_relaxed);
+}
 
 int lepton_ringbuffer_is_available(LeptonRingBuffer* rb)
 {
-    return (rb->count < BUFFER_SIZE) ? 1 : 0;
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    if (rb->policy != RINGBUFFER_DROP_NEWEST || head - rb->cached_tail < rb->capacity)
+    {
+        return 1;
+    }
+    // 캐시된 tail로는 가득 찬 것으로 보일 때만 공유 변수를 다시 읽는다.
+    rb->cached_tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    return (head - rb->cached_tail < rb->capacity) ? 1 : 0;
 }
 
 int lepton_ringbuffer_is_empty(LeptonRingBuffer* rb)
 {
-    return (rb->count == 0) ? 1 : 0;
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    // cached_head <= head 이므로 tail보다 크면 확실히 비어 있지 않다.
+    if (rb->cached_head > tail)
+    {
+        return 0;
+    }
+    rb->cached_head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    return (rb->cached_head == tail) ? 1 : 0;
 }
 
-int lepton_ringbuffer_enqueue(LeptonRingBuffer* rb, const uint16_t image[][LEPTON_WIDTH])
+size_t lepton_ringbuffer_count(LeptonRingBuffer* rb)
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    return head - tail;
+}
+
+// 생산자: 대기열에 keep개보다 많이 있으면 가장 오래된 프레임을 빼앗아 spare로 가져온다.
+// 성공 1, keep개 이하면 0. CAS에 실패하면(소비자가 먼저 가져감) 다시 세어서, 그 사이 자리가 났으면 버리지 않는다.
+static int _drop_oldest(LeptonRingBuffer* rb, size_t keep)
 {
-    if (lepton_ringbuffer_is_available(rb))
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+
+    while (head - tail > keep)
     {
-        #ifdef DEBUG
-        printf("HELLO!\n");
-        #endif
-        memcpy(rb->buffer[rb->head], image, sizeof(uint16_t)*LEPTON_HEIGHT*(LEPTON_WIDTH));
-        rb->head = (rb->head + OFFSET_SIZE) % (OFFSET_SIZE * BUFFER_SIZE);
-        rb->count++;
-        return 1;
+        uint32_t idx = atomic_load_explicit(&rb->queue[SLOT(tail)], memory_order_relaxed);
+        // 소비자와 같은 tail을 두고 경쟁한다. 이기면 그 프레임은 아무도 읽지 않는다.
+        if (atomic_compare_exchange_weak_explicit(&rb->tail, &tail, tail + 1,
+                                                  memory_order_acq_rel, memory_order_acquire))
+        {
+            rb->spare[rb->nspare++] = idx;
+            atomic_fetch_add_explicit(&rb->dropped_oldest, 1, memory_order_relaxed);
+            return 1;
+        }
     }
-    else
+    return 0;
+}
+
+// 생산자: 빈 프레임 하나를 가져온다 (spare -> free_q 순).
+static int32_t _take_free_frame(LeptonRingBuffer* rb)
+{
+    size_t free_head;
+
+    if (rb->nspare > 0)
+        return (int32_t)rb->spare[--rb->nspare];
+
+    free_head = atomic_load_explicit(&rb->free_head, memory_order_acquire);
+    if (rb->free_tail != free_head)
+        return (int32_t)atomic_load_explicit(&rb->free_q[rb->free_tail++ & rb->free_mask], memory_order_relaxed);
+
+    // 프레임이 capacity + 2개이므로 여기까지 오지 않는다.
+    return NO_FRAME;
+}
+
+uint16_t (*lepton_ringbuffer_reserve(LeptonRingBuffer* rb))[LEPTON_WIDTH]
+{
+    if (rb->prod_frame == NO_FRAME)
+    {
+        if (!lepton_ringbuffer_is_available(rb))
+        {
+            atomic_fetch_add_explicit(&rb->dropped_newest, 1, memory_order_relaxed);
+            return NULL; // 버퍼가 가득 참
+        }
+        rb->prod_frame = _take_free_frame(rb);
+        if (rb->prod_frame == NO_FRAME)
+            return NULL;
+    }
+    return rb->frames[rb->prod_frame];
+}
+
+void lepton_ringbuffer_commit(LeptonRingBuffer* rb)
+{
+    #ifdef DEBUG
+    printf("HELLO!\n");
+    #endif
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+
+    if (rb->prod_frame == NO_FRAME)
+        return;
+
+    if (rb->policy == RINGBUFFER_LATEST_ONLY)
+    {
+        while (_drop_oldest(rb, 0))
+            ;
+    }
+    else if (rb->policy == RINGBUFFER_DROP_OLDEST)
+    {
+        _drop_oldest(rb, rb->capacity - 1);
+    }
+
+    rb->commit_ns[rb->prod_frame] = latency_now_ns();
+    atomic_store_explicit(&rb->queue[SLOT(head)], (uint32_t)rb->prod_frame, memory_order_relaxed);
+    rb->prod_frame = NO_FRAME;
+    // release: 프레임과 queue 항목이 head 갱신보다 먼저 소비자에게 보이도록 한다.
+    atomic_store_explicit(&rb->head, head + 1, memory_order_release);
+
+    // head 갱신과 waiters 확인 사이의 순서를 보장한다 (소비자 쪽 fence와 짝).
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&rb->waiters, memory_order_relaxed) > 0)
+    {
+        atomic_fetch_add_explicit(&rb->wake_seq, 1, memory_order_relaxed);
+        syscall(SYS_futex, &rb->wake_seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+const uint16_t (*lepton_ringbuffer_acquire(LeptonRingBuffer* rb))[LEPTON_WIDTH]
+{
+    size_t tail;
+
+    if (rb->cons_frame != NO_FRAME)
+    {
+        return (const uint16_t (*)[LEPTON_WIDTH])rb->frames[rb->cons_frame];
+    }
+
+    tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    for (;;)
+    {
+        size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+        if (tail == head)
+        {
+            return NULL; // 버퍼가 비어 있음
+        }
+        uint32_t idx = atomic_load_explicit(&rb->queue[SLOT(tail)], memory_order_relaxed);
+        // 생산자가 같은 프레임을 버리는 중일 수 있으므로 CAS로 가져간다. 실패하면 tail이 갱신된다.
+        if (atomic_compare_exchange_weak_explicit(&rb->tail, &tail, tail + 1,
+                                                  memory_order_acq_rel, memory_order_acquire))
+        {
+            rb->cons_frame = (int32_t)idx;
+            return (const uint16_t (*)[LEPTON_WIDTH])rb->frames[idx];
+        }
+    }
+}
+
+const uint16_t (*lepton_ringbuffer_acquire_wait(LeptonRingBuffer* rb, int timeout_ms))[LEPTON_WIDTH]
+{
+    const uint16_t (*slot)[LEPTON_WIDTH];
+    uint64_t deadline = 0;
+
+    if (timeout_ms >= 0)
+        deadline = latency_now_ns() + (uint64_t)timeout_ms * 1000000ULL;
+
+    while ((slot = lepton_ringbuffer_acquire(rb)) == NULL)
+    {
+        struct timespec ts, *tsp = NULL;
+        unsigned int seq;
+
+        atomic_fetch_add_explicit(&rb->waiters, 1, memory_order_relaxed);
+        seq = atomic_load_explicit(&rb->wake_seq, memory_order_relaxed);
+        // waiters 증가 후에 head를 다시 확인해야 생산자의 깨우기를 놓치지 않는다.
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!lepton_ringbuffer_is_empty(rb))
+        {
+            atomic_fetch_sub_explicit(&rb->waiters, 1, memory_order_relaxed);
+            continue;
+        }
+        if (timeout_ms >= 0)
+        {
+            uint64_t now = latency_now_ns();
+            if (now >= deadline)
+            {
+                atomic_fetch_sub_explicit(&rb->waiters, 1, memory_order_relaxed);
+                return NULL;
+            }
+            ts.tv_sec = (time_t)((deadline - now) / 1000000000ULL);
+            ts.tv_nsec = (long)((deadline - now) % 1000000000ULL);
+            tsp = &ts;
+        }
+        // wake_seq가 seq에서 바뀌었으면 바로 반환된다 (EAGAIN).
+        syscall(SYS_futex, &rb->wake_seq, FUTEX_WAIT_PRIVATE, seq, tsp, NULL, 0);
+        atomic_fetch_sub_explicit(&rb->waiters, 1, memory_order_relaxed);
+    }
+    return slot;
+}
+
+uint64_t lepton_ringbuffer_commit_time(LeptonRingBuffer* rb)
+{
+    if (rb->cons_frame == NO_FRAME)
+        return 0;
+    return rb->commit_ns[rb->cons_frame];
+}
+
+void lepton_ringbuffer_release(LeptonRingBuffer* rb)
+{
+    size_t free_head;
+
+    if (rb->cons_frame == NO_FRAME)
+        return;
+    // 다 읽은 프레임을 생산자에게 돌려준다. release: 읽기가 끝난 뒤에야 생산자가 다시 쓴다.
+    free_head = atomic_load_explicit(&rb->free_head, memory_order_relaxed);
+    atomic_store_explicit(&rb->free_q[free_head & rb->free_mask], (uint32_t)rb->cons_frame, memory_order_relaxed);
+    atomic_store_explicit(&rb->free_head, free_head + 1, memory_order_release);
+    rb->cons_frame = NO_FRAME;
+}
+
+int lepton_ringbuffer_enqueue(LeptonRingBuffer* rb, const uint16_t image[][LEPTON_WIDTH])
+{
+    uint16_t (*slot)[LEPTON_WIDTH] = lepton_ringbuffer_reserve(rb);
+    if (slot == NULL)
     {
         printf("RingBuffer is full, cannot enqueue image.\n");
         return 0; // 버퍼가 가득 참
     }
+    memcpy(slot, image, sizeof(uint16_t)*LEPTON_HEIGHT*(LEPTON_WIDTH));
+    lepton_ringbuffer_commit(rb);
+    return 1;
 }
 
 int lepton_ringbuffer_dequeue(LeptonRingBuffer* rb, uint16_t image[][LEPTON_WIDTH])
 {
-    if (lepton_ringbuffer_is_empty(rb))
+    const uint16_t (*slot)[LEPTON_WIDTH] = lepton_ringbuffer_acquire(rb);
+    if (slot == NULL)
     {
         printf("RingBuffer is empty, cannot dequeue image.\n");
         return 0; // 버퍼가 비어 있음
     }
-    else
-    {
-        memcpy(image, rb->buffer[rb->tail], sizeof(uint16_t)*LEPTON_HEIGHT*(LEPTON_WIDTH));
-        rb->tail = (rb->tail + OFFSET_SIZE) % (OFFSET_SIZE * BUFFER_SIZE);
-        rb->count--;
-        return 1;
-    }
+    memcpy(image, slot, sizeof(uint16_t)*LEPTON_HEIGHT*(LEPTON_WIDTH));
+    lepton_ringbuffer_release(rb);
+    return 1;
 }
 
 
@@ -59,11 +424,17 @@ int lepton_ringbuffer_dequeue(LeptonRingBuffer* rb, uint16_t image[][LEPTON_WIDT
 static int print_ringbuffer_status(LeptonRingBuffer* rb)
 {
     printf("---- RingBuffer Status ----\n");
-    printf("RingBuffer Status: head=%zu, tail=%zu, count=%zu\n", rb->head, rb->tail, rb->count);
-    printf("RingBuffer buffer data: %04X %04X %04X ...\n", 
-        rb->buffer[rb->tail][0][0], 
-        rb->buffer[rb->tail][0][1], 
-        rb->buffer[rb->tail][0][2]);
+    size_t tail = atomic_load(&rb->tail);
+    size_t head = atomic_load(&rb->head);
+    printf("RingBuffer Status: head=%zu, tail=%zu, count=%zu\n", head, tail, head - tail);
+    if (head != tail)
+    {
+        uint32_t idx = atomic_load(&rb->queue[SLOT(tail)]);
+        printf("RingBuffer buffer data: %04X %04X %04X ...\n", 
+            rb->frames[idx][0][0], 
+            rb->frames[idx][0][1], 
+            rb->frames[idx][0][2]);
+    }
     printf("--------------------------\n");
     return 1;
 }
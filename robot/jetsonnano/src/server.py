@@ -5,11 +5,24 @@ import time
 import random
 import subprocess
 import os
+import struct
+import argparse
 
 # --- 설정 (Qt 코드와 맞춰야 함) ---
 TCP_PORT = 12345       # 명령/센서 데이터용
 UDP_PORT = 5000        # 음성 데이터용
 HOST = '0.0.0.0'       # 모든 접속 허용
+TELEMETRY_HZ = 10      # 센서 전송 주기 (--telemetry-hz). TLV 모드면 50~100Hz도 부담 없음
+TELEMETRY_BATCH_MS = 50  # 센서값을 이 시간 안에서 모아 한 번에 보냄 (--telemetry-batch-ms, 0 = 매번)
+
+# --- 바이너리 센서값 (docs/Protocol.md 2.4, JetDash telemetryparser.h와 맞춰야 함) ---
+# [sync 0xA5][body 길이 1B][TLV ...],  TLV = [tag 1B][len 1B][값, little-endian]
+TLV_SYNC = 0xA5
+TLV_CO_PPM = 0x01        # int16
+TLV_OBSTACLE_CM = 0x02   # int16
+TLV_ROLLOVER = 0x03      # uint8
+_TLV_RECORD = struct.Struct('<BB BBh BBh BBB')
+_TLV_BODY_SIZE = _TLV_RECORD.size - 2
 
 # --- 1. 오디오 처리 (UDP 수신 -> 스피커 출력) ---
 def audio_receiver():
@@ -38,22 +51,108 @@ def audio_receiver():
             print(f"Audio Error: {e}")
 
 # --- 2. 센서 데이터 전송 (Telemetry) ---
-def send_telemetry(conn):
+def read_sensors():
+    # 가짜 데이터 생성 (나중에 실제 센서 연결)
+    co_ppm = random.randint(0, 50)
+    obstacle_cm = random.randint(10, 200)
+    rollover = random.choice([True, False]) if random.random() > 0.9 else False
+    return co_ppm, obstacle_cm, rollover
+
+def encode_telemetry_json(co_ppm, obstacle_cm, rollover):
+    data = {
+        "type": "TELEMETRY",
+        "payload": {
+            "co_ppm": co_ppm,
+            "obstacle_cm": obstacle_cm,
+            "rollover": rollover
+        }
+    }
+    return (json.dumps(data) + "\n").encode()
+
+def _int16(v):
+    return max(-32768, min(32767, int(v)))
+
+def encode_telemetry_tlv(co_ppm, obstacle_cm, rollover):
+    # 13바이트 (JSON은 약 80바이트)
+    return _TLV_RECORD.pack(TLV_SYNC, _TLV_BODY_SIZE,
+                            TLV_CO_PPM, 2, _int16(co_ppm),
+                            TLV_OBSTACLE_CM, 2, _int16(obstacle_cm),
+                            TLV_ROLLOVER, 1, 1 if rollover else 0)
+
+class Session:
+    """연결 하나의 상태. 명령 ACK(명령 쓰레드)와 센서값(센서 쓰레드)이 같은 소켓에 쓰므로 send()로만 씀"""
+    def __init__(self, conn):
+        self.conn = conn
+        self.lock = threading.Lock()
+        self.telemetry = 'JSON'     # 지금 센서값 형식
+        self.hello = None           # HELLO를 받고 아직 응답 안 보낸 형식
+        self.acks = False           # HELLO를 보낸 클라이언트에게만 명령 ACK를 보냄
+
+    def send(self, data):
+        with self.lock:
+            self.conn.sendall(data)
+
+def handle_hello(session, payload):
+    # 클라이언트가 받을 수 있는 형식 목록 중 TLV가 있으면 TLV, 아니면 JSON 유지
+    wanted = payload.get('telemetry', [])
+    if isinstance(wanted, str):
+        wanted = [wanted]
+    session.acks = True
+    session.hello = 'TLV' if 'TLV' in wanted else 'JSON'
+
+def send_ack(session, request, rx_ns, exec_ns):
+    # 급한 메시지: 센서값 배치를 기다리지 않고 바로 보냄 (docs/Protocol.md 2.5)
+    # rx_ns/exec_ns는 로봇 CLOCK_MONOTONIC. 클라이언트는 exec_ns - rx_ns(로봇 처리 시간)만 씀
+    if session.acks:
+        payload = {"target": request['payload'].get('target'), "rx_ns": rx_ns, "exec_ns": exec_ns}
+        if 'seq' in request:
+            payload["seq"] = request['seq']
+        ack = {"type": "ACK", "payload": payload}
+        session.send((json.dumps(ack) + "\n").encode())
+
+def send_telemetry(session, hz=None, batch_ms=None):
     print("센서 데이터 전송 시작...")
+    period = 1.0 / (hz or TELEMETRY_HZ)
+    batch_s = (TELEMETRY_BATCH_MS if batch_ms is None else batch_ms) / 1000.0
+    batch = bytearray()
+    batch_start = 0.0
+    next_time = time.monotonic()
     while True:
         try:
-            # 가짜 데이터 생성 (나중에 실제 센서 연결)
-            data = {
-                "type": "TELEMETRY",
-                "payload": {
-                    "co_ppm": random.randint(0, 50),
-                    "obstacle_cm": random.randint(10, 200),
-                    "rollover": random.choice([True, False]) if random.random() > 0.9 else False
-                }
-            }
-            message = json.dumps(data) + "\n"
-            conn.sendall(message.encode())
-            time.sleep(0.1) # 0.1초마다 전송
+            mode = session.hello
+            if mode:
+                # 모아둔 것과 응답을 먼저 보내고 그 다음 메시지부터 형식을 바꿉니다
+                session.hello = None
+                ack = {"type": "HELLO", "payload": {"telemetry": mode, "rate_hz": round(1.0 / period)}}
+                batch += (json.dumps(ack) + "\n").encode()
+                session.send(batch)
+                batch.clear()
+                if mode != session.telemetry:
+                    print(f"센서값 형식: {mode}")
+                session.telemetry = mode
+
+            values = read_sensors()
+            now = time.monotonic()
+            if not batch:
+                batch_start = now
+            if session.telemetry == 'TLV':
+                batch += encode_telemetry_tlv(*values)
+            else:
+                batch += encode_telemetry_json(*values)
+
+            # 다음 값까지 기다리면 배치 시간을 넘는 경우에만 보냄
+            # (TCP_NODELAY라 write 한 번 = 패킷 하나. 10Hz에서는 매번, 100Hz에서는 5개씩)
+            if now - batch_start + period >= batch_s:
+                session.send(batch)
+                batch.clear()
+
+            # 고정 주기 (전송 시간만큼 밀리지 않게)
+            next_time += period
+            delay = next_time - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            else:
+                next_time = time.monotonic()
         except:
             break # 연결 끊기면 종료
 
@@ -72,30 +171,40 @@ def start_server():
     while True:
         conn, addr = server.accept()
         print(f"클라이언트 연결됨: {addr}")
+        handle_client(conn)
 
-        # 센서 데이터 보내는 쓰레드 시작
-        telemetry_thread = threading.Thread(target=send_telemetry, args=(conn,), daemon=True)
-        telemetry_thread.start()
+def handle_client(conn, hz=None, batch_ms=None):
+    # 작은 명령/ACK가 Nagle에 걸려 상대의 지연 ACK(최대 40ms)를 기다리지 않도록
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    session = Session(conn)
 
-        # 명령(Command) 받는 반복문
-        try:
-            # 데이터를 줄 단위로 읽기 위해 파일 객체처럼 변환
-            with conn.makefile('r') as f:
-                for line in f:
-                    if not line.strip(): continue
-                    
-                    try:
-                        # JSON 파싱
-                        request = json.loads(line)
-                        if request['type'] == 'COMMAND':
-                            process_command(request['payload'])
-                    except json.JSONDecodeError:
-                        print(f"깨진 데이터 수신: {line}")
-                        
-        except Exception as e:
-            print(f"연결 끊김: {e}")
-        finally:
-            conn.close()
+    # 센서 데이터 보내는 쓰레드 시작
+    telemetry_thread = threading.Thread(target=send_telemetry, args=(session, hz, batch_ms), daemon=True)
+    telemetry_thread.start()
+
+    # 명령(Command) 받는 반복문
+    try:
+        # 데이터를 줄 단위로 읽기 위해 파일 객체처럼 변환
+        with conn.makefile('r') as f:
+            for line in f:
+                if not line.strip(): continue
+
+                try:
+                    # JSON 파싱
+                    rx_ns = time.monotonic_ns()
+                    request = json.loads(line)
+                    if request['type'] == 'COMMAND':
+                        process_command(request['payload'])
+                        send_ack(session, request, rx_ns, time.monotonic_ns())
+                    elif request['type'] == 'HELLO':
+                        handle_hello(session, request.get('payload', {}))
+                except json.JSONDecodeError:
+                    print(f"깨진 데이터 수신: {line}")
+
+    except Exception as e:
+        print(f"연결 끊김: {e}")
+    finally:
+        conn.close()
 
 # --- 4. 명령 처리 로직 ---
 def process_command(payload):
@@ -103,6 +212,8 @@ def process_command(payload):
     value = payload.get('value')
     action = payload.get('action')
 
+    if target == 'PING': return     # 왕복 시간 측정용 (ACK만 보냄)
+
     print(f"⚙️ 명령 처리: 타겟={target}, 값={value}")
 
     if target == 'DRIVE':
@@ -120,4 +231,11 @@ def process_command(payload):
         if action == 'REBOOT': print("재부팅 시퀀스!")
 
 if __name__ == "__main__":
-    start_server()
\ No newline at end of file
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--telemetry-hz', type=float, default=TELEMETRY_HZ, help='센서값 전송 주기 (Hz)')
+    parser.add_argument('--telemetry-batch-ms', type=float, default=TELEMETRY_BATCH_MS,
+                        help='센서값을 모아 보내는 시간 (ms, 0 = 매번)')
+    args = parser.parse_args()
+    TELEMETRY_HZ = args.telemetry_hz
+    TELEMETRY_BATCH_MS = args.telemetry_batch_ms
+    start_server()
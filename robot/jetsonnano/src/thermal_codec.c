@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/thermal_codec.h"
+
+
+void thermal_encoder_init(ThermalEncoder *e)
+{
+    memset(e, 0, sizeof(*e));
+}
+
+void thermal_encoder_force_keyframe(ThermalEncoder *e)
+{
+    e->have_prev = 0;
+}
+
+void thermal_decoder_init(ThermalDecoder *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+// LOCO-I median edge detector. 첫 행은 왼쪽, 첫 열은 위 픽셀로 예측한다.
+static inline uint16_t _med(const uint16_t (*f)[LEPTON_WIDTH], int y, int x)
+{
+    uint16_t a, b, c, mx, mn;
+
+    if (y == 0)
+        return x ? f[0][x - 1] : 0;
+    if (x == 0)
+        return f[y - 1][0];
+    a = f[y][x - 1];
+    b = f[y - 1][x];
+    c = f[y - 1][x - 1];
+    mx = (a > b) ? a : b;
+    mn = (a > b) ? b : a;
+    if (c >= mx)
+        return mn;
+    if (c <= mn)
+        return mx;
+    return (uint16_t)(a + b - c);
+}
+
+static inline uint16_t _zigzag(uint16_t cur, uint16_t pred)
+{
+    int16_t r = (int16_t)(uint16_t)(cur - pred);
+    return (uint16_t)(((uint16_t)r << 1) ^ (uint16_t)(r >> 15));
+}
+
+static inline uint16_t _unzigzag(uint16_t z, uint16_t pred)
+{
+    return (uint16_t)(pred + ((z >> 1) ^ (uint16_t)-(z & 1)));
+}
+
+static inline int _bit_width(uint16_t v)
+{
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+// 16개 값을 w비트씩 LSB부터 이어 붙인다. 2w 바이트를 쓴다.
+static uint8_t *_pack(uint8_t *out, const uint16_t *z, int w)
+{
+    uint32_t acc = 0;
+    int bits = 0;
+
+    for (int i = 0; i < THERMAL_CODEC_BLOCK; i++)
+    {
+        acc |= (uint32_t)z[i] << bits;
+        bits += w;
+        while (bits >= 8)
+        {
+            *out++ = (uint8_t)acc;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    return out;
+}
+
+static const uint8_t *_unpack(const uint8_t *in, uint16_t *z, int w)
+{
+    uint32_t acc = 0;
+    uint32_t mask = (1u << w) - 1;
+    int bits = 0;
+
+    for (int i = 0; i < THERMAL_CODEC_BLOCK; i++)
+    {
+        while (bits < w)
+        {
+            acc |= (uint32_t)*in++ << bits;
+            bits += 8;
+        }
+        z[i] = (uint16_t)(acc & mask);
+        acc >>= w;
+        bits -= w;
+    }
+    return in;
+}
+
+size_t thermal_encode(ThermalEncoder *e, const uint16_t (*frame)[LEPTON_WIDTH], uint8_t *out)
+{
+    uint16_t zs[THERMAL_CODEC_BLOCK], zt[THERMAL_CODEC_BLOCK];
+    uint8_t *p = out;
+    int keyframe = !e->have_prev || e->since_keyframe >= THERMAL_CODEC_KEYFRAME_INTERVAL;
+
+    *p++ = keyframe ? THERMAL_CODEC_FLAG_KEYFRAME : 0;
+    *p++ = THERMAL_CODEC_BLOCK;
+
+    for (int y = 0; y < LEPTON_HEIGHT; y++)
+    {
+        for (int x0 = 0; x0 < LEPTON_WIDTH; x0 += THERMAL_CODEC_BLOCK)
+        {
+            uint16_t or_s = 0, or_t = 0xffff;
+            int ws, wt;
+
+            for (int i = 0; i < THERMAL_CODEC_BLOCK; i++)
+            {
+                zs[i] = _zigzag(frame[y][x0 + i], _med(frame, y, x0 + i));
+                or_s |= zs[i];
+            }
+            if (!keyframe)
+            {
+                or_t = 0;
+                for (int i = 0; i < THERMAL_CODEC_BLOCK; i++)
+                {
+                    zt[i] = _zigzag(frame[y][x0 + i], e->prev[y][x0 + i]);
+                    or_t |= zt[i];
+                }
+            }
+
+            ws = _bit_width(or_s);
+            wt = _bit_width(or_t);
+            if (!keyframe && wt < ws)
+            {
+                *p++ = (uint8_t)(THERMAL_CODEC_BLOCK_TEMPORAL | wt);
+                p = _pack(p, zt, wt);
+            }
+            else
+            {
+                *p++ = (uint8_t)ws;
+                p = _pack(p, zs, ws);
+            }
+        }
+    }
+
+    memcpy(e->prev, frame, sizeof(e->prev));
+    e->have_prev = 1;
+    e->since_keyframe = keyframe ? 1 : e->since_keyframe + 1;
+    return (size_t)(p - out);
+}
+
+int thermal_decode(ThermalDecoder *d, const uint8_t *in, size_t len, uint16_t (*frame)[LEPTON_WIDTH])
+{
+    const uint8_t *p = in, *end = in + len;
+    uint16_t z[THERMAL_CODEC_BLOCK];
+
+    if (len < 2 || in[1] != THERMAL_CODEC_BLOCK)
+        return -1;
+    if (!(in[0] & THERMAL_CODEC_FLAG_KEYFRAME) && !d->have_prev)
+        return 0;
+    p += 2;
+
+    for (int y = 0; y < LEPTON_HEIGHT; y++)
+    {
+        for (int x0 = 0; x0 < LEPTON_WIDTH; x0 += THERMAL_CODEC_BLOCK)
+        {
+            int w, temporal;
+
+            if (p >= end)
+                return -1;
+            w = *p & THERMAL_CODEC_BLOCK_WIDTH_MASK;
+            temporal = *p & THERMAL_CODEC_BLOCK_TEMPORAL;
+            p++;
+            if (w > 16 || p + 2 * w > end || (temporal && !d->have_prev))
+                return -1;
+            p = _unpack(p, z, w);
+
+            // 공간 예측은 방금 복원한 왼쪽 픽셀을 쓰므로 순서대로 복원한다.
+            for (int i = 0; i < THERMAL_CODEC_BLOCK; i++)
+            {
+                uint16_t pred = temporal ? d->prev[y][x0 + i] : _med((const uint16_t (*)[LEPTON_WIDTH])frame, y, x0 + i);
+                frame[y][x0 + i] = _unzigzag(z[i], pred);
+            }
+        }
+    }
+    if (p != end)
+        return -1;
+
+    memcpy(d->prev, frame, sizeof(d->prev));
+    d->have_prev = 1;
+    return 1;
+}
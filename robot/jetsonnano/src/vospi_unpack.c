@@ -0,0 +1,200 @@
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VOSPI_HAVE_X86 1
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VOSPI_HAVE_NEON 1
+#endif
+
+#include "../include/vospi_unpack.h"
+#include "../include/lepton.h"
+
+typedef void (*UnpackFn)(uint16_t *dst, const uint8_t *src, int n);
+
+static void _unpack_scalar(uint16_t *dst, const uint8_t *src, int n);
+static UnpackFn active_fn = _unpack_scalar;
+static int active_impl = VOSPI_UNPACK_IMPL_SCALAR;
+static int initialized = 0;
+
+
+static void _unpack_scalar(uint16_t *dst, const uint8_t *src, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        dst[i] = (uint16_t)((src[2*i] << 8 | src[2*i+1]) & VOSPI_PIXEL_MASK);
+    }
+}
+
+
+// ------------------ x86 ------------------ //
+#if defined(VOSPI_HAVE_X86)
+__attribute__((target("ssse3")))
+static void _unpack_ssse3(uint16_t *dst, const uint8_t *src, int n)
+{
+    const __m128i swap = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m128i mask = _mm_set1_epi16(VOSPI_PIXEL_MASK);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_and_si128(_mm_shuffle_epi8(v, swap), mask));
+    }
+    _unpack_scalar(dst + i, src + 2 * i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void _unpack_avx2(uint16_t *dst, const uint8_t *src, int n)
+{
+    const __m256i swap = _mm256_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                         14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m256i mask = _mm256_set1_epi16(VOSPI_PIXEL_MASK);
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_and_si256(_mm256_shuffle_epi8(v, swap), mask));
+    }
+    // 80픽셀 = 16 * 5 이므로 보통은 남지 않는다.
+    _unpack_ssse3(dst + i, src + 2 * i, n - i);
+}
+
+static int _impl_supported(int impl)
+{
+    __builtin_cpu_init();
+    if (impl == VOSPI_UNPACK_IMPL_SSSE3)
+        return __builtin_cpu_supports("ssse3");
+    if (impl == VOSPI_UNPACK_IMPL_AVX2)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("ssse3");
+    return impl == VOSPI_UNPACK_IMPL_SCALAR;
+}
+
+static UnpackFn _impl_fn(int impl)
+{
+    switch (impl)
+    {
+    case VOSPI_UNPACK_IMPL_SSSE3: return _unpack_ssse3;
+    case VOSPI_UNPACK_IMPL_AVX2:  return _unpack_avx2;
+    default:                      return _unpack_scalar;
+    }
+}
+
+
+// ------------------ ARM NEON ------------------ //
+#elif defined(VOSPI_HAVE_NEON)
+static void _unpack_neon(uint16_t *dst, const uint8_t *src, int n)
+{
+    const uint16x8_t mask = vdupq_n_u16(VOSPI_PIXEL_MASK);
+    int i = 0;
+
+    // 16픽셀(32바이트)씩 두 벡터로 처리해서 load 지연을 숨긴다.
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16_t a = vld1q_u8(src + 2 * i);
+        uint8x16_t b = vld1q_u8(src + 2 * i + 16);
+        vst1q_u16(dst + i, vandq_u16(vreinterpretq_u16_u8(vrev16q_u8(a)), mask));
+        vst1q_u16(dst + i + 8, vandq_u16(vreinterpretq_u16_u8(vrev16q_u8(b)), mask));
+    }
+    for (; i + 8 <= n; i += 8)
+    {
+        uint8x16_t a = vld1q_u8(src + 2 * i);
+        vst1q_u16(dst + i, vandq_u16(vreinterpretq_u16_u8(vrev16q_u8(a)), mask));
+    }
+    _unpack_scalar(dst + i, src + 2 * i, n - i);
+}
+
+static int _impl_supported(int impl)
+{
+    return impl == VOSPI_UNPACK_IMPL_SCALAR || impl == VOSPI_UNPACK_IMPL_NEON;
+}
+
+static UnpackFn _impl_fn(int impl)
+{
+    return (impl == VOSPI_UNPACK_IMPL_NEON) ? _unpack_neon : _unpack_scalar;
+}
+
+
+#else
+static int _impl_supported(int impl)
+{
+    return impl == VOSPI_UNPACK_IMPL_SCALAR;
+}
+
+static UnpackFn _impl_fn(int impl)
+{
+    (void)impl;
+    return _unpack_scalar;
+}
+#endif
+
+
+void vospi_unpack_line_impl(uint16_t *dst, const uint8_t *src, int n, int impl)
+{
+    _impl_fn(impl)(dst, src, n);
+}
+
+void vospi_unpack_line(uint16_t *dst, const uint8_t *src, int n)
+{
+    active_fn(dst, src, n);
+}
+
+// 가속 경로 자체 검증: 임의 패킷 payload에 대해 기준 구현과 비교한다.
+static int _self_test(int impl)
+{
+    uint8_t src[2 * VOSPI_PACKET_PIXELS];
+    uint16_t ref[VOSPI_PACKET_PIXELS], out[VOSPI_PACKET_PIXELS];
+    uint32_t seed = 0x1234;
+
+    for (int round = 0; round < 4; round++)
+    {
+        for (int i = 0; i < (int)sizeof(src); i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            src[i] = (uint8_t)(seed >> 16);
+        }
+        _unpack_scalar(ref, src, VOSPI_PACKET_PIXELS);
+        _impl_fn(impl)(out, src, VOSPI_PACKET_PIXELS);
+        if (memcmp(ref, out, sizeof(ref)) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+void vospi_unpack_init(void)
+{
+    // 빠른 구현부터 고른다.
+    static const int order[] = { VOSPI_UNPACK_IMPL_AVX2, VOSPI_UNPACK_IMPL_NEON, VOSPI_UNPACK_IMPL_SSSE3 };
+
+    if (initialized)
+        return;
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        if (_impl_supported(order[i]) && _self_test(order[i]))
+        {
+            active_impl = order[i];
+            active_fn = _impl_fn(order[i]);
+            break;
+        }
+    }
+    initialized = 1;
+}
+
+int vospi_unpack_active_impl(void)
+{
+    return active_impl;
+}
+
+int vospi_unpack_impl_available(int impl)
+{
+    return _impl_supported(impl);
+}
+
+const char *vospi_unpack_impl_name(int impl)
+{
+    static const char *names[VOSPI_UNPACK_IMPL_COUNT] = { "scalar", "ssse3", "avx2", "neon" };
+    return (impl >= 0 && impl < VOSPI_UNPACK_IMPL_COUNT) ? names[impl] : "?";
+}
@@ -0,0 +1,475 @@
+/*
+ * 양방향 음성 loopback 테스트 (docs/Protocol.md 4.5)
+ *
+ * 같은 프로세스 안에서 control_server_run() thread를 띄우고 장치 대신 파이프/파일을 쓴다.
+ *   1. 양방향: 로봇 마이크 = 파이프 (arecord처럼 10ms마다 80샘플, 250ms마다 클릭),
+ *      로봇 스피커 = 파이프 (aplay 대신 drain thread가 읽음).
+ *      운영자 thread는 HELLO로 listen을 협상하고 UDP로 받은 로봇 마이크 패킷을 JitterBuffer
+ *      (JetDash AudioJitterBuffer와 같은 동작)로 10ms마다 재생하면서, 동시에 20ms ADPCM 프레임
+ *      (250ms마다 클릭)을 로봇에 보낸다.
+ *      클릭이 캡처된 시각 -> 반대편에서 재생된 시각으로 양쪽 mouth-to-ear 지연을 재고,
+ *      로봇 -> 운영자는 단계별(캡처 + 네트워크, 로봇 프레임/인코드 = 헤더 delay, 지터 버퍼 대기)로도 나눈다.
+ *      재생 장치 큐와 JetDash 리샘플러는 여기서 돌지 않으므로 가정값(DEVICE_QUEUE_MS, RESAMPLER_MS)을 더해서
+ *      150ms 안인지 확인한다.
+ *   2. 파일 마이크 (main.c -A): PCM16 listen 패킷이 파일 내용 그대로, seq가 빠짐없이, 20ms 간격으로 오는지
+ *
+ * Build: gcc -O2 -pthread -o audio_duplex_test test/audio_duplex_test.c src/network.c src/audio_codec.c \
+ *            src/jitter_buffer.c src/thermal_codec.c src/latency_hist.c -lm
+ * Usage: ./audio_duplex_test [초, 기본 3]
+ */
+
+#define _GNU_SOURCE                     // ppoll()
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "../include/jitter_buffer.h"
+#include "../include/network.h"
+#include "../include/latency_hist.h"
+
+#define TEST_CONTROL_PORT 24345
+#define TEST_AUDIO_PORT 24500
+#define TEST_LISTEN_PORT 24503
+#define MIC_PERIOD_MS 10                // arecord --period-time (main.c AUDIO_CAPTURE_PERIOD_MS)
+#define MIC_CHUNK (AUDIO_RATE * MIC_PERIOD_MS / 1000)
+#define TALK_FRAME_MS 20                // JetDash AUDIO_FRAME_MS
+#define TALK_FRAME (AUDIO_RATE * TALK_FRAME_MS / 1000)
+#define CLICK_EVERY_MS 250
+#define CLICK_SAMPLES 40                // 5ms, 1kHz 사각파
+#define CLICK_AMPLITUDE 16000
+#define CLICK_THRESHOLD 8000
+#define CLICK_HOLDOFF (AUDIO_RATE / 10) // 검출 뒤 100ms는 무시 (PLC가 클릭을 반복해도 한 번)
+#define MAX_CLICKS 256
+#define DEVICE_QUEUE_MS 20              // 가정: QAudioSink 큐 / aplay 버퍼 중 재생 전에 남는 양
+#define RESAMPLER_MS 2                  // 가정: JetDash 8k <-> 48k 리샘플러 군지연 (docs/Protocol.md 4.3)
+#define BUDGET_MS 150
+#define FILE_SAMPLES 4000               // 파일 마이크 길이 (프레임 160샘플의 배수라 반복해도 timestamp와 맞음)
+
+#define CHECK(cond, msg) do { if (!(cond)) { printf("FAIL: %s\n", msg); ok = 0; } else printf("ok:   %s\n", msg); } while (0)
+
+// 한 방향의 클릭: 캡처 시각(보내는 쪽)과 재생 시각(받는 쪽)
+typedef struct {
+    uint64_t captured[MAX_CLICKS];
+    int sent;
+    uint64_t heard[MAX_CLICKS];
+    int detected;
+    int holdoff;
+} ClickTrack;
+
+static ControlServer server;
+static int mic_pipe[2], sink_pipe[2];
+static volatile int stop_audio;
+static uint64_t talk_end_ns;            // 양쪽 마이크는 여기까지만 (프레임 중간에 끊기면 마지막 클릭이 안 나감)
+static ClickTrack robot_clicks, operator_clicks;
+static uint64_t mic_start_ns;           // 로봇 마이크 첫 샘플 캡처 시각 (timestamp 0)
+
+// 운영자 쪽 결과 (operator thread가 끝난 뒤 읽음)
+static JitterBuffer listen_jb;
+static LatencyHist sender_delay;        // 헤더 delay (로봇이 첫 샘플 읽음 -> 전송)
+static LatencyHist capture_network;     // 첫 샘플 캡처 -> 운영자 도착 - delay
+static unsigned long talk_sent;
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    control_server_run(&server);
+    return NULL;
+}
+
+static void sleep_until(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static void make_click(int16_t *pcm)
+{
+    for (int i = 0; i < CLICK_SAMPLES; i++)
+        pcm[i] = (i / 4) % 2 ? -CLICK_AMPLITUDE : CLICK_AMPLITUDE;
+}
+
+// 재생된 n개 중 클릭 시작을 찾는다. 마지막 샘플이 end_ns에 재생된 것으로 본다
+static void detect_clicks(ClickTrack *t, const int16_t *pcm, size_t n, uint64_t end_ns)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (t->holdoff > 0)
+        {
+            t->holdoff--;
+            continue;
+        }
+        if (abs(pcm[i]) < CLICK_THRESHOLD || t->detected >= MAX_CLICKS)
+            continue;
+        t->heard[t->detected++] = end_ns - (uint64_t)(n - 1 - i) * 1000000000ULL / AUDIO_RATE;
+        t->holdoff = CLICK_HOLDOFF;
+    }
+}
+
+// arecord 흉내: 10ms마다 지난 10ms 분량을 파이프에 쓴다
+static void *robot_mic_thread(void *arg)
+{
+    int16_t chunk[MIC_CHUNK];
+    uint64_t next;
+    unsigned k = 0;
+    (void)arg;
+
+    mic_start_ns = latency_now_ns();
+    next = mic_start_ns + MIC_PERIOD_MS * 1000000ULL;
+    while (next <= talk_end_ns)
+    {
+        sleep_until(next);
+        memset(chunk, 0, sizeof(chunk));
+        if (k % (CLICK_EVERY_MS / MIC_PERIOD_MS) == 0 && robot_clicks.sent < MAX_CLICKS)
+        {
+            make_click(chunk);
+            robot_clicks.captured[robot_clicks.sent++] = next - MIC_PERIOD_MS * 1000000ULL;
+        }
+        if (write(mic_pipe[1], chunk, sizeof(chunk)) < 0)
+            break;
+        next += MIC_PERIOD_MS * 1000000ULL;
+        k++;
+    }
+    return NULL;
+}
+
+// 로봇 스피커 (aplay 대신): 읽은 시각에 재생된 것으로 본다
+static void *robot_speaker_thread(void *arg)
+{
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES];
+    ssize_t n;
+    (void)arg;
+    while ((n = read(sink_pipe[0], pcm, sizeof(pcm))) > 0)
+        detect_clicks(&operator_clicks, pcm, (size_t)n / sizeof(int16_t), latency_now_ns());
+    return NULL;
+}
+
+// JetDash 흉내: 받은 로봇 마이크 패킷 -> 지터 버퍼 -> 10ms마다 재생, 20ms마다 운영자 마이크 프레임 전송
+static void *operator_thread(void *arg)
+{
+    int fd = *(int *)arg;
+    int talk = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in robot;
+    uint8_t pkt[AUDIO_PACKET_HEADER + AUDIO_PACKET_MAX_SAMPLES * 2];
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES];
+    int16_t frame[TALK_FRAME];
+    ImaAdpcmState adpcm = { 0, 0 };
+    uint64_t now = latency_now_ns();
+    uint64_t next_tick = now + JITTER_TICK_MS * 1000000ULL;
+    uint64_t next_frame = now + TALK_FRAME_MS * 1000000ULL;
+    unsigned k = 0;
+
+    memset(&robot, 0, sizeof(robot));
+    robot.sin_family = AF_INET;
+    robot.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    robot.sin_port = htons(TEST_AUDIO_PORT);
+    jitter_buffer_init(&listen_jb, AUDIO_RATE);
+    latency_hist_reset(&sender_delay);
+    latency_hist_reset(&capture_network);
+
+    while (!stop_audio)
+    {
+        struct pollfd p = { fd, POLLIN, 0 };
+        uint64_t wake = next_tick < next_frame ? next_tick : next_frame;
+        struct timespec ts;
+        ssize_t len;
+
+        now = latency_now_ns();
+        ts.tv_sec = 0;
+        ts.tv_nsec = wake > now ? (long)(wake - now) : 0;
+        ppoll(&p, 1, &ts, NULL);
+
+        while ((len = recv(fd, pkt, sizeof(pkt), MSG_DONTWAIT)) > 0)
+        {
+            AudioPacketHeader h;
+            uint64_t arrival = latency_now_ns();
+            if (audio_packet_decode(pkt, (size_t)len, &h, pcm, AUDIO_PACKET_MAX_SAMPLES) < 0)
+                continue;
+            // 로봇 timestamp 0 = 파이프에 쓴 첫 샘플이라 캡처 시각을 바로 안다
+            uint64_t captured = mic_start_ns + (uint64_t)h.timestamp * 1000000000ULL / AUDIO_RATE;
+            uint64_t delay = (uint64_t)h.delay * 100000ULL;
+            latency_hist_add(&sender_delay, delay);
+            latency_hist_add(&capture_network, arrival - captured - delay);
+            jitter_buffer_put(&listen_jb, pkt, (size_t)len, arrival);
+        }
+
+        now = latency_now_ns();
+        if (now >= next_tick)
+        {
+            size_t n = jitter_buffer_get(&listen_jb, now, pcm, AUDIO_PACKET_MAX_SAMPLES);
+            detect_clicks(&robot_clicks, pcm, n, now);
+            next_tick += JITTER_TICK_MS * 1000000ULL;
+        }
+        if (now >= next_frame && next_frame <= talk_end_ns)
+        {
+            // 프레임 첫 샘플은 20ms 전에 캡처됨 (JetDash AudioEncoder가 프레임을 다 모았을 때 보냄)
+            AudioPacketHeader h = { .codec = AUDIO_CODEC_IMA_ADPCM, .seq = (uint16_t)k, .timestamp = k * TALK_FRAME };
+            memset(frame, 0, sizeof(frame));
+            if (k % (CLICK_EVERY_MS / TALK_FRAME_MS) == 0 && operator_clicks.sent < MAX_CLICKS)
+            {
+                make_click(frame);
+                operator_clicks.captured[operator_clicks.sent++] = next_frame - TALK_FRAME_MS * 1000000ULL;
+            }
+            len = (ssize_t)audio_packet_encode(&h, &adpcm, frame, TALK_FRAME, pkt);
+            if (sendto(talk, pkt, (size_t)len, 0, (struct sockaddr *)&robot, sizeof(robot)) == len)
+                talk_sent++;
+            next_frame += TALK_FRAME_MS * 1000000ULL;
+            k++;
+        }
+    }
+    close(talk);
+    return NULL;
+}
+
+static int udp_bind(uint16_t port)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("bind()");
+        return -1;
+    }
+    return fd;
+}
+
+// HELLO를 보내고 응답 한 줄을 reply에 받는다
+static int hello(const char *line, char *reply, size_t size)
+{
+    struct sockaddr_in addr;
+    struct timeval tv = { 2, 0 };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ssize_t n;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_CONTROL_PORT);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || write(fd, line, strlen(line)) < 0)
+    {
+        perror("connect()");
+        close(fd);
+        return -1;
+    }
+    n = read(fd, reply, size - 1);
+    reply[n > 0 ? n : 0] = '\0';
+    return fd;
+}
+
+// 클릭 캡처 -> 재생. 재생된 클릭마다 그 전에 캡처된 가장 가까운 클릭과 짝짓습니다 (지연 < 클릭 간격).
+// 지터 버퍼가 지연을 줄이며 건너뛴 10ms에 걸린 클릭은 빠질 수 있다. 짝지은 수
+static int mouth_to_ear(const ClickTrack *t, LatencyHist *h)
+{
+    int matched = 0, i = 0;
+    latency_hist_reset(h);
+    for (int d = 0; d < t->detected; d++)
+    {
+        while (i + 1 < t->sent && t->captured[i + 1] <= t->heard[d])
+            i++;
+        if (i < t->sent && t->captured[i] <= t->heard[d] &&
+            t->heard[d] - t->captured[i] < CLICK_EVERY_MS * 1000000ULL)
+        {
+            latency_hist_add(h, t->heard[d] - t->captured[i]);
+            matched++;
+        }
+    }
+    return matched;
+}
+
+static double p_ms(const LatencyHist *h, double p)
+{
+    return latency_hist_percentile(h, p) / 1e6;
+}
+
+static int run_duplex(double seconds)
+{
+    pthread_t srv, mic, speaker, op;
+    char reply[512];
+    const char *line = "{\"type\": \"HELLO\", \"payload\": {\"audio\": [\"ADPCM\"], "
+                       "\"listen\": [\"ADPCM\", \"PCM\"], \"listen_port\": 24503}}\n";
+    int listen_fd, ctl, n, ok = 1;
+    LatencyHist listen_m2e, talk_m2e;
+    const JitterStats *st;
+    double capture, sender, wait, total;
+
+    if (pipe(mic_pipe) < 0 || pipe(sink_pipe) < 0 ||
+        control_server_open(&server, TEST_CONTROL_PORT, TEST_AUDIO_PORT, NULL) < 0)
+        return 0;
+    control_server_set_telemetry(&server, 0, 0, NULL, NULL);
+    control_server_set_audio_sink(&server, sink_pipe[1], AUDIO_RATE);
+    CHECK(control_server_set_audio_source(&server, mic_pipe[0], AUDIO_RATE, 0, MIC_PERIOD_MS) > 0,
+          "파이프 마이크 등록");
+    if ((listen_fd = udp_bind(TEST_LISTEN_PORT)) < 0)
+        return 0;
+    pthread_create(&srv, NULL, server_thread, NULL);
+    pthread_create(&speaker, NULL, robot_speaker_thread, NULL);
+
+    ctl = hello(line, reply, sizeof(reply));
+    CHECK(ctl >= 0 && strstr(reply, "\"listen\": \"ADPCM\"") && strstr(reply, "\"listen_rate\": 8000") &&
+          strstr(reply, "\"listen_capture_ms\": 10"), "HELLO로 listen ADPCM 협상 (주파수, 캡처 주기)");
+
+    printf("\n[양방향] %.0f초: 로봇 마이크(파이프) -> UDP %d -> 운영자 지터 버퍼, 운영자 -> UDP %d -> 로봇 지터 버퍼 -> 파이프\n",
+           seconds, TEST_LISTEN_PORT, TEST_AUDIO_PORT);
+    talk_end_ns = latency_now_ns() + (uint64_t)(seconds * 1e9);
+    pthread_create(&op, NULL, operator_thread, &listen_fd);
+    pthread_create(&mic, NULL, robot_mic_thread, NULL);
+    pthread_join(mic, NULL);
+    usleep(300000);             // 마지막 클릭이 재생될 때까지
+    stop_audio = 1;
+    pthread_join(op, NULL);
+
+    // 로봇 -> 운영자: 단계별
+    st = jitter_buffer_stats(&listen_jb);
+    printf("    로봇 마이크: frames %lu, sent %lu / 운영자: received %lu, lost %lu, late %lu, concealed %.0fms\n",
+           server.source.frames, server.source.packets_sent, st->packets, st->lost, st->late,
+           st->concealed * 1000.0 / AUDIO_RATE);
+    latency_hist_print(&capture_network, "    capture+network");
+    latency_hist_print(&sender_delay, "    robot frame+encode (header delay)");
+    latency_hist_print(&st->wait, "    jitter buffer wait");
+    n = mouth_to_ear(&robot_clicks, &listen_m2e);
+    printf("    클릭 %d개 중 %d개 들림\n", robot_clicks.sent, n);
+    CHECK(robot_clicks.sent > 0 && n * 10 >= robot_clicks.sent * 9, "로봇 마이크 클릭이 운영자 쪽에서 90% 이상 들림");
+    latency_hist_print(&listen_m2e, "    robot mouth -> operator jitter buffer out");
+
+    capture = p_ms(&capture_network, 50);
+    sender = p_ms(&sender_delay, 50);
+    wait = p_ms(&st->wait, 50);
+    total = p_ms(&listen_m2e, 99) + RESAMPLER_MS + DEVICE_QUEUE_MS;
+    printf("    예산 p50: capture+network %.1f + frame/encode %.1f + jitter %.1f + resampler %d + device %d (가정)"
+           " = %.1fms, 측정 p99 + 가정 = %.1fms\n", capture, sender, wait, RESAMPLER_MS, DEVICE_QUEUE_MS,
+           capture + sender + wait + RESAMPLER_MS + DEVICE_QUEUE_MS, total);
+    CHECK(total < BUDGET_MS, "로봇 -> 운영자 mouth-to-ear p99 < 150ms");
+
+    // 운영자 -> 로봇 (같은 시간에 반대 방향)
+    printf("    운영자 마이크: sent %lu / 로봇: received %lu, late %lu\n", talk_sent, server.jitter.stats.packets,
+           server.jitter.stats.late);
+    n = mouth_to_ear(&operator_clicks, &talk_m2e);
+    printf("    클릭 %d개 중 %d개 들림\n", operator_clicks.sent, n);
+    CHECK(operator_clicks.sent > 0 && n * 10 >= operator_clicks.sent * 9, "운영자 마이크 클릭이 로봇 스피커 파이프에 90% 이상 나옴");
+    latency_hist_print(&talk_m2e, "    operator mouth -> robot speaker pipe");
+    total = p_ms(&talk_m2e, 99) + RESAMPLER_MS + DEVICE_QUEUE_MS;
+    printf("    측정 p99 + resampler %d + aplay %d (가정) = %.1fms\n", RESAMPLER_MS, DEVICE_QUEUE_MS, total);
+    CHECK(total < BUDGET_MS, "운영자 -> 로봇 mouth-to-ear p99 < 150ms");
+
+    close(ctl);
+    usleep(50000);              // 마지막 listener가 끊기면 로봇이 송신 통계를 찍음
+    control_server_stop(&server);
+    pthread_join(srv, NULL);
+    control_server_close(&server);
+    close(listen_fd);
+    close(mic_pipe[1]);
+    close(mic_pipe[0]);
+    close(sink_pipe[1]);
+    pthread_join(speaker, NULL);
+    close(sink_pipe[0]);
+    return ok;
+}
+
+// 파일 마이크: 20ms마다 한 프레임, 끝나면 처음부터
+static int run_file_source(void)
+{
+    pthread_t srv;
+    char path[] = "/tmp/audio_duplex_XXXXXX";
+    char reply[512];
+    const char *line = "{\"type\": \"HELLO\", \"payload\": {\"listen\": [\"PCM\"], \"listen_port\": 24503}}\n";
+    static int16_t file[FILE_SAMPLES];
+    uint8_t pkt[AUDIO_PACKET_HEADER + AUDIO_PACKET_MAX_SAMPLES * 2];
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES];
+    int fd = mkstemp(path), listen_fd, ctl, ok = 1;
+    unsigned long packets = 0, mismatched = 0, gaps = 0;
+    uint64_t first = 0, last = 0;
+    uint16_t prev_seq = 0;
+    int max_delay = 0;
+
+    for (int i = 0; i < FILE_SAMPLES; i++)
+        file[i] = (int16_t)(i * 37 - 20000);
+    if (fd < 0 || write(fd, file, sizeof(file)) != (ssize_t)sizeof(file) || lseek(fd, 0, SEEK_SET) != 0)
+        return 0;
+    unlink(path);
+
+    if (control_server_open(&server, TEST_CONTROL_PORT, TEST_AUDIO_PORT, NULL) < 0)
+        return 0;
+    control_server_set_telemetry(&server, 0, 0, NULL, NULL);
+    CHECK(control_server_set_audio_source(&server, fd, AUDIO_RATE, 1, AUDIO_SOURCE_FRAME_MS) > 0, "파일 마이크 등록");
+    if ((listen_fd = udp_bind(TEST_LISTEN_PORT)) < 0)
+        return 0;
+    pthread_create(&srv, NULL, server_thread, NULL);
+
+    printf("\n[파일 마이크] %d샘플 반복, PCM16 listen 1초\n", FILE_SAMPLES);
+    ctl = hello(line, reply, sizeof(reply));
+    CHECK(ctl >= 0 && strstr(reply, "\"listen\": \"PCM\"") && strstr(reply, "\"listen_capture_ms\": 20"),
+          "HELLO로 listen PCM 협상");
+
+    {
+        struct timeval tv = { 0, 200000 };
+        uint64_t end = latency_now_ns() + 1000000000ULL;
+        setsockopt(listen_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        while (latency_now_ns() < end)
+        {
+            AudioPacketHeader h;
+            ssize_t len = recv(listen_fd, pkt, sizeof(pkt), 0);
+            int n;
+            if (len <= 0 || (n = audio_packet_decode(pkt, (size_t)len, &h, pcm, AUDIO_PACKET_MAX_SAMPLES)) < 0)
+                continue;
+            last = latency_now_ns();
+            if (packets++ == 0)
+                first = last;
+            else if ((uint16_t)(h.seq - prev_seq) != 1)
+                gaps++;
+            prev_seq = h.seq;
+            if (h.delay > max_delay)
+                max_delay = h.delay;
+            for (int i = 0; i < n; i++)
+            {
+                if (pcm[i] != file[(h.timestamp + (uint32_t)i) % FILE_SAMPLES])
+                {
+                    mismatched++;
+                    break;
+                }
+            }
+        }
+    }
+    printf("    packets %lu, seq gaps %lu, 내용 다름 %lu, 간격 평균 %.2fms, delay 최대 %.1fms\n", packets, gaps,
+           mismatched, packets > 1 ? (last - first) / 1e6 / (packets - 1) : 0.0, max_delay / 10.0);
+    CHECK(packets >= 45 && gaps == 0 && mismatched == 0, "파일 내용 그대로, 빠짐없이 (20ms마다 한 패킷)");
+    CHECK(packets > 1 && fabs((last - first) / 1e6 / (packets - 1) - AUDIO_SOURCE_FRAME_MS) < 1.0, "실시간 속도");
+
+    close(ctl);
+    usleep(50000);
+    control_server_stop(&server);
+    pthread_join(srv, NULL);
+    control_server_close(&server);
+    close(listen_fd);
+    close(fd);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 3.0;
+    int ok = 1;
+
+    printf("양방향 음성: 로봇 마이크 %dms 캡처 주기 / %dms 프레임, 운영자 %dms 프레임, 클릭 %dms마다, 예산 %dms\n",
+           MIC_PERIOD_MS, AUDIO_SOURCE_FRAME_MS, TALK_FRAME_MS, CLICK_EVERY_MS, BUDGET_MS);
+    ok &= run_duplex(seconds);
+    ok &= run_file_source();
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,615 @@
+/*
+ * 제어 채널 서버(ControlServer, epoll loop 하나) loopback 부하 테스트
+ *
+ * 같은 프로세스 안에서 control_server_run() thread를 띄우고
+ *   1. 프로토콜 확인: HELLO 전 JSON 센서값, 두 번에 나눠 보낸 HELLO -> 응답 후 TLV 레코드,
+ *      깨진 줄/너무 긴 줄 뒤에도 연결 유지, PING ACK의 seq, HELLO 안 보낸 클라이언트에는 ACK 없음,
+ *      HELLO로 음성 ADPCM 협상 -> 패킷이 지터 버퍼를 거쳐 PCM으로 sink에 가고, 끊기면 예전 형식(raw)으로 돌아오는지
+ *   2. 부하: 클라이언트 1/4/16개가 동시에 COMMAND를 (클라이언트마다 WINDOW개씩 겹쳐서) 보내고
+ *      ACK를 받아 전체 msgs/s와 명령 왕복 시간 히스토그램, 클라이언트별 센서값(100Hz TLV) 수신율을 잰다.
+ *      그동안 음성 UDP datagram(20ms 분량 320바이트, 1ms마다)과 열화상 TCP 스트림(27Hz)도 같은 loop로 돈다.
+ *   3. 열화상 UDP 구독자가 포트를 닫고 프레임이 멈춘 뒤에도 epoll thread가 쉬는지 (ICMP 오류로 계속 깨지 않는지)
+ * server.py와 비교하려면 robot/jetsonnano/test/telemetry_bench.py (명령 RTT는 같은 방식으로 잰다)
+ *
+ * Build: gcc -O2 -pthread -o control_load_test test/control_load_test.c src/network.c \
+ *            src/thermal_codec.c src/latency_hist.c src/audio_codec.c src/jitter_buffer.c -lm
+ * Usage: ./control_load_test [초, 기본 2]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "../include/network.h"
+#include "../include/latency_hist.h"
+
+#define TEST_CONTROL_PORT 22345
+#define TEST_AUDIO_PORT 22500
+#define TEST_THERMAL_PORT 22001
+#define TEST_THERMAL_UDP_PORT 22002
+#define IDLE_CPU_LIMIT 0.1          // 프레임이 멈춘 뒤 epoll thread가 쓸 수 있는 CPU 비율
+#define TEST_TELEMETRY_HZ 100
+#define TEST_BATCH_MS 20
+#define WINDOW 16                   // 클라이언트마다 ACK를 기다리지 않고 보내 두는 명령 수
+#define MAX_LOAD_CLIENTS 16
+
+static ControlServer server;
+static ThermalServer thermal;
+static volatile int stop_side_traffic;
+static int audio_sink[2];                   // aplay 대신 파이프
+static unsigned long commands_handled;      // epoll thread만 쓴다
+
+enum { MSG_NONE, MSG_TELEMETRY_JSON, MSG_TLV, MSG_HELLO, MSG_ACK, MSG_OTHER };
+
+typedef struct {
+    int fd;
+    uint8_t buf[65536];
+    size_t len;
+    size_t start;
+    const char *line;       // 마지막 메시지 (줄이면 '\n' 앞까지)
+    size_t line_len;
+} Conn;
+
+typedef struct {
+    int id;
+    double seconds;
+    // 결과
+    unsigned long acks;
+    unsigned long telemetry;
+    unsigned long errors;
+    LatencyHist rtt;
+} LoadClient;
+
+static void read_sensors(ControlTelemetry *t, void *arg)
+{
+    static int n;
+    (void)arg;
+    n++;
+    t->co_ppm = n % 51;
+    t->obstacle_cm = 10 + n % 191;
+    t->rollover = (n % 10) == 0;
+}
+
+static void count_command(const ControlCommand *cmd, void *arg)
+{
+    (void)cmd;
+    (void)arg;
+    commands_handled++;
+}
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    control_server_run(&server);
+    return NULL;
+}
+
+static int conn_open(Conn *c, uint16_t port)
+{
+    struct sockaddr_in addr;
+    struct timeval tv = { 2, 0 };
+    int one = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    c->len = c->start = 0;
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c->fd < 0 || connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("connect()");
+        return -1;
+    }
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return 1;
+}
+
+static int conn_send(Conn *c, const char *s)
+{
+    size_t len = strlen(s);
+    return send(c->fd, s, len, MSG_NOSIGNAL) == (ssize_t)len ? 1 : -1;
+}
+
+// 다음 메시지 하나 (JSON 줄 또는 TLV 레코드). timeout/끊김이면 MSG_NONE
+static int conn_next(Conn *c)
+{
+    for (;;)
+    {
+        uint8_t *p = c->buf + c->start;
+        size_t avail = c->len - c->start;
+
+        if (avail >= 2 && p[0] == TELEMETRY_TLV_SYNC && avail >= 2u + p[1])
+        {
+            c->line = (const char *)p;
+            c->line_len = 2u + p[1];
+            c->start += c->line_len;
+            return MSG_TLV;
+        }
+        if (avail > 0 && p[0] != TELEMETRY_TLV_SYNC)
+        {
+            uint8_t *nl = memchr(p, '\n', avail);
+            if (nl)
+            {
+                c->line = (const char *)p;
+                c->line_len = (size_t)(nl - p);
+                c->start += c->line_len + 1;
+                *nl = '\0';
+                if (strstr(c->line, "\"type\": \"ACK\""))
+                    return MSG_ACK;
+                if (strstr(c->line, "\"type\": \"HELLO\""))
+                    return MSG_HELLO;
+                if (strstr(c->line, "\"type\": \"TELEMETRY\""))
+                    return MSG_TELEMETRY_JSON;
+                return MSG_OTHER;
+            }
+        }
+
+        memmove(c->buf, c->buf + c->start, avail);
+        c->len = avail;
+        c->start = 0;
+        ssize_t n = recv(c->fd, c->buf + c->len, sizeof(c->buf) - c->len, 0);
+        if (n <= 0)
+            return MSG_NONE;
+        c->len += (size_t)n;
+    }
+}
+
+static int64_t ack_seq(const Conn *c)
+{
+    const char *p = strstr(c->line, "\"seq\": ");
+    return p ? strtoll(p + 7, NULL, 10) : -1;
+}
+
+// 원하는 종류가 올 때까지 읽는다 (그 사이 센서값은 건너뜀)
+static int wait_for(Conn *c, int kind)
+{
+    int k;
+    while ((k = conn_next(c)) != MSG_NONE)
+    {
+        if (k == kind)
+            return 1;
+    }
+    return 0;
+}
+
+#define CHECK(cond, msg) do { if (!(cond)) { printf("FAIL: %s\n", msg); ok = 0; } else printf("ok:   %s\n", msg); } while (0)
+
+static int send_audio(const void *buf, size_t len)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ssize_t n;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_AUDIO_PORT);
+    n = sendto(fd, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr));
+    close(fd);
+    return n == (ssize_t)len;
+}
+
+// sink에서 n바이트를 다 읽을 때까지 (지터 버퍼는 10ms마다 조금씩 쓴다)
+static int read_sink(void *buf, size_t n)
+{
+    size_t got = 0;
+    while (got < n)
+    {
+        ssize_t r = read(audio_sink[0], (uint8_t *)buf + got, n - got);
+        if (r <= 0)
+            return 0;
+        got += (size_t)r;
+    }
+    return 1;
+}
+
+// 음성 협상: ADPCM 패킷은 풀어서 지터 버퍼를 거쳐 재생 시계대로, 깨진 패킷은 버리고,
+// 협상한 클라이언트가 끊기면 다시 raw 그대로
+static int check_audio(void)
+{
+    static Conn c;
+    int16_t pcm[160], expect[160], got[160];
+    uint8_t packet[AUDIO_PACKET_HEADER + AUDIO_ADPCM_HEADER + 80];
+    AudioPacketHeader h = { .codec = AUDIO_CODEC_IMA_ADPCM, .seq = 1, .timestamp = 1000 };
+    ImaAdpcmState state = { 0, 0 };
+    unsigned long bad;
+    uint64_t sent_ns;
+    size_t len;
+    int ok = 1;
+
+    if (conn_open(&c, TEST_CONTROL_PORT) < 0)
+        return 0;
+    conn_send(&c, "{\"type\": \"HELLO\", \"payload\": {\"telemetry\": [\"JSON\"], \"audio\": [\"ADPCM\", \"PCM\"]}}\n");
+    CHECK(wait_for(&c, MSG_HELLO) && strstr(c.line, "\"audio\": \"ADPCM\", \"audio_rate\": 8000"),
+          "음성 HELLO에 ADPCM, audio_rate 응답");
+
+    for (int i = 0; i < 160; i++)
+        pcm[i] = (int16_t)(8000 * ((i % 40) < 20 ? 1 : -1) + 97 * i);
+    len = audio_packet_encode(&h, &state, pcm, 160, packet);
+    audio_packet_decode(packet, len, NULL, expect, 160);
+    bad = server.audio_bad;
+    send_audio(packet, 5);          // 잘린 패킷
+    sent_ns = latency_now_ns();
+    send_audio(packet, len);
+    CHECK(read_sink(got, sizeof(got)) && memcmp(got, expect, sizeof(got)) == 0,
+          "ADPCM 패킷 20ms가 지터 버퍼를 거쳐 PCM 320바이트로 sink에");
+    CHECK(latency_now_ns() - sent_ns >= (JITTER_START_MS + 20 - JITTER_TICK_MS) * 1000000ULL,
+          "첫 패킷은 JITTER_START_MS 뒤부터 재생 시계대로");
+    CHECK(server.audio_bad - bad == 1, "잘린 음성 패킷은 버림");
+
+    // 패킷이 끊기면 보정 -> 무음 -> JITTER_IDLE_MS 뒤 재생을 멈춘다
+    close(c.fd);
+    for (int i = 0; i < 2000 && (server.audio_codec != AUDIO_CODEC_RAW || server.playout_on); i++)
+        usleep(1000);
+    CHECK(!server.playout_on && server.audio_codec == AUDIO_CODEC_RAW, "스트림 끝나면 playout timer 멈춤");
+    // 남은 보정/무음 샘플은 버린다
+    fcntl(audio_sink[0], F_SETFL, O_NONBLOCK);
+    while (read(audio_sink[0], got, sizeof(got)) > 0)
+        ;
+    fcntl(audio_sink[0], F_SETFL, 0);
+    send_audio(packet, len);
+    CHECK(read_sink(got, len) && memcmp(got, packet, len) == 0, "협상한 클라이언트가 끊기면 예전처럼 받은 그대로");
+    return ok;
+}
+
+static int check_protocol(void)
+{
+    static Conn a, b;
+    char long_line[CONTROL_LINE_MAX * 2 + 2];
+    unsigned long before;
+    int ok = 1;
+
+    if (conn_open(&a, TEST_CONTROL_PORT) < 0 || conn_open(&b, TEST_CONTROL_PORT) < 0)
+        return 0;
+
+    CHECK(wait_for(&a, MSG_TELEMETRY_JSON), "HELLO 전에는 JSON 센서값");
+
+    conn_send(&a, "{\"type\": \"HELLO\", \"payload\": {\"telem");
+    usleep(20000);
+    conn_send(&a, "etry\": [\"TLV\", \"JSON\"]}}\n");
+    CHECK(wait_for(&a, MSG_HELLO) && strstr(a.line, "\"telemetry\": \"TLV\""), "나눠 보낸 HELLO에 TLV 응답");
+    CHECK(conn_next(&a) == MSG_TLV && a.line_len == TELEMETRY_TLV_RECORD_SIZE, "응답 다음부터 TLV 레코드");
+
+    memset(long_line, 'x', sizeof(long_line) - 2);
+    long_line[sizeof(long_line) - 2] = '\n';
+    long_line[sizeof(long_line) - 1] = '\0';
+    before = server.bad_lines;
+    conn_send(&a, "not json\n");
+    conn_send(&a, "{\"type\": \"COMMAND\", \"payload\": {\"target\": \"DRIVE\",}}\n");
+    conn_send(&a, long_line);
+    conn_send(&a, "\n   \r\n{\"payload\": {\"target\": \"PING\", \"extra\": [1, {\"a\": \"}\\\"\"}]}, \"seq\": 7, "
+                  "\"type\": \"COMMAND\"}\n");
+    CHECK(wait_for(&a, MSG_ACK) && ack_seq(&a) == 7 && strstr(a.line, "\"target\": \"PING\""),
+          "깨진 줄/긴 줄 뒤에도 연결 유지, 키 순서 상관없이 PING ACK seq=7");
+    CHECK(server.bad_lines - before == 3, "깨진 줄 3개 집계");
+
+    conn_send(&a, "{\"type\": \"COMMAND\", \"seq\": 8, \"payload\": {\"target\": \"DRIVE\", \"value\": \"F\"}}\n"
+                  "{\"type\": \"COMMAND\", \"seq\": 9, \"payload\": {\"target\": \"MIC\", \"value\": true}}\n");
+    CHECK(wait_for(&a, MSG_ACK) && ack_seq(&a) == 8 && wait_for(&a, MSG_ACK) && ack_seq(&a) == 9,
+          "한 번에 온 두 명령에 순서대로 ACK");
+    CHECK(strstr(a.line, "\"rx_ns\": ") && strstr(a.line, "\"exec_ns\": "), "ACK에 rx_ns/exec_ns");
+
+    // HELLO를 안 보낸 예전 클라이언트: 명령은 처리하고 ACK는 보내지 않는다
+    before = server.commands;
+    conn_send(&b, "{\"type\": \"COMMAND\", \"seq\": 1, \"payload\": {\"target\": \"DRIVE\", \"value\": \"STOP\"}}\n");
+    conn_send(&a, "{\"type\": \"COMMAND\", \"seq\": 10, \"payload\": {\"target\": \"PING\"}}\n");
+    wait_for(&a, MSG_ACK);
+    {
+        int k, acked = 0;
+        for (int i = 0; i < 5 && (k = conn_next(&b)) != MSG_NONE; i++)
+            acked |= k == MSG_ACK;
+        CHECK(!acked && server.commands - before == 2, "HELLO 안 보낸 클라이언트에는 ACK 없음");
+    }
+
+    close(a.fd);
+    close(b.fd);
+    ok &= check_audio();
+    return ok;
+}
+
+static void *load_client(void *arg)
+{
+    LoadClient *lc = arg;
+    static __thread Conn c;
+    uint64_t sent_ns[WINDOW];
+    uint32_t next_seq = 1, outstanding = 0;
+    uint64_t end_ns;
+    char cmd[160];
+
+    latency_hist_reset(&lc->rtt);
+    if (conn_open(&c, TEST_CONTROL_PORT) < 0)
+    {
+        lc->errors++;
+        return NULL;
+    }
+    conn_send(&c, "{\"type\": \"HELLO\", \"payload\": {\"telemetry\": [\"TLV\", \"JSON\"]}}\n");
+    if (!wait_for(&c, MSG_HELLO))
+    {
+        lc->errors++;
+        close(c.fd);
+        return NULL;
+    }
+
+    end_ns = latency_now_ns() + (uint64_t)(lc->seconds * 1e9);
+    for (;;)
+    {
+        // 창이 빌 때마다 채운다 (마지막까지 WINDOW개가 겹쳐 있음)
+        while (outstanding < WINDOW && latency_now_ns() < end_ns)
+        {
+            snprintf(cmd, sizeof(cmd), "{\"type\": \"COMMAND\", \"seq\": %u, \"payload\": {\"target\": \"DRIVE\", "
+                     "\"value\": \"F\"}}\n", next_seq);
+            sent_ns[next_seq % WINDOW] = latency_now_ns();
+            if (conn_send(&c, cmd) < 0)
+            {
+                lc->errors++;
+                goto out;
+            }
+            next_seq++;
+            outstanding++;
+        }
+        if (outstanding == 0)
+            break;
+
+        switch (conn_next(&c))
+        {
+        case MSG_ACK:
+        {
+            int64_t seq = ack_seq(&c);
+            if (seq != (int64_t)(next_seq - outstanding))
+                lc->errors++;       // TCP 하나 안에서는 순서대로 와야 한다
+            latency_hist_add(&lc->rtt, latency_now_ns() - sent_ns[seq % WINDOW]);
+            lc->acks++;
+            outstanding--;
+            break;
+        }
+        case MSG_TLV:
+            lc->telemetry++;
+            break;
+        case MSG_NONE:
+            lc->errors++;
+            goto out;
+        default:
+            break;
+        }
+    }
+out:
+    close(c.fd);
+    return NULL;
+}
+
+// 음성: 8kHz 16bit mono 20ms = 320바이트를 1ms마다 (실제의 20배)
+static void *audio_sender(void *arg)
+{
+    struct sockaddr_in addr;
+    uint8_t pcm[320];
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    (void)arg;
+
+    memset(pcm, 0x11, sizeof(pcm));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_AUDIO_PORT);
+    while (!stop_side_traffic)
+    {
+        sendto(fd, pcm, sizeof(pcm), 0, (struct sockaddr *)&addr, sizeof(addr));
+        usleep(1000);
+    }
+    close(fd);
+    return NULL;
+}
+
+// aplay 대신 파이프를 비운다
+static void *audio_drain(void *arg)
+{
+    int fd = *(int *)arg;
+    uint8_t buf[4096];
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    return NULL;
+}
+
+// transmit thread처럼 27Hz로 프레임을 보낸다
+static void *thermal_sender(void *arg)
+{
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    uint16_t *pixels = &frame[0][0];
+    uint32_t seq = 0;
+    (void)arg;
+
+    while (!stop_side_traffic)
+    {
+        for (int i = 0; i < LEPTON_HEIGHT * LEPTON_WIDTH; i++)
+            pixels[i] = (uint16_t)(7000 + ((seq + i) & 0xff));
+        thermal_server_send_frame(&thermal, (const uint16_t (*)[LEPTON_WIDTH])frame, seq++, latency_now_ns());
+        usleep(37000);
+    }
+    return NULL;
+}
+
+static unsigned long thermal_frames;
+
+static void *thermal_client(void *arg)
+{
+    static uint8_t msg[THERMAL_HEADER_SIZE + THERMAL_CODEC_MAX_BYTES];
+    Conn *c = arg;
+
+    for (;;)
+    {
+        ThermalFrameHeader h;
+        ssize_t n;
+        size_t got = 0;
+        while (got < THERMAL_HEADER_SIZE && (n = recv(c->fd, msg + got, THERMAL_HEADER_SIZE - got, 0)) > 0)
+            got += (size_t)n;
+        if (got < THERMAL_HEADER_SIZE || thermal_header_decode(&h, msg) < 0 || h.payload_size > THERMAL_CODEC_MAX_BYTES)
+            break;
+        got = 0;
+        while (got < h.payload_size && (n = recv(c->fd, msg + got, h.payload_size - got, 0)) > 0)
+            got += (size_t)n;
+        if (got < h.payload_size)
+            break;
+        thermal_frames++;
+    }
+    return NULL;
+}
+
+static double thread_cpu_seconds(pthread_t thread)
+{
+    clockid_t clock;
+    struct timespec ts;
+
+    if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &ts) < 0)
+        return 0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// UDP 구독자가 프레임 하나를 받고 소켓을 닫는다. 프레임을 하나 더 보내면 ICMP port unreachable이
+// udp 소켓의 error queue에 쌓이는데, 그 뒤 프레임이 없어도 epoll thread가 그걸 비우고 쉬어야 한다.
+static int check_udp_refused(pthread_t srv)
+{
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    static uint8_t msg[THERMAL_HEADER_SIZE + THERMAL_CODEC_MAX_BYTES];
+    struct sockaddr_in addr;
+    struct timeval tv = { 1, 0 };
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int subscribed = 0, received, peers;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_THERMAL_UDP_PORT);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sendto(fd, "SUB", 3, 0, (struct sockaddr *)&addr, sizeof(addr));
+    for (int i = 0; i < 1000 && !subscribed; i++)
+    {
+        usleep(1000);
+        pthread_mutex_lock(&thermal.lock);
+        subscribed = thermal.n_new_peers > 0;
+        pthread_mutex_unlock(&thermal.lock);
+    }
+    thermal_server_send_frame(&thermal, (const uint16_t (*)[LEPTON_WIDTH])frame, 0, latency_now_ns());
+    received = recv(fd, msg, sizeof(msg), 0) > 0;
+    close(fd);
+    thermal_server_send_frame(&thermal, (const uint16_t (*)[LEPTON_WIDTH])frame, 1, latency_now_ns());
+
+    usleep(50000);      // ICMP가 돌아올 시간
+    double cpu0 = thread_cpu_seconds(srv);
+    uint64_t t0 = latency_now_ns();
+    usleep(500000);
+    double busy = (thread_cpu_seconds(srv) - cpu0) / ((latency_now_ns() - t0) * 1e-9);
+
+    // 다음 프레임에서 구독자가 빠진다
+    thermal_server_send_frame(&thermal, (const uint16_t (*)[LEPTON_WIDTH])frame, 2, latency_now_ns());
+    peers = thermal.udp_npeers;
+    printf("thermal UDP: 구독 %s, 수신 %s, 포트 닫힌 뒤 epoll thread CPU %.1f%%, 남은 구독자 %d\n",
+           subscribed ? "OK" : "FAIL", received ? "OK" : "FAIL", busy * 100, peers);
+    return subscribed && received && busy < IDLE_CPU_LIMIT && peers == 0;
+}
+
+static int run_load(int nclients, double seconds)
+{
+    static LoadClient clients[MAX_LOAD_CLIENTS];
+    pthread_t threads[MAX_LOAD_CLIENTS];
+    LatencyHist all;
+    unsigned long acks = 0, telemetry = 0, errors = 0;
+    unsigned long audio0 = server.audio_packets, handled0 = commands_handled;
+    char name[64];
+
+    latency_hist_reset(&all);
+    uint64_t t0 = latency_now_ns();
+    for (int i = 0; i < nclients; i++)
+    {
+        memset(&clients[i], 0, sizeof(clients[i]));
+        clients[i].id = i;
+        clients[i].seconds = seconds;
+        pthread_create(&threads[i], NULL, load_client, &clients[i]);
+    }
+    for (int i = 0; i < nclients; i++)
+    {
+        pthread_join(threads[i], NULL);
+        acks += clients[i].acks;
+        telemetry += clients[i].telemetry;
+        errors += clients[i].errors;
+        for (int b = 0; b < LATENCY_HIST_BUCKETS; b++)
+            all.buckets[b] += clients[i].rtt.buckets[b];
+        all.count += clients[i].rtt.count;
+        all.sum_ns += clients[i].rtt.sum_ns;
+        if (clients[i].rtt.max_ns > all.max_ns)
+            all.max_ns = clients[i].rtt.max_ns;
+    }
+    double elapsed = (latency_now_ns() - t0) * 1e-9;
+
+    printf("%2d clients: %9.0f cmd/s  telemetry %5.1f Hz/client  audio %5.0f pkt/s  errors=%lu\n",
+           nclients, acks / elapsed, telemetry / elapsed / nclients,
+           (server.audio_packets - audio0) / elapsed, errors);
+    snprintf(name, sizeof(name), "    command RTT (%d clients, window %d)", nclients, WINDOW);
+    latency_hist_print(&all, name);
+    return errors == 0 && commands_handled - handled0 == acks;
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 2.0;
+    static const int load_clients[] = { 1, 4, MAX_LOAD_CLIENTS };
+    pthread_t srv, audio, drain, frames, frames_rx;
+    static Conn thermal_conn;
+    int ok;
+
+    if (pipe(audio_sink) < 0 ||
+        thermal_server_open(&thermal, TEST_THERMAL_PORT, TEST_THERMAL_UDP_PORT) < 0 ||
+        control_server_open(&server, TEST_CONTROL_PORT, TEST_AUDIO_PORT, &thermal) < 0)
+        return 1;
+    thermal_server_set_format(&thermal, THERMAL_FORMAT_DELTA_PACK);
+    control_server_set_telemetry(&server, TEST_TELEMETRY_HZ, TEST_BATCH_MS, read_sensors, NULL);
+    control_server_set_command_handler(&server, count_command, NULL);
+    control_server_set_audio_sink(&server, audio_sink[1], AUDIO_RATE);
+    pthread_create(&srv, NULL, server_thread, NULL);
+
+    ok = check_protocol();
+
+    pthread_create(&drain, NULL, audio_drain, &audio_sink[0]);
+    pthread_create(&audio, NULL, audio_sender, NULL);
+    pthread_create(&frames, NULL, thermal_sender, NULL);
+    if (conn_open(&thermal_conn, TEST_THERMAL_PORT) < 0)
+        return 1;
+    pthread_create(&frames_rx, NULL, thermal_client, &thermal_conn);
+
+    printf("\n부하: 센서값 %dHz TLV (batch %dms), 음성 1000 pkt/s, 열화상 27Hz\n", TEST_TELEMETRY_HZ, TEST_BATCH_MS);
+    for (size_t i = 0; i < sizeof(load_clients) / sizeof(load_clients[0]); i++)
+        ok &= run_load(load_clients[i], seconds);
+
+    stop_side_traffic = 1;
+    pthread_join(audio, NULL);
+    pthread_join(frames, NULL);
+    shutdown(thermal_conn.fd, SHUT_RDWR);
+    pthread_join(frames_rx, NULL);
+    ok &= check_udp_refused(srv);
+    control_server_stop(&server);
+    pthread_join(srv, NULL);
+
+    printf("audio: %lu packets, %lu bytes, sink dropped %lu\n", server.audio_packets, server.audio_bytes,
+           server.audio_dropped);
+    printf("thermal: %lu frames received over TCP while loaded\n", thermal_frames);
+    printf("telemetry: sent %lu, dropped %lu, clients dropped %lu\n", server.telemetry_sent,
+           server.telemetry_dropped, server.clients_dropped);
+    ok &= server.audio_packets > 0 && thermal_frames > 0;
+
+    control_server_close(&server);
+    thermal_server_close(&thermal);
+    close(audio_sink[1]);
+    pthread_join(drain, NULL);
+    close(audio_sink[0]);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,541 @@
+/*
+ * 음성 지터 버퍼(JitterBuffer) 테스트
+ *
+ * netem처럼 패킷을 흔드는 shuffler(고정 지연 + 균일 지터, 손실(Gilbert 버스트), 순서 바꿈, 중복,
+ * 주기적인 멈춤(한동안 안 오다가 몰려옴))를 거쳐 20ms ADPCM 패킷을 넣고
+ *   1. 가상 시계: 조건별 30초를 1ms 단위로 돌려서 손실/늦음/보정 샘플, 기다린 시간(도착 -> 재생),
+ *      지연 조정(끼워 넣기/건너뛰기), 재생 샘플 수가 시계와 맞는지 확인 (결과가 매번 같음)
+ *   2. loopback: ControlServer에 HELLO로 음성을 협상하고 shuffler thread가 실제 UDP로 3초 보낸다.
+ *      epoll loop의 playout timer가 sink 파이프에 쓴 양이 실제 시간과 맞는지, 통계가 맞는지 확인
+ *   3. 컴포트 노이즈: CN 패킷 디코드(크기, 재현성), 조용한 구간을 CN 패킷만 보낼 때
+ *      손실/PLC 없이 이어서 재생하는지
+ *
+ * Build: gcc -O2 -pthread -o jitter_buffer_test test/jitter_buffer_test.c src/jitter_buffer.c \
+ *            src/audio_codec.c src/network.c src/thermal_codec.c src/latency_hist.c -lm
+ * Usage: ./jitter_buffer_test
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "../include/jitter_buffer.h"
+#include "../include/network.h"
+#include "../include/latency_hist.h"
+
+#define FRAME_MS 20
+#define FRAME_SAMPLES (AUDIO_RATE * FRAME_MS / 1000)
+#define PACKET_MAX (AUDIO_PACKET_HEADER + AUDIO_ADPCM_HEADER + FRAME_SAMPLES / 2)
+#define SIM_SECONDS 30
+#define QUEUE_MAX 256
+#define TEST_CONTROL_PORT 23345
+#define TEST_AUDIO_PORT 23500
+#define LOOPBACK_SECONDS 3
+
+#define CHECK(cond, msg) do { if (!(cond)) { printf("FAIL: %s\n", msg); ok = 0; } else printf("ok:   %s\n", msg); } while (0)
+
+typedef struct {
+    const char *name;
+    int delay_ms;
+    int jitter_ms;          // 균일 분포 ±
+    double loss;            // 손실 시작 확률
+    double burst;           // 직전 패킷이 빠졌을 때 이어서 빠질 확률 (Gilbert)
+    double reorder;         // 이 확률로 지연 없이 바로 보냄 (netem reorder)
+    double duplicate;
+    int stall_ms;           // stall_every_ms마다 이만큼 아무것도 안 오다가 한꺼번에
+    int stall_every_ms;
+} NetemProfile;
+
+static const NetemProfile profiles[] = {
+    { "clean",     20,  0, 0.00, 0.0, 0.00, 0.00,   0,    0 },
+    { "jitter",    20, 15, 0.00, 0.0, 0.00, 0.00,   0,    0 },
+    { "reorder",   30,  5, 0.00, 0.0, 0.10, 0.00,   0,    0 },
+    { "loss 5%",   20,  5, 0.05, 0.0, 0.00, 0.00,   0,    0 },
+    { "burst",     20,  5, 0.02, 0.5, 0.00, 0.00,   0,    0 },
+    { "duplicate", 20,  5, 0.00, 0.0, 0.00, 0.05,   0,    0 },
+    { "stall",     20,  5, 0.00, 0.0, 0.00, 0.00, 150, 5000 },
+};
+
+typedef struct {
+    uint64_t release_ns;
+    size_t len;
+    int duplicate;
+    uint8_t data[PACKET_MAX];
+} Queued;
+
+typedef struct {
+    const NetemProfile *p;
+    uint32_t rng;
+    int lost_last;
+    Queued q[QUEUE_MAX];
+    int n;
+    unsigned long dropped;
+} Shuffler;
+
+static double _random(Shuffler *s)
+{
+    s->rng ^= s->rng << 13;
+    s->rng ^= s->rng >> 17;
+    s->rng ^= s->rng << 5;
+    return (s->rng >> 8) / 16777216.0;
+}
+
+static void shuffler_init(Shuffler *s, const NetemProfile *p)
+{
+    memset(s, 0, sizeof(*s));
+    s->p = p;
+    s->rng = 2463534242u;
+}
+
+static void _enqueue(Shuffler *s, const uint8_t *pkt, size_t len, uint64_t release_ns, int duplicate)
+{
+    if (s->n == QUEUE_MAX)
+        return;
+    s->q[s->n].release_ns = release_ns;
+    s->q[s->n].duplicate = duplicate;
+    s->q[s->n].len = len;
+    memcpy(s->q[s->n].data, pkt, len);
+    s->n++;
+}
+
+// t_ns(송신 시각, 0부터)에 보낸 패킷이 언제 도착할지 정한다
+static void shuffler_push(Shuffler *s, const uint8_t *pkt, size_t len, uint64_t t_ns, uint64_t base_ns)
+{
+    const NetemProfile *p = s->p;
+    double delay_ms = p->delay_ms + (2.0 * _random(s) - 1.0) * p->jitter_ms;
+    uint64_t release;
+
+    if (_random(s) < (s->lost_last ? p->burst : p->loss))
+    {
+        s->lost_last = 1;
+        s->dropped++;
+        return;
+    }
+    s->lost_last = 0;
+    if (_random(s) < p->reorder)
+        delay_ms = 0;
+    release = t_ns + (uint64_t)(delay_ms * 1e6);
+    if (p->stall_every_ms)
+    {
+        // 멈춘 동안 보낸 패킷은 멈춤이 끝날 때 한꺼번에 도착
+        uint64_t every = (uint64_t)p->stall_every_ms * 1000000ULL;
+        uint64_t from = t_ns / every * every + every / 2;
+        uint64_t to = from + (uint64_t)p->stall_ms * 1000000ULL;
+        if (t_ns >= from && release < to)
+            release = to + (release - t_ns) / 4;
+    }
+    _enqueue(s, pkt, len, base_ns + release, 0);
+    if (_random(s) < p->duplicate)
+        _enqueue(s, pkt, len, base_ns + release + 1000000ULL, 1);
+}
+
+// now_ns까지 도착한 것 중 가장 이른 패킷. 없으면 0
+static size_t shuffler_pop(Shuffler *s, uint64_t now_ns, uint8_t *out)
+{
+    int best = -1;
+    size_t len;
+
+    for (int i = 0; i < s->n; i++)
+    {
+        if (s->q[i].release_ns <= now_ns && (best < 0 || s->q[i].release_ns < s->q[best].release_ns))
+            best = i;
+    }
+    if (best < 0)
+        return 0;
+    len = s->q[best].len;
+    memcpy(out, s->q[best].data, len);
+    s->q[best] = s->q[--s->n];
+    return len;
+}
+
+// 아직 도착하지 않은 패킷 (중복 제외)
+static unsigned long shuffler_in_flight(const Shuffler *s)
+{
+    unsigned long n = 0;
+    for (int i = 0; i < s->n; i++)
+        n += !s->q[i].duplicate;
+    return n;
+}
+
+static uint64_t shuffler_next(const Shuffler *s)
+{
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < s->n; i++)
+    {
+        if (s->q[i].release_ns < next)
+            next = s->q[i].release_ns;
+    }
+    return next;
+}
+
+// 말소리 비슷한 신호: 피치가 100~200Hz로 움직이는 배음 + 4Hz 음절 envelope
+typedef struct {
+    double phase;
+    unsigned long n;
+    ImaAdpcmState adpcm;
+    uint16_t seq;
+    uint32_t timestamp;
+} Talker;
+
+static size_t talker_packet(Talker *t, uint8_t *out)
+{
+    int16_t pcm[FRAME_SAMPLES];
+    AudioPacketHeader h;
+
+    for (int i = 0; i < FRAME_SAMPLES; i++, t->n++)
+    {
+        double sec = (double)t->n / AUDIO_RATE;
+        double f0 = 150.0 + 50.0 * sin(2 * M_PI * 0.7 * sec);
+        double env = 0.5 + 0.5 * sin(2 * M_PI * 4.0 * sec);
+        double v = 0.0;
+        t->phase += 2 * M_PI * f0 / AUDIO_RATE;
+        for (int k = 1; k <= 8; k++)
+            v += sin(k * t->phase) / k;
+        pcm[i] = (int16_t)(6000.0 * env * v);
+    }
+    h.codec = AUDIO_CODEC_IMA_ADPCM;
+    h.flags = 0;
+    h.seq = t->seq++;
+    h.timestamp = t->timestamp;
+    t->timestamp += FRAME_SAMPLES;
+    return audio_packet_encode(&h, &t->adpcm, pcm, FRAME_SAMPLES, out);
+}
+
+static double ms_of(unsigned long samples)
+{
+    return samples * 1000.0 / AUDIO_RATE;
+}
+
+// 1. 가상 시계 (1ms 단위)
+static JitterBuffer sim_jb;
+
+static int run_profile(const NetemProfile *p)
+{
+    static Shuffler sh;
+    Talker talker;
+    const JitterStats *st;
+    uint8_t pkt[PACKET_MAX];
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES];
+    const uint64_t base = 1000000000ULL;
+    const uint64_t end = (uint64_t)SIM_SECONDS * 1000000000ULL;
+    uint64_t first_arrival = 0;
+    unsigned long sent = 0, played = 0, expect_played;
+    double loss_pct;
+    int ok = 1;
+
+    memset(&talker, 0, sizeof(talker));
+    shuffler_init(&sh, p);
+    jitter_buffer_init(&sim_jb, AUDIO_RATE);
+
+    for (uint64_t t = 0; t < end; t += 1000000ULL)
+    {
+        size_t len;
+        if (t % (FRAME_MS * 1000000ULL) == 0)
+        {
+            len = talker_packet(&talker, pkt);
+            shuffler_push(&sh, pkt, len, t, base);
+            sent++;
+        }
+        while ((len = shuffler_pop(&sh, base + t, pkt)) > 0)
+        {
+            if (!first_arrival)
+                first_arrival = base + t;
+            jitter_buffer_put(&sim_jb, pkt, len, base + t);
+        }
+        if (t % (JITTER_TICK_MS * 1000000ULL) == 0)
+            played += jitter_buffer_get(&sim_jb, base + t, pcm, AUDIO_PACKET_MAX_SAMPLES);
+    }
+
+    st = jitter_buffer_stats(&sim_jb);
+    loss_pct = 100.0 * st->lost / sent;
+    printf("\n[%s] delay %dms ±%dms, loss %.0f%% (burst %.0f%%), reorder %.0f%%, dup %.0f%%, stall %dms/%ds\n",
+           p->name, p->delay_ms, p->jitter_ms, p->loss * 100, p->burst * 100, p->reorder * 100,
+           p->duplicate * 100, p->stall_ms, p->stall_every_ms / 1000);
+    jitter_buffer_print_stats(&sim_jb, "    jitter buffer");
+
+    // 재생 샘플 수는 시계가 정한다: 첫 패킷 + JITTER_START_MS부터 마지막 tick까지
+    expect_played = (unsigned long)((base + end - JITTER_TICK_MS * 1000000ULL -
+                                     (first_arrival + JITTER_START_MS * 1000000ULL)) * AUDIO_RATE / 1000000000ULL);
+    CHECK(labs((long)played - (long)expect_played) <= AUDIO_RATE * JITTER_TICK_MS / 1000,
+          "재생 샘플 수가 재생 시계와 맞음 (패킷이 늦거나 몰려도)");
+    CHECK(st->lost == sh.dropped, "seq로 센 손실 = shuffler가 버린 패킷");
+    CHECK(st->packets == sent - sh.dropped - shuffler_in_flight(&sh), "중복은 한 번만");
+
+    if (p->loss == 0 && p->stall_ms == 0)
+        CHECK(st->late * 100 <= st->packets, "늦어서 버린 패킷 1% 이하");
+    if (p->jitter_ms == 0 && p->loss == 0)
+    {
+        CHECK(st->concealed == 0 && st->inserted == 0, "흔들림 없으면 보정 없음");
+        CHECK(latency_hist_percentile(&st->wait, 50) <= 2 * (uint64_t)(st->margin_ms * 1e6) + 2000000,
+              "시작 지연(40ms)에서 여유분 근처까지 줄어듦");
+    }
+    if (p->loss > 0)
+    {
+        printf("    손실 %.1f%% -> 보정 %.0fms (손실 %.0fms)\n", loss_pct, ms_of(st->concealed),
+               st->lost * (double)FRAME_MS);
+        CHECK(st->concealed >= st->lost * FRAME_SAMPLES / 2, "빠진 패킷 자리를 PLC로 채움");
+    }
+    if (p->duplicate > 0)
+        CHECK(st->duplicates > 0, "중복 패킷을 셈");
+    if (p->stall_ms > 0)
+    {
+        CHECK(st->inserted > 0, "멈춤 동안 지연을 늘림");
+        CHECK(st->skipped > 0, "멈춤 뒤 남는 지연을 다시 줄임");
+        CHECK(latency_hist_percentile(&st->wait, 50) < (uint64_t)p->stall_ms * 1000000ULL,
+              "평소 대기 시간은 멈춤 길이보다 짧게 돌아옴");
+    }
+    return ok;
+}
+
+// 2. loopback
+static ControlServer server;
+static int sink[2];
+static unsigned long sink_bytes;
+static volatile int sender_done;
+static unsigned long loop_sent, loop_dropped;
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    control_server_run(&server);
+    return NULL;
+}
+
+static void *drain_thread(void *arg)
+{
+    uint8_t buf[4096];
+    ssize_t n;
+    (void)arg;
+    while ((n = read(sink[0], buf, sizeof(buf))) > 0)
+        sink_bytes += (unsigned long)n;
+    return NULL;
+}
+
+// 20ms마다 패킷을 만들어 shuffler에 넣고, 도착 시각이 된 것부터 UDP로 보낸다
+static void *sender_thread(void *arg)
+{
+    static Shuffler sh;
+    Talker talker;
+    struct sockaddr_in addr;
+    uint8_t pkt[PACKET_MAX];
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    uint64_t start = latency_now_ns();
+    uint64_t next_frame = start;
+    uint64_t end = start + (uint64_t)LOOPBACK_SECONDS * 1000000000ULL;
+
+    memset(&talker, 0, sizeof(talker));
+    shuffler_init(&sh, (const NetemProfile *)arg);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_AUDIO_PORT);
+
+    while (next_frame < end || sh.n > 0)
+    {
+        uint64_t now = latency_now_ns();
+        uint64_t wake;
+        size_t len;
+        struct timespec ts;
+
+        if (next_frame < end && now >= next_frame)
+        {
+            len = talker_packet(&talker, pkt);
+            shuffler_push(&sh, pkt, len, next_frame - start, start);
+            loop_sent++;
+            next_frame += FRAME_MS * 1000000ULL;
+        }
+        while ((len = shuffler_pop(&sh, now, pkt)) > 0)
+            sendto(fd, pkt, len, 0, (struct sockaddr *)&addr, sizeof(addr));
+        wake = shuffler_next(&sh);
+        if (next_frame < end && next_frame < wake)
+            wake = next_frame;
+        now = latency_now_ns();
+        if (wake != UINT64_MAX && wake > now)
+        {
+            ts.tv_sec = 0;
+            ts.tv_nsec = (long)(wake - now);
+            nanosleep(&ts, NULL);
+        }
+    }
+    loop_dropped = sh.dropped;
+    close(fd);
+    sender_done = 1;
+    return NULL;
+}
+
+static int run_loopback(const NetemProfile *p)
+{
+    pthread_t srv, drain, sender;
+    struct sockaddr_in addr;
+    char reply[256];
+    const char *hello = "{\"type\": \"HELLO\", \"payload\": {\"audio\": [\"ADPCM\"]}}\n";
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    unsigned long packets, late, played;
+    uint64_t start;
+    ssize_t n;
+    int ok = 1;
+
+    if (pipe(sink) < 0 || control_server_open(&server, TEST_CONTROL_PORT, TEST_AUDIO_PORT, NULL) < 0)
+        return 0;
+    control_server_set_telemetry(&server, 0, 0, NULL, NULL);
+    control_server_set_audio_sink(&server, sink[1], AUDIO_RATE);
+    pthread_create(&srv, NULL, server_thread, NULL);
+    pthread_create(&drain, NULL, drain_thread, NULL);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_CONTROL_PORT);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || write(fd, hello, strlen(hello)) < 0)
+        return 0;
+    n = read(fd, reply, sizeof(reply) - 1);
+    reply[n > 0 ? n : 0] = '\0';
+    CHECK(strstr(reply, "\"audio\": \"ADPCM\"") != NULL, "HELLO로 ADPCM 협상");
+
+    printf("\n[loopback %s] %d초, UDP %u -> ControlServer -> 파이프\n", p->name, LOOPBACK_SECONDS, TEST_AUDIO_PORT);
+    start = latency_now_ns();
+    pthread_create(&sender, NULL, sender_thread, (void *)p);
+    pthread_join(sender, NULL);
+    usleep(100000);
+
+    // epoll thread가 쓰는 값이지만 패킷이 끝난 뒤라 더 바뀌지 않는다 (재생 샘플만 늘어남)
+    packets = server.jitter.stats.packets;
+    late = server.jitter.stats.late;
+    played = server.jitter.stats.played;
+    printf("    sent %lu, shuffler dropped %lu, received %lu, late %lu, concealed %.0fms, inserted %.0fms, "
+           "skipped %.0fms\n", loop_sent, loop_dropped, packets, late, ms_of(server.jitter.stats.concealed),
+           ms_of(server.jitter.stats.inserted), ms_of(server.jitter.stats.skipped));
+    latency_hist_print(&server.jitter.stats.wait, "    arrival->playout");
+    CHECK(packets == loop_sent - loop_dropped, "보낸 패킷이 다 지터 버퍼에 도착 (중복 제외)");
+    CHECK(late * 50 <= packets, "늦어서 버린 패킷 2% 이하");
+    {
+        double elapsed_ms = (latency_now_ns() - start) / 1e6 - JITTER_START_MS;
+        printf("    played %.0fms / 재생 시계 %.0fms\n", ms_of(played), elapsed_ms);
+        CHECK(fabs(ms_of(played) - elapsed_ms) < 3 * JITTER_TICK_MS, "playout timer가 실제 시간대로 씀");
+    }
+
+    // 패킷이 끊기면 JITTER_IDLE_MS 뒤 재생을 멈추고 통계를 찍는다
+    usleep((JITTER_IDLE_MS + 100) * 1000);
+    CHECK(!server.playout_on, "스트림 끝나면 playout timer 멈춤");
+    CHECK(sink_bytes >= played * sizeof(int16_t), "재생한 샘플이 sink에 다 씀");
+
+    close(fd);
+    control_server_stop(&server);
+    pthread_join(srv, NULL);
+    control_server_close(&server);
+    close(sink[1]);
+    pthread_join(drain, NULL);
+    close(sink[0]);
+    return ok;
+}
+
+// 3. 컴포트 노이즈: 1초 말 / 1초 조용을 반복. 조용한 구간은 100ms마다 CN 패킷 하나 (JetDash AudioEncoder처럼)
+#define CN_FRAMES 5
+#define CN_LEVEL 50
+
+static int run_comfort_noise(void)
+{
+    static Shuffler sh;
+    Talker talker;
+    const JitterStats *st;
+    AudioPacketHeader h;
+    uint8_t pkt[PACKET_MAX];
+    int16_t pcm[AUDIO_PACKET_MAX_SAMPLES], again[AUDIO_PACKET_MAX_SAMPLES];
+    const uint64_t base = 1000000000ULL;
+    const uint64_t end = 10ULL * 1000000000ULL;
+    unsigned long sent = 0, cn_sent = 0, cn_samples = 0, frames = 0;
+    double sum = 0.0, level_db;
+    int n, cn_left = 0, ok = 1;
+
+    printf("\n[comfort noise] 1초 말 / 1초 조용, CN 패킷 %dms마다 (-%ddBFS)\n", CN_FRAMES * FRAME_MS, CN_LEVEL);
+
+    // 디코더: 크기와 재현성
+    memset(&h, 0, sizeof(h));
+    h.codec = AUDIO_CODEC_IMA_ADPCM;
+    h.timestamp = 12345;
+    n = audio_packet_decode(pkt, audio_packet_encode_cn(&h, CN_FRAMES * FRAME_SAMPLES, CN_LEVEL, pkt), &h, pcm,
+                            AUDIO_PACKET_MAX_SAMPLES);
+    audio_packet_decode(pkt, AUDIO_PACKET_HEADER + 1, NULL, again, AUDIO_PACKET_MAX_SAMPLES);
+    for (int i = 0; i < n; i++)
+        sum += (double)pcm[i] * pcm[i];
+    level_db = n > 0 ? 10 * log10(sum / n / (32768.0 * 32768.0)) : 0.0;
+    printf("    CN 디코드: %d 샘플, %.2fdBFS\n", n, level_db);
+    CHECK(n == CN_FRAMES * FRAME_SAMPLES && (h.flags & AUDIO_FLAG_CN), "CN 패킷은 1바이트로 100ms");
+    CHECK(fabs(level_db + CN_LEVEL) < 0.5, "컴포트 노이즈 크기 = 패킷의 level");
+    CHECK(memcmp(pcm, again, (size_t)n * sizeof(int16_t)) == 0, "같은 패킷이면 같은 잡음");
+
+    memset(&talker, 0, sizeof(talker));
+    shuffler_init(&sh, &profiles[0]);
+    jitter_buffer_init(&sim_jb, AUDIO_RATE);
+    for (uint64_t t = 0; t < end; t += 1000000ULL)
+    {
+        size_t len;
+        if (t % (FRAME_MS * 1000000ULL) == 0)
+        {
+            int silent = (t / 1000000000ULL) % 2 == 1;
+            len = talker_packet(&talker, pkt);      // 조용한 구간에도 talker 시계는 그대로 간다
+            if (silent)
+            {
+                if (cn_left == 0)
+                {
+                    h.seq = (uint16_t)(talker.seq - 1);
+                    h.timestamp = talker.timestamp - FRAME_SAMPLES;
+                    len = audio_packet_encode_cn(&h, CN_FRAMES * FRAME_SAMPLES, CN_LEVEL, pkt);
+                    cn_left = CN_FRAMES;
+                    cn_sent++;
+                    cn_samples += CN_FRAMES * FRAME_SAMPLES;
+                }
+                else
+                {
+                    talker.seq--;                   // 안 보낸 프레임은 seq를 쓰지 않는다
+                    len = 0;
+                }
+                cn_left--;
+            }
+            else
+                cn_left = 0;
+            if (len)
+            {
+                shuffler_push(&sh, pkt, len, t, base);
+                sent++;
+            }
+            frames++;
+        }
+        while ((len = shuffler_pop(&sh, base + t, pkt)) > 0)
+            jitter_buffer_put(&sim_jb, pkt, len, base + t);
+        if (t % (JITTER_TICK_MS * 1000000ULL) == 0)
+            jitter_buffer_get(&sim_jb, base + t, pcm, AUDIO_PACKET_MAX_SAMPLES);
+    }
+
+    st = jitter_buffer_stats(&sim_jb);
+    jitter_buffer_print_stats(&sim_jb, "    jitter buffer");
+    printf("    패킷 %lu / 프레임 %lu (CN %lu)\n", sent, frames, cn_sent);
+    CHECK(sent == frames / 2 + frames / 2 / CN_FRAMES, "조용한 구간은 100ms마다 CN 패킷 하나만");
+    CHECK(st->lost == 0 && st->restarts == 0, "seq가 이어져서 손실/재시작 없음");
+    CHECK(st->concealed == 0 && st->inserted == 0, "조용한 구간을 PLC로 채우지 않음");
+    CHECK(st->comfort == cn_samples, "CN 샘플을 셈");
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    printf("지터 버퍼: %dms 패킷, tick %dms, 시작 %dms, 여유분 %dms + 지터, 최대 %dms\n", FRAME_MS, JITTER_TICK_MS,
+           JITTER_START_MS, JITTER_MARGIN_MS, JITTER_MAX_DELAY_MS);
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+        ok &= run_profile(&profiles[i]);
+
+    ok &= run_comfort_noise();
+    ok &= run_loopback(&profiles[1]);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*
+ * lepton_capture() 벤치마크 (replay 백엔드)
+ *
+ * 녹화된 VoSPI 패킷 파일을 최대 속도로 재생하면서 batch 크기별로
+ * 프레임당 SPI 전송 횟수와 캡처 시간을 측정한다.
+ * 파일을 주지 않으면 discard 패킷과 순서가 뒤바뀐 패킷 ID가 섞인 합성 캡처를 만들어 사용한다.
+ * 순서가 뒤바뀐 프레임은 sync 오류로 버려지므로 sync_err 열에 잡힌다.
+ * Lepton 3.x 빌드에서는 세그먼트 4개(패킷 20에 세그먼트 번호)와 무효 세그먼트(0)를 섞어 만든다.
+ * 끝으로 record 백엔드를 확인한다: 재생하면서 녹화하고, 녹화 파일을 다시 재생해 같은 프레임이 나오는지 비교한다.
+ *
+ * Build: gcc -O2 -o lepton_bench test/lepton_bench.c src/lepton.c src/lepton_transport.c src/crc16.c src/vospi_unpack.c
+ *        (Lepton 3.x: -DLEPTON_VERSION=3 추가)
+ * Usage: ./lepton_bench [capture.vospi]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/lepton.h"
+#include "../include/lepton_transport.h"
+#include "../include/crc16.h"
+
+#define SYNTH_FRAMES 64
+#define DISCARDS_PER_FRAME 8    // 프레임 사이의 discard 패킷 수
+#define BENCH_FRAMES 2000
+#define ROUND_TRIP_FRAMES 100   // 합성 캡처(SYNTH_FRAMES)를 한 번 넘겨 반복 재생 구간도 녹화되도록
+
+static void synth_packet(uint8_t *p, int id, int segment)
+{
+    if (id < 0)
+    {
+        memset(p, 0, VOSPI_FRAME_SIZE);
+        p[0] = 0x0f;    // discard 패킷
+        return;
+    }
+    p[0] = (id == VOSPI_SEGMENT_ID_PACKET && LEPTON_SEGMENTS > 1) ? (uint8_t)(segment << 4) : 0;
+    p[1] = (uint8_t)id;
+    p[2] = p[3] = 0;
+    for (int i = 4; i < VOSPI_FRAME_SIZE; i += 2)
+    {
+        p[i] = 0x1f;
+        p[i + 1] = (uint8_t)(id + i);
+    }
+    uint16_t crc = crc16_vospi(p, CRC16_IMPL_TABLE);
+    p[2] = (uint8_t)(crc >> 8);
+    p[3] = (uint8_t)crc;
+}
+
+// 합성 캡처: 프레임마다 discard 패킷 + 세그먼트별 패킷 0~59, 4번째 프레임마다 두 패킷의 순서를 바꾼다.
+// Lepton 3.x는 3번째 프레임마다 세그먼트 번호가 0인 무효 프레임으로 만든다.
+static int write_synth_capture(const char *path)
+{
+    uint8_t pkt[VOSPI_FRAME_SIZE];
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        perror("fopen()");
+        return -1;
+    }
+    for (int f = 0; f < SYNTH_FRAMES; f++)
+    {
+        for (int d = 0; d < DISCARDS_PER_FRAME; d++)
+        {
+            synth_packet(pkt, -1, 0);
+            fwrite(pkt, sizeof(pkt), 1, fp);
+        }
+        for (int seg = 1; seg <= LEPTON_SEGMENTS; seg++)
+        {
+            int ttt = (LEPTON_SEGMENTS > 1 && f % 3 == 2) ? 0 : seg;
+            for (int id = 0; id < VOSPI_SEGMENT_PACKETS; id++)
+            {
+                int out = id;
+                if (f % 4 == 3 && seg == LEPTON_SEGMENTS && (id == 10 || id == 11))
+                    out = (id == 10) ? 11 : 10;
+                synth_packet(pkt, out, ttt);
+                fwrite(pkt, sizeof(pkt), 1, fp);
+            }
+        }
+    }
+    fclose(fp);
+    return 1;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// path를 재생하면서 녹화한 파일이 원래 파일과 같은 프레임을 내는지 확인한다. 같으면 1
+static int check_record_round_trip(const char *path)
+{
+    static uint16_t recorded[ROUND_TRIP_FRAMES][LEPTON_HEIGHT][LEPTON_WIDTH];
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    char record_path[] = "/tmp/lepton_record_XXXXXX";
+    LeptonTransport *t;
+    int fd = mkstemp(record_path);
+    int n, same = 0;
+
+    if (fd < 0)
+    {
+        perror("mkstemp()");
+        return 0;
+    }
+    close(fd);
+    lepton_set_batch_size(LEPTON_DEFAULT_BATCH_PACKETS);
+
+    t = lepton_record_open(lepton_replay_open(path, LEPTON_REPLAY_UNLIMITED), record_path);
+    if (init_lepton(t) < 0)
+        goto out;
+    for (int i = 0; i < ROUND_TRIP_FRAMES; i++)
+    {
+        if (lepton_capture(t, recorded[i]) <= 0)
+        {
+            cleanup_lepton(t);
+            goto out;
+        }
+    }
+    cleanup_lepton(t);
+
+    t = lepton_replay_open(record_path, LEPTON_REPLAY_UNLIMITED);
+    if (init_lepton(t) < 0)
+    {
+        cleanup_lepton(t);
+        goto out;
+    }
+    for (n = 0; n < ROUND_TRIP_FRAMES; n++)
+    {
+        if (lepton_capture(t, frame) <= 0 || memcmp(frame, recorded[n], sizeof(frame)) != 0)
+            break;
+    }
+    same = (n == ROUND_TRIP_FRAMES);
+    cleanup_lepton(t);
+
+out:
+    printf("record -> replay: %d frames %s\n", ROUND_TRIP_FRAMES, same ? "OK" : "FAIL");
+    unlink(record_path);
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    static const int batches[] = { 1, 4, 10, 20, 30, 60 };
+    char synth_path[] = "/tmp/lepton_bench_XXXXXX";
+    const char *path = argv[1];
+    LeptonStats st;
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+
+    if (argc < 2)
+    {
+        int fd = mkstemp(synth_path);
+        if (fd < 0)
+        {
+            perror("mkstemp()");
+            return 1;
+        }
+        close(fd);
+        crc16_init();
+        if (write_synth_capture(synth_path) < 0)
+            return 1;
+        path = synth_path;
+    }
+
+    LeptonTransport *t = lepton_replay_open(path, LEPTON_REPLAY_UNLIMITED);
+    if (init_lepton(t) < 0)
+        return 1;
+
+    printf("%dx%d, %d segment(s)\n", LEPTON_WIDTH, LEPTON_HEIGHT, LEPTON_SEGMENTS);
+    printf("%6s %14s %14s %12s %12s %10s %10s %8s\n", "batch", "xfer/frame", "packets/frame", "us/frame", "frames/s",
+           "crc_err", "sync_err", "resync");
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+    {
+        lepton_set_batch_size(batches[b]);
+        lepton_reset_stats();
+
+        double t0 = now_sec();
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            if (lepton_capture(t, frame) <= 0)
+                return 1;
+        }
+        double t1 = now_sec();
+
+        lepton_get_stats(&st);
+        printf("%6d %14.2f %14.2f %12.2f %12.0f %10lu %10lu %8lu\n", batches[b],
+               (double)st.spi_transfers / st.frames,
+               (double)st.packets / st.frames,
+               (t1 - t0) * 1e6 / st.frames,
+               st.frames / (t1 - t0),
+               st.crc_errors, st.sync_errors, st.resyncs);
+    }
+    cleanup_lepton(t);
+
+    int ok = check_record_round_trip(path);
+    if (argc < 2)
+        unlink(synth_path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,391 @@
+/*
+ * LeptonRingBuffer SPSC 스트레스 테스트 + 처리량 벤치마크
+ *
+ * 1) 스트레스: 생산자가 프레임마다 일련번호를 모든 픽셀에 채우고,
+ *    소비자가 순서와 내용이 온전한지 검사한다.
+ * 2) 벤치마크: 같은 zero-copy API를 lock-free 그대로 쓸 때와
+ *    기존처럼 buffer_mutex로 감쌀 때의 프레임 처리량을 비교한다.
+ * 3) 정책: drop-newest / drop-oldest / latest 각각 가득 찼을 때 남는 프레임과 drop 카운터,
+ *    그리고 소비자가 슬롯을 읽는 중에 생산자가 오래된 프레임을 버리는 경쟁 상황의 스트레스
+ *    (drop-oldest는 넘칠 때마다 정확히 한 프레임만 버리는지).
+ * 4) 지연: 27Hz로 commit되는 프레임을 polling(37ms sleep)으로 꺼낼 때와
+ *    acquire_wait()로 꺼낼 때의 commit->dequeue 지연 히스토그램을 비교한다.
+ *
+ * Build: gcc -O2 -pthread -o ringbuffer_test test/ringbuffer_test.c src/ringbuffer.c src/latency_hist.c
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "../include/ringbuffer.h"
+#include "../include/latency_hist.h"
+
+#define STRESS_FRAMES 200000
+#define BENCH_FRAMES 2000000
+#define LATENCY_FRAMES 54       // 27Hz로 2초
+
+static LeptonRingBuffer *rb;
+static pthread_mutex_t buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int use_mutex;
+static int full_check;          // 1: 모든 픽셀을 쓰고 검사, 0: 첫 픽셀만 (동기화 비용만 측정)
+static unsigned long frames;
+static unsigned long errors;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    for (unsigned long n = 0; n < frames; )
+    {
+        uint16_t (*slot)[LEPTON_WIDTH];
+        if (use_mutex) pthread_mutex_lock(&buffer_mutex);
+        slot = lepton_ringbuffer_reserve(rb);
+        if (use_mutex) pthread_mutex_unlock(&buffer_mutex);
+        if (slot == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        uint16_t v = (uint16_t)n;
+        if (full_check)
+        {
+            for (int r = 0; r < LEPTON_HEIGHT; r++)
+                for (int c = 0; c < LEPTON_WIDTH; c++)
+                    slot[r][c] = v;
+        }
+        else
+        {
+            slot[0][0] = v;
+        }
+
+        if (use_mutex) pthread_mutex_lock(&buffer_mutex);
+        lepton_ringbuffer_commit(rb);
+        if (use_mutex) pthread_mutex_unlock(&buffer_mutex);
+        n++;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    (void)arg;
+    for (unsigned long n = 0; n < frames; )
+    {
+        const uint16_t (*slot)[LEPTON_WIDTH];
+        if (use_mutex) pthread_mutex_lock(&buffer_mutex);
+        slot = lepton_ringbuffer_acquire(rb);
+        if (use_mutex) pthread_mutex_unlock(&buffer_mutex);
+        if (slot == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        uint16_t v = (uint16_t)n;
+        if (slot[0][0] != v)
+            errors++;
+        if (full_check)
+        {
+            for (int r = 0; r < LEPTON_HEIGHT; r++)
+                for (int c = 0; c < LEPTON_WIDTH; c++)
+                    if (slot[r][c] != v)
+                    {
+                        errors++;
+                        r = LEPTON_HEIGHT;
+                        break;
+                    }
+        }
+
+        if (use_mutex) pthread_mutex_lock(&buffer_mutex);
+        lepton_ringbuffer_release(rb);
+        if (use_mutex) pthread_mutex_unlock(&buffer_mutex);
+        n++;
+    }
+    return NULL;
+}
+
+// 소비자 없이 n개를 넣은 뒤 남은 프레임 번호들을 확인한다.
+static int check_policy(int policy, int n, int first_expected, int expected_count,
+                        unsigned long newest, unsigned long oldest)
+{
+    LeptonRingBufferDrops drops;
+    int count = 0;
+
+    lepton_ringbuffer_destroy(rb);
+    lepton_ringbuffer_init(rb, 4, 0);
+    lepton_ringbuffer_set_policy(rb, policy);
+    for (int i = 0; i < n; i++)
+    {
+        uint16_t (*slot)[LEPTON_WIDTH] = lepton_ringbuffer_reserve(rb);
+        if (slot == NULL)
+            continue;
+        slot[0][0] = (uint16_t)i;
+        lepton_ringbuffer_commit(rb);
+    }
+    for (const uint16_t (*slot)[LEPTON_WIDTH]; (slot = lepton_ringbuffer_acquire(rb)) != NULL; count++)
+    {
+        if (slot[0][0] != first_expected + count)
+        {
+            printf("FAIL: %s frame %d = %u\n", lepton_ringbuffer_policy_name(policy), count, slot[0][0]);
+            return 0;
+        }
+        lepton_ringbuffer_release(rb);
+    }
+    lepton_ringbuffer_get_drops(rb, &drops);
+    printf("policy %-12s: kept %d, dropped newest=%lu oldest=%lu\n",
+           lepton_ringbuffer_policy_name(policy), count, drops.dropped_newest, drops.dropped_oldest);
+    return count == expected_count && drops.dropped_newest == newest && drops.dropped_oldest == oldest;
+}
+
+// drop-oldest 경쟁: 생산자는 쉬지 않고 넣고 소비자는 슬롯을 제자리에서 검사한다.
+// 받은 번호는 증가해야 하고 내용이 중간에 바뀌면 안 된다.
+// drop-oldest는 commit 한 번에 많아야 한 프레임, 그것도 commit 전에 가득 차 있었을 때만 버려야 한다
+// (commit 전 개수는 소비자가 줄이기만 하므로, 가득 차지 않았으면 commit 중에도 자리가 있다).
+static unsigned long overdrops;
+
+static void *overwrite_producer(void *arg)
+{
+    LeptonRingBufferDrops before, after;
+    (void)arg;
+    for (unsigned long n = 1; n <= frames; n++)
+    {
+        uint16_t (*slot)[LEPTON_WIDTH] = lepton_ringbuffer_reserve(rb);
+        size_t count;
+        for (int r = 0; r < LEPTON_HEIGHT; r++)
+            for (int c = 0; c < LEPTON_WIDTH; c++)
+                slot[r][c] = (uint16_t)n;
+        lepton_ringbuffer_get_drops(rb, &before);
+        count = lepton_ringbuffer_count(rb);
+        lepton_ringbuffer_commit(rb);
+        lepton_ringbuffer_get_drops(rb, &after);
+        if (rb->policy == RINGBUFFER_DROP_OLDEST)
+        {
+            unsigned long dropped = after.dropped_oldest - before.dropped_oldest;
+            if (dropped > 1 || (dropped == 1 && count < rb->capacity))
+                overdrops++;
+        }
+    }
+    return NULL;
+}
+
+static void *overwrite_consumer(void *arg)
+{
+    uint16_t last = 0;
+    (void)arg;
+    while (last != (uint16_t)frames)
+    {
+        const uint16_t (*slot)[LEPTON_WIDTH] = lepton_ringbuffer_acquire_wait(rb, 1000);
+        if (slot == NULL)
+        {
+            errors++;
+            break;
+        }
+        uint16_t v = slot[0][0];
+        if (v <= last)
+            errors++;
+        for (int r = 0; r < LEPTON_HEIGHT; r++)
+            for (int c = 0; c < LEPTON_WIDTH; c++)
+                if (slot[r][c] != v)
+                    errors++;
+        last = v;
+        lepton_ringbuffer_release(rb);
+    }
+    return NULL;
+}
+
+static int run_overwrite_stress(int policy)
+{
+    pthread_t p, c;
+    LeptonRingBufferDrops drops;
+
+    frames = 60000;     // uint16_t로 번호를 비교하므로 65535 이하
+    errors = 0;
+    overdrops = 0;
+    lepton_ringbuffer_destroy(rb);
+    lepton_ringbuffer_init(rb, 4, 0);
+    lepton_ringbuffer_set_policy(rb, policy);
+    pthread_create(&c, NULL, overwrite_consumer, NULL);
+    pthread_create(&p, NULL, overwrite_producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    lepton_ringbuffer_get_drops(rb, &drops);
+    printf("stress (%s): %lu frames, dropped oldest=%lu, errors=%lu, over-drops=%lu\n",
+           lepton_ringbuffer_policy_name(policy), frames, drops.dropped_oldest, errors, overdrops);
+    return errors == 0 && overdrops == 0;
+}
+
+static int poll_consumer;
+static LatencyHist latency;
+
+static void *paced_producer(void *arg)
+{
+    (void)arg;
+    for (unsigned long n = 0; n < frames; n++)
+    {
+        usleep(37000);
+        uint16_t (*slot)[LEPTON_WIDTH] = lepton_ringbuffer_reserve(rb);
+        if (slot == NULL)
+            continue;
+        slot[0][0] = (uint16_t)n;
+        lepton_ringbuffer_commit(rb);
+    }
+    return NULL;
+}
+
+static void *latency_consumer(void *arg)
+{
+    (void)arg;
+    for (unsigned long n = 0; n < frames; )
+    {
+        const uint16_t (*slot)[LEPTON_WIDTH];
+        if (poll_consumer)
+        {
+            slot = lepton_ringbuffer_acquire(rb);
+            if (slot == NULL)
+            {
+                usleep(37000);
+                continue;
+            }
+        }
+        else
+        {
+            slot = lepton_ringbuffer_acquire_wait(rb, 1000);
+            if (slot == NULL)
+            {
+                errors++;
+                break;
+            }
+        }
+        latency_hist_add(&latency, latency_now_ns() - lepton_ringbuffer_commit_time(rb));
+        lepton_ringbuffer_release(rb);
+        n++;
+    }
+    return NULL;
+}
+
+static void run_latency(int poll)
+{
+    pthread_t p, c;
+    poll_consumer = poll;
+    frames = LATENCY_FRAMES;
+    errors = 0;
+    latency_hist_reset(&latency);
+    lepton_ringbuffer_destroy(rb);
+    if (lepton_ringbuffer_init(rb, RINGBUFFER_DEFAULT_CAPACITY, 0) < 0)
+        exit(1);
+
+    pthread_create(&c, NULL, latency_consumer, NULL);
+    pthread_create(&p, NULL, paced_producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    latency_hist_print(&latency, poll ? "commit->dequeue (polling 37ms)" : "commit->dequeue (acquire_wait)");
+}
+
+static double run(int mutex, int check, unsigned long n, size_t capacity)
+{
+    pthread_t p, c;
+    use_mutex = mutex;
+    full_check = check;
+    frames = n;
+    errors = 0;
+    lepton_ringbuffer_destroy(rb);
+    if (lepton_ringbuffer_init(rb, capacity, 0) < 0)
+        exit(1);
+
+    double t0 = now_sec();
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    return now_sec() - t0;
+}
+
+int main(void)
+{
+    rb = aligned_alloc(RINGBUFFER_CACHELINE, sizeof(LeptonRingBuffer));
+    if (rb == NULL)
+    {
+        perror("aligned_alloc()");
+        return 1;
+    }
+    memset(rb, 0, sizeof(*rb));
+
+    // capacity가 2의 거듭제곱이 아닐 때 올림되는지 확인
+    if (lepton_ringbuffer_init(rb, 5, 0) < 0 || rb->capacity != 8 ||
+        lepton_ringbuffer_memory_budget(5, 0) < 10 * sizeof(uint16_t) * LEPTON_HEIGHT * LEPTON_WIDTH)
+    {
+        printf("FAIL: capacity rounding\n");
+        return 1;
+    }
+    for (size_t d = 1; d <= 128; d *= 4)
+    {
+        printf("depth %3zu: %8zu B (4KB pages), %8zu B (hugepage)\n", d,
+               lepton_ringbuffer_memory_budget(d, 0),
+               lepton_ringbuffer_memory_budget(d, RINGBUFFER_HUGEPAGE));
+    }
+
+    run(0, 1, STRESS_FRAMES, 4);
+    printf("stress (lock-free): %d frames, errors=%lu, remaining=%zu\n",
+           STRESS_FRAMES, errors, lepton_ringbuffer_count(rb));
+    if (errors || lepton_ringbuffer_count(rb))
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    for (int mutex = 0; mutex <= 1; mutex++)
+    {
+        double sec = run(mutex, 0, BENCH_FRAMES, RINGBUFFER_DEFAULT_CAPACITY);
+        printf("%-10s %10.0f frames/s %8.1f ns/frame errors=%lu\n",
+               mutex ? "mutex" : "lock-free", BENCH_FRAMES / sec, sec * 1e9 / BENCH_FRAMES, errors);
+    }
+
+    // capacity 4에 10개: drop-newest는 0~3, drop-oldest는 6~9, latest는 9만 남는다.
+    if (!check_policy(RINGBUFFER_DROP_NEWEST, 10, 0, 4, 6, 0) ||
+        !check_policy(RINGBUFFER_DROP_OLDEST, 10, 6, 4, 0, 6) ||
+        !check_policy(RINGBUFFER_LATEST_ONLY, 10, 9, 1, 0, 9))
+    {
+        printf("FAIL: overflow policy\n");
+        return 1;
+    }
+    if (!run_overwrite_stress(RINGBUFFER_DROP_OLDEST) || !run_overwrite_stress(RINGBUFFER_LATEST_ONLY))
+    {
+        printf("FAIL: overwrite stress\n");
+        return 1;
+    }
+
+    // 빈 버퍼에서 timeout이 지켜지는지 확인
+    lepton_ringbuffer_destroy(rb);
+    lepton_ringbuffer_init(rb, 4, 0);
+    uint64_t t0 = latency_now_ns();
+    if (lepton_ringbuffer_acquire_wait(rb, 50) != NULL || latency_now_ns() - t0 < 50000000ULL)
+    {
+        printf("FAIL: acquire_wait timeout\n");
+        return 1;
+    }
+
+    run_latency(1);
+    run_latency(0);
+    if (errors)
+    {
+        printf("FAIL: acquire_wait missed a frame\n");
+        return 1;
+    }
+
+    lepton_ringbuffer_destroy(rb);
+    free(rb);
+    return 0;
+}
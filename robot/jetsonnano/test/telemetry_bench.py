@@ -0,0 +1,310 @@
+"""
+센서값(TELEMETRY) 전송 loopback 벤치마크: JSON 줄 vs 바이너리 TLV (docs/Protocol.md 2.3, 2.4)
+
+  1. HELLO 협상 확인: server.handle_client()에 TCP loopback으로 붙어서
+     HELLO를 보내면 응답 뒤로 TLV 레코드가, 안 보내면(예전 클라이언트) JSON 줄이 오는지 본다.
+  2. 최대 속도: 송신 프로세스(fork)가 TCP loopback으로 N개를 쉬지 않고 보내고 이 프로세스가 받아서 디코드.
+     messages/s, 메시지당 송신/수신 CPU 시간(us), 메시지 크기
+  3. 고정 주기: server.send_telemetry()를 10Hz / 100Hz로 2초 돌렸을 때 송신 CPU 사용률과 실제 주기, write 횟수
+  4. 명령 -> ACK 왕복 시간: 100Hz 센서값이 흐르는 중에 DRIVE F / STOP 쌍을 seq를 붙여 보내고
+     같은 seq의 ACK까지 시간 (p50/p99/max)과 ACK에 담긴 로봇 처리 시간
+     클라이언트 TCP_NODELAY 켬/끔 비교
+
+수신 쪽 JetDash(C++) 파서의 ns/message는 JetDash/bench/telemetry_bench.cpp에서 잰다.
+
+Usage: python3 test/telemetry_bench.py [-n 200000]
+"""
+
+import argparse
+import json
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src'))
+import server  # noqa: E402
+
+
+# --- 수신 쪽 (JetDash TelemetryParser와 같은 규칙) ---
+class StreamDecoder:
+    def __init__(self):
+        self.buf = bytearray()
+        self.json_msgs = 0
+        self.tlv_msgs = 0
+        self.other = []         # TELEMETRY가 아닌 JSON 줄 (HELLO 응답 등)
+
+    def feed(self, data, out):
+        buf = self.buf
+        buf += data
+        pos = 0
+        n = len(buf)
+        while pos < n:
+            if buf[pos] == server.TLV_SYNC:
+                if n - pos < 2 or n - pos < 2 + buf[pos + 1]:
+                    break
+                body = bytes(buf[pos + 2:pos + 2 + buf[pos + 1]])
+                pos += 2 + buf[pos + 1]
+                out.append(decode_tlv(body))
+                self.tlv_msgs += 1
+                continue
+            nl = buf.find(b'\n', pos)
+            if nl < 0:
+                break
+            line = bytes(buf[pos:nl])
+            pos = nl + 1
+            if not line.strip():
+                continue
+            msg = json.loads(line)
+            if msg.get('type') == 'TELEMETRY':
+                p = msg.get('payload', {})
+                out.append((p.get('co_ppm', 0), p.get('obstacle_cm', 0), p.get('rollover', False)))
+                self.json_msgs += 1
+            else:
+                self.other.append(msg)
+        del buf[:pos]
+
+
+def decode_tlv(body):
+    co = obstacle = 0
+    rollover = False
+    i = 0
+    while i < len(body):
+        tag, n = body[i], body[i + 1]
+        v = body[i + 2:i + 2 + n]
+        if len(v) != n:
+            raise ValueError('TLV가 레코드 밖으로 넘어감')
+        if tag == server.TLV_CO_PPM and n == 2:
+            co = struct.unpack('<h', v)[0]
+        elif tag == server.TLV_OBSTACLE_CM and n == 2:
+            obstacle = struct.unpack('<h', v)[0]
+        elif tag == server.TLV_ROLLOVER and n == 1:
+            rollover = v[0] != 0
+        i += 2 + n
+    return co, obstacle, rollover
+
+
+def check_encoding():
+    ok = True
+    for values in [(12, 150, False), (0, 0, True), (-4, 32767, False), (50, 10, True), (99999, -99999, False)]:
+        out = []
+        d = StreamDecoder()
+        # 한 바이트씩 들어와도 같은 결과여야 함 (0x0A가 값 안에 있어도 줄로 자르지 않음)
+        for b in server.encode_telemetry_tlv(*values) + server.encode_telemetry_json(*values):
+            d.feed(bytes([b]), out)
+        want = (max(-32768, min(32767, values[0])), max(-32768, min(32767, values[1])), values[2])
+        if out != [want, tuple(values)]:
+            print(f'  encode/decode mismatch: {values} -> {out}')
+            ok = False
+    print(f'encode/decode: {"ok" if ok else "FAIL"}  (TLV {len(server.encode_telemetry_tlv(12, 150, False))}B, '
+          f'JSON {len(server.encode_telemetry_json(12, 150, False))}B)')
+    return ok
+
+
+def tcp_pair():
+    # (서버 쪽, 클라이언트 쪽) TCP loopback 연결. socketpair는 AF_UNIX라 TCP 옵션을 못 씀
+    lsock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    lsock.bind(('127.0.0.1', 0))
+    lsock.listen(1)
+    c = socket.create_connection(lsock.getsockname())
+    conn, _ = lsock.accept()
+    lsock.close()
+    return conn, c
+
+
+def check_negotiation(send_hello):
+    a, b = tcp_pair()
+    threading.Thread(target=server.handle_client, args=(a, 100), daemon=True).start()
+    if send_hello:
+        b.sendall(b'{"type":"HELLO","payload":{"telemetry":["TLV","JSON"]}}\n')
+    d = StreamDecoder()
+    out = []
+    b.settimeout(0.5)
+    end = time.monotonic() + 0.5
+    while time.monotonic() < end:
+        try:
+            data = b.recv(4096)
+        except socket.timeout:
+            break
+        if not data:
+            break
+        d.feed(data, out)
+    b.close()
+
+    hello = [m for m in d.other if m.get('type') == 'HELLO']
+    if send_hello:
+        # 응답 전에 JSON이 몇 개 올 수 있고, 응답 뒤로는 전부 TLV
+        ok = bool(hello) and hello[0]['payload']['telemetry'] == 'TLV' and d.tlv_msgs > 0
+    else:
+        ok = not hello and d.tlv_msgs == 0 and d.json_msgs > 0
+    print(f'negotiation ({"HELLO" if send_hello else "legacy"}): json {d.json_msgs}, tlv {d.tlv_msgs}, '
+          f'hello {[m["payload"] for m in hello]} -> {"ok" if ok else "FAIL"}')
+    return ok
+
+
+def run_max_rate(mode, count):
+    lsock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    lsock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    lsock.bind(('127.0.0.1', 0))
+    lsock.listen(1)
+    port = lsock.getsockname()[1]
+    rpipe, wpipe = os.pipe()
+
+    pid = os.fork()
+    if pid == 0:
+        # 송신 프로세스: server.py와 같은 인코더로 한 메시지씩 sendall
+        lsock.close()
+        os.close(rpipe)
+        s = socket.create_connection(('127.0.0.1', port))
+        encode = server.encode_telemetry_tlv if mode == 'TLV' else server.encode_telemetry_json
+        c0 = time.process_time()
+        for i in range(count):
+            s.sendall(encode(i % 51, 10 + i % 191, i % 97 == 0))
+        cpu = time.process_time() - c0
+        s.close()
+        os.write(wpipe, struct.pack('<d', cpu))
+        os._exit(0)
+
+    os.close(wpipe)
+    conn, _ = lsock.accept()
+    lsock.close()
+    d = StreamDecoder()
+    out = []
+    t0 = time.monotonic()
+    c0 = time.process_time()
+    total = 0
+    while True:
+        data = conn.recv(65536)
+        if not data:
+            break
+        total += len(data)
+        d.feed(data, out)
+    recv_cpu = time.process_time() - c0
+    wall = time.monotonic() - t0
+    conn.close()
+    send_cpu = struct.unpack('<d', os.read(rpipe, 8))[0]
+    os.close(rpipe)
+    os.waitpid(pid, 0)
+
+    ok = len(out) == count and all(out[i] == (i % 51, 10 + i % 191, i % 97 == 0) for i in range(count))
+    print(f'{mode:4s} max rate: {count / wall:10.0f} msg/s  {total / count:5.1f} B/msg  '
+          f'send {send_cpu / count * 1e6:5.2f} us/msg  recv {recv_cpu / count * 1e6:5.2f} us/msg  '
+          f'{"ok" if ok else "MISMATCH"}')
+    return ok
+
+
+def run_paced(mode, hz, seconds=2.0):
+    a, b = socket.socketpair()
+    rpipe, wpipe = os.pipe()
+    pid = os.fork()
+    if pid == 0:
+        b.close()
+        os.close(rpipe)
+        session = server.Session(a)
+        session.telemetry = mode
+        sys.stdout = open(os.devnull, 'w')
+        c0 = time.process_time()
+        server.send_telemetry(session, hz)           # 상대가 닫으면 끝남
+        os.write(wpipe, struct.pack('<d', time.process_time() - c0))
+        os._exit(0)
+
+    a.close()
+    os.close(wpipe)
+    d = StreamDecoder()
+    out = []
+    reads = 0
+    t0 = time.monotonic()
+    while time.monotonic() - t0 < seconds:
+        d.feed(b.recv(65536), out)
+        reads += 1
+    wall = time.monotonic() - t0
+    b.close()
+    cpu = struct.unpack('<d', os.read(rpipe, 8))[0]
+    os.close(rpipe)
+    os.waitpid(pid, 0)
+    print(f'{mode:4s} {hz:5.0f} Hz: {len(out) / wall:6.1f} msg/s  {reads / wall:6.1f} writes/s  '
+          f'send CPU {cpu / wall * 100:5.2f} %  ({cpu / max(len(out), 1) * 1e6:6.1f} us/msg incl. sleep loop)')
+
+
+def run_command_rtt(nodelay, pairs=100):
+    conn, c = tcp_pair()
+    c.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1 if nodelay else 0)
+
+    devnull = open(os.devnull, 'w')
+    stdout, sys.stdout = sys.stdout, devnull      # process_command의 출력 끄기
+    threading.Thread(target=server.handle_client, args=(conn, 100), daemon=True).start()
+
+    sent = {}           # seq -> 보낸 시각
+    rtts = []
+    robot = []          # ACK의 exec_ns - rx_ns
+    done = threading.Event()
+
+    def reader():
+        d = StreamDecoder()
+        out = []
+        while len(rtts) < pairs * 2:
+            data = c.recv(65536)
+            if not data:
+                break
+            now = time.monotonic()
+            d.feed(data, out)
+            while d.other:
+                msg = d.other.pop(0)
+                if msg.get('type') != 'ACK':
+                    continue
+                p = msg['payload']
+                if p.get('seq') in sent:
+                    rtts.append(now - sent.pop(p['seq']))
+                    robot.append(p['exec_ns'] - p['rx_ns'])
+        done.set()
+
+    threading.Thread(target=reader, daemon=True).start()
+    c.sendall(b'{"type":"HELLO","payload":{"telemetry":["TLV","JSON"]}}\n')
+    time.sleep(0.1)
+    seq = 0
+    for i in range(pairs):
+        # 키를 눌렀다 바로 뗀 경우: 두 번째 작은 패킷이 첫 패킷의 ACK를 기다리는지 봄
+        for cmd in (b'"F"', b'"STOP"'):
+            seq += 1
+            sent[seq] = time.monotonic()
+            c.sendall(b'{"type":"COMMAND","seq":%d,"payload":{"target":"DRIVE","value":%s}}\n' % (seq, cmd))
+            time.sleep(0.002)
+        time.sleep(0.02 + (i % 7) * 0.003)
+    done.wait(2.0)
+    c.close()
+    sys.stdout = stdout
+
+    if not rtts:
+        print(f'command RTT (client nodelay {int(nodelay)}): no ACK')
+        return False
+    rtts.sort()
+    ms = [x * 1000 for x in rtts]
+    robot.sort()
+    print(f'command RTT (client nodelay {int(nodelay)}): {len(ms)} acks  p50 {ms[len(ms) // 2]:6.3f} ms  '
+          f'p99 {ms[min(len(ms) - 1, len(ms) * 99 // 100)]:6.3f} ms  max {ms[-1]:6.3f} ms  '
+          f'(robot exec p50 {robot[len(robot) // 2] / 1e6:6.3f} ms)')
+    return len(ms) == pairs * 2
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument('-n', type=int, default=200000, help='최대 속도 측정 메시지 수')
+    args = ap.parse_args()
+
+    ok = check_encoding()
+    ok &= check_negotiation(True)
+    ok &= check_negotiation(False)
+    for mode in ('JSON', 'TLV'):
+        ok &= run_max_rate(mode, args.n)
+    for hz in (10, 100):
+        for mode in ('JSON', 'TLV'):
+            run_paced(mode, hz)
+    for nodelay in (True, False):
+        ok &= run_command_rtt(nodelay)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
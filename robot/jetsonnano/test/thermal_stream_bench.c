@@ -0,0 +1,329 @@
+/*
+ * 열화상 프레임 바이너리 스트림 loopback 벤치마크
+ *
+ * 같은 프로세스 안에서 ThermalServer(송신)와 클라이언트(수신) thread를 돌려
+ * TCP / UDP 각각 27Hz와 최대 속도로 프레임을 보내고 다음을 측정한다.
+ *   - 처리량 (frames/s, MB/s)
+ *   - send -> 수신 완료 지연 히스토그램 (헤더의 timestamp_ns 기준, 같은 호스트라 시계가 같다)
+ *   - 빠진 프레임 수 (seq 기준), payload 손상 여부
+ * 끝으로 UDP 구독자가 사라졌을 때(포트를 닫음 / 재구독 없음) 서버가 구독을 지우는지 확인한다.
+ * payload는 RAW16과 DELTA_PACK(무손실 압축, 수신 측에서 복원 후 검사) 둘 다 돌린다.
+ * 비교용으로 같은 프레임을 JSON 숫자 배열로 만들었을 때의 크기도 출력한다.
+ *
+ * Build: gcc -O2 -pthread -o thermal_stream_bench test/thermal_stream_bench.c src/network.c \
+ *            src/thermal_codec.c src/latency_hist.c src/audio_codec.c src/jitter_buffer.c -lm
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "../include/network.h"
+#include "../include/latency_hist.h"
+#include "../include/thermal_codec.h"
+
+#define BENCH_TCP_PORT 15001
+#define BENCH_UDP_PORT 15002
+#define FRAME_BYTES (sizeof(uint16_t) * LEPTON_HEIGHT * LEPTON_WIDTH)
+
+typedef struct {
+    int udp;            // 0: TCP, 1: UDP
+    int format;         // THERMAL_FORMAT_*
+    int rate_hz;        // 0: 최대 속도
+    int frames;
+    // 결과
+    unsigned long received;
+    unsigned long lost;
+    unsigned long corrupt;
+    unsigned long bytes;
+    LatencyHist latency;
+    double seconds;
+} BenchRun;
+
+static ThermalServer server;
+static ThermalDecoder decoder;
+static volatile int client_ready;
+
+static void fill_frame(uint16_t (*frame)[LEPTON_WIDTH], uint32_t seq)
+{
+    for (int r = 0; r < LEPTON_HEIGHT; r++)
+        for (int c = 0; c < LEPTON_WIDTH; c++)
+            frame[r][c] = (uint16_t)(7000 + ((seq + r * 3 + c) & 0x3ff));
+}
+
+static int check_frame(const uint16_t *p, uint32_t seq)
+{
+    return p[0] == (uint16_t)(7000 + (seq & 0x3ff)) &&
+           p[LEPTON_HEIGHT * LEPTON_WIDTH - 1] ==
+           (uint16_t)(7000 + ((seq + (LEPTON_HEIGHT - 1) * 3 + LEPTON_WIDTH - 1) & 0x3ff));
+}
+
+static int recv_all(int fd, uint8_t *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// 받은 프레임 하나를 (필요하면 복원해서) 검사하고 통계에 더한다. 마지막 프레임이면 0
+static int account(BenchRun *run, const uint8_t *msg, uint32_t *next_seq)
+{
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    ThermalFrameHeader h;
+    const uint16_t *pixels = (const uint16_t *)(msg + THERMAL_HEADER_SIZE);
+
+    if (thermal_header_decode(&h, msg) < 0)
+    {
+        run->corrupt++;
+        return 1;
+    }
+    if (h.seq > *next_seq)
+    {
+        run->lost += h.seq - *next_seq;
+        thermal_decoder_init(&decoder);     // 시간 예측이 끊겼으므로 keyframe부터 다시
+    }
+    *next_seq = h.seq + 1;
+    if (h.format == THERMAL_FORMAT_DELTA_PACK)
+    {
+        int ret = thermal_decode(&decoder, msg + h.header_size, h.payload_size, frame);
+        if (ret == 0)
+        {
+            run->lost++;                    // keyframe을 기다리는 동안은 보여줄 수 없다
+            return h.seq + 1 < (uint32_t)run->frames;
+        }
+        if (ret < 0)
+        {
+            run->corrupt++;
+            return 1;
+        }
+        pixels = frame[0];
+    }
+    else if (h.payload_size != FRAME_BYTES)
+    {
+        run->corrupt++;
+        return 1;
+    }
+    if (!check_frame(pixels, h.seq))
+        run->corrupt++;
+    run->received++;
+    run->bytes += THERMAL_HEADER_SIZE + h.payload_size;
+    latency_hist_add(&run->latency, latency_now_ns() - h.timestamp_ns);
+    return h.seq + 1 < (uint32_t)run->frames;
+}
+
+static void *client_thread(void *arg)
+{
+    BenchRun *run = arg;
+    static uint8_t msg[THERMAL_HEADER_SIZE + THERMAL_CODEC_MAX_BYTES];
+    struct sockaddr_in addr;
+    uint32_t next_seq = 0;
+    int fd;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (!run->udp)
+    {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        addr.sin_port = htons(BENCH_TCP_PORT);
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            perror("connect()");
+            return NULL;
+        }
+        client_ready = 1;
+        while (recv_all(fd, msg, THERMAL_HEADER_SIZE) > 0)
+        {
+            ThermalFrameHeader h;
+            if (thermal_header_decode(&h, msg) < 0 || h.payload_size > THERMAL_CODEC_MAX_BYTES)
+            {
+                run->corrupt++;
+                break;      // 스트림 경계를 잃었다
+            }
+            if (recv_all(fd, msg + THERMAL_HEADER_SIZE, h.payload_size) < 0 ||
+                !account(run, msg, &next_seq))
+                break;
+        }
+    }
+    else
+    {
+        int rcvbuf = 4 * 1024 * 1024;
+        struct timeval tv = { 0, 500000 };
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        addr.sin_port = htons(BENCH_UDP_PORT);
+        sendto(fd, "SUB", 3, 0, (struct sockaddr *)&addr, sizeof(addr));
+        client_ready = 1;
+        for (;;)
+        {
+            ssize_t n = recv(fd, msg, sizeof(msg), 0);
+            if (n < 0)
+                break;      // timeout: 마지막 프레임이 빠졌다
+            if (n < THERMAL_HEADER_SIZE)
+            {
+                run->corrupt++;
+                continue;
+            }
+            if (!account(run, msg, &next_seq))
+                break;
+        }
+        if (next_seq < (uint32_t)run->frames)
+            run->lost += run->frames - next_seq;
+    }
+    close(fd);
+    return NULL;
+}
+
+static void run_bench(BenchRun *run)
+{
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    pthread_t client;
+    struct timespec next;
+    uint64_t period_ns = run->rate_hz ? 1000000000ULL / run->rate_hz : 0;
+
+    latency_hist_reset(&run->latency);
+    thermal_decoder_init(&decoder);
+    if (thermal_server_open(&server, run->udp ? 0 : BENCH_TCP_PORT, run->udp ? BENCH_UDP_PORT : 0) < 0)
+        exit(1);
+    thermal_server_set_format(&server, run->format);
+    client_ready = 0;
+    pthread_create(&client, NULL, client_thread, run);
+
+    // 클라이언트가 접속/구독할 때까지 기다린다. (poll()은 받아두기만 하고 첫 send_frame()에서 전송 목록으로 옮긴다)
+    while (!client_ready || (run->udp ? server.n_new_peers == 0 : server.n_new_clients == 0))
+    {
+        thermal_server_poll(&server);
+        usleep(1000);
+    }
+
+    uint64_t t0 = latency_now_ns();
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (int i = 0; i < run->frames; i++)
+    {
+        fill_frame(frame, (uint32_t)i);
+        thermal_server_send_frame(&server, (const uint16_t (*)[LEPTON_WIDTH])frame, (uint32_t)i, latency_now_ns());
+        if (period_ns)
+        {
+            next.tv_nsec += (long)period_ns;
+            while (next.tv_nsec >= 1000000000L)
+            {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    }
+    pthread_join(client, NULL);
+    run->seconds = (latency_now_ns() - t0) * 1e-9;
+    thermal_server_close(&server);
+}
+
+// 구독 후 소켓을 닫은 구독자는 ECONNREFUSED로, 재구독하지 않는 구독자는 timeout으로 지워져야 한다
+static int check_udp_expiry(void)
+{
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    struct sockaddr_in addr;
+    int closed = socket(AF_INET, SOCK_DGRAM, 0);
+    int silent = socket(AF_INET, SOCK_DGRAM, 0);
+    int refused_ok, expired_ok;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(BENCH_UDP_PORT);
+    if (thermal_server_open(&server, 0, BENCH_UDP_PORT) < 0)
+        exit(1);
+    sendto(closed, "SUB", 3, 0, (struct sockaddr *)&addr, sizeof(addr));
+    sendto(silent, "SUB", 3, 0, (struct sockaddr *)&addr, sizeof(addr));
+    while (server.n_new_peers < 2)
+    {
+        thermal_server_poll(&server);
+        usleep(1000);
+    }
+    fill_frame(frame, 0);
+    thermal_server_send_frame(&server, (const uint16_t (*)[LEPTON_WIDTH])frame, 0, latency_now_ns());
+    close(closed);
+    for (uint32_t seq = 1; seq < 10 && server.udp_npeers > 1; seq++)
+    {
+        thermal_server_send_frame(&server, (const uint16_t (*)[LEPTON_WIDTH])frame, seq, latency_now_ns());
+        usleep(10000);  // loopback ICMP가 돌아올 시간
+    }
+    refused_ok = (server.udp_npeers == 1);
+
+    // 남은 구독자의 마지막 구독 요청을 timeout 전으로 돌린다
+    server.udp_seen_ns[0] -= (THERMAL_UDP_PEER_TIMEOUT_S + 1) * 1000000000ULL;
+    thermal_server_send_frame(&server, (const uint16_t (*)[LEPTON_WIDTH])frame, 10, latency_now_ns());
+    expired_ok = (server.udp_npeers == 0);
+
+    printf("UDP 구독 정리: 포트 닫힘 %s, 재구독 없음 %s\n", refused_ok ? "OK" : "FAIL", expired_ok ? "OK" : "FAIL");
+    close(silent);
+    thermal_server_close(&server);
+    return refused_ok && expired_ok;
+}
+
+// 같은 프레임을 {"type":"THERMAL","payload":{"pixels":[...]}} 로 보낼 때의 크기
+static size_t json_frame_size(void)
+{
+    static uint16_t frame[LEPTON_HEIGHT][LEPTON_WIDTH];
+    char num[8];
+    size_t size = strlen("{\"type\":\"THERMAL\",\"payload\":{\"pixels\":[]}}\n");
+
+    fill_frame(frame, 0);
+    for (int r = 0; r < LEPTON_HEIGHT; r++)
+        for (int c = 0; c < LEPTON_WIDTH; c++)
+            size += (size_t)snprintf(num, sizeof(num), "%u,", frame[r][c]);
+    return size - 1;
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = (argc > 1) ? atoi(argv[1]) : 5000;
+    BenchRun runs[] = {
+        { .udp = 0, .format = THERMAL_FORMAT_RAW16, .rate_hz = 27, .frames = 81 },
+        { .udp = 0, .format = THERMAL_FORMAT_RAW16, .rate_hz = 0,  .frames = frames },
+        { .udp = 1, .format = THERMAL_FORMAT_RAW16, .rate_hz = 27, .frames = 81 },
+        { .udp = 1, .format = THERMAL_FORMAT_RAW16, .rate_hz = 0,  .frames = frames },
+        { .udp = 0, .format = THERMAL_FORMAT_DELTA_PACK, .rate_hz = 27, .frames = 81 },
+        { .udp = 0, .format = THERMAL_FORMAT_DELTA_PACK, .rate_hz = 0,  .frames = frames },
+        { .udp = 1, .format = THERMAL_FORMAT_DELTA_PACK, .rate_hz = 27, .frames = 81 },
+        { .udp = 1, .format = THERMAL_FORMAT_DELTA_PACK, .rate_hz = 0,  .frames = frames },
+    };
+    int failed = 0;
+
+    printf("frame %dx%d: binary %zu B, JSON %zu B\n", LEPTON_WIDTH, LEPTON_HEIGHT,
+           THERMAL_HEADER_SIZE + FRAME_BYTES, json_frame_size());
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++)
+    {
+        BenchRun *run = &runs[i];
+
+        run_bench(run);
+        printf("%s %-5s %-9s: %6lu frames %8.0f frames/s %8.1f MB/s %6lu B/frame lost=%lu corrupt=%lu\n",
+               run->udp ? "UDP" : "TCP", run->format == THERMAL_FORMAT_RAW16 ? "raw" : "delta",
+               run->rate_hz ? "27Hz" : "unlimited",
+               run->received, run->received / run->seconds,
+               run->bytes / run->seconds / 1e6,
+               run->received ? run->bytes / run->received : 0,
+               run->lost, run->corrupt);
+        latency_hist_print(&run->latency, "    send->recv");
+        if (run->corrupt || (!run->udp && run->lost))
+            failed = 1;
+    }
+    if (!check_udp_expiry())
+        failed = 1;
+    return failed;
+}
@@ -0,0 +1,116 @@
+/*
+ * VoSPI payload unpack 마이크로벤치마크 + 정확성 검사
+ *
+ * big-endian 16bit 픽셀 80개(한 패킷)를 byte swap + 14bit mask 해서 프레임에 쓰는
+ * scalar / SSSE3 / AVX2 / NEON 구현을 비교한다.
+ * 정확성: 임의 데이터, 길이 0~VOSPI_PACKET_PIXELS, 정렬되지 않은 src/dst에서 scalar와 결과가 같은지,
+ * dst 범위 밖을 건드리지 않는지 확인한다.
+ *
+ * Build: gcc -O2 -o vospi_unpack_bench test/vospi_unpack_bench.c src/vospi_unpack.c
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/vospi_unpack.h"
+#include "../include/lepton.h"
+
+#define BENCH_LINES 64
+#define BENCH_ROUNDS 50000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int check_impl(int impl)
+{
+    uint8_t src[2 * VOSPI_PACKET_PIXELS + 1];
+    uint16_t ref[VOSPI_PACKET_PIXELS + 2], out[VOSPI_PACKET_PIXELS + 2];
+    uint32_t seed = 7;
+
+    for (int round = 0; round < 200; round++)
+    {
+        for (size_t i = 0; i < sizeof(src); i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            src[i] = (uint8_t)(seed >> 16);
+        }
+        for (int n = 0; n <= VOSPI_PACKET_PIXELS; n++)
+        {
+            int off = round & 1;    // 홀수 주소에서 읽기
+            memset(ref, 0xa5, sizeof(ref));
+            memset(out, 0xa5, sizeof(out));
+            vospi_unpack_line_impl(ref + 1, src + off, n, VOSPI_UNPACK_IMPL_SCALAR);
+            vospi_unpack_line_impl(out + 1, src + off, n, impl);
+            if (memcmp(ref, out, sizeof(ref)) != 0)
+            {
+                printf("FAIL: %s n=%d off=%d\n", vospi_unpack_impl_name(impl), n, off);
+                return 0;
+            }
+        }
+    }
+    // 기준 구현 자체: 0x12 0x34 -> 0x1234, 0xff 0xff -> 0x3fff
+    {
+        const uint8_t be[4] = { 0x12, 0x34, 0xff, 0xff };
+        uint16_t px[2];
+        vospi_unpack_line_impl(px, be, 2, impl);
+        if (px[0] != 0x1234 || px[1] != VOSPI_PIXEL_MASK)
+        {
+            printf("FAIL: %s 기준값\n", vospi_unpack_impl_name(impl));
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(void)
+{
+    static uint8_t packets[BENCH_LINES][VOSPI_FRAME_SIZE];
+    static uint16_t frame[BENCH_LINES][VOSPI_PACKET_PIXELS];
+    uint32_t seed = 1;
+    int failed = 0;
+
+    vospi_unpack_init();
+    for (int p = 0; p < BENCH_LINES; p++)
+    {
+        for (int i = 0; i < VOSPI_FRAME_SIZE; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            packets[p][i] = (uint8_t)(seed >> 16);
+        }
+    }
+
+    for (int impl = 0; impl < VOSPI_UNPACK_IMPL_COUNT; impl++)
+    {
+        if (!vospi_unpack_impl_available(impl))
+        {
+            printf("%-7s  (사용 불가)\n", vospi_unpack_impl_name(impl));
+            continue;
+        }
+        if (!check_impl(impl))
+        {
+            failed = 1;
+            continue;
+        }
+
+        double t0 = now_sec();
+        for (int r = 0; r < BENCH_ROUNDS; r++)
+        {
+            for (int p = 0; p < BENCH_LINES; p++)
+                vospi_unpack_line_impl(frame[p], packets[p] + 4, VOSPI_PACKET_PIXELS, impl);
+            __asm__ volatile("" : : "r"(frame) : "memory");
+        }
+        double t1 = now_sec();
+        double ns = (t1 - t0) * 1e9 / ((double)BENCH_ROUNDS * BENCH_LINES);
+        printf("%-7s %7.1f ns/line %7.2f GB/s %8.1f us/frame (%d packets)\n",
+               vospi_unpack_impl_name(impl), ns, 2 * VOSPI_PACKET_PIXELS / ns,
+               ns * VOSPI_SEGMENT_PACKETS * LEPTON_SEGMENTS / 1000, VOSPI_SEGMENT_PACKETS * LEPTON_SEGMENTS);
+    }
+    printf("active: %s\n", vospi_unpack_impl_name(vospi_unpack_active_impl()));
+    return failed;
+}